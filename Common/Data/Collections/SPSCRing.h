@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include "Common/Log.h"
+
+// Wait-free ring buffer for exactly one producer thread and one consumer thread, for bulk transfers
+// like audio. Neither side ever blocks or spins on the other: they only share the two indices, which
+// are kept on separate cache lines so that they don't bounce between cores on every access.
+//
+// Each side also keeps a stale copy of the other side's index, and only reloads it when that copy
+// says there's not enough room (or data). So most calls don't touch the other side's cache line at all.
+//
+// The capacity must be a power of two. Indices run freely and wrap around, so the full capacity is usable.
+// T must be trivially copyable.
+template <class T>
+class SPSCRing {
+public:
+	explicit SPSCRing(size_t capacity) : capacity_(capacity), mask_(capacity - 1) {
+		_dbg_assert_((capacity & (capacity - 1)) == 0);
+		storage_ = new T[capacity]();
+	}
+	~SPSCRing() {
+		delete[] storage_;
+	}
+
+	SPSCRing(const SPSCRing &) = delete;
+	SPSCRing &operator=(const SPSCRing &) = delete;
+
+	size_t Capacity() const { return capacity_; }
+
+	// Producer side.
+
+	// How much can be written right now. More may become available at any time.
+	size_t WriteAvailable() {
+		size_t w = write_.index.load(std::memory_order_relaxed);
+		write_.cachedRead = read_.index.load(std::memory_order_acquire);
+		return capacity_ - (w - write_.cachedRead);
+	}
+
+	// Gets up to two pointers to write count items to directly, wrapping around the end of the buffer.
+	// Returns false (without reserving anything) if there isn't room. Call EndWrite() when done.
+	bool BeginWrite(size_t count, T **dest1, size_t *sz1, T **dest2, size_t *sz2) {
+		size_t w = write_.index.load(std::memory_order_relaxed);
+		if (capacity_ - (w - write_.cachedRead) < count) {
+			write_.cachedRead = read_.index.load(std::memory_order_acquire);
+			if (capacity_ - (w - write_.cachedRead) < count)
+				return false;
+		}
+		size_t offset = w & mask_;
+		*dest1 = storage_ + offset;
+		*sz1 = std::min(count, capacity_ - offset);
+		*sz2 = count - *sz1;
+		*dest2 = *sz2 ? storage_ : nullptr;
+		return true;
+	}
+
+	// Publishes count items written through the pointers from BeginWrite().
+	void EndWrite(size_t count) {
+		write_.index.store(write_.index.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	// All or nothing.
+	bool Push(const T *data, size_t count) {
+		T *dest1, *dest2;
+		size_t sz1, sz2;
+		if (!BeginWrite(count, &dest1, &sz1, &dest2, &sz2))
+			return false;
+		memcpy(dest1, data, sz1 * sizeof(T));
+		if (sz2)
+			memcpy(dest2, data + sz1, sz2 * sizeof(T));
+		EndWrite(count);
+		return true;
+	}
+
+	// Consumer side.
+
+	// How much can be read right now. More may show up at any time.
+	size_t ReadAvailable() {
+		size_t r = read_.index.load(std::memory_order_relaxed);
+		read_.cachedWrite = write_.index.load(std::memory_order_acquire);
+		return read_.cachedWrite - r;
+	}
+
+	// Looks at an item without consuming it. Only valid for offset < ReadAvailable().
+	const T &Peek(size_t offset) const {
+		return storage_[(read_.index.load(std::memory_order_relaxed) + offset) & mask_];
+	}
+
+	// Copies count items starting at offset (which must all be available) without consuming them.
+	void PeekRange(size_t offset, T *out, size_t count) const {
+		size_t start = (read_.index.load(std::memory_order_relaxed) + offset) & mask_;
+		size_t sz1 = std::min(count, capacity_ - start);
+		memcpy(out, storage_ + start, sz1 * sizeof(T));
+		if (count > sz1)
+			memcpy(out + sz1, storage_, (count - sz1) * sizeof(T));
+	}
+
+	// Releases count items (which must be available) back to the producer.
+	void Consume(size_t count) {
+		read_.index.store(read_.index.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	// Reads up to count items, returns how many were read.
+	size_t Pop(T *out, size_t count) {
+		size_t r = read_.index.load(std::memory_order_relaxed);
+		if (read_.cachedWrite - r < count)
+			read_.cachedWrite = write_.index.load(std::memory_order_acquire);
+		count = std::min(count, read_.cachedWrite - r);
+		PeekRange(0, out, count);
+		Consume(count);
+		return count;
+	}
+
+	// Either side. Only a snapshot, for statistics and heuristics.
+	size_t SizeApprox() const {
+		size_t r = read_.index.load(std::memory_order_relaxed);
+		size_t w = write_.index.load(std::memory_order_relaxed);
+		return w - r;
+	}
+
+private:
+	enum { CACHE_LINE = 64 };
+
+	struct alignas(CACHE_LINE) WriteSide {
+		std::atomic<size_t> index{};
+		size_t cachedRead = 0;
+	};
+	struct alignas(CACHE_LINE) ReadSide {
+		std::atomic<size_t> index{};
+		size_t cachedWrite = 0;
+	};
+
+	WriteSide write_;
+	ReadSide read_;
+	// Not touched after construction, so fine to share a line.
+	alignas(CACHE_LINE) T *storage_;
+	size_t capacity_;
+	size_t mask_;
+};
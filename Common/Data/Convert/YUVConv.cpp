@@ -0,0 +1,298 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#include "Common/Data/Convert/YUVConv.h"
+#include "Common/Math/CrossSIMD.h"
+
+// The SIMD paths do 16 pixels at a time in 16-bit lanes. The BT.601 constants are chosen so that nothing
+// overflows except y + 129 * u for blue, which saturates - and anything that large clamps to 255 anyway.
+
+template <YUVOutputFormat F>
+static inline void StorePixel(void *dst, int x, int r, int g, int b) {
+	switch (F) {
+	case YUVOutputFormat::RGBA8888:
+		((u32 *)dst)[x] = (b << 16) | (g << 8) | r;
+		break;
+	case YUVOutputFormat::RGB565:
+		((u16 *)dst)[x] = (u16)((r >> 3) | ((g >> 2) << 5) | ((b >> 3) << 11));
+		break;
+	case YUVOutputFormat::RGBA5551:
+		((u16 *)dst)[x] = (u16)((r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10));
+		break;
+	case YUVOutputFormat::RGBA4444:
+		((u16 *)dst)[x] = (u16)((r >> 4) | ((g >> 4) << 4) | ((b >> 4) << 8));
+		break;
+	}
+}
+
+#if PPSSPP_ARCH(SSE2)
+
+static inline void YUVToRGB_BT601_SSE2(__m128i y, __m128i u, __m128i v, __m128i *r, __m128i *g, __m128i *b) {
+	__m128i ys = _mm_sub_epi16(y, _mm_set1_epi16(16));
+	__m128i y1 = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(ys, _mm_set1_epi16(74)), _mm_srai_epi16(ys, 1)), _mm_set1_epi16(32));
+	__m128i uv = _mm_add_epi16(_mm_mullo_epi16(u, _mm_set1_epi16(25)), _mm_mullo_epi16(v, _mm_set1_epi16(52)));
+	*r = _mm_srai_epi16(_mm_adds_epi16(y1, _mm_mullo_epi16(v, _mm_set1_epi16(102))), 6);
+	*g = _mm_srai_epi16(_mm_subs_epi16(y1, uv), 6);
+	*b = _mm_srai_epi16(_mm_adds_epi16(y1, _mm_mullo_epi16(u, _mm_set1_epi16(129))), 6);
+}
+
+// r8, g8 and b8 hold 16 clamped components each.
+template <YUVOutputFormat F>
+static inline void Store16Pixels(void *dst, int x, __m128i r8, __m128i g8, __m128i b8) {
+	const __m128i zero = _mm_setzero_si128();
+	if (F == YUVOutputFormat::RGBA8888) {
+		__m128i rgLo = _mm_unpacklo_epi8(r8, g8);
+		__m128i rgHi = _mm_unpackhi_epi8(r8, g8);
+		__m128i bLo = _mm_unpacklo_epi8(b8, zero);
+		__m128i bHi = _mm_unpackhi_epi8(b8, zero);
+		__m128i *out = (__m128i *)((u32 *)dst + x);
+		_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rgLo, bLo));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLo, bLo));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHi, bHi));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHi, bHi));
+		return;
+	}
+
+	__m128i *out = (__m128i *)((u16 *)dst + x);
+	for (int half = 0; half < 2; half++) {
+		__m128i r = half ? _mm_unpackhi_epi8(r8, zero) : _mm_unpacklo_epi8(r8, zero);
+		__m128i g = half ? _mm_unpackhi_epi8(g8, zero) : _mm_unpacklo_epi8(g8, zero);
+		__m128i b = half ? _mm_unpackhi_epi8(b8, zero) : _mm_unpacklo_epi8(b8, zero);
+		__m128i px;
+		if (F == YUVOutputFormat::RGB565) {
+			px = _mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 2), 5));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 3), 11));
+		} else if (F == YUVOutputFormat::RGBA5551) {
+			px = _mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 3), 5));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 3), 10));
+		} else {
+			px = _mm_or_si128(_mm_srli_epi16(r, 4), _mm_slli_epi16(_mm_srli_epi16(g, 4), 4));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 4), 8));
+		}
+		_mm_storeu_si128(out + half, px);
+	}
+}
+
+#elif PPSSPP_ARCH(ARM_NEON)
+
+static inline void YUVToRGB_BT601_NEON(int16x8_t y, int16x8_t u, int16x8_t v, int16x8_t *r, int16x8_t *g, int16x8_t *b) {
+	int16x8_t ys = vsubq_s16(y, vdupq_n_s16(16));
+	int16x8_t y1 = vaddq_s16(vaddq_s16(vmulq_n_s16(ys, 74), vshrq_n_s16(ys, 1)), vdupq_n_s16(32));
+	int16x8_t uv = vaddq_s16(vmulq_n_s16(u, 25), vmulq_n_s16(v, 52));
+	*r = vshrq_n_s16(vqaddq_s16(y1, vmulq_n_s16(v, 102)), 6);
+	*g = vshrq_n_s16(vqsubq_s16(y1, uv), 6);
+	*b = vshrq_n_s16(vqaddq_s16(y1, vmulq_n_s16(u, 129)), 6);
+}
+
+template <YUVOutputFormat F>
+static inline void Store16Pixels(void *dst, int x, uint8x16_t r8, uint8x16_t g8, uint8x16_t b8) {
+	if (F == YUVOutputFormat::RGBA8888) {
+		uint8x16x4_t px;
+		px.val[0] = r8;
+		px.val[1] = g8;
+		px.val[2] = b8;
+		px.val[3] = vdupq_n_u8(0);
+		vst4q_u8((u8 *)((u32 *)dst + x), px);
+		return;
+	}
+
+	u16 *out = (u16 *)dst + x;
+	for (int half = 0; half < 2; half++) {
+		uint16x8_t r = vmovl_u8(half ? vget_high_u8(r8) : vget_low_u8(r8));
+		uint16x8_t g = vmovl_u8(half ? vget_high_u8(g8) : vget_low_u8(g8));
+		uint16x8_t b = vmovl_u8(half ? vget_high_u8(b8) : vget_low_u8(b8));
+		uint16x8_t px;
+		if (F == YUVOutputFormat::RGB565) {
+			px = vorrq_u16(vshrq_n_u16(r, 3), vshlq_n_u16(vshrq_n_u16(g, 2), 5));
+			px = vorrq_u16(px, vshlq_n_u16(vshrq_n_u16(b, 3), 11));
+		} else if (F == YUVOutputFormat::RGBA5551) {
+			px = vorrq_u16(vshrq_n_u16(r, 3), vshlq_n_u16(vshrq_n_u16(g, 3), 5));
+			px = vorrq_u16(px, vshlq_n_u16(vshrq_n_u16(b, 3), 10));
+		} else {
+			px = vorrq_u16(vshrq_n_u16(r, 4), vshlq_n_u16(vshrq_n_u16(g, 4), 4));
+			px = vorrq_u16(px, vshlq_n_u16(vshrq_n_u16(b, 4), 8));
+		}
+		vst1q_u16(out + half * 8, px);
+	}
+}
+
+#endif
+
+template <YUVOutputFormat F>
+static void ConvertYUV420RowBT601T(void *dst, const u8 *y, const u8 *u, const u8 *v, int width) {
+	int x = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	for (; x + 16 <= width; x += 16) {
+		__m128i y8 = _mm_loadu_si128((const __m128i *)(y + x));
+		__m128i u16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + x / 2)), zero), bias);
+		__m128i v16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + x / 2)), zero), bias);
+
+		__m128i rLo, gLo, bLo, rHi, gHi, bHi;
+		YUVToRGB_BT601_SSE2(_mm_unpacklo_epi8(y8, zero), _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), &rLo, &gLo, &bLo);
+		YUVToRGB_BT601_SSE2(_mm_unpackhi_epi8(y8, zero), _mm_unpackhi_epi16(u16, u16), _mm_unpackhi_epi16(v16, v16), &rHi, &gHi, &bHi);
+		Store16Pixels<F>(dst, x, _mm_packus_epi16(rLo, rHi), _mm_packus_epi16(gLo, gHi), _mm_packus_epi16(bLo, bHi));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int16x8_t bias = vdupq_n_s16(128);
+	for (; x + 16 <= width; x += 16) {
+		uint8x16_t y8 = vld1q_u8(y + x);
+		int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x / 2))), bias);
+		int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x / 2))), bias);
+		int16x8x2_t uu = vzipq_s16(u16, u16);
+		int16x8x2_t vv = vzipq_s16(v16, v16);
+
+		int16x8_t rLo, gLo, bLo, rHi, gHi, bHi;
+		YUVToRGB_BT601_NEON(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), uu.val[0], vv.val[0], &rLo, &gLo, &bLo);
+		YUVToRGB_BT601_NEON(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), uu.val[1], vv.val[1], &rHi, &gHi, &bHi);
+		Store16Pixels<F>(dst, x, vcombine_u8(vqmovun_s16(rLo), vqmovun_s16(rHi)), vcombine_u8(vqmovun_s16(gLo), vqmovun_s16(gHi)), vcombine_u8(vqmovun_s16(bLo), vqmovun_s16(bHi)));
+	}
+#endif
+	for (; x < width; x++) {
+		int r, g, b;
+		YUVToRGB_BT601(y[x], u[x >> 1], v[x >> 1], &r, &g, &b);
+		StorePixel<F>(dst, x, r, g, b);
+	}
+}
+
+void ConvertYUV420RowBT601(YUVOutputFormat format, void *dst, const u8 *y, const u8 *u, const u8 *v, int width) {
+	switch (format) {
+	case YUVOutputFormat::RGBA8888: ConvertYUV420RowBT601T<YUVOutputFormat::RGBA8888>(dst, y, u, v, width); break;
+	case YUVOutputFormat::RGB565: ConvertYUV420RowBT601T<YUVOutputFormat::RGB565>(dst, y, u, v, width); break;
+	case YUVOutputFormat::RGBA5551: ConvertYUV420RowBT601T<YUVOutputFormat::RGBA5551>(dst, y, u, v, width); break;
+	case YUVOutputFormat::RGBA4444: ConvertYUV420RowBT601T<YUVOutputFormat::RGBA4444>(dst, y, u, v, width); break;
+	}
+}
+
+void ConvertYUV420ToRGB_BT601(YUVOutputFormat format, u8 *dst, int dstStride,
+	const u8 *y, int yStride, const u8 *u, int uStride, const u8 *v, int vStride, int width, int height) {
+	for (int row = 0; row < height; row++) {
+		ConvertYUV420RowBT601(format, dst + row * dstStride, y + row * yStride, u + (row >> 1) * uStride, v + (row >> 1) * vStride, width);
+	}
+}
+
+#if PPSSPP_ARCH(SSE2)
+
+static inline __m128i YCbCrToRGB8_PSPJpeg_SSE2(__m128i yLo, __m128i yHi, __m128i cbLo, __m128i cbHi, __m128i crLo, __m128i crHi, int component) {
+	__m128i lanes[2];
+	for (int half = 0; half < 2; half++) {
+		__m128i y = half ? yHi : yLo;
+		__m128i cb = half ? cbHi : cbLo;
+		__m128i cr = half ? crHi : crLo;
+		__m128i c;
+		if (component == 0) {
+			c = _mm_add_epi16(_mm_add_epi16(y, cr), _mm_add_epi16(_mm_srai_epi16(cr, 2), _mm_srai_epi16(cr, 3)));
+			c = _mm_add_epi16(c, _mm_srai_epi16(cr, 5));
+		} else if (component == 1) {
+			__m128i cbPart = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(cb, 2), _mm_srai_epi16(cb, 4)), _mm_srai_epi16(cb, 5));
+			__m128i crPart = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(cr, 1), _mm_srai_epi16(cr, 3)), _mm_add_epi16(_mm_srai_epi16(cr, 4), _mm_srai_epi16(cr, 5)));
+			c = _mm_sub_epi16(_mm_sub_epi16(y, cbPart), crPart);
+		} else {
+			c = _mm_add_epi16(_mm_add_epi16(y, cb), _mm_add_epi16(_mm_srai_epi16(cb, 1), _mm_srai_epi16(cb, 2)));
+			c = _mm_add_epi16(c, _mm_srai_epi16(cb, 6));
+		}
+		lanes[half] = c;
+	}
+	return _mm_packus_epi16(lanes[0], lanes[1]);
+}
+
+#elif PPSSPP_ARCH(ARM_NEON)
+
+static inline uint8x8_t YCbCrToRGB8_PSPJpeg_NEON(int16x8_t y, int16x8_t cb, int16x8_t cr, int component) {
+	int16x8_t c;
+	if (component == 0) {
+		c = vaddq_s16(vaddq_s16(y, cr), vaddq_s16(vshrq_n_s16(cr, 2), vshrq_n_s16(cr, 3)));
+		c = vaddq_s16(c, vshrq_n_s16(cr, 5));
+	} else if (component == 1) {
+		int16x8_t cbPart = vaddq_s16(vaddq_s16(vshrq_n_s16(cb, 2), vshrq_n_s16(cb, 4)), vshrq_n_s16(cb, 5));
+		int16x8_t crPart = vaddq_s16(vaddq_s16(vshrq_n_s16(cr, 1), vshrq_n_s16(cr, 3)), vaddq_s16(vshrq_n_s16(cr, 4), vshrq_n_s16(cr, 5)));
+		c = vsubq_s16(vsubq_s16(y, cbPart), crPart);
+	} else {
+		c = vaddq_s16(vaddq_s16(y, cb), vaddq_s16(vshrq_n_s16(cb, 1), vshrq_n_s16(cb, 2)));
+		c = vaddq_s16(c, vshrq_n_s16(cb, 6));
+	}
+	return vqmovun_s16(c);
+}
+
+#endif
+
+void ConvertYCbCrRowPSPJpeg(u32 *dst, const u8 *y, const u8 *cb, const u8 *cr, int width, int chromaShiftX) {
+	int x = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	for (; x + 16 <= width; x += 16) {
+		__m128i y8 = _mm_loadu_si128((const __m128i *)(y + x));
+		__m128i cbLo, cbHi, crLo, crHi;
+		if (chromaShiftX) {
+			__m128i cb16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cb + x / 2)), zero), bias);
+			__m128i cr16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cr + x / 2)), zero), bias);
+			cbLo = _mm_unpacklo_epi16(cb16, cb16);
+			cbHi = _mm_unpackhi_epi16(cb16, cb16);
+			crLo = _mm_unpacklo_epi16(cr16, cr16);
+			crHi = _mm_unpackhi_epi16(cr16, cr16);
+		} else {
+			__m128i cb8 = _mm_loadu_si128((const __m128i *)(cb + x));
+			__m128i cr8 = _mm_loadu_si128((const __m128i *)(cr + x));
+			cbLo = _mm_sub_epi16(_mm_unpacklo_epi8(cb8, zero), bias);
+			cbHi = _mm_sub_epi16(_mm_unpackhi_epi8(cb8, zero), bias);
+			crLo = _mm_sub_epi16(_mm_unpacklo_epi8(cr8, zero), bias);
+			crHi = _mm_sub_epi16(_mm_unpackhi_epi8(cr8, zero), bias);
+		}
+		__m128i yLo = _mm_unpacklo_epi8(y8, zero);
+		__m128i yHi = _mm_unpackhi_epi8(y8, zero);
+		__m128i r8 = YCbCrToRGB8_PSPJpeg_SSE2(yLo, yHi, cbLo, cbHi, crLo, crHi, 0);
+		__m128i g8 = YCbCrToRGB8_PSPJpeg_SSE2(yLo, yHi, cbLo, cbHi, crLo, crHi, 1);
+		__m128i b8 = YCbCrToRGB8_PSPJpeg_SSE2(yLo, yHi, cbLo, cbHi, crLo, crHi, 2);
+		Store16Pixels<YUVOutputFormat::RGBA8888>(dst, x, r8, g8, b8);
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int16x8_t bias = vdupq_n_s16(128);
+	for (; x + 16 <= width; x += 16) {
+		uint8x16_t y8 = vld1q_u8(y + x);
+		int16x8_t cbLo, cbHi, crLo, crHi;
+		if (chromaShiftX) {
+			int16x8_t cb16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cb + x / 2))), bias);
+			int16x8_t cr16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cr + x / 2))), bias);
+			int16x8x2_t cbcb = vzipq_s16(cb16, cb16);
+			int16x8x2_t crcr = vzipq_s16(cr16, cr16);
+			cbLo = cbcb.val[0];
+			cbHi = cbcb.val[1];
+			crLo = crcr.val[0];
+			crHi = crcr.val[1];
+		} else {
+			uint8x16_t cb8 = vld1q_u8(cb + x);
+			uint8x16_t cr8 = vld1q_u8(cr + x);
+			cbLo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(cb8))), bias);
+			cbHi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(cb8))), bias);
+			crLo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(cr8))), bias);
+			crHi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(cr8))), bias);
+		}
+		int16x8_t yLo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8)));
+		int16x8_t yHi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8)));
+		uint8x16_t r8 = vcombine_u8(YCbCrToRGB8_PSPJpeg_NEON(yLo, cbLo, crLo, 0), YCbCrToRGB8_PSPJpeg_NEON(yHi, cbHi, crHi, 0));
+		uint8x16_t g8 = vcombine_u8(YCbCrToRGB8_PSPJpeg_NEON(yLo, cbLo, crLo, 1), YCbCrToRGB8_PSPJpeg_NEON(yHi, cbHi, crHi, 1));
+		uint8x16_t b8 = vcombine_u8(YCbCrToRGB8_PSPJpeg_NEON(yLo, cbLo, crLo, 2), YCbCrToRGB8_PSPJpeg_NEON(yHi, cbHi, crHi, 2));
+		Store16Pixels<YUVOutputFormat::RGBA8888>(dst, x, r8, g8, b8);
+	}
+#endif
+	for (; x < width; x++) {
+		dst[x] = YCbCrToABGR_PSPJpeg(y[x], cb[x >> chromaShiftX], cr[x >> chromaShiftX]);
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Planar YCbCr to the PSP's pixel formats, for decoded video and sceJpeg.
+// The SIMD paths produce exactly the same output as the per-pixel functions below.
+
+// Output layouts, as in memory on the PSP (red in the low bits). Alpha is always written as zero,
+// like the PSP's decoders do.
+enum class YUVOutputFormat {
+	RGBA8888,
+	RGB565,
+	RGBA5551,
+	RGBA4444,
+};
+
+inline int ClampYUVComponent(int c) {
+	return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+// BT.601 with limited ("TV") range, which is what PSMF video uses. 6 bits of fraction, to fit 16-bit lanes.
+// The luma scale is 74.5 / 64, so that 235 still reaches 255.
+inline void YUVToRGB_BT601(int y, int u, int v, int *r, int *g, int *b) {
+	int ys = y - 16;
+	int y1 = ys * 74 + (ys >> 1) + 32;
+	u -= 128;
+	v -= 128;
+	*r = ClampYUVComponent((y1 + 102 * v) >> 6);
+	*g = ClampYUVComponent((y1 - 25 * u - 52 * v) >> 6);
+	*b = ClampYUVComponent((y1 + 129 * u) >> 6);
+}
+
+// The shift based approximation sceJpegCsc and sceJpegMJpegCsc use, returns ABGR8888 with zero alpha.
+// See http://en.wikipedia.org/wiki/Yuv#Y.27UV444_to_RGB888_conversion for more information.
+inline u32 YCbCrToABGR_PSPJpeg(int y, int cb, int cr) {
+	cb = cb - 128;
+	cr = cr - 128;
+	int r = y + cr + (cr >> 2) + (cr >> 3) + (cr >> 5);
+	int g = y - ((cb >> 2) + (cb >> 4) + (cb >> 5)) - ((cr >> 1) + (cr >> 3) + (cr >> 4) + (cr >> 5));
+	int b = y + cb + (cb >> 1) + (cb >> 2) + (cb >> 6);
+	return (ClampYUVComponent(b) << 16) | (ClampYUVComponent(g) << 8) | (ClampYUVComponent(r) << 0);
+}
+
+// One row of 4:2:0 (or 4:2:2) video: u and v have one sample per two pixels.
+void ConvertYUV420RowBT601(YUVOutputFormat format, void *dst, const u8 *y, const u8 *u, const u8 *v, int width);
+
+// A whole 4:2:0 frame. Strides are in bytes.
+void ConvertYUV420ToRGB_BT601(YUVOutputFormat format, u8 *dst, int dstStride,
+	const u8 *y, int yStride, const u8 *u, int uStride, const u8 *v, int vStride, int width, int height);
+
+// One row for sceJpeg. chromaShiftX is 1 when cb and cr have one sample per two pixels, otherwise 0.
+void ConvertYCbCrRowPSPJpeg(u32 *dst, const u8 *y, const u8 *cb, const u8 *cr, int width, int chromaShiftX);
@@ -0,0 +1,157 @@
+#include <cstring>
+
+#include "Common/Data/Encoding/LZ4.h"
+
+enum {
+	MIN_MATCH = 4,
+	// The format requires the last 5 bytes to be literals, and the last match to start 12 bytes before the end.
+	LAST_LITERALS = 5,
+	MF_LIMIT = 12,
+	MAX_OFFSET = 65535,
+	HASH_BITS = 12,
+};
+
+static inline uint32_t Read32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+// Reads the 255-byte continuation of a length that didn't fit in the token.
+static inline bool ReadLength(const uint8_t *&ip, const uint8_t *iend, size_t *length) {
+	uint8_t s;
+	do {
+		if (ip >= iend)
+			return false;
+		s = *ip++;
+		*length += s;
+	} while (s == 255);
+	return true;
+}
+
+int LZ4DecompressBlock(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity) {
+	const uint8_t *ip = src;
+	const uint8_t *const iend = src + srcSize;
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + dstCapacity;
+
+	while (ip < iend) {
+		const uint8_t token = *ip++;
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(ip, iend, &literals))
+			return -1;
+		if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+			return -1;
+		memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		// The last sequence is only literals.
+		if (ip == iend || op == oend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dst))
+			return -1;
+
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(ip, iend, &length))
+			return -1;
+		length += MIN_MATCH;
+		if (length > (size_t)(oend - op))
+			return -1;
+
+		const uint8_t *match = op - offset;
+		if (offset >= 8) {
+			// Each 8 byte step only reads what's already been written.
+			size_t i = 0;
+			for (; i + 8 <= length; i += 8)
+				memcpy(op + i, match + i, 8);
+			for (; i < length; i++)
+				op[i] = match[i];
+		} else {
+			// Overlapping, this repeats a short pattern.
+			for (size_t i = 0; i < length; i++)
+				op[i] = match[i];
+		}
+		op += length;
+		if (op == oend)
+			break;
+	}
+
+	return (int)(op - dst);
+}
+
+static bool WriteLength(uint8_t *&op, const uint8_t *oend, size_t length) {
+	for (; length >= 255; length -= 255) {
+		if (op >= oend)
+			return false;
+		*op++ = 255;
+	}
+	if (op >= oend)
+		return false;
+	*op++ = (uint8_t)length;
+	return true;
+}
+
+static bool WriteSequence(uint8_t *&op, const uint8_t *oend, const uint8_t *literals, size_t literalCount, size_t offset, size_t matchLength) {
+	if (op >= oend)
+		return false;
+	const size_t matchCode = matchLength != 0 ? matchLength - MIN_MATCH : 0;
+	uint8_t *token = op++;
+	*token = (uint8_t)((literalCount >= 15 ? 15 : literalCount) << 4);
+	if (literalCount >= 15 && !WriteLength(op, oend, literalCount - 15))
+		return false;
+	if (literalCount > (size_t)(oend - op))
+		return false;
+	if (literalCount != 0)
+		memcpy(op, literals, literalCount);
+	op += literalCount;
+
+	if (matchLength == 0)
+		return true;
+	if (oend - op < 2)
+		return false;
+	*op++ = (uint8_t)offset;
+	*op++ = (uint8_t)(offset >> 8);
+	*token |= (uint8_t)(matchCode >= 15 ? 15 : matchCode);
+	return matchCode < 15 || WriteLength(op, oend, matchCode - 15);
+}
+
+int LZ4CompressBlock(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity) {
+	uint8_t *op = dst;
+	const uint8_t *const oend = dst + dstCapacity;
+
+	int table[1 << HASH_BITS];
+	memset(table, 0xFF, sizeof(table));
+
+	int anchor = 0;
+	int pos = 0;
+	const int matchLimit = srcSize - LAST_LITERALS;
+	while (pos + MF_LIMIT <= srcSize) {
+		const uint32_t sequence = Read32(src + pos);
+		const uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+		const int candidate = table[hash];
+		table[hash] = pos;
+		if (candidate < 0 || pos - candidate > MAX_OFFSET || Read32(src + candidate) != sequence) {
+			pos++;
+			continue;
+		}
+
+		int length = MIN_MATCH;
+		while (pos + length < matchLimit && src[candidate + length] == src[pos + length])
+			length++;
+		if (!WriteSequence(op, oend, src + anchor, pos - anchor, pos - candidate, length))
+			return 0;
+		pos += length;
+		anchor = pos;
+	}
+
+	if (!WriteSequence(op, oend, src + anchor, srcSize - anchor, 0, 0))
+		return 0;
+	return (int)(op - dst);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// The raw LZ4 block format (no frame header or checksums), as used in ZSO images.
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md.
+
+// Returns the number of bytes written, or -1 if the input is corrupt or doesn't fit in dstCapacity.
+// Stops as soon as dstCapacity bytes have been written, ignoring anything after (like the alignment
+// padding in ZSO files). Never reads or writes out of bounds, whatever the input.
+int LZ4DecompressBlock(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity);
+
+// Simple greedy compressor, fast but far from the best ratio. Returns the compressed size,
+// or 0 if it doesn't fit in dstCapacity.
+int LZ4CompressBlock(const uint8_t *src, int srcSize, uint8_t *dst, int dstCapacity);
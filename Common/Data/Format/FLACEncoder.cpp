@@ -0,0 +1,358 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Data/Format/FLACEncoder.h"
+
+// Format reference: https://xiph.org/flac/format.html
+
+static const int MAX_FIXED_ORDER = 4;
+static const int MAX_PARTITION_ORDER = 8;
+// With the 4-bit parameter coding method.
+static const int MAX_RICE_PARAM = 14;
+
+enum class SubframeType {
+	CONSTANT,
+	VERBATIM,
+	FIXED,
+};
+
+struct FLACEncoder::SubframePlan {
+	SubframeType type;
+	int order;
+	int partitionOrder;
+	uint8_t riceParams[1 << MAX_PARTITION_ORDER];
+	uint64_t bits;
+};
+
+class FLACBitWriter {
+public:
+	explicit FLACBitWriter(std::vector<uint8_t> *out) : out_(out) {}
+
+	// count <= 32.
+	void Put(uint32_t value, int count) {
+		if (count == 0)
+			return;
+		acc_ = (acc_ << count) | (value & (0xFFFFFFFFU >> (32 - count)));
+		bits_ += count;
+		while (bits_ >= 8) {
+			bits_ -= 8;
+			out_->push_back((uint8_t)(acc_ >> bits_));
+		}
+	}
+	void PutSigned(int32_t value, int count) {
+		Put((uint32_t)value, count);
+	}
+	// value zeros followed by a one.
+	void PutUnary(uint32_t value) {
+		while (value >= 32) {
+			Put(0, 32);
+			value -= 32;
+		}
+		Put(1, value + 1);
+	}
+	void AlignToByte() {
+		if (bits_ != 0)
+			Put(0, 8 - bits_);
+	}
+
+private:
+	std::vector<uint8_t> *out_;
+	uint64_t acc_ = 0;
+	int bits_ = 0;
+};
+
+static uint8_t CRC8(const uint8_t *data, size_t size) {
+	uint8_t crc = 0;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= data[i];
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+static uint16_t CRC16(const uint8_t *data, size_t size) {
+	uint16_t crc = 0;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+static int32_t FixedResidual(const int32_t *x, int i, int order) {
+	switch (order) {
+	case 0: return x[i];
+	case 1: return x[i] - x[i - 1];
+	case 2: return x[i] - 2 * x[i - 1] + x[i - 2];
+	case 3: return x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+	default: return x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+	}
+}
+
+static inline uint32_t ZigZag(int32_t r) {
+	return ((uint32_t)r << 1) ^ (uint32_t)(r >> 31);
+}
+
+FLACEncoder::FLACEncoder(uint32_t sampleRate) : sampleRate_(sampleRate) {
+	ppsspp_md5_starts(&md5_);
+	for (auto &channel : channels_)
+		channel.resize(BLOCK_SIZE);
+	residual_.resize(BLOCK_SIZE);
+}
+
+void FLACEncoder::Header(std::vector<uint8_t> *out) const {
+	FLACBitWriter bits(out);
+	bits.Put('f', 8);
+	bits.Put('L', 8);
+	bits.Put('a', 8);
+	bits.Put('C', 8);
+
+	// STREAMINFO, and the last metadata block.
+	bits.Put(1, 1);
+	bits.Put(0, 7);
+	bits.Put(34, 24);
+	bits.Put(BLOCK_SIZE, 16);
+	bits.Put(BLOCK_SIZE, 16);
+	bits.Put(minFrameBytes_, 24);
+	bits.Put(maxFrameBytes_, 24);
+	bits.Put(sampleRate_, 20);
+	bits.Put(2 - 1, 3);
+	bits.Put(16 - 1, 5);
+	bits.Put((uint32_t)(totalFrames_ >> 32), 4);
+	bits.Put((uint32_t)totalFrames_, 32);
+
+	// All zeros means unknown, which is what a file cut short should say.
+	uint8_t md5[16]{};
+	if (totalFrames_ != 0) {
+		md5_context ctx = md5_;
+		ppsspp_md5_finish(&ctx, md5);
+	}
+	for (uint8_t b : md5)
+		bits.Put(b, 8);
+}
+
+void FLACEncoder::PlanSubframe(const int32_t *samples, int count, int bps, SubframePlan *plan) const {
+	plan->type = SubframeType::VERBATIM;
+	plan->bits = (uint64_t)count * bps;
+
+	bool constant = true;
+	for (int i = 1; i < count && constant; i++)
+		constant = samples[i] == samples[0];
+	if (constant) {
+		plan->type = SubframeType::CONSTANT;
+		plan->bits = bps;
+		return;
+	}
+
+	// Pick the predictor with the smallest residuals, measured over the samples all of them predict.
+	int bestOrder = -1;
+	uint64_t bestSum = 0;
+	for (int order = 0; order <= MAX_FIXED_ORDER && order < count; order++) {
+		uint64_t sum = 0;
+		for (int i = std::min(MAX_FIXED_ORDER, count - 1); i < count; i++) {
+			int32_t r = FixedResidual(samples, i, order);
+			sum += (uint32_t)(r < 0 ? -r : r);
+		}
+		if (bestOrder == -1 || sum < bestSum) {
+			bestOrder = order;
+			bestSum = sum;
+		}
+	}
+	const int order = bestOrder;
+
+	for (int i = order; i < count; i++)
+		residual_[i] = ZigZag(FixedResidual(samples, i, order));
+
+	// Finest usable partitioning: count must split evenly, and every partition must hold more than the warmup.
+	int maxPartitionOrder = 0;
+	while (maxPartitionOrder < MAX_PARTITION_ORDER && (count % (2 << maxPartitionOrder)) == 0 && (count >> (maxPartitionOrder + 1)) > order)
+		maxPartitionOrder++;
+
+	// The cost of each Rice parameter for each of the finest partitions, to be summed up for coarser ones.
+	const int finest = 1 << maxPartitionOrder;
+	const int finestSize = count >> maxPartitionOrder;
+	uint64_t costs[1 << MAX_PARTITION_ORDER][MAX_RICE_PARAM + 1];
+	for (int p = 0; p < finest; p++) {
+		int start = p == 0 ? order : p * finestSize;
+		int end = (p + 1) * finestSize;
+		for (int k = 0; k <= MAX_RICE_PARAM; k++) {
+			uint64_t sum = (uint64_t)(end - start) * (k + 1);
+			for (int i = start; i < end; i++)
+				sum += residual_[i] >> k;
+			costs[p][k] = sum;
+		}
+	}
+
+	// Residual header (coding method and partition order), plus the warmup and subframe type costs.
+	const uint64_t baseBits = 2 + 4 + (uint64_t)order * bps;
+	for (int partitionOrder = maxPartitionOrder; partitionOrder >= 0; partitionOrder--) {
+		const int partitions = 1 << partitionOrder;
+		const int children = finest / partitions;
+		uint64_t total = baseBits;
+		uint8_t params[1 << MAX_PARTITION_ORDER];
+		for (int p = 0; p < partitions; p++) {
+			uint64_t best = 0;
+			for (int k = 0; k <= MAX_RICE_PARAM; k++) {
+				uint64_t sum = 0;
+				for (int c = 0; c < children; c++)
+					sum += costs[p * children + c][k];
+				if (k == 0 || sum < best) {
+					best = sum;
+					params[p] = (uint8_t)k;
+				}
+			}
+			total += 4 + best;
+		}
+		if (total < plan->bits) {
+			plan->type = SubframeType::FIXED;
+			plan->order = order;
+			plan->partitionOrder = partitionOrder;
+			memcpy(plan->riceParams, params, partitions);
+			plan->bits = total;
+		}
+	}
+}
+
+void FLACEncoder::WriteSubframe(FLACBitWriter &bits, const int32_t *samples, int count, int bps, const SubframePlan &plan) const {
+	bits.Put(0, 1);
+	switch (plan.type) {
+	case SubframeType::CONSTANT:
+		bits.Put(0, 6);
+		bits.Put(0, 1);
+		bits.PutSigned(samples[0], bps);
+		break;
+
+	case SubframeType::VERBATIM:
+		bits.Put(1, 6);
+		bits.Put(0, 1);
+		for (int i = 0; i < count; i++)
+			bits.PutSigned(samples[i], bps);
+		break;
+
+	case SubframeType::FIXED:
+	{
+		bits.Put(8 | plan.order, 6);
+		bits.Put(0, 1);
+		for (int i = 0; i < plan.order; i++)
+			bits.PutSigned(samples[i], bps);
+
+		bits.Put(0, 2);
+		bits.Put(plan.partitionOrder, 4);
+		const int partitions = 1 << plan.partitionOrder;
+		const int size = count >> plan.partitionOrder;
+		for (int p = 0; p < partitions; p++) {
+			const int k = plan.riceParams[p];
+			bits.Put(k, 4);
+			int start = p == 0 ? plan.order : p * size;
+			int end = (p + 1) * size;
+			for (int i = start; i < end; i++) {
+				uint32_t u = ZigZag(FixedResidual(samples, i, plan.order));
+				bits.PutUnary(u >> k);
+				bits.Put(u, k);
+			}
+		}
+		break;
+	}
+	}
+}
+
+static void PutUTF8(FLACBitWriter &bits, uint32_t value) {
+	if (value < 0x80) {
+		bits.Put(value, 8);
+		return;
+	}
+	int extra = value < 0x800 ? 1 : value < 0x10000 ? 2 : value < 0x200000 ? 3 : value < 0x4000000 ? 4 : 5;
+	// The first byte has extra + 1 leading ones, then a zero, then the top bits.
+	int firstBits = 6 - extra;
+	bits.Put(((1 << (extra + 1)) - 1) << 1, extra + 2);
+	bits.Put(value >> (extra * 6), firstBits);
+	for (int i = extra - 1; i >= 0; i--)
+		bits.Put(0x80 | ((value >> (i * 6)) & 0x3F), 8);
+}
+
+void FLACEncoder::EncodeFrame(const int16_t *interleaved, int frames, std::vector<uint8_t> *out) {
+	if (frames <= 0)
+		return;
+	frames = std::min(frames, (int)BLOCK_SIZE);
+	ppsspp_md5_update(&md5_, (unsigned char *)interleaved, frames * 2 * sizeof(int16_t));
+
+	// Left, right, mid and side.
+	for (int i = 0; i < frames; i++) {
+		int32_t l = interleaved[i * 2];
+		int32_t r = interleaved[i * 2 + 1];
+		channels_[0][i] = l;
+		channels_[1][i] = r;
+		channels_[2][i] = (l + r) >> 1;
+		channels_[3][i] = l - r;
+	}
+
+	SubframePlan plans[4];
+	for (int c = 0; c < 4; c++)
+		PlanSubframe(channels_[c].data(), frames, c == 3 ? 17 : 16, &plans[c]);
+
+	// Channel assignment codes: independent, left/side, side/right, mid/side.
+	struct Assignment { int code; int first; int second; };
+	static const Assignment assignments[] = { { 1, 0, 1 }, { 8, 0, 3 }, { 9, 3, 1 }, { 10, 2, 3 } };
+	const Assignment *best = &assignments[0];
+	for (const Assignment &a : assignments) {
+		if (plans[a.first].bits + plans[a.second].bits < plans[best->first].bits + plans[best->second].bits)
+			best = &a;
+	}
+
+	const size_t start = out->size();
+	FLACBitWriter bits(out);
+	bits.Put(0x3FFE, 14);
+	bits.Put(0, 1);
+	// Fixed block size.
+	bits.Put(0, 1);
+	int blockSizeCode = frames == BLOCK_SIZE ? 12 : (frames <= 256 ? 6 : 7);
+	bits.Put(blockSizeCode, 4);
+	int sampleRateCode = 0;
+	switch (sampleRate_) {
+	case 22050: sampleRateCode = 7; break;
+	case 32000: sampleRateCode = 8; break;
+	case 44100: sampleRateCode = 9; break;
+	case 48000: sampleRateCode = 10; break;
+	}
+	bits.Put(sampleRateCode, 4);
+	bits.Put(best->code, 4);
+	// 16 bits per sample.
+	bits.Put(4, 3);
+	bits.Put(0, 1);
+	PutUTF8(bits, frameNumber_);
+	if (blockSizeCode == 6)
+		bits.Put(frames - 1, 8);
+	else if (blockSizeCode == 7)
+		bits.Put(frames - 1, 16);
+	bits.Put(CRC8(out->data() + start, out->size() - start), 8);
+
+	WriteSubframe(bits, channels_[best->first].data(), frames, best->first == 3 ? 17 : 16, plans[best->first]);
+	WriteSubframe(bits, channels_[best->second].data(), frames, best->second == 3 ? 17 : 16, plans[best->second]);
+	bits.AlignToByte();
+	bits.Put(CRC16(out->data() + start, out->size() - start), 16);
+
+	uint32_t frameBytes = (uint32_t)(out->size() - start);
+	minFrameBytes_ = frameNumber_ == 0 ? frameBytes : std::min(minFrameBytes_, frameBytes);
+	maxFrameBytes_ = std::max(maxFrameBytes_, frameBytes);
+	frameNumber_++;
+	totalFrames_ += frames;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Common/Crypto/md5.h"
+
+class FLACBitWriter;
+
+// Minimal FLAC encoder for 16-bit stereo, for audio recording. It only uses the fixed predictors and
+// Rice coding, picking the best of the four stereo decorrelation modes per frame - roughly what the
+// reference encoder does at its fastest settings, which is plenty for a background thread.
+//
+// Usage: write Header() at the start of the file, then one EncodeFrame() per block. When done, write
+// Header() again over the start of the file to fill in the totals and checksum.
+class FLACEncoder {
+public:
+	enum {
+		BLOCK_SIZE = 4096,
+		// "fLaC" plus the STREAMINFO block.
+		HEADER_SIZE = 42,
+	};
+
+	explicit FLACEncoder(uint32_t sampleRate);
+
+	void Header(std::vector<uint8_t> *out) const;
+	// frames must be BLOCK_SIZE, except for the last frame of the stream which may be shorter.
+	void EncodeFrame(const int16_t *interleaved, int frames, std::vector<uint8_t> *out);
+
+	uint64_t TotalFrames() const { return totalFrames_; }
+
+private:
+	struct SubframePlan;
+
+	void PlanSubframe(const int32_t *samples, int count, int bps, SubframePlan *plan) const;
+	void WriteSubframe(FLACBitWriter &bits, const int32_t *samples, int count, int bps, const SubframePlan &plan) const;
+
+	uint32_t sampleRate_;
+	uint64_t totalFrames_ = 0;
+	uint32_t frameNumber_ = 0;
+	uint32_t minFrameBytes_ = 0;
+	uint32_t maxFrameBytes_ = 0;
+	md5_context md5_;
+
+	std::vector<int32_t> channels_[4];
+	mutable std::vector<uint32_t> residual_;
+};
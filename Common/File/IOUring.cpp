@@ -0,0 +1,223 @@
+#include "ppsspp_config.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+// Waits with a timeout (5.11) are needed so that Interrupt() can always stop the waiting thread.
+#ifndef IORING_FEAT_EXT_ARG
+#undef HAVE_IO_URING
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Common/File/IOUring.h"
+#include "Common/Log.h"
+
+IOUring::~IOUring() {
+	Shutdown();
+}
+
+#ifdef HAVE_IO_URING
+
+static int io_uring_setup(uint32_t entries, io_uring_params *params) {
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags, void *arg = nullptr, size_t argSize = 0) {
+	return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize);
+}
+
+template <typename T>
+static T *RingPointer(void *map, uint32_t offset) {
+	return (T *)((uint8_t *)map + offset);
+}
+
+bool IOUring::Init(uint32_t entries) {
+	io_uring_params params{};
+	int fd = io_uring_setup(entries, &params);
+	if (fd < 0) {
+		INFO_LOG(Log::IO, "io_uring is not available: %s", strerror(errno));
+		return false;
+	}
+	// Reads with plain buffers (IORING_OP_READ) came in the same kernel as RW_CUR_POS, timeouts need EXT_ARG.
+	if (!(params.features & IORING_FEAT_RW_CUR_POS) || !(params.features & IORING_FEAT_EXT_ARG)) {
+		INFO_LOG(Log::IO, "io_uring is too old to use");
+		close(fd);
+		return false;
+	}
+	ringFd_ = fd;
+	interrupted_ = false;
+
+	sqMapSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	cqMapSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	// Newer kernels map both rings at once.
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (cqMapSize_ > sqMapSize_)
+			sqMapSize_ = cqMapSize_;
+		cqMapSize_ = 0;
+	}
+
+	sqMap_ = mmap(nullptr, sqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (sqMap_ == MAP_FAILED) {
+		sqMap_ = nullptr;
+		Shutdown();
+		return false;
+	}
+	if (cqMapSize_ != 0) {
+		cqMap_ = mmap(nullptr, cqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (cqMap_ == MAP_FAILED) {
+			cqMap_ = nullptr;
+			Shutdown();
+			return false;
+		}
+	}
+	sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+	sqes_ = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (sqes_ == MAP_FAILED) {
+		sqes_ = nullptr;
+		Shutdown();
+		return false;
+	}
+
+	void *cqMap = cqMap_ ? cqMap_ : sqMap_;
+	sqHead_ = RingPointer<uint32_t>(sqMap_, params.sq_off.head);
+	sqTail_ = RingPointer<uint32_t>(sqMap_, params.sq_off.tail);
+	sqMask_ = *RingPointer<uint32_t>(sqMap_, params.sq_off.ring_mask);
+	sqArray_ = RingPointer<uint32_t>(sqMap_, params.sq_off.array);
+	cqHead_ = RingPointer<uint32_t>(cqMap, params.cq_off.head);
+	cqTail_ = RingPointer<uint32_t>(cqMap, params.cq_off.tail);
+	cqMask_ = *RingPointer<uint32_t>(cqMap, params.cq_off.ring_mask);
+	cqes_ = RingPointer<void>(cqMap, params.cq_off.cqes);
+	return true;
+}
+
+void IOUring::Shutdown() {
+	if (sqes_)
+		munmap(sqes_, sqesSize_);
+	if (cqMap_)
+		munmap(cqMap_, cqMapSize_);
+	if (sqMap_)
+		munmap(sqMap_, sqMapSize_);
+	sqes_ = nullptr;
+	cqMap_ = nullptr;
+	sqMap_ = nullptr;
+	if (ringFd_ >= 0)
+		close(ringFd_);
+	ringFd_ = -1;
+}
+
+void IOUring::Interrupt() {
+	// Closing the fd here instead would be a race: the number could be reused before the waiting
+	// thread's next io_uring_enter(). A wait in progress notices the flag within its timeout.
+	interrupted_ = true;
+}
+
+bool IOUring::Submit(uint8_t opcode, int fd, void *buf, uint32_t size, uint64_t offset, uint64_t userData) {
+	if (!IsOpen() || interrupted_)
+		return false;
+
+	std::lock_guard<std::mutex> guard(submitLock_);
+	// Everything is submitted right away, so the queue is only full if the kernel is behind.
+	uint32_t tail = *sqTail_;
+	if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) > sqMask_)
+		return false;
+
+	uint32_t index = tail & sqMask_;
+	io_uring_sqe *sqe = (io_uring_sqe *)sqes_ + index;
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)buf;
+	sqe->len = size;
+	sqe->off = offset;
+	sqe->user_data = userData;
+	sqArray_[index] = index;
+	__atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+	int submitted;
+	do {
+		submitted = io_uring_enter(ringFd_, 1, 0, 0);
+	} while (submitted < 0 && errno == EINTR);
+	if (submitted != 1) {
+		// Not consumed, so take it back.
+		ERROR_LOG(Log::IO, "io_uring submit failed: %s", submitted < 0 ? strerror(errno) : "nothing submitted");
+		__atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+		return false;
+	}
+	return true;
+}
+
+bool IOUring::SubmitRead(int fd, void *buf, uint32_t size, uint64_t offset, uint64_t userData) {
+	return Submit(IORING_OP_READ, fd, buf, size, offset, userData);
+}
+
+bool IOUring::SubmitNop(uint64_t userData) {
+	return Submit(IORING_OP_NOP, -1, nullptr, 0, 0, userData);
+}
+
+bool IOUring::WaitCompletion(uint64_t *userData, int32_t *result) {
+	if (!IsOpen())
+		return false;
+
+	// Nothing can wake up a wait that's already blocked, so never block for long, see Interrupt().
+	__kernel_timespec timeout{};
+	timeout.tv_nsec = 100 * 1000 * 1000;
+	io_uring_getevents_arg arg{};
+	arg.ts = (uint64_t)(uintptr_t)&timeout;
+
+	uint32_t head = *cqHead_;
+	while (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+		if (interrupted_)
+			return false;
+		int ret = io_uring_enter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+		if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != ETIME) {
+			ERROR_LOG(Log::IO, "io_uring wait failed: %s", strerror(errno));
+			return false;
+		}
+	}
+
+	const io_uring_cqe *cqe = (const io_uring_cqe *)cqes_ + (head & cqMask_);
+	*userData = cqe->user_data;
+	*result = cqe->res;
+	__atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+#else
+
+bool IOUring::Init(uint32_t entries) {
+	return false;
+}
+
+void IOUring::Shutdown() {
+}
+
+void IOUring::Interrupt() {
+}
+
+bool IOUring::SubmitRead(int fd, void *buf, uint32_t size, uint64_t offset, uint64_t userData) {
+	return false;
+}
+
+bool IOUring::SubmitNop(uint64_t userData) {
+	return false;
+}
+
+bool IOUring::WaitCompletion(uint64_t *userData, int32_t *result) {
+	return false;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// A minimal io_uring for reading files with several requests in flight, on Linux.
+// Talks to the kernel directly, so liburing isn't needed. Init() fails on other platforms, old kernels
+// (before 5.11) and where it's blocked (containers and Android often do that), so always have a fallback.
+//
+// Submissions can come from any thread. Completions must all be reaped by one thread.
+class IOUring {
+public:
+	IOUring() {}
+	~IOUring();
+
+	IOUring(const IOUring &) = delete;
+	IOUring &operator=(const IOUring &) = delete;
+
+	// entries is the most requests that may be in flight at once, the caller has to keep track.
+	bool Init(uint32_t entries);
+	void Shutdown();
+	bool IsOpen() const { return ringFd_ >= 0; }
+	// Makes WaitCompletion() on another thread return false within its timeout, so that thread can be
+	// joined. The fd stays open until Shutdown(), which is the only call allowed afterwards.
+	void Interrupt();
+
+	// Reads at an absolute offset, without touching the file position.
+	bool SubmitRead(int fd, void *buf, uint32_t size, uint64_t offset, uint64_t userData);
+	// Completes right away, useful to wake up the thread waiting on completions.
+	bool SubmitNop(uint64_t userData);
+
+	// Blocks until a request completes. result is what read() would return, but -errno on errors.
+	bool WaitCompletion(uint64_t *userData, int32_t *result);
+
+private:
+	bool Submit(uint8_t opcode, int fd, void *buf, uint32_t size, uint64_t offset, uint64_t userData);
+
+	int ringFd_ = -1;
+	std::atomic<bool> interrupted_{};
+	std::mutex submitLock_;
+
+	void *sqMap_ = nullptr;
+	size_t sqMapSize_ = 0;
+	void *cqMap_ = nullptr;
+	size_t cqMapSize_ = 0;
+	void *sqes_ = nullptr;
+	size_t sqesSize_ = 0;
+
+	uint32_t *sqHead_ = nullptr;
+	uint32_t *sqTail_ = nullptr;
+	uint32_t sqMask_ = 0;
+	uint32_t *sqArray_ = nullptr;
+	uint32_t *cqHead_ = nullptr;
+	uint32_t *cqTail_ = nullptr;
+	uint32_t cqMask_ = 0;
+	void *cqes_ = nullptr;
+};
@@ -0,0 +1,522 @@
+#include "ppsspp_config.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <set>
+
+#include "zlib.h"
+
+#ifdef _WIN32
+#include "Common/CommonWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Common/Common.h"
+#include "Common/Log.h"
+#include "Common/File/VFS/MappedZipFileReader.h"
+#include "Common/StringUtils.h"
+
+// Same limits as LocalFileLoader::MapIntoMemory, texture packs can be several GB.
+#if PPSSPP_ARCH(64BIT) && !defined(HAVE_LIBRETRO_VFS) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(UWP)
+#define CAN_MAP_ZIP 1
+#endif
+
+static const uint32_t ZIP_LOCAL_HEADER_MAGIC = 0x04034b50;
+static const uint32_t ZIP_CENTRAL_HEADER_MAGIC = 0x02014b50;
+static const uint32_t ZIP_END_MAGIC = 0x06054b50;
+static const uint32_t ZIP64_END_LOCATOR_MAGIC = 0x07064b50;
+
+static const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static const size_t ZIP_END_SIZE = 22;
+static const size_t ZIP64_END_LOCATOR_SIZE = 20;
+
+static const uint16_t ZIP_METHOD_STORE = 0;
+static const uint16_t ZIP_METHOD_DEFLATE = 8;
+static const uint16_t ZIP_FLAG_ENCRYPTED = 1;
+
+static uint16_t ReadLE16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadLE32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static std::string LowerCaseASCII(const std::string &str) {
+	std::string lower = str;
+	for (char &c : lower) {
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	}
+	return lower;
+}
+
+class MappedZipFileReference : public VFSFileReference {
+public:
+	size_t index;
+};
+
+class MappedZipOpenFile : public VFSOpenFile {
+public:
+	~MappedZipOpenFile() {
+		if (inflating)
+			inflateEnd(&stream);
+	}
+	const uint8_t *data = nullptr;
+	uint32_t compressedSize = 0;
+	uint32_t size = 0;
+	// Only for stored files, for deflated ones it's stream.total_out.
+	uint32_t pos = 0;
+	bool inflating = false;
+	z_stream stream{};
+};
+
+MappedZipFileReader *MappedZipFileReader::Create(const Path &zipFile, const char *inZipPath, bool logErrors) {
+	// Content URIs may be on removable storage, where a read error would be a crash.
+	if (zipFile.Type() != PathType::NATIVE)
+		return nullptr;
+
+	// The inZipPath is supposed to be a folder, and internally in this class, we suffix
+	// folder paths with '/', matching how zip files store them.
+	std::string path = inZipPath;
+	if (!path.empty() && path.back() != '/') {
+		path.push_back('/');
+	}
+
+	MappedZipFileReader *reader = new MappedZipFileReader(zipFile, path);
+	if (!reader->Map(logErrors)) {
+		delete reader;
+		return nullptr;
+	}
+	if (!reader->ParseCentralDirectory()) {
+		// Not necessarily broken, could be zip64 or something else libzip handles.
+		INFO_LOG(Log::IO, "Not mapping %s, using libzip for it", zipFile.c_str());
+		delete reader;
+		return nullptr;
+	}
+	INFO_LOG(Log::IO, "Mapped %s as a zip file (%d files)", zipFile.c_str(), (int)reader->entries_.size());
+	return reader;
+}
+
+bool MappedZipFileReader::Map(bool logErrors) {
+#if !defined(CAN_MAP_ZIP)
+	return false;
+#elif !defined(_WIN32)
+	int fd = open(zipPath_.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		if (logErrors) {
+			ERROR_LOG(Log::IO, "Failed to open %s as a zip file", zipPath_.c_str());
+		}
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)ZIP_END_SIZE) {
+		close(fd);
+		if (logErrors) {
+			ERROR_LOG(Log::IO, "Failed to open %s as a zip file", zipPath_.c_str());
+		}
+		return false;
+	}
+	void *ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping keeps the file alive.
+	close(fd);
+	if (ptr == MAP_FAILED) {
+		WARN_LOG(Log::IO, "Couldn't map %s: %s", zipPath_.c_str(), strerror(errno));
+		return false;
+	}
+	data_ = (const uint8_t *)ptr;
+	size_ = (size_t)st.st_size;
+	return true;
+#else
+	HANDLE handle = CreateFile(zipPath_.ToWString().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		if (logErrors) {
+			ERROR_LOG(Log::IO, "Failed to open %s as a zip file", zipPath_.c_str());
+		}
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart < (LONGLONG)ZIP_END_SIZE) {
+		CloseHandle(handle);
+		if (logErrors) {
+			ERROR_LOG(Log::IO, "Failed to open %s as a zip file", zipPath_.c_str());
+		}
+		return false;
+	}
+	HANDLE mapping = CreateFileMapping(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The mapping keeps the file alive.
+	CloseHandle(handle);
+	if (!mapping) {
+		WARN_LOG(Log::IO, "Couldn't map %s: %08x", zipPath_.c_str(), (uint32_t)GetLastError());
+		return false;
+	}
+	const uint8_t *ptr = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!ptr) {
+		WARN_LOG(Log::IO, "Couldn't map %s: %08x", zipPath_.c_str(), (uint32_t)GetLastError());
+		CloseHandle(mapping);
+		return false;
+	}
+	mappingHandle_ = mapping;
+	data_ = ptr;
+	size_ = (size_t)fileSize.QuadPart;
+	return true;
+#endif
+}
+
+MappedZipFileReader::~MappedZipFileReader() {
+	if (!data_)
+		return;
+#if !defined(CAN_MAP_ZIP)
+#elif !defined(_WIN32)
+	munmap((void *)data_, size_);
+#else
+	UnmapViewOfFile(data_);
+	CloseHandle(mappingHandle_);
+#endif
+}
+
+bool MappedZipFileReader::ParseCentralDirectory() {
+	// The end record is last, followed only by a comment of up to 64 KB.
+	size_t searchStart = size_ > ZIP_END_SIZE + 0xFFFF ? size_ - ZIP_END_SIZE - 0xFFFF : 0;
+	const uint8_t *end = nullptr;
+	for (size_t pos = size_ - ZIP_END_SIZE + 1; pos-- > searchStart; ) {
+		if (ReadLE32(data_ + pos) == ZIP_END_MAGIC && pos + ZIP_END_SIZE + ReadLE16(data_ + pos + 20) <= size_) {
+			end = data_ + pos;
+			break;
+		}
+	}
+	if (!end)
+		return false;
+
+	// Zip64 archives (over 4 GB or 65535 files) are left to libzip, as are multi-disk ones.
+	if (end - data_ >= (ptrdiff_t)ZIP64_END_LOCATOR_SIZE && ReadLE32(end - ZIP64_END_LOCATOR_SIZE) == ZIP64_END_LOCATOR_MAGIC)
+		return false;
+	uint16_t count = ReadLE16(end + 10);
+	uint32_t dirSize = ReadLE32(end + 12);
+	uint32_t dirOffset = ReadLE32(end + 16);
+	if (ReadLE16(end + 4) != 0 || ReadLE16(end + 6) != 0 || ReadLE16(end + 8) != count)
+		return false;
+	if (dirOffset > (size_t)(end - data_) || dirSize > (size_t)(end - data_) - dirOffset)
+		return false;
+
+	entries_.reserve(count);
+	index_.reserve(count);
+	const uint8_t *p = data_ + dirOffset;
+	const uint8_t *dirEnd = p + dirSize;
+	for (uint16_t i = 0; i < count; i++) {
+		if (dirEnd - p < (ptrdiff_t)ZIP_CENTRAL_HEADER_SIZE || ReadLE32(p) != ZIP_CENTRAL_HEADER_MAGIC)
+			return false;
+		uint16_t flags = ReadLE16(p + 8);
+		uint16_t method = ReadLE16(p + 10);
+		uint16_t nameLen = ReadLE16(p + 28);
+		uint16_t extraLen = ReadLE16(p + 30);
+		uint16_t commentLen = ReadLE16(p + 32);
+		size_t headerSize = ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+		if ((size_t)(dirEnd - p) < headerSize)
+			return false;
+		if ((flags & ZIP_FLAG_ENCRYPTED) != 0 || (method != ZIP_METHOD_STORE && method != ZIP_METHOD_DEFLATE))
+			return false;
+
+		Entry entry;
+		entry.name.assign((const char *)p + ZIP_CENTRAL_HEADER_SIZE, nameLen);
+		entry.compressedSize = ReadLE32(p + 20);
+		entry.size = ReadLE32(p + 24);
+		entry.localHeaderOffset = ReadLE32(p + 42);
+		entry.deflated = method == ZIP_METHOD_DEFLATE;
+		// 0xFFFFFFFF means the real value is in a zip64 extra field.
+		if (entry.compressedSize == 0xFFFFFFFF || entry.size == 0xFFFFFFFF || entry.localHeaderOffset == 0xFFFFFFFF)
+			return false;
+		if (!entry.deflated && entry.compressedSize != entry.size)
+			return false;
+		if (entry.localHeaderOffset >= dirOffset)
+			return false;
+
+		// Like libzip, the first one wins if a name is repeated.
+		index_.emplace(LowerCaseASCII(entry.name), entries_.size());
+		entries_.push_back(std::move(entry));
+		p += headerSize;
+	}
+	return true;
+}
+
+const MappedZipFileReader::Entry *MappedZipFileReader::FindEntry(const std::string &path) const {
+	auto iter = index_.find(LowerCaseASCII(path));
+	if (iter == index_.end())
+		return nullptr;
+	return &entries_[iter->second];
+}
+
+const uint8_t *MappedZipFileReader::EntryData(const Entry &entry) const {
+	// The local header repeats most of the central one, but the extra field can differ in size.
+	size_t offset = entry.localHeaderOffset;
+	if (size_ - offset < ZIP_LOCAL_HEADER_SIZE || ReadLE32(data_ + offset) != ZIP_LOCAL_HEADER_MAGIC) {
+		ERROR_LOG(Log::IO, "Bad local header for %s in %s", entry.name.c_str(), zipPath_.c_str());
+		return nullptr;
+	}
+	offset += ZIP_LOCAL_HEADER_SIZE + ReadLE16(data_ + offset + 26) + ReadLE16(data_ + offset + 28);
+	if (offset > size_ || size_ - offset < entry.compressedSize) {
+		ERROR_LOG(Log::IO, "Truncated data for %s in %s", entry.name.c_str(), zipPath_.c_str());
+		return nullptr;
+	}
+	return data_ + offset;
+}
+
+bool MappedZipFileReader::Inflate(const Entry &entry, uint8_t *dest) const {
+	const uint8_t *src = EntryData(entry);
+	if (!src)
+		return false;
+
+	z_stream stream{};
+	// Raw deflate, zip files have no zlib header.
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		return false;
+	stream.next_in = (Bytef *)src;
+	stream.avail_in = entry.compressedSize;
+	stream.next_out = dest;
+	stream.avail_out = entry.size;
+	int result = inflate(&stream, Z_FINISH);
+	bool success = result == Z_STREAM_END && stream.total_out == entry.size;
+	inflateEnd(&stream);
+	if (!success) {
+		ERROR_LOG(Log::IO, "Failed to inflate %s from %s (%d)", entry.name.c_str(), zipPath_.c_str(), result);
+	}
+	return success;
+}
+
+uint8_t *MappedZipFileReader::ReadFile(const char *path, size_t *size) {
+	std::string temp_path = inZipPath_ + path;
+	const Entry *entry = FindEntry(temp_path);
+	if (!entry) {
+		ERROR_LOG(Log::IO, "Error opening %s from ZIP", temp_path.c_str());
+		return nullptr;
+	}
+
+	uint8_t *contents = new uint8_t[(size_t)entry->size + 1];
+	if (entry->deflated) {
+		if (!Inflate(*entry, contents)) {
+			delete[] contents;
+			return nullptr;
+		}
+	} else {
+		const uint8_t *src = EntryData(*entry);
+		if (!src) {
+			delete[] contents;
+			return nullptr;
+		}
+		memcpy(contents, src, entry->size);
+	}
+	contents[entry->size] = 0;
+
+	*size = entry->size;
+	return contents;
+}
+
+bool MappedZipFileReader::GetFileListing(const char *orig_path, std::vector<File::FileInfo> *listing, const char *filter = 0) {
+	std::string path = std::string(inZipPath_) + orig_path;
+	if (!path.empty() && path.back() != '/') {
+		path.push_back('/');
+	}
+
+	std::set<std::string> filters;
+	std::string tmp;
+	if (filter) {
+		while (*filter) {
+			if (*filter == ':') {
+				filters.emplace("." + tmp);
+				tmp.clear();
+			} else {
+				tmp.push_back(*filter);
+			}
+			filter++;
+		}
+	}
+
+	if (tmp.size())
+		filters.emplace("." + tmp);
+
+	// Same as ZipFileReader::GetZipListings, but there's no need to lock.
+	std::set<std::string> files;
+	std::set<std::string> directories;
+	bool anyPrefixMatched = false;
+	for (const Entry &entry : entries_) {
+		const std::string &name = entry.name;
+		if (!startsWith(name, path) || name.size() == path.size())
+			continue;
+		anyPrefixMatched = true;
+		size_t slashPos = name.find('/', path.size());
+		if (slashPos != std::string::npos) {
+			directories.insert(name.substr(path.size(), slashPos - path.size()));
+		} else {
+			files.insert(name.substr(path.size()));
+		}
+	}
+	if (!anyPrefixMatched) {
+		// This means that no file prefix matched the path.
+		return false;
+	}
+
+	listing->clear();
+
+	const std::string relativePath = path.substr(inZipPath_.size());
+
+	listing->reserve(directories.size() + files.size());
+	for (const auto &dir : directories) {
+		File::FileInfo info;
+		info.name = dir;
+		info.fullName = Path(relativePath + dir);
+		info.exists = true;
+		info.isWritable = false;
+		info.isDirectory = true;
+		listing->push_back(info);
+	}
+
+	for (const auto &fiter : files) {
+		File::FileInfo info;
+		info.name = fiter;
+		info.fullName = Path(relativePath + fiter);
+		info.exists = true;
+		info.isWritable = false;
+		info.isDirectory = false;
+		std::string ext = info.fullName.GetFileExtension();
+		if (filter) {
+			if (filters.find(ext) == filters.end()) {
+				continue;
+			}
+		}
+		listing->push_back(info);
+	}
+
+	std::sort(listing->begin(), listing->end());
+	return true;
+}
+
+bool MappedZipFileReader::GetFileInfo(const char *path, File::FileInfo *info) {
+	std::string temp_path = inZipPath_ + path;
+
+	// Clear some things to start.
+	info->isDirectory = false;
+	info->isWritable = false;
+	info->size = 0;
+
+	const Entry *entry = FindEntry(temp_path);
+	if (!entry) {
+		// ZIP files do not have real directories, so we'll end up here if we
+		// try to stat one. For now that's fine.
+		info->exists = false;
+		return false;
+	}
+
+	// Zips usually don't contain directory entries, but they may.
+	info->isDirectory = !entry->name.empty() && entry->name.back() == '/';
+	info->size = entry->size;
+	info->fullName = Path(path);
+	info->exists = true;
+	return true;
+}
+
+VFSFileReference *MappedZipFileReader::GetFile(const char *path) {
+	auto iter = index_.find(LowerCaseASCII(inZipPath_ + path));
+	if (iter == index_.end()) {
+		// Not found.
+		return nullptr;
+	}
+	MappedZipFileReference *ref = new MappedZipFileReference();
+	ref->index = iter->second;
+	return ref;
+}
+
+bool MappedZipFileReader::GetFileInfo(VFSFileReference *vfsReference, File::FileInfo *fileInfo) {
+	MappedZipFileReference *reference = (MappedZipFileReference *)vfsReference;
+	*fileInfo = File::FileInfo{};
+	fileInfo->size = entries_[reference->index].size;
+	return true;
+}
+
+void MappedZipFileReader::ReleaseFile(VFSFileReference *vfsReference) {
+	MappedZipFileReference *reference = (MappedZipFileReference *)vfsReference;
+	// Don't do anything other than deleting it.
+	delete reference;
+}
+
+VFSOpenFile *MappedZipFileReader::OpenFileForRead(VFSFileReference *vfsReference, size_t *size) {
+	MappedZipFileReference *reference = (MappedZipFileReference *)vfsReference;
+	const Entry &entry = entries_[reference->index];
+	*size = 0;
+
+	const uint8_t *data = EntryData(entry);
+	if (!data)
+		return nullptr;
+
+	MappedZipOpenFile *openFile = new MappedZipOpenFile();
+	openFile->data = data;
+	openFile->compressedSize = entry.compressedSize;
+	openFile->size = entry.size;
+	if (entry.deflated) {
+		if (inflateInit2(&openFile->stream, -MAX_WBITS) != Z_OK) {
+			delete openFile;
+			return nullptr;
+		}
+		openFile->inflating = true;
+		openFile->stream.next_in = (Bytef *)data;
+		openFile->stream.avail_in = entry.compressedSize;
+	}
+
+	*size = entry.size;
+	return openFile;
+}
+
+void MappedZipFileReader::Rewind(VFSOpenFile *vfsOpenFile) {
+	MappedZipOpenFile *file = (MappedZipOpenFile *)vfsOpenFile;
+	_assert_(file);
+	if (file->inflating) {
+		inflateReset(&file->stream);
+		file->stream.next_in = (Bytef *)file->data;
+		file->stream.avail_in = file->compressedSize;
+	} else {
+		file->pos = 0;
+	}
+}
+
+size_t MappedZipFileReader::Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) {
+	MappedZipOpenFile *file = (MappedZipOpenFile *)vfsOpenFile;
+	_assert_(file);
+	if (!file->inflating) {
+		size_t count = std::min(length, (size_t)(file->size - file->pos));
+		memcpy(buffer, file->data + file->pos, count);
+		file->pos += (uint32_t)count;
+		return count;
+	}
+
+	z_stream &stream = file->stream;
+	uLong startOut = stream.total_out;
+	stream.next_out = (Bytef *)buffer;
+	stream.avail_out = (uInt)std::min(length, (size_t)(file->size - stream.total_out));
+	while (stream.avail_out != 0) {
+		int result = inflate(&stream, Z_NO_FLUSH);
+		if (result == Z_STREAM_END)
+			break;
+		if (result != Z_OK) {
+			ERROR_LOG(Log::IO, "Failed to inflate from %s (%d)", zipPath_.c_str(), result);
+			break;
+		}
+	}
+	return stream.total_out - startOut;
+}
+
+void MappedZipFileReader::CloseFile(VFSOpenFile *vfsOpenFile) {
+	MappedZipOpenFile *file = (MappedZipOpenFile *)vfsOpenFile;
+	_assert_(file);
+	delete file;
+}
+
+const uint8_t *MappedZipFileReader::DataPointer(VFSOpenFile *vfsOpenFile) {
+	MappedZipOpenFile *file = (MappedZipOpenFile *)vfsOpenFile;
+	_assert_(file);
+	return file->inflating ? nullptr : file->data;
+}
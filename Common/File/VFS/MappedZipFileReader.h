@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/File/VFS/VFS.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+
+// Read-only zip backend that maps the whole archive into memory and indexes the central directory once,
+// so that lookups and reads don't need a lock and can run on any number of threads at once. Stored
+// (uncompressed) files can be used right out of the mapping through DataPointer(), deflated ones are
+// inflated straight from it.
+//
+// Create() fails for anything it can't handle (zip64, encrypted files, other compression methods, content
+// URIs, 32-bit builds), so always fall back to ZipFileReader. A read error on a mapped file is a crash
+// rather than an error, which is why only local paths are mapped.
+class MappedZipFileReader : public VFSBackend {
+public:
+	static MappedZipFileReader *Create(const Path &zipFile, const char *inZipPath, bool logErrors = true);
+	~MappedZipFileReader();
+
+	// use delete[] on the returned value.
+	uint8_t *ReadFile(const char *path, size_t *size) override;
+
+	VFSFileReference *GetFile(const char *path) override;
+	bool GetFileInfo(VFSFileReference *vfsReference, File::FileInfo *fileInfo) override;
+	void ReleaseFile(VFSFileReference *vfsReference) override;
+
+	VFSOpenFile *OpenFileForRead(VFSFileReference *vfsReference, size_t *size) override;
+	void Rewind(VFSOpenFile *vfsOpenFile) override;
+	size_t Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) override;
+	void CloseFile(VFSOpenFile *vfsOpenFile) override;
+	const uint8_t *DataPointer(VFSOpenFile *vfsOpenFile) override;
+
+	bool GetFileListing(const char *path, std::vector<File::FileInfo> *listing, const char *filter) override;
+	bool GetFileInfo(const char *path, File::FileInfo *info) override;
+	std::string toString() const override {
+		std::string retval = zipPath_.ToVisualString();
+		if (!inZipPath_.empty()) {
+			retval += ": ";
+			retval += inZipPath_;
+		}
+		return retval;
+	}
+
+private:
+	struct Entry {
+		std::string name;
+		uint32_t localHeaderOffset;
+		uint32_t compressedSize;
+		uint32_t size;
+		bool deflated;
+	};
+
+	MappedZipFileReader(const Path &zipPath, const std::string &inZipPath) : zipPath_(zipPath), inZipPath_(inZipPath) {}
+	bool Map(bool logErrors);
+	bool ParseCentralDirectory();
+	const Entry *FindEntry(const std::string &path) const;
+	// Where the file data starts, or nullptr if the local header is broken.
+	const uint8_t *EntryData(const Entry &entry) const;
+	bool Inflate(const Entry &entry, uint8_t *dest) const;
+
+	Path zipPath_;
+	std::string inZipPath_;
+
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void *mappingHandle_ = nullptr;
+#endif
+
+	// Never changes after Create(), that's what makes the lock unnecessary.
+	std::vector<Entry> entries_;
+	// Lowercase names, for case insensitive lookups like ZipFileReader does.
+	std::unordered_map<std::string, size_t> index_;
+};
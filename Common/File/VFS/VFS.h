@@ -53,6 +53,9 @@ class VFSBackend : public VFSInterface {
 	virtual void Rewind(VFSOpenFile *vfsOpenFile) = 0;
 	virtual size_t Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) = 0;
 	virtual void CloseFile(VFSOpenFile *vfsOpenFile) = 0;
+	// If the whole file is already in memory as-is, returns it (with the size from OpenFileForRead)
+	// so it doesn't need to be read into a buffer. Valid until CloseFile.
+	virtual const uint8_t *DataPointer(VFSOpenFile *vfsOpenFile) { return nullptr; }
 
 	// Filter support is optional but nice to have
 	virtual bool GetFileInfo(const char *path, File::FileInfo *info) = 0;
@@ -15,8 +15,10 @@
 // Official SVN repository and contact information can be found at
 // http://code.google.com/p/dolphin-emu/
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <snappy-c.h>
 #include <zstd.h>
 
@@ -24,6 +26,7 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 
 enum class SerializeCompressType {
 	NONE = 0,
@@ -32,6 +35,14 @@ enum class SerializeCompressType {
 };
 
 static constexpr SerializeCompressType SAVE_TYPE = SerializeCompressType::ZSTD;
+// Chunks start at sections down to this depth: SaveStart, and Memory, Kernel, HLE Modules etc. inside it.
+static constexpr int CHUNK_SECTION_DEPTH = 1;
+// Bigger sections (RAM) are split up, so they still compress and decompress in parallel.
+// The default level only looks back 2 MB anyway, so this costs very little in size.
+static constexpr size_t CHUNK_MAX_SIZE = 4 * 1024 * 1024;
+
+typedef CChunkFileReader::ChunkInfo ChunkInfo;
+static_assert(sizeof(ChunkInfo) == 32, "ChunkInfo is written to disk as is");
 
 void PointerWrap::RewindForWrite(u8 *writePtr) {
 	_assert_(mode == MODE_MEASURE);
@@ -61,6 +72,8 @@ PointerWrapSection PointerWrap::Section(const char *title, int minVer, int ver)
 	int foundVersion = ver;
 
 	curTitle_ = title;
+	// ~PointerWrapSection() goes back up, whatever happens below.
+	int depth = depth_++;
 
 	// This is strncpy because we rely on its weird non-null-terminating zero-filling truncation behaviour.
 	// Can't replace it with the more sensible truncate_cpy because that would break savestates.
@@ -69,7 +82,7 @@ PointerWrapSection PointerWrap::Section(const char *title, int minVer, int ver)
 	// Compare the measure and write passes. Sanity check to catch bugs, doesn't do anything for output.
 	size_t offset = Offset();
 	if (mode == MODE_MEASURE) {
-		checkpoints_.emplace_back(marker, offset);
+		checkpoints_.emplace_back(marker, offset, depth);
 	} else if (mode == MODE_WRITE) {
 		if (!checkpoints_.empty()) {
 			if (checkpoints_.size() <= curCheckpoint_) {
@@ -284,6 +297,223 @@ PointerWrapSection::~PointerWrapSection() {
 	if (ver_ > 0) {
 		p_.DoMarker(title_);
 	}
+	p_.depth_--;
+}
+
+static void AddChunks(std::vector<ChunkInfo> *chunks, const char *title, size_t start, size_t end) {
+	for (size_t offset = start; offset < end; offset += CHUNK_MAX_SIZE) {
+		ChunkInfo chunk{};
+		memcpy(chunk.title, title, sizeof(chunk.title));
+		chunk.offset = (u32)offset;
+		chunk.size = (u32)std::min(CHUNK_MAX_SIZE, end - offset);
+		chunks->push_back(chunk);
+	}
+}
+
+static std::vector<ChunkInfo> ChooseChunks(const std::vector<SerializeCheckpoint> &sections, size_t sz) {
+	std::vector<ChunkInfo> chunks;
+	char title[16]{};
+	size_t start = 0;
+	for (const SerializeCheckpoint &section : sections) {
+		if (section.depth > CHUNK_SECTION_DEPTH)
+			continue;
+		if (section.offset > start) {
+			AddChunks(&chunks, title, start, section.offset);
+			start = section.offset;
+		}
+		memcpy(title, section.title, sizeof(title));
+	}
+	AddChunks(&chunks, title, start, sz);
+	return chunks;
+}
+
+static void ForEachChunk(size_t count, const std::function<void(int, int)> &loop, TaskPriority priority) {
+	// Tools and tests might not have started the threads.
+	if (g_threadManager.IsInitialized()) {
+		ParallelRangeLoop(&g_threadManager, loop, 0, (int)count, 1, priority);
+	} else {
+		loop(0, (int)count);
+	}
+}
+
+static size_t ChunksBound(const std::vector<ChunkInfo> &chunks) {
+	size_t bound = 0;
+	for (const ChunkInfo &chunk : chunks) {
+		bound += ZSTD_compressBound(chunk.size);
+	}
+	return bound;
+}
+
+// Compresses each chunk into a zstd frame, one after another. dst must have room for ChunksBound().
+// Fills in where they ended up.
+static bool CompressChunks(u8 *dst, const u8 *src, std::vector<ChunkInfo> &chunks, size_t *written) {
+	// Each is compressed to its worst case spot first, then they're moved together.
+	std::vector<size_t> spots(chunks.size());
+	size_t spot = 0;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		spots[i] = spot;
+		spot += ZSTD_compressBound(chunks[i].size);
+	}
+
+	ForEachChunk(chunks.size(), [&](int lower, int upper) {
+		ZSTD_CCtx *ctx = ZSTD_createCCtx();
+		for (int i = lower; i < upper; i++) {
+			ChunkInfo &chunk = chunks[i];
+			// A zstd frame is never empty, so this marks failure.
+			chunk.compressedSize = 0;
+			if (!ctx)
+				continue;
+			ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+			// TODO: If free disk space is low, we could max this out to 22?
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+			ZSTD_CCtx_setPledgedSrcSize(ctx, chunk.size);
+			size_t result = ZSTD_compress2(ctx, dst + spots[i], ZSTD_compressBound(chunk.size), src + chunk.offset, chunk.size);
+			if (!ZSTD_isError(result))
+				chunk.compressedSize = (u32)result;
+		}
+		ZSTD_freeCCtx(ctx);
+	}, TaskPriority::LOW);
+
+	*written = 0;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (chunks[i].compressedSize == 0)
+			return false;
+		memmove(dst + *written, dst + spots[i], chunks[i].compressedSize);
+		chunks[i].compressedOffset = (u32)*written;
+		*written += chunks[i].compressedSize;
+	}
+	return true;
+}
+
+static bool DecompressChunks(u8 *dst, const u8 *src, const std::vector<ChunkInfo> &chunks) {
+	// Not vector<bool>, the threads write next to each other.
+	std::vector<u8> success(chunks.size());
+	ForEachChunk(chunks.size(), [&](int lower, int upper) {
+		ZSTD_DCtx *ctx = ZSTD_createDCtx();
+		for (int i = lower; i < upper; i++) {
+			const ChunkInfo &chunk = chunks[i];
+			if (!ctx)
+				continue;
+			size_t result = ZSTD_decompressDCtx(ctx, dst + chunk.offset, chunk.size, src + chunk.compressedOffset, chunk.compressedSize);
+			success[i] = !ZSTD_isError(result) && result == chunk.size;
+		}
+		ZSTD_freeDCtx(ctx);
+	}, TaskPriority::NORMAL);
+
+	return std::all_of(success.begin(), success.end(), [](u8 s) { return s != 0; });
+}
+
+// The chunks have to cover the state exactly, in order, and the frames have to be in the data.
+static bool ValidateChunkIndex(const std::vector<ChunkInfo> &chunks, size_t dataSize, size_t uncompressedSize) {
+	size_t offset = 0;
+	for (const ChunkInfo &chunk : chunks) {
+		if (chunk.offset != offset || (u64)chunk.compressedOffset + chunk.compressedSize > dataSize) {
+			return false;
+		}
+		offset += chunk.size;
+	}
+	return offset == uncompressedSize;
+}
+
+// The index is a zstd skippable frame in front of the chunk frames: the magic, the frame size and the number
+// of chunks (all u32), then their ChunkInfo. Older versions just skip it and decompress the frames as one.
+static constexpr u32 CHUNK_INDEX_MAGIC = ZSTD_MAGIC_SKIPPABLE_START;
+static constexpr size_t CHUNK_INDEX_HEADER_SIZE = 3 * sizeof(u32);
+
+static size_t ChunkIndexSize(size_t count) {
+	return CHUNK_INDEX_HEADER_SIZE + count * sizeof(ChunkInfo);
+}
+
+static void WriteChunkIndex(u8 *dst, const std::vector<ChunkInfo> &chunks) {
+	const u32 header[3] = { CHUNK_INDEX_MAGIC, (u32)(ChunkIndexSize(chunks.size()) - 2 * sizeof(u32)), (u32)chunks.size() };
+	memcpy(dst, header, sizeof(header));
+	if (!chunks.empty())
+		memcpy(dst + sizeof(header), chunks.data(), chunks.size() * sizeof(ChunkInfo));
+}
+
+// Gets the number of chunks, if the data starts with an index. maxSize is how much data there is.
+static bool ParseChunkIndexHeader(const u8 *data, size_t maxSize, u32 *count) {
+	u32 header[3];
+	if (maxSize < sizeof(header))
+		return false;
+	memcpy(header, data, sizeof(header));
+	if (header[0] != CHUNK_INDEX_MAGIC || header[2] > (maxSize - sizeof(header)) / sizeof(ChunkInfo))
+		return false;
+	*count = header[2];
+	return header[1] == ChunkIndexSize(*count) - 2 * sizeof(u32);
+}
+
+static bool ParseChunkIndex(const u8 *data, size_t sz, u32 uncompressedSize, std::vector<ChunkInfo> *chunks, size_t *indexSize) {
+	u32 count;
+	if (!ParseChunkIndexHeader(data, sz, &count))
+		return false;
+
+	chunks->resize(count);
+	if (count != 0)
+		memcpy(chunks->data(), data + CHUNK_INDEX_HEADER_SIZE, count * sizeof(ChunkInfo));
+	*indexSize = ChunkIndexSize(count);
+	return ValidateChunkIndex(*chunks, sz - *indexSize, uncompressedSize);
+}
+
+CChunkFileReader::Error CChunkFileReader::LoadChunkIndex(File::IOFile &pFile, const SChunkHeader &header, std::vector<ChunkInfo> *chunks) {
+	u8 indexHeader[CHUNK_INDEX_HEADER_SIZE];
+	u32 count;
+	if (SerializeCompressType(header.Compress) != SerializeCompressType::ZSTD || !pFile.ReadArray(indexHeader, sizeof(indexHeader)) || !ParseChunkIndexHeader(indexHeader, header.ExpectedSize, &count)) {
+		ERROR_LOG(Log::SaveState, "ChunkReader: Not a chunked state (compression type %d)", header.Compress);
+		return ERROR_BAD_FILE;
+	}
+	chunks->resize(count);
+	if (count != 0 && !pFile.ReadArray(chunks->data(), count)) {
+		ERROR_LOG(Log::SaveState, "ChunkReader: Unable to read chunk index");
+		return ERROR_BAD_FILE;
+	}
+
+	if (!ValidateChunkIndex(*chunks, header.ExpectedSize - ChunkIndexSize(count), header.UncompressedSize)) {
+		ERROR_LOG(Log::SaveState, "ChunkReader: Bad chunk index");
+		return ERROR_BAD_FILE;
+	}
+	return ERROR_NONE;
+}
+
+CChunkFileReader::Error CChunkFileReader::GetChunkIndex(const Path &filename, std::vector<ChunkInfo> *chunks) {
+	File::IOFile pFile(filename, "rb");
+	SChunkHeader header;
+	Error err = LoadFileHeader(pFile, header, nullptr);
+	if (err != ERROR_NONE) {
+		return err;
+	}
+	return LoadChunkIndex(pFile, header, chunks);
+}
+
+CChunkFileReader::Error CChunkFileReader::ReadChunk(const Path &filename, const ChunkInfo &chunk, std::vector<u8> *data) {
+	File::IOFile pFile(filename, "rb");
+	SChunkHeader header;
+	Error err = LoadFileHeader(pFile, header, nullptr);
+	if (err != ERROR_NONE) {
+		return err;
+	}
+	std::vector<ChunkInfo> chunks;
+	err = LoadChunkIndex(pFile, header, &chunks);
+	if (err != ERROR_NONE) {
+		return err;
+	}
+
+	// The frames follow the index.
+	std::vector<u8> compressed(chunk.compressedSize);
+	if (!pFile.Seek(chunk.compressedOffset, SEEK_CUR) || !pFile.ReadBytes(compressed.data(), compressed.size())) {
+		ERROR_LOG(Log::SaveState, "ChunkReader: Error reading chunk");
+		return ERROR_BAD_FILE;
+	}
+
+	data->resize(chunk.size);
+	size_t result = ZSTD_decompress(data->data(), data->size(), compressed.data(), compressed.size());
+	if (ZSTD_isError(result) || result != chunk.size) {
+		ERROR_LOG(Log::SaveState, "ChunkReader: Failed to decompress chunk");
+		data->clear();
+		return ERROR_BAD_FILE;
+	}
+	return ERROR_NONE;
 }
 
 CChunkFileReader::Error CChunkFileReader::LoadFileHeader(File::IOFile &pFile, SChunkHeader &header, std::string *title) {
@@ -377,10 +607,17 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 			auto status = snappy_uncompress((const char *)buffer, sz, (char *)uncomp_buffer, &uncomp_size);
 			success = status == SNAPPY_OK;
 		} else if (SerializeCompressType(header.Compress) == SerializeCompressType::ZSTD) {
-			size_t status = ZSTD_decompress((char *)uncomp_buffer, uncomp_size, (const char *)buffer, sz);
-			success = !ZSTD_isError(status);
-			if (success) {
-				uncomp_size = status;
+			// With an index, the chunks can be decompressed in parallel. Older states are a single frame.
+			std::vector<ChunkInfo> chunks;
+			size_t indexSize = 0;
+			if (ParseChunkIndex(buffer, sz, header.UncompressedSize, &chunks, &indexSize)) {
+				success = DecompressChunks(uncomp_buffer, buffer + indexSize, chunks);
+			} else {
+				size_t status = ZSTD_decompress((char *)uncomp_buffer, uncomp_size, (const char *)buffer, sz);
+				success = !ZSTD_isError(status);
+				if (success) {
+					uncomp_size = status;
+				}
 			}
 		} else {
 			ERROR_LOG(Log::SaveState, "ChunkReader: Unexpected compression type %d", header.Compress);
@@ -414,7 +651,7 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 }
 
 // Takes ownership of buffer.
-CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz) {
+CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz, const std::vector<SerializeCheckpoint> &sections) {
 	INFO_LOG(Log::SaveState, "ChunkReader: Writing %s", filename.c_str());
 
 	File::IOFile pFile(filename, "wb");
@@ -427,6 +664,8 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 	// Make sure we can allocate a buffer to compress before compressing.
 	size_t write_len;
 	SerializeCompressType usedType = SAVE_TYPE;
+	std::vector<ChunkInfo> chunks;
+	size_t indexSize = 0;
 	switch (usedType) {
 	case SerializeCompressType::NONE:
 		write_len = 0;
@@ -435,7 +674,9 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 		write_len = snappy_max_compressed_length(sz);
 		break;
 	case SerializeCompressType::ZSTD:
-		write_len = ZSTD_compressBound(sz);
+		chunks = ChooseChunks(sections, sz);
+		indexSize = ChunkIndexSize(chunks.size());
+		write_len = indexSize + ChunksBound(chunks);
 		break;
 	}
 	u8 *compressed_buffer = write_len == 0 ? nullptr : (u8 *)malloc(write_len);
@@ -456,19 +697,11 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 			success = snappy_compress((const char *)buffer, sz, (char *)compressed_buffer, &write_len) == SNAPPY_OK;
 			break;
 		case SerializeCompressType::ZSTD:
-			{
-				auto ctx = ZSTD_createCCtx();
-				if (!ctx) {
-					success = false;
-				} else {
-					// TODO: If free disk space is low, we could max this out to 22?
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
-					ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
-					write_len = ZSTD_compress2(ctx, compressed_buffer, write_len, buffer, sz);
-					success = !ZSTD_isError(write_len);
-				}
-				ZSTD_freeCCtx(ctx);
+			// Concatenated frames read back as one, so this is still a plain zstd state to older versions.
+			success = CompressChunks(compressed_buffer + indexSize, buffer, chunks, &write_len);
+			if (success) {
+				WriteChunkIndex(compressed_buffer, chunks);
+				write_len += indexSize;
 			}
 			break;
 		}
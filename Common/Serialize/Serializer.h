@@ -76,11 +76,13 @@ class PointerWrapSection
 struct SerializeCheckpoint {
 	char title[17];  // 16-byte section header, plus a zero terminator for debug printing.
 	size_t offset;
+	int depth;  // 0 for the outermost section.
 
-	SerializeCheckpoint(char _title[16], size_t off) {
+	SerializeCheckpoint(char _title[16], size_t off, int _depth) {
 		memcpy(title, _title, 16);
 		title[16] = 0;
 		offset = off;
+		depth = _depth;
 	}
 
 	bool Matches(const char *_title, size_t off) const {
@@ -140,6 +142,11 @@ class PointerWrap
 		return firstBadSectionTitle_;
 	}
 
+	// All sections in the order they start, from the measure pass.
+	const std::vector<SerializeCheckpoint> &GetCheckpoints() const {
+		return checkpoints_;
+	}
+
 	// Same as DoVoid, except doesn't advance pointer if it doesn't match on read.
 	bool ExpectVoid(void *data, int size);
 	void DoVoid(void *data, int size);
@@ -154,12 +161,15 @@ class PointerWrap
 	size_t Offset() const { return *ptr - ptrStart_; }
 
 private:
+	friend class PointerWrapSection;
+
 	const char *firstBadSectionTitle_ = nullptr;
 	const char *curTitle_;
 	u8 *ptrStart_;
 	std::vector<SerializeCheckpoint> checkpoints_;
 	size_t curCheckpoint_ = 0;
 	size_t measuredSize_ = 0;
+	int depth_ = 0;
 };
 
 class CChunkFileReader
@@ -172,6 +182,17 @@ class CChunkFileReader
 		ERROR_BAD_ALLOC,
 	};
 
+	// Save states are compressed a section at a time (the outermost two levels of them, big ones are
+	// split further), so loading can decompress in parallel and tools can get at single sections.
+	struct ChunkInfo {
+		char title[16];  // The section the chunk starts with. Like the markers, not terminated at 16 chars.
+		u32 offset;
+		u32 size;
+		// From the end of the index.
+		u32 compressedOffset;
+		u32 compressedSize;
+	};
+
 	// May fail badly if ptr doesn't point to valid data.
 	template<class T>
 	static Error LoadPtr(u8 *ptr, T &_class, std::string *errorString)
@@ -199,8 +220,9 @@ class CChunkFileReader
 
 	// If *saved is null, will allocate storage using malloc.
 	// If it's not null, it will be used, but only hope can save you from overruns at the end. For libretro.
+	// sections gets where each section starts, for SaveFile.
 	template<class T>
-	static Error MeasureAndSavePtr(T &_class, u8 **saved, size_t *savedSize)
+	static Error MeasureAndSavePtr(T &_class, u8 **saved, size_t *savedSize, std::vector<SerializeCheckpoint> *sections = nullptr)
 	{
 		u8 *ptr = nullptr;
 		PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
@@ -223,6 +245,8 @@ class CChunkFileReader
 		if (p.CheckAfterWrite()) {
 			*saved = data;
 			*savedSize = measuredSize;
+			if (sections)
+				*sections = p.GetCheckpoints();
 			return ERROR_NONE;
 		} else {
 			if (!*saved) {
@@ -282,11 +306,12 @@ class CChunkFileReader
 	{
 		u8 *buffer = nullptr;
 		size_t sz = 0;
-		Error error = MeasureAndSavePtr(_class, &buffer, &sz);
+		std::vector<SerializeCheckpoint> sections;
+		Error error = MeasureAndSavePtr(_class, &buffer, &sz, &sections);
 
 		// SaveFile takes ownership of buffer (malloc/free)
 		if (error == ERROR_NONE)
-			error = SaveFile(filename, title, gitVersion, buffer, sz);
+			error = SaveFile(filename, title, gitVersion, buffer, sz, sections);
 		return error;
 	}
 
@@ -316,6 +341,14 @@ class CChunkFileReader
 
 	static Error GetFileTitle(const Path &filename, std::string *title);
 
+	// For tools, to look at (or compare) single sections without decompressing the whole state.
+	static Error GetChunkIndex(const Path &filename, std::vector<ChunkInfo> *chunks);
+	static Error ReadChunk(const Path &filename, const ChunkInfo &chunk, std::vector<u8> *data);
+
+	// Compresses and writes a state from MeasureAndSavePtr. Takes ownership of buffer (malloc/free).
+	// Doesn't touch the emulator, so it's fine to call on another thread once the state is taken.
+	static Error SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz, const std::vector<SerializeCheckpoint> &sections);
+
 private:
 	struct SChunkHeader
 	{
@@ -333,6 +366,6 @@ class CChunkFileReader
 	};
 
 	static Error LoadFile(const Path &filename, std::string *gitVersion, u8 *&buffer, size_t &sz, std::string *failureReason);
-	static Error SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz);
 	static Error LoadFileHeader(File::IOFile &pFile, SChunkHeader &header, std::string *title);
+	static Error LoadChunkIndex(File::IOFile &pFile, const SChunkHeader &header, std::vector<ChunkInfo> *chunks);
 };
@@ -0,0 +1,165 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Common/Data/Format/FLACEncoder.h"
+#include "Common/Log.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Core/AudioCapture.h"
+
+AudioCapture::AudioCapture() : ring_(RING_SIZE) {}
+
+AudioCapture::~AudioCapture() {
+	Stop();
+}
+
+bool AudioCapture::Start(const Path &filename, AudioDumpFormat format, int sampleRate) {
+	_dbg_assert_(!IsRunning());
+	format_ = format;
+	sampleRate_ = sampleRate;
+
+	if (format_ == AudioDumpFormat::FLAC) {
+		flacFile_.Open(filename, "wb");
+		if (!flacFile_) {
+			ERROR_LOG(Log::IO, "The file %s could not be opened for writing.", filename.c_str());
+			return false;
+		}
+		flac_.reset(new FLACEncoder(sampleRate));
+		flacBlock_.resize(FLACEncoder::BLOCK_SIZE * 2);
+		flacBlockFrames_ = 0;
+		// A placeholder until the totals are known.
+		encoded_.clear();
+		flac_->Header(&encoded_);
+		flacFile_.WriteBytes(encoded_.data(), encoded_.size());
+	} else if (!wav_.Start(filename, sampleRate)) {
+		return false;
+	}
+
+	pendingSilence_ = 0;
+	droppedFrames_ = 0;
+	stop_ = false;
+	thread_ = std::thread(&AudioCapture::WriterThread, this);
+	return true;
+}
+
+void AudioCapture::Stop() {
+	if (!IsRunning())
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_one();
+	thread_.join();
+
+	uint64_t dropped = droppedFrames_;
+	if (dropped != 0) {
+		WARN_LOG(Log::Audio, "Audio recording couldn't keep up: %lld frames (%0.2f seconds) were replaced by silence",
+			(long long)dropped, (double)dropped / sampleRate_);
+	}
+}
+
+bool AudioCapture::PushSilence() {
+	size_t count = (size_t)std::min(pendingSilence_, (uint64_t)(ring_.WriteAvailable() / 2));
+	s16 *dest1, *dest2;
+	size_t sz1, sz2;
+	if (count != 0 && ring_.BeginWrite(count * 2, &dest1, &sz1, &dest2, &sz2)) {
+		memset(dest1, 0, sz1 * sizeof(s16));
+		if (sz2)
+			memset(dest2, 0, sz2 * sizeof(s16));
+		ring_.EndWrite(count * 2);
+		pendingSilence_ -= count;
+	}
+	return pendingSilence_ == 0;
+}
+
+void AudioCapture::Push(const s16 *samples, int frames) {
+	if (!IsRunning())
+		return;
+	// Anything owed from an earlier overflow has to go first, to keep the timing.
+	if ((pendingSilence_ != 0 && !PushSilence()) || !ring_.Push(samples, frames * 2)) {
+		pendingSilence_ += frames;
+		droppedFrames_ += frames;
+	}
+}
+
+void AudioCapture::WriteFLACBlock(int frames) {
+	encoded_.clear();
+	flac_->EncodeFrame(flacBlock_.data(), frames, &encoded_);
+	flacFile_.WriteBytes(encoded_.data(), encoded_.size());
+	flacBlockFrames_ = 0;
+}
+
+void AudioCapture::Write(const s16 *samples, int frames) {
+	if (format_ != AudioDumpFormat::FLAC) {
+		wav_.AddStereoSamples(samples, frames);
+		return;
+	}
+
+	while (frames > 0) {
+		int count = std::min(frames, (int)FLACEncoder::BLOCK_SIZE - flacBlockFrames_);
+		memcpy(&flacBlock_[flacBlockFrames_ * 2], samples, count * 2 * sizeof(s16));
+		flacBlockFrames_ += count;
+		samples += count * 2;
+		frames -= count;
+		if (flacBlockFrames_ == FLACEncoder::BLOCK_SIZE)
+			WriteFLACBlock(FLACEncoder::BLOCK_SIZE);
+	}
+}
+
+void AudioCapture::WriterThread() {
+	SetCurrentThreadName("AudioCapture");
+
+	// The producer always pushes whole frames, so reads are always even.
+	std::vector<s16> buffer(FLACEncoder::BLOCK_SIZE * 2);
+	while (true) {
+		bool stopping;
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			stopping = stop_;
+		}
+
+		// Once stop_ is seen, the producer is done, so this drains everything.
+		size_t count;
+		while ((count = ring_.Pop(buffer.data(), buffer.size())) != 0)
+			Write(buffer.data(), (int)(count / 2));
+		if (stopping)
+			break;
+
+		// Push() doesn't signal, so that it never has to make a syscall. Polling is plenty, the ring holds seconds.
+		std::unique_lock<std::mutex> guard(mutex_);
+		if (!stop_)
+			cond_.wait_for(guard, std::chrono::milliseconds(20));
+	}
+
+	if (format_ == AudioDumpFormat::FLAC) {
+		if (flacBlockFrames_ != 0)
+			WriteFLACBlock(flacBlockFrames_);
+		encoded_.clear();
+		flac_->Header(&encoded_);
+		flacFile_.Seek(0, SEEK_SET);
+		flacFile_.WriteBytes(encoded_.data(), encoded_.size());
+		flacFile_.Close();
+		flac_.reset();
+	} else {
+		wav_.Stop();
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Data/Collections/SPSCRing.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Core/ConfigValues.h"
+#include "Core/WaveFile.h"
+
+class FLACEncoder;
+
+// Records 16-bit stereo audio to disk without ever blocking the thread that produces it.
+// Push() only copies into a lock-free ring, and a background thread encodes and writes the file.
+//
+// If the writer falls so far behind that the ring fills up (a badly stalled disk), whatever doesn't
+// fit is counted as dropped, and written out as the same length of silence once there's room again,
+// so that the recording keeps its timing (and stays in sync with a video dump).
+class AudioCapture {
+public:
+	AudioCapture();
+	~AudioCapture();
+
+	bool Start(const Path &filename, AudioDumpFormat format, int sampleRate);
+	// Writes out everything pushed so far and finishes the file.
+	void Stop();
+	bool IsRunning() const { return thread_.joinable(); }
+
+	// Producer thread only, between Start() and Stop(). Never blocks.
+	void Push(const s16 *samples, int frames);
+
+	uint64_t DroppedFrames() const { return droppedFrames_; }
+
+private:
+	// About three seconds at 44.1 kHz.
+	enum { RING_SIZE = 1 << 18 };
+
+	void WriterThread();
+	void Write(const s16 *samples, int frames);
+	void WriteFLACBlock(int frames);
+	bool PushSilence();
+
+	SPSCRing<s16> ring_;
+	AudioDumpFormat format_ = AudioDumpFormat::WAV;
+	int sampleRate_ = 44100;
+
+	// Frames of silence still owed to the file, producer side only.
+	uint64_t pendingSilence_ = 0;
+	std::atomic<uint64_t> droppedFrames_{};
+
+	// Writer thread only, while it runs.
+	WaveFileWriter wav_;
+	File::IOFile flacFile_;
+	std::unique_ptr<FLACEncoder> flac_;
+	std::vector<s16> flacBlock_;
+	int flacBlockFrames_ = 0;
+	std::vector<u8> encoded_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	bool stop_ = false;
+};
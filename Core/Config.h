@@ -84,6 +84,7 @@ struct Config {
 	bool bDumpFrames;
 	bool bDumpVideoOutput;
 	bool bDumpAudio;
+	int iAudioDumpFormat;  // AudioDumpFormat
 	bool bSaveLoadResetsAVdumping;
 	bool bEnableLogging;
 	bool bDumpDecryptedEboot;
@@ -120,10 +121,13 @@ struct Config {
 	bool bDisableHTTPS;
 
 	bool bSeparateSASThread;
+	bool bSpeculativeSASMix;
+	bool bMultithreadedVideoDecode;
 	int iIOTimingMethod;
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
 	bool bCacheFullIsoInRam;
+	bool bMemoryMapIso;
 	int iRemoteISOPort;
 	std::string sLastRemoteISOServer;
 	int iLastRemoteISOPort;
@@ -230,12 +234,14 @@ struct Config {
 	int iTexScalingType; // 0 = xBRZ, 1 = Hybrid
 	bool bTexDeposterize;
 	bool bTexHardwareScaling;
+	bool bShaderDepalettize;
 	int iFpsLimit1;
 	int iFpsLimit2;
 	int iAnalogFpsLimit;
 	int iMaxRecent;
 	int iCurrentStateSlot;
 	int iRewindSnapshotInterval;
+	int iRewindMemoryBudget;  // MB, including the two full states kept besides the deltas
 	bool bUISound;
 	bool bEnableStateUndo;
 	std::string sStateLoadUndoGame;
@@ -282,6 +288,7 @@ struct Config {
 	int iAltSpeedVolume;
 	int iAchievementSoundVolume;
 	bool bExtraAudioBuffering;  // For bluetooth
+	int iAudioResampleMode;  // AudioResampleMode
 	std::string sAudioDevice;
 	bool bAutoAudioDevice;
 	bool bUseExperimentalAtrac;
@@ -190,6 +190,16 @@ enum class SkipGPUReadbackMode : int {
 	COPY_TO_TEXTURE,
 };
 
+enum class AudioResampleMode : int {
+	LINEAR = 0,
+	SINC = 1,
+};
+
+enum class AudioDumpFormat : int {
+	WAV = 0,
+	FLAC = 1,
+};
+
 enum class RemoteISOShareType : int {
 	RECENT,
 	LOCAL_FOLDER,
@@ -15,7 +15,10 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 
 #include "ppsspp_config.h"
 
@@ -36,6 +39,7 @@
 #endif
 #else
 #include <fcntl.h>
+#include <sys/mman.h>
 #endif
 
 #ifdef HAVE_LIBRETRO_VFS
@@ -124,6 +128,7 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 }
 
 LocalFileLoader::~LocalFileLoader() {
+	Unmap();
 #if defined(HAVE_LIBRETRO_VFS)
     filestream_close(handle_);
 #elif !defined(_WIN32)
@@ -179,6 +184,14 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 		return 0;
 	}
 
+	if (const u8 *mapped = mapped_.load(std::memory_order_acquire)) {
+		if (absolutePos < 0 || (u64)absolutePos >= filesize_)
+			return 0;
+		count = std::min(count, (size_t)((filesize_ - absolutePos) / bytes));
+		memcpy(data, mapped + absolutePos, bytes * count);
+		return count;
+	}
+
 #if defined(HAVE_LIBRETRO_VFS)
     std::lock_guard<std::mutex> guard(readLock_);
 	filestream_seek(handle_, absolutePos, RETRO_VFS_SEEK_POSITION_START);
@@ -217,3 +230,67 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 	return result == TRUE ? (size_t)read / bytes : -1;
 #endif
 }
+
+bool LocalFileLoader::MapIntoMemory() {
+	std::lock_guard<std::mutex> guard(mapLock_);
+	if (mapped_)
+		return true;
+	// Content URIs may be on removable storage, where a read error would be a crash.
+	if (filesize_ == 0 || filename_.Type() != PathType::NATIVE)
+		return false;
+
+	// Mapping a whole disc image needs a 64-bit address space.
+#if !PPSSPP_ARCH(64BIT) || defined(HAVE_LIBRETRO_VFS) || PPSSPP_PLATFORM(SWITCH) || PPSSPP_PLATFORM(UWP)
+	return false;
+#else
+#if !defined(_WIN32)
+	if (fd_ == -1)
+		return false;
+	void *ptr = mmap(nullptr, (size_t)filesize_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (ptr == MAP_FAILED) {
+		WARN_LOG(Log::FileSystem, "Couldn't map %s, reading normally: %s", filename_.c_str(), strerror(errno));
+		return false;
+	}
+#else
+	const u8 *ptr;
+	if (handle_ == INVALID_HANDLE_VALUE)
+		return false;
+	mappingHandle_ = CreateFileMapping(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle_) {
+		WARN_LOG(Log::FileSystem, "Couldn't map %s, reading normally: %08x", filename_.c_str(), (uint32_t)GetLastError());
+		return false;
+	}
+	ptr = (const u8 *)MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0);
+	if (!ptr) {
+		WARN_LOG(Log::FileSystem, "Couldn't map %s, reading normally: %08x", filename_.c_str(), (uint32_t)GetLastError());
+		CloseHandle(mappingHandle_);
+		mappingHandle_ = 0;
+		return false;
+	}
+#endif
+	mapped_.store((const u8 *)ptr, std::memory_order_release);
+	INFO_LOG(Log::FileSystem, "Mapped %s (%lld bytes)", filename_.c_str(), (long long)filesize_);
+	return true;
+#endif
+}
+
+const u8 *LocalFileLoader::DataPointer(s64 absolutePos, size_t bytes) {
+	const u8 *mapped = mapped_.load(std::memory_order_acquire);
+	if (!mapped || absolutePos < 0 || (u64)absolutePos > filesize_ || bytes > filesize_ - absolutePos)
+		return nullptr;
+	return mapped + absolutePos;
+}
+
+void LocalFileLoader::Unmap() {
+	const u8 *mapped = mapped_.exchange(nullptr);
+	if (!mapped)
+		return;
+#if !PPSSPP_ARCH(64BIT) || defined(HAVE_LIBRETRO_VFS) || PPSSPP_PLATFORM(SWITCH) || PPSSPP_PLATFORM(UWP)
+#elif !defined(_WIN32)
+	munmap((void *)mapped, (size_t)filesize_);
+#else
+	UnmapViewOfFile(mapped);
+	CloseHandle(mappingHandle_);
+	mappingHandle_ = 0;
+#endif
+}
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 
 #include "Common/CommonTypes.h"
@@ -45,13 +46,24 @@ class LocalFileLoader : public FileLoader {
 	}
 	size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
 
+	bool MapIntoMemory() override;
+	const u8 *DataPointer(s64 absolutePos, size_t bytes) override;
+
 private:
+	void Unmap();
+
 #if !defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
 	void DetectSizeFd();
 	int fd_ = -1;
 #else
 	HANDLE handle_ = 0;
 #endif
+#if defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
+	HANDLE mappingHandle_ = 0;
+#endif
+	// The whole file, after MapIntoMemory(). Never changes after that.
+	std::atomic<const u8 *> mapped_{};
+	std::mutex mapLock_;
 	u64 filesize_ = 0;
 	Path filename_;
 	std::mutex readLock_;
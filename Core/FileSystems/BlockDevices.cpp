@@ -15,10 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
+#include <functional>
 
+#include "Common/Data/Encoding/LZ4.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/File/FileUtil.h"
 #include "Common/System/OSD.h"
@@ -26,6 +29,8 @@
 #include "Common/Swap.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Loaders.h"
 #include "Core/FileSystems/BlockDevices.h"
 #include "libchdr/chd.h"
@@ -56,6 +61,8 @@ BlockDevice *constructBlockDevice(FileLoader *fileLoader) {
 	// Check for CISO
 	if (!memcmp(buffer, "CISO", 4)) {
 		return new CISOFileBlockDevice(fileLoader);
+	} else if (!memcmp(buffer, "ZISO", 4)) {
+		return new ZSOFileBlockDevice(fileLoader);
 	} else if (!memcmp(buffer, "\x00PBP", 4)) {
 		uint32_t psarOffset = 0;
 		size = fileLoader->ReadAt(0x24, 1, 4, &psarOffset);
@@ -77,6 +84,27 @@ void BlockDevice::NotifyReadError() {
 	}
 }
 
+void BlockDevice::PrefetchFileRange(u64 start, u64 end) {
+	// In pieces, so a foreground read never waits long behind it.
+	const size_t chunkSize = 128 * 1024;
+	std::vector<u8> buffer(chunkSize);
+	for (u64 pos = start; pos < end; pos += chunkSize) {
+		if (fileLoader_->ReadAt(pos, 1, (size_t)std::min((u64)chunkSize, end - pos), buffer.data()) == 0)
+			break;
+	}
+}
+
+// The file range holding the frames of the blocks [minBlock, minBlock + count), for CSO and ZSO.
+static bool FramesFileRange(const u32 *index, u32 numFrames, u8 indexShift, u8 blockShift, u32 minBlock, u32 count, u64 *start, u64 *end) {
+	const u32 firstFrame = minBlock >> blockShift;
+	const u32 endFrame = std::min((u32)(((u64)minBlock + count + (1 << blockShift) - 1) >> blockShift), numFrames);
+	if (count == 0 || firstFrame >= endFrame)
+		return false;
+	*start = (u64)(index[firstFrame] & 0x7FFFFFFF) << indexShift;
+	*end = (u64)(index[endFrame] & 0x7FFFFFFF) << indexShift;
+	return *end > *start;
+}
+
 FileBlockDevice::FileBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader) {
 	filesize_ = fileLoader->FileSize();
@@ -96,6 +124,20 @@ bool FileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
 	return true;
 }
 
+bool FileBlockDevice::Prefetch(u32 minBlock, u32 count) {
+	const u64 start = (u64)minBlock * GetBlockSize();
+	const u64 end = std::min(start + (u64)count * GetBlockSize(), filesize_);
+	if (start < end)
+		PrefetchFileRange(start, end);
+	return true;
+}
+
+const u8 *FileBlockDevice::DataPointer(u64 pos, u64 size) const {
+	if (pos + size > filesize_)
+		return nullptr;
+	return fileLoader_->DataPointer((s64)pos, (size_t)size);
+}
+
 bool FileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	size_t retval = fileLoader_->ReadAt((u64)minBlock * (u64)GetBlockSize(), 2048, count, outPtr);
 	if (retval != (size_t)count) {
@@ -135,6 +177,146 @@ typedef struct ciso_header
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
 
+// The index after the header, shared by CSO and ZSO. Entry i is where frame i starts (shifted by align),
+// with the top bit set if it's stored uncompressed, and there's one extra entry for the end of the last frame.
+static bool ReadFrameIndex(FileLoader *fileLoader, size_t offset, u32 *index, u32 indexSize) {
+#if COMMON_LITTLE_ENDIAN
+	if (fileLoader->ReadAt(offset, sizeof(u32), indexSize, index) != indexSize) {
+		memset(index, 0, indexSize * sizeof(u32));
+		return false;
+	}
+	return true;
+#else
+	u32_le *indexTemp = new u32_le[indexSize];
+
+	bool success = fileLoader->ReadAt(offset, sizeof(u32), indexSize, indexTemp) == indexSize;
+	if (!success)
+		memset(indexTemp, 0, indexSize * sizeof(u32_le));
+
+	for (u32 i = 0; i < indexSize; i++)
+		index[i] = indexTemp[i];
+
+	delete[] indexTemp;
+	return success;
+#endif
+}
+
+// How many recently decompressed frames or hunks each device keeps.
+static const int FRAME_CACHE_SIZE = 8;
+// Below this many bytes of output, it's not worth handing deflate (CSO) frames to other threads.
+static const u32 PARALLEL_MIN_BYTES = 32 * 1024;
+
+static const u32 NO_FRAME = 0xFFFFFFFF;
+
+void DecompressedFrameCache::Init(u32 frameSize, int count) {
+	frameSize_ = frameSize;
+	slots_.assign(count, Slot{ NO_FRAME, 0 });
+	data_.resize((size_t)frameSize * count);
+}
+
+const u8 *DecompressedFrameCache::Find(u32 frame) {
+	for (size_t i = 0; i < slots_.size(); i++) {
+		if (slots_[i].frame == frame) {
+			slots_[i].lastUsed = ++useCounter_;
+			return &data_[i * frameSize_];
+		}
+	}
+	return nullptr;
+}
+
+u8 *DecompressedFrameCache::Reserve(u32 frame) {
+	size_t best = 0;
+	for (size_t i = 0; i < slots_.size(); i++) {
+		if (slots_[i].frame == frame) {
+			best = i;
+			break;
+		}
+		if (slots_[i].lastUsed < slots_[best].lastUsed)
+			best = i;
+	}
+	slots_[best].frame = frame;
+	slots_[best].lastUsed = ++useCounter_;
+	return &data_[best * frameSize_];
+}
+
+void DecompressedFrameCache::Invalidate(u32 frame) {
+	for (Slot &slot : slots_) {
+		if (slot.frame == frame) {
+			slot.frame = NO_FRAME;
+			slot.lastUsed = 0;
+		}
+	}
+}
+
+// One frame (or CHD hunk) of a multi-block read, for a worker to decompress.
+struct FrameDecodeJob {
+	u32 frame;
+	u32 blockOffset;
+	u32 blocks;
+	u8 *outPtr;
+	// Set if only part of the frame is wanted. The whole frame goes here (a cache slot), then the part is copied out.
+	u8 *frameBuffer;
+	bool failed;
+};
+
+// unitBytes is how far apart the blocks are in a decompressed frame, only CHD has it differ from the block size.
+static void CopyFrameBlocks(const u8 *frameData, u32 blockOffset, u32 blocks, u32 unitBytes, u8 *outPtr) {
+	const u32 blockSize = 2048;
+	if (unitBytes == blockSize) {
+		memcpy(outPtr, frameData + blockOffset * blockSize, blocks * blockSize);
+		return;
+	}
+	for (u32 i = 0; i < blocks; i++)
+		memcpy(outPtr + i * blockSize, frameData + (blockOffset + i) * unitBytes, blockSize);
+}
+
+// Splits the blocks [minBlock, lastBlock] into frames. The cached ones are copied right away, the rest become jobs.
+// needsFrameBuffer(frame) says if a partly wanted frame has to be decompressed whole (not if it's stored plain).
+template <typename F>
+static void PlanFrameJobs(u32 minBlock, u32 lastBlock, u32 blocksPerFrame, u32 unitBytes, u8 *outPtr, DecompressedFrameCache *cache, std::vector<FrameDecodeJob> *jobs, F needsFrameBuffer) {
+	const u32 blockSize = 2048;
+	for (u32 frame = minBlock / blocksPerFrame; frame <= lastBlock / blocksPerFrame; frame++) {
+		const u32 firstBlock = std::max(minBlock, frame * blocksPerFrame);
+		const u32 endBlock = std::min(lastBlock + 1, (frame + 1) * blocksPerFrame);
+		FrameDecodeJob job{ frame, firstBlock - frame * blocksPerFrame, endBlock - firstBlock, outPtr + (firstBlock - minBlock) * blockSize, nullptr, false };
+		if (const u8 *cached = cache->Find(frame)) {
+			CopyFrameBlocks(cached, job.blockOffset, job.blocks, unitBytes, job.outPtr);
+			continue;
+		}
+		// At most the first and last frame, so they can't push each other out of the cache.
+		if (job.blocks != blocksPerFrame && needsFrameBuffer(frame))
+			job.frameBuffer = cache->Reserve(frame);
+		jobs->push_back(job);
+	}
+}
+
+static bool ShouldDecodeInParallel(int count, int minPerTask) {
+	return count > minPerTask && g_threadManager.IsInitialized();
+}
+
+// Once their data is in memory, frames can be decompressed in any order, so spread them over the workers.
+// Unless there are too few to be worth it.
+static void DecodeFramesInParallel(int count, int minPerTask, const std::function<void(int, int)> &decode) {
+	if (ShouldDecodeInParallel(count, minPerTask)) {
+		ParallelRangeLoop(&g_threadManager, decode, 0, count, minPerTask);
+	} else {
+		decode(0, count);
+	}
+}
+
+// After the workers are done. Frames that failed are dropped from the cache.
+static bool FinishFrameJobs(const std::vector<FrameDecodeJob> &jobs, DecompressedFrameCache *cache) {
+	bool success = true;
+	for (const FrameDecodeJob &job : jobs) {
+		if (job.failed) {
+			success = false;
+			if (job.frameBuffer)
+				cache->Invalidate(job.frame);
+		}
+	}
+	return success;
+}
+
 CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader)
 {
@@ -161,42 +343,21 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 		++blockShift;
 
 	indexShift = hdr.align;
-	const u64 totalSize = hdr.total_bytes;
-	numFrames = (u32)((totalSize + frameSize - 1) / frameSize);
-	numBlocks = (u32)(totalSize / GetBlockSize());
+	totalBytes = hdr.total_bytes;
+	numFrames = (u32)((totalBytes + frameSize - 1) / frameSize);
+	numBlocks = (u32)(totalBytes / GetBlockSize());
 	VERBOSE_LOG(Log::Loader, "CSO numBlocks=%i numFrames=%i align=%i", numBlocks, numFrames, indexShift);
 
 	// We might read a bit of alignment too, so be prepared.
-	if (frameSize + (1 << indexShift) < CSO_READ_BUFFER_SIZE)
-		readBuffer = new u8[CSO_READ_BUFFER_SIZE];
-	else
-		readBuffer = new u8[frameSize + (1 << indexShift)];
-	zlibBuffer = new u8[frameSize + (1 << indexShift)];
-	zlibBufferFrame = numFrames;
+	readBuffer.resize(std::max(CSO_READ_BUFFER_SIZE, frameSize + (1 << indexShift)));
+	cache.Init(frameSize, FRAME_CACHE_SIZE);
 
 	const u32 indexSize = numFrames + 1;
 	const size_t headerEnd = hdr.ver > 1 ? (size_t)hdr.header_size : sizeof(hdr);
 
-#if COMMON_LITTLE_ENDIAN
-	index = new u32[indexSize];
-	if (fileLoader->ReadAt(headerEnd, sizeof(u32), indexSize, index) != indexSize) {
-		NotifyReadError();
-		memset(index, 0, indexSize * sizeof(u32));
-	}
-#else
 	index = new u32[indexSize];
-	u32_le *indexTemp = new u32_le[indexSize];
-
-	if (fileLoader->ReadAt(headerEnd, sizeof(u32), indexSize, indexTemp) != indexSize) {
+	if (!ReadFrameIndex(fileLoader, headerEnd, index, indexSize))
 		NotifyReadError();
-		memset(indexTemp, 0, indexSize * sizeof(u32_le));
-	}
-
-	for (u32 i = 0; i < indexSize; i++)
-		index[i] = indexTemp[i];
-
-	delete[] indexTemp;
-#endif
 
 	ver_ = hdr.ver;
 
@@ -214,8 +375,46 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 CISOFileBlockDevice::~CISOFileBlockDevice()
 {
 	delete [] index;
-	delete [] readBuffer;
-	delete [] zlibBuffer;
+}
+
+bool CISOFileBlockDevice::Prefetch(u32 minBlock, u32 count) {
+	u64 start, end;
+	if (FramesFileRange(index, numFrames, indexShift, blockShift, minBlock, count, &start, &end))
+		PrefetchFileRange(start, end);
+	return true;
+}
+
+bool CISOFileBlockDevice::IsPlainFrame(u32 frame, u32 compressedSize) const {
+	if (ver_ >= 2) {
+		// CSO v2+ requires blocks be uncompressed if large enough to be.  High bit means other things.
+		return compressedSize >= frameSize;
+	}
+	return (index[frame] & 0x80000000) != 0;
+}
+
+// The last frame may be short.
+u32 CISOFileBlockDevice::FrameBytes(u32 frame) const {
+	return (u32)std::min((u64)frameSize, totalBytes - (u64)frame * frameSize);
+}
+
+// z must be set up for raw deflate, it's reset for the next frame afterwards.
+static bool InflateFrame(z_stream &z, u32 frame, const u8 *src, u32 srcSize, u8 *outPtr, u32 frameBytes) {
+	z.next_in = (Bytef *)src;
+	z.avail_in = srcSize;
+	z.next_out = outPtr;
+	z.avail_out = frameBytes;
+
+	bool success = true;
+	int status = inflate(&z, Z_FINISH);
+	if (status != Z_STREAM_END) {
+		ERROR_LOG(Log::Loader, "Inflate frame %d: failed - %s[%d]\n", frame, (z.msg) ? z.msg : "error", status);
+		success = false;
+	} else if (z.total_out != frameBytes) {
+		ERROR_LOG(Log::Loader, "Inflate frame %d: block size error %d != %d\n", frame, (u32)z.total_out, frameBytes);
+		success = false;
+	}
+	inflateReset(&z);
+	return success;
 }
 
 bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
@@ -227,66 +426,58 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	}
 
 	const u32 frameNumber = blockNumber >> blockShift;
+	const u32 compressedOffset = (blockNumber & ((1 << blockShift) - 1)) * GetBlockSize();
+	if (const u8 *cached = cache.Find(frameNumber)) {
+		// We already have it.  Just apply the offset and copy.
+		memcpy(outPtr, cached + compressedOffset, GetBlockSize());
+		return true;
+	}
+
 	const u32 idx = index[frameNumber];
 	const u32 indexPos = idx & 0x7FFFFFFF;
 	const u32 nextIndexPos = index[frameNumber + 1] & 0x7FFFFFFF;
-	z_stream z{};
 
 	const u64 compressedReadPos = (u64)indexPos << indexShift;
 	const u64 compressedReadEnd = (u64)nextIndexPos << indexShift;
 	const size_t compressedReadSize = (size_t)(compressedReadEnd - compressedReadPos);
-	const u32 compressedOffset = (blockNumber & ((1 << blockShift) - 1)) * GetBlockSize();
 
-	bool plain = (idx & 0x80000000) != 0;
-	if (ver_ >= 2) {
-		// CSO v2+ requires blocks be uncompressed if large enough to be.  High bit means other things.
-		plain = compressedReadSize >= frameSize;
-	}
-	if (plain) {
+	if (IsPlainFrame(frameNumber, (u32)compressedReadSize)) {
 		int readSize = (u32)fileLoader_->ReadAt(compressedReadPos + compressedOffset, 1, GetBlockSize(), outPtr, flags);
 		if (readSize < GetBlockSize())
 			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
-	} else if (zlibBufferFrame == frameNumber) {
-		// We already have it.  Just apply the offset and copy.
-		memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
-	} else {
-		const u32 readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer, flags);
+		return true;
+	}
 
-		z.zalloc = Z_NULL;
-		z.zfree = Z_NULL;
-		z.opaque = Z_NULL;
-		if (inflateInit2(&z, -15) != Z_OK) {
-			ERROR_LOG(Log::Loader, "GetBlockSize() ERROR: %s\n", (z.msg) ? z.msg : "?");
-			NotifyReadError();
-			return false;
-		}
-		z.avail_in = readSize;
-		z.next_out = frameSize == (u32)GetBlockSize() ? outPtr : zlibBuffer;
-		z.avail_out = frameSize;
-		z.next_in = readBuffer;
-
-		int status = inflate(&z, Z_FINISH);
-		if (status != Z_STREAM_END) {
-			ERROR_LOG(Log::Loader, "block %d: inflate : %s[%d]\n", blockNumber, (z.msg) ? z.msg : "error", status);
-			NotifyReadError();
-			inflateEnd(&z);
-			memset(outPtr, 0, GetBlockSize());
-			return false;
-		}
-		if (z.total_out != frameSize) {
-			ERROR_LOG(Log::Loader, "block %d: block size error %d != %d\n", blockNumber, (u32)z.total_out, frameSize);
-			NotifyReadError();
-			inflateEnd(&z);
-			memset(outPtr, 0, GetBlockSize());
-			return false;
-		}
-		inflateEnd(&z);
+	if (compressedReadEnd < compressedReadPos || compressedReadSize > (size_t)frameSize * 2 + (1 << indexShift)) {
+		ERROR_LOG(Log::Loader, "block %d: bad index (%lld - %lld)\n", blockNumber, compressedReadPos, compressedReadEnd);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize());
+		return false;
+	}
+	readBuffer.resize(std::max(readBuffer.size(), compressedReadSize));
+	const u32 readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer.data(), flags);
 
-		if (frameSize != (u32)GetBlockSize()) {
-			zlibBufferFrame = frameNumber;
-			memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
-		}
+	z_stream z{};
+	if (inflateInit2(&z, -15) != Z_OK) {
+		ERROR_LOG(Log::Loader, "GetBlockSize() ERROR: %s\n", (z.msg) ? z.msg : "?");
+		NotifyReadError();
+		return false;
+	}
+
+	// With larger frames, decompress the whole thing into the cache, the next block is probably in it too.
+	u8 *frameBuffer = frameSize == (u32)GetBlockSize() ? outPtr : cache.Reserve(frameNumber);
+	bool success = InflateFrame(z, frameNumber, readBuffer.data(), readSize, frameBuffer, FrameBytes(frameNumber));
+	inflateEnd(&z);
+	if (!success) {
+		if (frameBuffer != outPtr)
+			cache.Invalidate(frameNumber);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize());
+		return false;
 	}
+
+	if (frameBuffer != outPtr)
+		memcpy(outPtr, frameBuffer + compressedOffset, GetBlockSize());
 	return true;
 }
 
@@ -300,83 +491,281 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	}
 
 	const u32 lastBlock = std::min(minBlock + count, numBlocks) - 1;
-	const u32 missingBlocks = (lastBlock + 1 - minBlock) - count;
-	if (lastBlock < minBlock + count) {
+	const u32 missingBlocks = count - (lastBlock + 1 - minBlock);
+	if (missingBlocks != 0) {
 		memset(outPtr + GetBlockSize() * (count - missingBlocks), 0, GetBlockSize() * missingBlocks);
 	}
 
 	const u32 minFrameNumber = minBlock >> blockShift;
 	const u32 lastFrameNumber = lastBlock >> blockShift;
-	const u32 afterLastIndexPos = index[lastFrameNumber + 1] & 0x7FFFFFFF;
-	const u64 totalReadEnd = (u64)afterLastIndexPos << indexShift;
-
-	z_stream z{};
-	if (inflateInit2(&z, -15) != Z_OK) {
-		ERROR_LOG(Log::Loader, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
+	const u32 frames = lastFrameNumber + 1 - minFrameNumber;
+	const u64 totalReadStart = (u64)(index[minFrameNumber] & 0x7FFFFFFF) << indexShift;
+	const u64 totalReadEnd = (u64)(index[lastFrameNumber + 1] & 0x7FFFFFFF) << indexShift;
+	if (totalReadEnd < totalReadStart || totalReadEnd - totalReadStart > (u64)frames * (frameSize * 2 + (1 << indexShift))) {
+		ERROR_LOG(Log::Loader, "Frames %d-%d: bad index (%lld - %lld)\n", minFrameNumber, lastFrameNumber, totalReadStart, totalReadEnd);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize() * (count - missingBlocks));
 		return false;
 	}
 
-	u64 readBufferStart = 0;
-	u64 readBufferEnd = 0;
-	u32 block = minBlock;
-	const u32 blocksPerFrame = 1 << blockShift;
-	for (u32 frame = minFrameNumber; frame <= lastFrameNumber; ++frame) {
-		const u32 idx = index[frame];
-		const u32 indexPos = idx & 0x7FFFFFFF;
-		const u32 nextIndexPos = index[frame + 1] & 0x7FFFFFFF;
-
-		const u64 frameReadPos = (u64)indexPos << indexShift;
-		const u64 frameReadEnd = (u64)nextIndexPos << indexShift;
-		const u32 frameReadSize = (u32)(frameReadEnd - frameReadPos);
-		const u32 frameBlockOffset = block & ((1 << blockShift) - 1);
-		const u32 frameBlocks = std::min(lastBlock - block + 1, blocksPerFrame - frameBlockOffset);
-
-		if (frameReadEnd > readBufferEnd) {
-			const s64 maxNeeded = totalReadEnd - frameReadPos;
-			const size_t chunkSize = (size_t)std::min(maxNeeded, (s64)std::max(frameReadSize, CSO_READ_BUFFER_SIZE));
-
-			const u32 readSize = (u32)fileLoader_->ReadAt(frameReadPos, 1, chunkSize, readBuffer);
-			if (readSize < chunkSize) {
-				memset(readBuffer + readSize, 0, chunkSize - readSize);
+	// Fetch the whole compressed extent in one go.
+	const size_t totalReadSize = (size_t)(totalReadEnd - totalReadStart);
+	readBuffer.resize(std::max(readBuffer.size(), totalReadSize));
+	const size_t readSize = fileLoader_->ReadAt(totalReadStart, 1, totalReadSize, readBuffer.data());
+	if (readSize < totalReadSize) {
+		memset(readBuffer.data() + readSize, 0, totalReadSize - readSize);
+	}
+
+	std::vector<FrameDecodeJob> jobs;
+	PlanFrameJobs(minBlock, lastBlock, 1 << blockShift, GetBlockSize(), outPtr, &cache, &jobs, [&](u32 frame) {
+		const u64 pos = (u64)(index[frame] & 0x7FFFFFFF) << indexShift;
+		const u64 end = (u64)(index[frame + 1] & 0x7FFFFFFF) << indexShift;
+		return !IsPlainFrame(frame, (u32)(end - pos));
+	});
+
+	DecodeFramesInParallel((int)jobs.size(), std::max(1, (int)(PARALLEL_MIN_BYTES / frameSize)), [&](int lower, int upper) {
+		z_stream z{};
+		const bool initialized = inflateInit2(&z, -15) == Z_OK;
+		for (int i = lower; i < upper; i++) {
+			FrameDecodeJob &job = jobs[i];
+			const u64 framePos = (u64)(index[job.frame] & 0x7FFFFFFF) << indexShift;
+			const u64 frameEnd = (u64)(index[job.frame + 1] & 0x7FFFFFFF) << indexShift;
+			const u32 needed = job.blocks * GetBlockSize();
+			if (!initialized || framePos < totalReadStart || frameEnd < framePos || frameEnd > totalReadEnd) {
+				job.failed = true;
+				memset(job.outPtr, 0, needed);
+				continue;
 			}
 
-			readBufferStart = frameReadPos;
-			readBufferEnd = frameReadPos + readSize;
+			const u8 *src = &readBuffer[framePos - totalReadStart];
+			const u32 srcSize = (u32)(frameEnd - framePos);
+			const u32 start = job.blockOffset * GetBlockSize();
+			if (IsPlainFrame(job.frame, srcSize)) {
+				const u32 available = srcSize > start ? std::min(srcSize - start, needed) : 0;
+				memcpy(job.outPtr, src + start, available);
+				memset(job.outPtr + available, 0, needed - available);
+			} else if (!InflateFrame(z, job.frame, src, srcSize, job.frameBuffer ? job.frameBuffer : job.outPtr, FrameBytes(job.frame))) {
+				job.failed = true;
+				memset(job.outPtr, 0, needed);
+			} else if (job.frameBuffer) {
+				memcpy(job.outPtr, job.frameBuffer + start, needed);
+			}
 		}
+		if (initialized)
+			inflateEnd(&z);
+	});
 
-		u8 *rawBuffer = &readBuffer[frameReadPos - readBufferStart];
-		const int plain = idx & 0x80000000;
-		if (plain) {
-			memcpy(outPtr, rawBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
-		} else {
-			z.avail_in = frameReadSize;
-			z.next_out = frameBlocks == blocksPerFrame ? outPtr : zlibBuffer;
-			z.avail_out = frameSize;
-			z.next_in = rawBuffer;
-
-			int status = inflate(&z, Z_FINISH);
-			if (status != Z_STREAM_END) {
-				ERROR_LOG(Log::Loader, "Inflate frame %d: failed - %s[%d]\n", frame, (z.msg) ? z.msg : "error", status);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (z.total_out != frameSize) {
-				ERROR_LOG(Log::Loader, "Inflate frame %d: block size error %d != %d\n", frame, (u32)z.total_out, frameSize);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (frameBlocks != blocksPerFrame) {
-				memcpy(outPtr, zlibBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
-				// In case we end up reusing it in a single read later.
-				zlibBufferFrame = frame;
-			}
+	if (!FinishFrameJobs(jobs, &cache)) {
+		NotifyReadError();
+		return false;
+	}
+	return true;
+}
 
-			inflateReset(&z);
-		}
+// .ZSO format
+
+// LZ4 decodes several times faster than deflate (a frame takes a microsecond or two), so a task needs
+// more output than with CSO before it's worth handing to another thread.
+static const u32 ZSO_PARALLEL_MIN_BYTES = 2 * PARALLEL_MIN_BYTES;
+
+ZSOFileBlockDevice::ZSOFileBlockDevice(FileLoader *fileLoader)
+	: BlockDevice(fileLoader)
+{
+	// Same header as CSO v1, just a different magic.
+	CISO_H hdr;
+	size_t readSize = fileLoader->ReadAt(0, sizeof(CISO_H), 1, &hdr);
+	if (readSize != 1 || memcmp(hdr.magic, "ZISO", 4) != 0) {
+		WARN_LOG(Log::Loader, "Invalid ZSO!");
+	}
+	if (hdr.ver > 1) {
+		WARN_LOG(Log::Loader, "ZSO version too high!");
+	}
 
-		block += frameBlocks;
-		outPtr += frameBlocks * GetBlockSize();
+	frameSize = hdr.block_size;
+	if ((frameSize & (frameSize - 1)) != 0 || frameSize < 0x800) {
+		ERROR_LOG(Log::Loader, "ZSO block size %i unsupported, must be a power of two and at least one sector", frameSize);
+		NotifyReadError();
+		// Leave it empty, every read will fail.
+		frameSize = 0x800;
+		index = new u32[1]{};
+		return;
 	}
 
-	inflateEnd(&z);
+	blockShift = 0;
+	for (u32 i = frameSize; i > 0x800; i >>= 1)
+		++blockShift;
+
+	indexShift = hdr.align;
+	totalBytes = hdr.total_bytes;
+	numFrames = (u32)((totalBytes + frameSize - 1) / frameSize);
+	numBlocks = (u32)(totalBytes / GetBlockSize());
+	VERBOSE_LOG(Log::Loader, "ZSO numBlocks=%i numFrames=%i align=%i", numBlocks, numFrames, indexShift);
+
+	cache.Init(frameSize, FRAME_CACHE_SIZE);
+
+	const u32 indexSize = numFrames + 1;
+	index = new u32[indexSize];
+	if (!ReadFrameIndex(fileLoader, sizeof(hdr), index, indexSize))
+		NotifyReadError();
+
+	u64 fileSize = fileLoader->FileSize();
+	u64 expectedFileSize = (u64)(index[indexSize - 1] & 0x7FFFFFFF) << indexShift;
+	if (expectedFileSize > fileSize) {
+		ERROR_LOG(Log::Loader, "Expected ZSO to at least be %lld bytes, but file is %lld bytes. File: '%s'",
+			expectedFileSize, fileSize, fileLoader->GetPath().c_str());
+		NotifyReadError();
+	}
+}
+
+ZSOFileBlockDevice::~ZSOFileBlockDevice() {
+	delete [] index;
+}
+
+bool ZSOFileBlockDevice::Prefetch(u32 minBlock, u32 count) {
+	u64 start, end;
+	if (FramesFileRange(index, numFrames, indexShift, blockShift, minBlock, count, &start, &end))
+		PrefetchFileRange(start, end);
+	return true;
+}
+
+// Writes the blocks [blockOffset, blockOffset + blocks) of the frame to outPtr, given its data from the file.
+// If frameBuffer is set, the whole frame is decompressed into it first.
+// Only reads member state that never changes after construction, so workers can call it at the same time.
+bool ZSOFileBlockDevice::DecodeFrame(u32 frame, const u8 *src, u32 srcSize, u32 blockOffset, u32 blocks, u8 *outPtr, u8 *frameBuffer) const {
+	const u32 start = blockOffset * GetBlockSize();
+	const u32 needed = blocks * GetBlockSize();
+
+	if (index[frame] & 0x80000000) {
+		const u32 available = srcSize > start ? std::min(srcSize - start, needed) : 0;
+		memcpy(outPtr, src + start, available);
+		memset(outPtr + available, 0, needed - available);
+		return available == needed;
+	}
+
+	// The last frame may be short. Asking for exactly the frame's size also skips the alignment padding.
+	const u32 frameBytes = (u32)std::min((u64)frameSize, totalBytes - (u64)frame * frameSize);
+	int decoded;
+	if (!frameBuffer) {
+		_dbg_assert_(start == 0 && needed == frameBytes);
+		decoded = LZ4DecompressBlock(src, srcSize, outPtr, frameBytes);
+	} else {
+		decoded = LZ4DecompressBlock(src, srcSize, frameBuffer, frameBytes);
+		if (decoded >= (int)(start + needed))
+			memcpy(outPtr, frameBuffer + start, needed);
+	}
+	if (decoded < (int)(start + needed)) {
+		ERROR_LOG(Log::Loader, "ZSO frame %d: LZ4 decompression failed (%d)", frame, decoded);
+		memset(outPtr, 0, needed);
+		return false;
+	}
+	return true;
+}
+
+bool ZSOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
+	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
+	if ((u32)blockNumber >= numBlocks) {
+		memset(outPtr, 0, GetBlockSize());
+		return false;
+	}
+
+	const u32 frameNumber = blockNumber >> blockShift;
+	const u32 blockOffset = blockNumber & ((1 << blockShift) - 1);
+	if (const u8 *cached = cache.Find(frameNumber)) {
+		// We already have it.  Just apply the offset and copy.
+		memcpy(outPtr, cached + blockOffset * GetBlockSize(), GetBlockSize());
+		return true;
+	}
+
+	const u32 idx = index[frameNumber];
+	const u64 readPos = (u64)(idx & 0x7FFFFFFF) << indexShift;
+	const u64 readEnd = (u64)(index[frameNumber + 1] & 0x7FFFFFFF) << indexShift;
+	if (idx & 0x80000000) {
+		size_t readSize = fileLoader_->ReadAt(readPos + blockOffset * GetBlockSize(), 1, GetBlockSize(), outPtr, flags);
+		if (readSize < (size_t)GetBlockSize())
+			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
+		return true;
+	}
+
+	// A compressed frame can't be larger than the data, or it would have been stored plain.
+	if (readEnd < readPos || readEnd - readPos > frameSize + (1 << indexShift)) {
+		ERROR_LOG(Log::Loader, "ZSO frame %d: bad index (%lld - %lld)", frameNumber, readPos, readEnd);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize());
+		return false;
+	}
+
+	readBuffer.resize(std::max(readBuffer.size(), (size_t)(readEnd - readPos)));
+	const u32 readSize = (u32)fileLoader_->ReadAt(readPos, 1, (size_t)(readEnd - readPos), readBuffer.data(), flags);
+	// With larger frames, decompress the whole thing into the cache, the next block is probably in it too.
+	u8 *frameBuffer = frameSize != (u32)GetBlockSize() ? cache.Reserve(frameNumber) : nullptr;
+	if (!DecodeFrame(frameNumber, readBuffer.data(), readSize, blockOffset, 1, outPtr, frameBuffer)) {
+		if (frameBuffer)
+			cache.Invalidate(frameNumber);
+		NotifyReadError();
+		return false;
+	}
+	return true;
+}
+
+bool ZSOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	if (count == 1) {
+		return ReadBlock(minBlock, outPtr);
+	}
+	if (minBlock >= numBlocks) {
+		memset(outPtr, 0, GetBlockSize() * count);
+		return false;
+	}
+
+	const u32 lastBlock = std::min(minBlock + count, numBlocks) - 1;
+	const u32 validBlocks = lastBlock + 1 - minBlock;
+	if (validBlocks < (u32)count) {
+		memset(outPtr + GetBlockSize() * validBlocks, 0, GetBlockSize() * (count - validBlocks));
+	}
+
+	const u32 minFrame = minBlock >> blockShift;
+	const u32 lastFrame = lastBlock >> blockShift;
+	const u32 frames = lastFrame + 1 - minFrame;
+	const u64 readStart = (u64)(index[minFrame] & 0x7FFFFFFF) << indexShift;
+	const u64 readEnd = (u64)(index[lastFrame + 1] & 0x7FFFFFFF) << indexShift;
+	if (readEnd < readStart || readEnd - readStart > (u64)frames * (frameSize + (1 << indexShift))) {
+		ERROR_LOG(Log::Loader, "ZSO frames %d-%d: bad index (%lld - %lld)", minFrame, lastFrame, readStart, readEnd);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize() * validBlocks);
+		return false;
+	}
+
+	// One read for the whole run, then the frames are independent and can be decompressed in any order.
+	const size_t readSize = (size_t)(readEnd - readStart);
+	readBuffer.resize(std::max(readBuffer.size(), readSize));
+	const size_t got = fileLoader_->ReadAt(readStart, 1, readSize, readBuffer.data());
+	if (got < readSize) {
+		memset(readBuffer.data() + got, 0, readSize - got);
+	}
+
+	std::vector<FrameDecodeJob> jobs;
+	PlanFrameJobs(minBlock, lastBlock, 1 << blockShift, GetBlockSize(), outPtr, &cache, &jobs, [&](u32 frame) {
+		return (index[frame] & 0x80000000) == 0;
+	});
+
+	DecodeFramesInParallel((int)jobs.size(), std::max(1, (int)(ZSO_PARALLEL_MIN_BYTES / frameSize)), [&](int lower, int upper) {
+		for (int i = lower; i < upper; i++) {
+			FrameDecodeJob &job = jobs[i];
+			const u64 framePos = (u64)(index[job.frame] & 0x7FFFFFFF) << indexShift;
+			const u64 frameEnd = (u64)(index[job.frame + 1] & 0x7FFFFFFF) << indexShift;
+			if (framePos < readStart || frameEnd < framePos || frameEnd > readEnd) {
+				memset(job.outPtr, 0, job.blocks * GetBlockSize());
+				job.failed = true;
+				continue;
+			}
+			if (!DecodeFrame(job.frame, &readBuffer[framePos - readStart], (u32)(frameEnd - framePos), job.blockOffset, job.blocks, job.outPtr, job.frameBuffer))
+				job.failed = true;
+		}
+	});
+
+	if (!FinishFrameJobs(jobs, &cache)) {
+		NotifyReadError();
+		return false;
+	}
 	return true;
 }
 
@@ -555,19 +944,14 @@ struct ExtendedCoreFile {
 	uint64_t seekPos;
 };
 
-CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
-	: BlockDevice(fileLoader), impl_(new CHDImpl()) {
-	Path paths[8];
-	paths[0] = fileLoader->GetPath();
-	int depth = 0;
-
-	core_file_ = new ExtendedCoreFile();
-	core_file_->core.argp = fileLoader;
-	core_file_->core.fsize = [](core_file *file) -> uint64_t {
+static ExtendedCoreFile *NewCoreFile(FileLoader *fileLoader) {
+	ExtendedCoreFile *coreFile = new ExtendedCoreFile();
+	coreFile->core.argp = fileLoader;
+	coreFile->core.fsize = [](core_file *file) -> uint64_t {
 		FileLoader *loader = (FileLoader *)file->argp;
 		return loader->FileSize();
 	};
-	core_file_->core.fseek = [](core_file *file, int64_t offset, int seekType) -> int {
+	coreFile->core.fseek = [](core_file *file, int64_t offset, int seekType) -> int {
 		ExtendedCoreFile *coreFile = (ExtendedCoreFile *)file;
 		switch (seekType) {
 		case SEEK_SET:
@@ -587,7 +971,7 @@ CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
 		}
 		return 0;
 	};
-	core_file_->core.fread = [](void *out_data, size_t size, size_t count, core_file *file) {
+	coreFile->core.fread = [](void *out_data, size_t size, size_t count, core_file *file) {
 		ExtendedCoreFile *coreFile = (ExtendedCoreFile *)file;
 		FileLoader *loader = (FileLoader *)file->argp;
 		uint64_t totalSize = size * count;
@@ -595,11 +979,21 @@ CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
 		coreFile->seekPos += totalSize;
 		return size * count;
 	};
-	core_file_->core.fclose = [](core_file *file) {
+	coreFile->core.fclose = [](core_file *file) {
 		ExtendedCoreFile *coreFile = (ExtendedCoreFile *)file;
 		delete coreFile;
 		return 0;
 	};
+	return coreFile;
+}
+
+CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
+	: BlockDevice(fileLoader), impl_(new CHDImpl()) {
+	Path paths[8];
+	paths[0] = fileLoader->GetPath();
+	int depth = 0;
+
+	core_file_ = NewCoreFile(fileLoader);
 
 	/*
 	// TODO: Support parent/child CHD files.
@@ -662,8 +1056,7 @@ CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
 	impl_->chd = file;
 	impl_->header = chd_get_header(impl_->chd);
 
-	readBuffer = new u8[impl_->header->hunkbytes];
-	currentHunk = -1;
+	cache.Init(impl_->header->hunkbytes, FRAME_CACHE_SIZE);
 	blocksPerHunk = impl_->header->hunkbytes / impl_->header->unitbytes;
 	numBlocks = impl_->header->unitcount;
 }
@@ -671,7 +1064,6 @@ CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
 CHDFileBlockDevice::~CHDFileBlockDevice() {
 	if (impl_->chd) {
 		chd_close(impl_->chd);
-		delete[] readBuffer;
 	}
 }
 
@@ -687,28 +1079,75 @@ bool CHDFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
 	u32 hunk = blockNumber / blocksPerHunk;
 	u32 blockInHunk = blockNumber % blocksPerHunk;
 
-	if (currentHunk != hunk) {
-		chd_error err = chd_read(impl_->chd, hunk, readBuffer);
+	const u8 *hunkData = cache.Find(hunk);
+	if (!hunkData) {
+		u8 *hunkBuffer = cache.Reserve(hunk);
+		chd_error err = chd_read(impl_->chd, hunk, hunkBuffer);
 		if (err != CHDERR_NONE) {
 			ERROR_LOG(Log::Loader, "CHD read failed: %d %d %s", blockNumber, hunk, chd_error_string(err));
 			NotifyReadError();
+			cache.Invalidate(hunk);
+			memset(outPtr, 0, GetBlockSize());
+			return false;
 		}
-		currentHunk = hunk;
+		hunkData = hunkBuffer;
 	}
-	memcpy(outPtr, readBuffer + blockInHunk * impl_->header->unitbytes, GetBlockSize());
+	memcpy(outPtr, hunkData + blockInHunk * impl_->header->unitbytes, GetBlockSize());
 	return true;
 }
 
 bool CHDFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	if (count == 1) {
+		return ReadBlock(minBlock, outPtr);
+	}
+	if (!impl_->chd) {
+		ERROR_LOG(Log::Loader, "ReadBlocks: CHD not open. %s", fileLoader_->GetPath().c_str());
+		return false;
+	}
 	if (minBlock >= numBlocks) {
 		memset(outPtr, 0, GetBlockSize() * count);
 		return false;
 	}
 
-	for (int i = 0; i < count; i++) {
-		if (!ReadBlock(minBlock + i, outPtr + i * GetBlockSize())) {
-			return false;
+	const u32 lastBlock = std::min(minBlock + count, numBlocks) - 1;
+	const u32 missingBlocks = count - (lastBlock + 1 - minBlock);
+	if (missingBlocks != 0) {
+		memset(outPtr + GetBlockSize() * (count - missingBlocks), 0, GetBlockSize() * missingBlocks);
+	}
+
+	const u32 unitBytes = impl_->header->unitbytes;
+	const u32 hunkBytes = impl_->header->hunkbytes;
+	std::vector<FrameDecodeJob> jobs;
+	PlanFrameJobs(minBlock, lastBlock, blocksPerHunk, unitBytes, outPtr, &cache, &jobs, [](u32) {
+		return true;
+	});
+
+	// Unlike CSO, libchdr reads the compressed data itself, through the one chd_file (which can't be
+	// shared between threads). Decoding hunks on workers would need a chd_file each, which is untested,
+	// so the hunks are decoded here, but still skip the cache and go straight to the output when they can.
+	chd_file *chd = impl_->chd;
+	std::vector<u8> scratch;
+	for (FrameDecodeJob &job : jobs) {
+		// Whole hunks go straight to the output, if their layout matches.
+		u8 *hunkBuffer = job.frameBuffer;
+		if (!hunkBuffer && (unitBytes != (u32)GetBlockSize() || hunkBytes != job.blocks * GetBlockSize())) {
+			scratch.resize(hunkBytes);
+			hunkBuffer = scratch.data();
+		}
+
+		chd_error err = chd_read(chd, job.frame, hunkBuffer ? hunkBuffer : job.outPtr);
+		if (err != CHDERR_NONE) {
+			ERROR_LOG(Log::Loader, "CHD read failed: hunk %d %s", job.frame, chd_error_string(err));
+			job.failed = true;
+			memset(job.outPtr, 0, job.blocks * GetBlockSize());
+		} else if (hunkBuffer) {
+			CopyFrameBlocks(hunkBuffer, job.blockOffset, job.blocks, unitBytes, job.outPtr);
 		}
 	}
+
+	if (!FinishFrameJobs(jobs, &cache)) {
+		NotifyReadError();
+		return false;
+	}
 	return true;
 }
@@ -19,11 +19,16 @@
 
 // Abstractions around read-only blockdevices, such as PSP UMD discs.
 // CISOFileBlockDevice implements compressed iso images, CISO format.
+// ZSOFileBlockDevice implements the same layout with LZ4 instead of deflate (ZISO format).
+// FileBlockDevice reads straight from memory when the loader was memory mapped (an opt-in setting).
+// CSO and ZSO decompress the frames of larger reads on worker threads, CHD hunks are decoded in order.
 //
 // The ISOFileSystemReader reads from a BlockDevice, so it automatically works
 // with CISO images.
 
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/ELF/PBPReader.h"
@@ -50,14 +55,49 @@ class BlockDevice {
 		return (u64)GetNumBlocks() * (u64)GetBlockSize();
 	}
 	virtual bool IsDisc() const = 0;
+	// Direct access to the image's bytes [pos, pos + size), when the data is uncompressed and memory mapped.
+	virtual const u8 *DataPointer(u64 pos, u64 size) const {
+		return nullptr;
+	}
+	// Reads the file data behind the blocks without decoding it, so that it's already in the loader's (and
+	// the OS's) caches when it's needed. Safe to call from another thread. False if the device can't do it.
+	virtual bool Prefetch(u32 minBlock, u32 count) {
+		return false;
+	}
 
 	void NotifyReadError();
 
 protected:
+	void PrefetchFileRange(u64 start, u64 end);
+
 	FileLoader *fileLoader_;
 	bool reportedError_ = false;
 };
 
+// The last few decompressed frames (CSO, ZSO) or hunks (CHD), so that reading a frame block by block
+// only decompresses it once. The least recently used one goes first.
+// Only used by the thread calling ReadBlock(s), workers just get handed buffers to fill.
+class DecompressedFrameCache {
+public:
+	void Init(u32 frameSize, int count);
+	// nullptr if it's not cached.
+	const u8 *Find(u32 frame);
+	// A buffer to decompress the frame into. Invalidate() it if that fails.
+	u8 *Reserve(u32 frame);
+	void Invalidate(u32 frame);
+
+private:
+	struct Slot {
+		u32 frame;
+		u64 lastUsed;
+	};
+
+	std::vector<Slot> slots_;
+	std::vector<u8> data_;
+	u32 frameSize_ = 0;
+	u64 useCounter_ = 0;
+};
+
 class CISOFileBlockDevice : public BlockDevice {
 public:
 	CISOFileBlockDevice(FileLoader *fileLoader);
@@ -65,21 +105,50 @@ class CISOFileBlockDevice : public BlockDevice {
 	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
 	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
 	u32 GetNumBlocks() const override { return numBlocks; }
+	bool Prefetch(u32 minBlock, u32 count) override;
 	bool IsDisc() const override { return true; }
 
 private:
+	bool IsPlainFrame(u32 frame, u32 compressedSize) const;
+	u32 FrameBytes(u32 frame) const;
+
 	u32 *index = nullptr;
-	u8 *readBuffer = nullptr;
-	u8 *zlibBuffer = nullptr;
-	u32 zlibBufferFrame = 0;
+	std::vector<u8> readBuffer;
+	DecompressedFrameCache cache;
 	u8 indexShift = 0;
 	u8 blockShift = 0;
 	u32 frameSize = 0;
 	u32 numBlocks = 0;
+	u64 totalBytes = 0;
 	u32 numFrames = 0;
 	int ver_ = 0;
 };
 
+// Same header and index as CSO, but each frame is a raw LZ4 block, which is much faster to decompress.
+class ZSOFileBlockDevice : public BlockDevice {
+public:
+	ZSOFileBlockDevice(FileLoader *fileLoader);
+	~ZSOFileBlockDevice();
+	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
+	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
+	u32 GetNumBlocks() const override { return numBlocks; }
+	bool Prefetch(u32 minBlock, u32 count) override;
+	bool IsDisc() const override { return true; }
+
+private:
+	bool DecodeFrame(u32 frame, const u8 *src, u32 srcSize, u32 blockOffset, u32 blocks, u8 *outPtr, u8 *frameBuffer) const;
+
+	u32 *index = nullptr;
+	std::vector<u8> readBuffer;
+	DecompressedFrameCache cache;
+	u8 indexShift = 0;
+	u8 blockShift = 0;
+	u32 frameSize = 0;
+	u64 totalBytes = 0;
+	u32 numBlocks = 0;
+	u32 numFrames = 0;
+};
+
 
 class FileBlockDevice : public BlockDevice {
 public:
@@ -88,10 +157,12 @@ class FileBlockDevice : public BlockDevice {
 	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
 	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
 	u32 GetNumBlocks() const override {return (u32)(filesize_ / GetBlockSize());}
+	bool Prefetch(u32 minBlock, u32 count) override;
 	bool IsDisc() const override { return true; }
 	u64 GetUncompressedSize() const override {
 		return filesize_;
 	}
+	const u8 *DataPointer(u64 pos, u64 size) const override;
 private:
 	u64 filesize_;
 };
@@ -151,8 +222,7 @@ class CHDFileBlockDevice : public BlockDevice {
 private:
 	struct ExtendedCoreFile *core_file_ = nullptr;
 	std::unique_ptr<CHDImpl> impl_;
-	u8 *readBuffer = nullptr;
-	u32 currentHunk = 0;
+	DecompressedFrameCache cache;
 	u32 blocksPerHunk = 0;
 	u32 numBlocks = 0;
 };
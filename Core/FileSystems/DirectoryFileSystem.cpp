@@ -416,6 +416,39 @@ size_t DirectoryFileHandle::Seek(s32 position, FileMove type)
 	return replay_ ? (size_t)ReplayApplyDisk64(ReplayAction::FILE_SEEK, result, CoreTiming::GetGlobalTimeUs()) : result;
 }
 
+bool DirectoryFileHandle::BeginHostRead(s64 size, HostFileRead *read)
+{
+#ifdef _WIN32
+	return false;
+#else
+	// Replays have to see every read, let those go through Read().
+	if (replay_ && (ReplayIsExecuting() || ReplayIsSaving()))
+		return false;
+
+	off_t off = lseek(hFile, 0, SEEK_CUR);
+	if (off < 0)
+		return false;
+	if (needsTrunc_ != -1 && needsTrunc_ < off + size) {
+		size = needsTrunc_ - off;
+	}
+	if (size <= 0 || size > 0x7FFFFFFF)
+		return false;
+
+	read->fd = hFile;
+	read->offset = off;
+	read->size = size;
+	return true;
+#endif
+}
+
+void DirectoryFileHandle::EndHostRead(const HostFileRead &read, s64 bytesRead)
+{
+#ifndef _WIN32
+	if (bytesRead > 0)
+		lseek(hFile, (off_t)(read.offset + bytesRead), SEEK_SET);
+#endif
+}
+
 void DirectoryFileHandle::Close()
 {
 	if (needsTrunc_ != -1) {
@@ -648,6 +681,19 @@ size_t DirectoryFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &use
 	}
 }
 
+bool DirectoryFileSystem::BeginHostRead(u32 handle, s64 size, HostFileRead *read) {
+	EntryMap::iterator iter = entries.find(handle);
+	if (iter != entries.end() && size >= 0)
+		return iter->second.hFile.BeginHostRead(size, read);
+	return false;
+}
+
+void DirectoryFileSystem::EndHostRead(u32 handle, const HostFileRead &read, s64 bytesRead) {
+	EntryMap::iterator iter = entries.find(handle);
+	if (iter != entries.end())
+		iter->second.hFile.EndHostRead(read, bytesRead);
+}
+
 size_t DirectoryFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size) {
 	int ignored;
 	return WriteFile(handle, pointer, size, ignored);
@@ -833,7 +879,7 @@ std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &p
 			entry.name = file.name;
 		}
 		if (hideISOFiles) {
-			if (endsWithNoCase(entry.name, ".cso") || endsWithNoCase(entry.name, ".iso") || endsWithNoCase(entry.name, ".chd")) {  // chd not really necessary, but let's hide them too.
+			if (endsWithNoCase(entry.name, ".cso") || endsWithNoCase(entry.name, ".zso") || endsWithNoCase(entry.name, ".iso") || endsWithNoCase(entry.name, ".chd")) {  // chd not really necessary, but let's hide them too.
 				// Workaround for DJ Max Portable, see compat.ini.
 				continue;
 			} else if (file.isDirectory) {
@@ -54,6 +54,8 @@ struct DirectoryFileHandle {
 	size_t Read(u8* pointer, s64 size);
 	size_t Write(const u8* pointer, s64 size);
 	size_t Seek(s32 position, FileMove type);
+	bool BeginHostRead(s64 size, HostFileRead *read);
+	void EndHostRead(const HostFileRead &read, s64 bytesRead);
 	void Close();
 };
 
@@ -87,6 +89,8 @@ class DirectoryFileSystem : public IFileSystem {
 
 	bool ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) override;
 	void Describe(char *buf, size_t size) const override { snprintf(buf, size, "Dir: %s", basePath.c_str()); }
+	bool BeginHostRead(u32 handle, s64 size, HostFileRead *read) override;
+	void EndHostRead(u32 handle, const HostFileRead &read, s64 bytesRead) override;
 
 private:
 	struct OpenFileEntry {
@@ -122,6 +122,13 @@ struct PSPFileInfo {
 	u32 sectorSize = 0;
 };
 
+// Where a read can be done directly from a host file, see IFileSystem::BeginHostRead.
+struct HostFileRead {
+	int fd = -1;
+	s64 offset = 0;
+	s64 size = 0;
+};
+
 
 class IFileSystem {
 public:
@@ -148,6 +155,12 @@ class IFileSystem {
 	virtual u64      FreeDiskSpace(const std::string &path) = 0;
 	virtual bool     ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) = 0;
 	virtual void     Describe(char *buf, size_t size) const = 0;
+
+	// For asynchronous reads without a blocked thread (io_uring): where the next size bytes of the file are.
+	// The caller then reads them itself and calls EndHostRead with what it got, to move the file position.
+	// Returns false when the read has to go through ReadFile.
+	virtual bool     BeginHostRead(u32 handle, s64 size, HostFileRead *read) { return false; }
+	virtual void     EndHostRead(u32 handle, const HostFileRead &read, s64 bytesRead) {}
 };
 
 
@@ -24,6 +24,7 @@
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/FileSystems/ISOFileSystem.h"
+#include "Core/FileSystems/UmdPrefetcher.h"
 #include "Core/HLE/sceKernel.h"
 #include "Core/MemMap.h"
 #include "Core/Reporting.h"
@@ -173,10 +174,16 @@ ISOFileSystem::ISOFileSystem(IHandleAllocator *_hAlloc, BlockDevice *_blockDevic
 }
 
 ISOFileSystem::~ISOFileSystem() {
+	// Reads from the block device in the background.
+	prefetcher_.reset();
 	delete blockDevice;
 	delete treeroot;
 }
 
+void ISOFileSystem::StartPrefetcher(const Path &traceFile) {
+	prefetcher_.reset(new UmdPrefetcher(blockDevice, traceFile));
+}
+
 std::string ISOFileSystem::TreeEntry::BuildPath() {
 	if (parent) {
 		return parent->BuildPath() + "/" + name;
@@ -367,6 +374,8 @@ int ISOFileSystem::OpenFile(std::string filename, FileAccess access, const char
 
 	if (entry.file == &entireISO)
 		entry.isBlockSectorMode = true;
+	else if (prefetcher_)
+		prefetcher_->OnOpen(entry.file->startingPosition / 2048);
 
 	entry.seekPos = 0;
 
@@ -486,6 +495,8 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 		if (e.isBlockSectorMode) {
 			// Whole sectors! Shortcut to this simple code.
 			blockDevice->ReadBlocks(e.seekPos, (int)size, pointer);
+			if (prefetcher_)
+				prefetcher_->OnRead(e.seekPos, (u32)size);
 			if (abs((int)lastReadBlock_ - (int)e.seekPos) > 100) {
 				// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
 				usec = 100000;
@@ -538,23 +549,33 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 		}
 
 		const u8 *const start = pointer;
-		if (firstBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
-			pointer += firstBlockSize;
-		}
-		if (middleSize > 0) {
-			const u32 sectors = (u32)(middleSize / 2048);
-			blockDevice->ReadBlocks(secNum, sectors, pointer);
-			secNum += sectors;
-			pointer += middleSize;
-		}
-		if (lastBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector, lastBlockSize);
-			pointer += lastBlockSize;
+		if (const u8 *data = blockDevice->DataPointer(positionOnIso, size)) {
+			// A memory mapped plain ISO, so it's all just one copy.
+			memcpy(pointer, data, (size_t)size);
+			pointer += size;
+			secNum += (firstBlockSize > 0 ? 1 : 0) + (u32)(middleSize / 2048) + (lastBlockSize > 0 ? 1 : 0);
+		} else {
+			if (firstBlockSize > 0) {
+				blockDevice->ReadBlock(secNum++, theSector);
+				memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
+				pointer += firstBlockSize;
+			}
+			if (middleSize > 0) {
+				const u32 sectors = (u32)(middleSize / 2048);
+				blockDevice->ReadBlocks(secNum, sectors, pointer);
+				secNum += sectors;
+				pointer += middleSize;
+			}
+			if (lastBlockSize > 0) {
+				blockDevice->ReadBlock(secNum++, theSector);
+				memcpy(pointer, theSector, lastBlockSize);
+				pointer += lastBlockSize;
+			}
 		}
 
+		if (prefetcher_)
+			prefetcher_->OnRead((u32)(positionOnIso / 2048), secNum - (u32)(positionOnIso / 2048));
+
 		size_t totalBytes = pointer - start;
 		if (abs((int)lastReadBlock_ - (int)secNum) > 100) {
 			// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
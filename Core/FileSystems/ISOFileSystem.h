@@ -25,6 +25,8 @@
 
 #include "BlockDevices.h"
 
+class UmdPrefetcher;
+
 bool parseLBN(const std::string &filename, u32 *sectorStart, u32 *readSize);
 
 class ISOFileSystem : public IFileSystem {
@@ -57,6 +59,9 @@ class ISOFileSystem : public IFileSystem {
 	bool ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) override { return false; }
 	void Describe(char *buf, size_t size) const override { snprintf(buf, size, "ISO"); }  // TODO: Ask the fileLoader about the origins
 
+	// Records the game's reads into traceFile, and prefetches using what's already there.
+	void StartPrefetcher(const Path &traceFile);
+
 private:
 	struct TreeEntry {
 		~TreeEntry();
@@ -93,6 +98,7 @@ class ISOFileSystem : public IFileSystem {
 	IHandleAllocator *hAlloc;
 	TreeEntry *treeroot;
 	BlockDevice *blockDevice;
+	std::unique_ptr<UmdPrefetcher> prefetcher_;
 	u32 lastReadBlock_;
 
 	TreeEntry entireISO;
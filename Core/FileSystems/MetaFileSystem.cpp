@@ -563,6 +563,24 @@ size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec)
 		return 0;
 }
 
+bool MetaFileSystem::BeginHostRead(u32 handle, s64 size, HostFileRead *read)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock);
+	IFileSystem *sys = GetHandleOwner(handle);
+	if (sys)
+		return sys->BeginHostRead(handle, size, read);
+	else
+		return false;
+}
+
+void MetaFileSystem::EndHostRead(u32 handle, const HostFileRead &read, s64 bytesRead)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock);
+	IFileSystem *sys = GetHandleOwner(handle);
+	if (sys)
+		sys->EndHostRead(handle, read, bytesRead);
+}
+
 size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, int &usec)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
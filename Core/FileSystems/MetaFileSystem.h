@@ -119,6 +119,8 @@ class MetaFileSystem : public IHandleAllocator, public IFileSystem {
 	size_t   SeekFile(u32 handle, s32 position, FileMove type) override;
 	PSPFileInfo GetFileInfo(std::string filename) override;
 	bool     OwnsHandle(u32 handle) override { return false; }
+	bool     BeginHostRead(u32 handle, s64 size, HostFileRead *read) override;
+	void     EndHostRead(u32 handle, const HostFileRead &read, s64 bytesRead) override;
 	inline size_t GetSeekPos(u32 handle) {
 		return SeekFile(handle, 0, FILEMOVE_CURRENT);
 	}
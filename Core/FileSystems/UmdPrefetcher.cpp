@@ -0,0 +1,249 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/Swap.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Core/FileSystems/BlockDevices.h"
+#include "Core/FileSystems/UmdPrefetcher.h"
+
+// The trace file: this header, then (sector, count) pairs.
+struct UmdTraceHeader {
+	char magic[4];
+	u32_le version;
+	// To notice a different image of the game (a patched translation, say.)
+	u32_le numBlocks;
+	u32_le count;
+};
+
+static const u32 TRACE_VERSION = 1;
+// 128 KB of trace, plenty to cover the boot and a good number of loads.
+static const size_t MAX_EVENTS = 16384;
+// Sequential reads are merged up to this many sectors (1 MB), after that a new event starts,
+// so that long streams still have points to predict from.
+static const u32 MAX_EVENT_SECTORS = 512;
+// How far ahead of the game to read (8 MB), and in how big pieces.
+static const u32 PREFETCH_AHEAD_SECTORS = 4096;
+static const u32 PREFETCH_CHUNK_SECTORS = 128;
+static const size_t PREFETCH_MAX_EVENTS = 256;
+
+UmdPrefetcher::UmdPrefetcher(BlockDevice *blockDevice, const Path &traceFile)
+	: blockDevice_(blockDevice), traceFile_(traceFile) {
+	if (traceFile_.empty())
+		return;
+
+	std::string data;
+	if (File::ReadBinaryFileToString(traceFile_, &data) && Deserialize(std::vector<u8>(data.begin(), data.end()))) {
+		INFO_LOG(Log::FileSystem, "Prefetching the disc from a trace of %d reads", (int)old_.size());
+	}
+}
+
+UmdPrefetcher::~UmdPrefetcher() {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stop_ = true;
+		queue_.clear();
+	}
+	cond_.notify_one();
+	if (thread_.joinable())
+		thread_.join();
+
+	if (traceFile_.empty() || session_.empty())
+		return;
+
+	std::vector<u8> data;
+	Serialize(&data);
+	File::CreateFullPath(traceFile_.NavigateUp());
+	if (!File::WriteDataToFile(false, data.data(), data.size(), traceFile_)) {
+		WARN_LOG(Log::FileSystem, "Couldn't save the disc read trace to %s", traceFile_.c_str());
+	}
+}
+
+void UmdPrefetcher::OnOpen(u32 startSector) {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (opened_.insert(startSector).second && session_.size() < MAX_EVENTS)
+		session_.push_back(Event{ startSector, 0 });
+
+	auto it = oldOpens_.find(startSector);
+	if (it != oldOpens_.end())
+		Predict(it->second);
+}
+
+void UmdPrefetcher::OnRead(u32 startSector, u32 sectors) {
+	if (sectors == 0)
+		return;
+
+	std::lock_guard<std::mutex> guard(lock_);
+	RecordRead(startSector, sectors);
+
+	auto it = oldReads_.upper_bound(startSector);
+	if (it != oldReads_.begin()) {
+		--it;
+		const Event &event = old_[it->second];
+		if (startSector < event.sector + event.count)
+			Predict(it->second);
+	}
+}
+
+bool UmdPrefetcher::IsRecorded(u32 startSector, u32 endSector) const {
+	auto it = recorded_.upper_bound(startSector);
+	return it != recorded_.begin() && std::prev(it)->second >= endSector;
+}
+
+void UmdPrefetcher::RecordRead(u32 startSector, u32 sectors) {
+	const u32 endSector = startSector + sectors;
+	if (IsRecorded(startSector, endSector))
+		return;
+	u32 &recordedEnd = recorded_[startSector];
+	recordedEnd = std::max(recordedEnd, endSector);
+
+	if (!session_.empty()) {
+		Event &last = session_.back();
+		if (last.count != 0 && last.sector + last.count == startSector && last.count + sectors <= MAX_EVENT_SECTORS) {
+			last.count += sectors;
+			return;
+		}
+	}
+	if (session_.size() < MAX_EVENTS)
+		session_.push_back(Event{ startSector, sectors });
+}
+
+// Queues what came after the old event, replacing whatever was queued for an earlier prediction.
+void UmdPrefetcher::Predict(size_t oldIndex) {
+	for (size_t index : queue_)
+		oldQueued_[index] = false;
+	queue_.clear();
+
+	u32 sectors = 0;
+	const size_t end = std::min(old_.size(), oldIndex + 1 + PREFETCH_MAX_EVENTS);
+	for (size_t i = oldIndex + 1; i < end && sectors < PREFETCH_AHEAD_SECTORS; i++) {
+		// Skip what the game already read itself this time.
+		if (old_[i].count == 0 || oldQueued_[i] || IsRecorded(old_[i].sector, old_[i].sector + old_[i].count))
+			continue;
+		oldQueued_[i] = true;
+		queue_.push_back(i);
+		sectors += old_[i].count;
+	}
+
+	if (queue_.empty())
+		return;
+	if (!thread_.joinable())
+		thread_ = std::thread(&UmdPrefetcher::PrefetchThread, this);
+	cond_.notify_one();
+}
+
+void UmdPrefetcher::PrefetchThread() {
+	SetCurrentThreadName("UmdPrefetch");
+
+	std::unique_lock<std::mutex> guard(lock_);
+	while (true) {
+		cond_.wait(guard, [&] { return stop_ || !queue_.empty(); });
+		if (stop_)
+			break;
+
+		Event event = old_[queue_.front()];
+		queue_.pop_front();
+		busy_ = true;
+		guard.unlock();
+
+		for (u32 offset = 0; offset < event.count; offset += PREFETCH_CHUNK_SECTORS) {
+			if (!blockDevice_->Prefetch(event.sector + offset, std::min(PREFETCH_CHUNK_SECTORS, event.count - offset)))
+				break;
+			std::lock_guard<std::mutex> stopGuard(lock_);
+			if (stop_)
+				break;
+		}
+
+		guard.lock();
+		busy_ = false;
+		if (queue_.empty())
+			idleCond_.notify_all();
+	}
+	busy_ = false;
+	idleCond_.notify_all();
+}
+
+void UmdPrefetcher::WaitUntilIdle() {
+	std::unique_lock<std::mutex> guard(lock_);
+	idleCond_.wait(guard, [&] { return stop_ || (queue_.empty() && !busy_); });
+}
+
+void UmdPrefetcher::Serialize(std::vector<u8> *data) {
+	std::lock_guard<std::mutex> guard(lock_);
+
+	std::vector<Event> events = session_;
+	std::unordered_set<u64> seen;
+	for (const Event &event : events)
+		seen.insert(((u64)event.sector << 32) | event.count);
+	for (const Event &event : old_) {
+		if (events.size() >= MAX_EVENTS)
+			break;
+		if (seen.insert(((u64)event.sector << 32) | event.count).second)
+			events.push_back(event);
+	}
+
+	UmdTraceHeader header;
+	memcpy(header.magic, "UMDT", 4);
+	header.version = TRACE_VERSION;
+	header.numBlocks = blockDevice_->GetNumBlocks();
+	header.count = (u32)events.size();
+
+	data->resize(sizeof(header) + events.size() * 8);
+	memcpy(data->data(), &header, sizeof(header));
+	u32_le *out = (u32_le *)(data->data() + sizeof(header));
+	for (const Event &event : events) {
+		*out++ = event.sector;
+		*out++ = event.count;
+	}
+}
+
+bool UmdPrefetcher::Deserialize(const std::vector<u8> &data) {
+	UmdTraceHeader header;
+	if (data.size() < sizeof(header))
+		return false;
+	memcpy(&header, data.data(), sizeof(header));
+	if (memcmp(header.magic, "UMDT", 4) != 0 || header.version != TRACE_VERSION || header.count > MAX_EVENTS) {
+		WARN_LOG(Log::FileSystem, "Ignoring bad disc read trace %s", traceFile_.c_str());
+		return false;
+	}
+	if (header.numBlocks != blockDevice_->GetNumBlocks() || data.size() < sizeof(header) + header.count * 8) {
+		WARN_LOG(Log::FileSystem, "Ignoring disc read trace %s, it's from a different image", traceFile_.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock_);
+	old_.clear();
+	oldReads_.clear();
+	oldOpens_.clear();
+	const u32_le *in = (const u32_le *)(data.data() + sizeof(header));
+	for (u32 i = 0; i < header.count; i++) {
+		Event event{ in[i * 2], in[i * 2 + 1] };
+		if (event.count == 0) {
+			oldOpens_.emplace(event.sector, old_.size());
+		} else {
+			oldReads_.emplace(event.sector, old_.size());
+		}
+		old_.push_back(event);
+	}
+	oldQueued_.assign(old_.size(), false);
+	return true;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+
+class BlockDevice;
+
+// Remembers in which order a game opens files and reads sectors from its disc, in a small trace file per game.
+// On later runs, whenever the game gets to a point of the old trace, what it read next that time is read
+// from the image on a background thread, so it's already in the caches (ours or the OS's) when asked for.
+//
+// This only makes the host side faster (slow SD cards, network shares, HTTP). Reads still report the same
+// emulated timing as before.
+class UmdPrefetcher {
+public:
+	// traceFile can be empty, to only record (see Serialize).
+	UmdPrefetcher(BlockDevice *blockDevice, const Path &traceFile);
+	// Stops prefetching and saves the trace, merged with the old one.
+	~UmdPrefetcher();
+
+	// Can be called from any thread, reads can come from the async IO thread.
+	void OnOpen(u32 startSector);
+	void OnRead(u32 startSector, u32 sectors);
+
+	// The trace of this session, followed by what the old one had that this session didn't get to.
+	void Serialize(std::vector<u8> *data);
+	bool Deserialize(const std::vector<u8> &data);
+
+	// Returns once everything queued has been read. For tests.
+	void WaitUntilIdle();
+
+private:
+	struct Event {
+		u32 sector;
+		// 0 for file opens.
+		u32 count;
+	};
+
+	bool IsRecorded(u32 startSector, u32 endSector) const;
+	void RecordRead(u32 startSector, u32 sectors);
+	void Predict(size_t oldIndex);
+	void PrefetchThread();
+
+	BlockDevice *blockDevice_;
+	Path traceFile_;
+
+	std::mutex lock_;
+	std::vector<Event> session_;
+	// Only the first open of each file and read of each sector is recorded.
+	std::set<u32> opened_;
+	std::map<u32, u32> recorded_;
+
+	// The trace from earlier sessions, and where its events are.
+	std::vector<Event> old_;
+	std::vector<bool> oldQueued_;
+	std::map<u32, size_t> oldReads_;
+	std::unordered_map<u32, size_t> oldOpens_;
+
+	// Indices into old_.
+	std::deque<size_t> queue_;
+	bool busy_ = false;
+	bool stop_ = false;
+	std::condition_variable cond_;
+	std::condition_variable idleCond_;
+	std::thread thread_;
+};
@@ -35,7 +35,7 @@
 #include "Core/Reporting.h"
 #include "Core/System.h"
 #ifndef MOBILE_DEVICE
-#include "Core/WaveFile.h"
+#include "Core/AudioCapture.h"
 #include "Core/ELF/ParamSFO.h"
 #include "Core/HLE/sceKernelTime.h"
 #include "StringUtils.h"
@@ -46,12 +46,9 @@
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/Util/AudioFormat.h"
 
-// Should be used to lock anything related to the outAudioQueue.
-// atomic locks are used on the lock. TODO: make this lock-free
-std::atomic_flag atomicLock_;
-
 // We copy samples as they are written into this simple ring buffer.
-// Might try something more efficient later.
+// Both filling (the sceAudio output calls) and draining (__AudioUpdate) happen on the emu thread,
+// so unlike the resampler's buffer, this needs no synchronization.
 FixedSizeQueue<s16, 32768 * 8> chanSampleQueues[PSP_AUDIO_CHANNEL_MAX + 1];
 
 int eventAudioUpdate = -1;
@@ -71,8 +68,13 @@ static int audioHostIntervalCycles;
 static s32 *mixBuffer;
 static s16 *clampedMixBuffer;
 #ifndef MOBILE_DEVICE
-WaveFileWriter g_wave_writer;
+static AudioCapture g_audioCapture;
 static bool m_logAudio;
+static bool m_logAudioFailed;
+
+static const char *AudioDumpExtension() {
+	return (AudioDumpFormat)g_Config.iAudioDumpFormat == AudioDumpFormat::FLAC ? "flac" : "wav";
+}
 #endif
 
 // High and low watermarks, basically.  For perfect emulation, the correct values are 0 and 1, respectively.
@@ -423,7 +425,7 @@ void __AudioUpdate(bool resetRecording) {
 		if (g_Config.bSaveLoadResetsAVdumping && resetRecording) {
 			__StopLogAudio();
 			std::string discID = g_paramSFO.GetDiscID();
-			Path audio_file_name = GetSysDirectory(DIRECTORY_AUDIO) / StringFromFormat("%s_%s.wav", discID.c_str(), KernelTimeNowFormatted().c_str()).c_str();
+			Path audio_file_name = GetSysDirectory(DIRECTORY_AUDIO) / StringFromFormat("%s_%s.%s", discID.c_str(), KernelTimeNowFormatted().c_str(), AudioDumpExtension()).c_str();
 			INFO_LOG(Log::Common, "Restarted audio recording to: %s", audio_file_name.c_str());
 			if (!File::Exists(GetSysDirectory(DIRECTORY_AUDIO)))
 				File::CreateDir(GetSysDirectory(DIRECTORY_AUDIO));
@@ -431,10 +433,12 @@ void __AudioUpdate(bool resetRecording) {
 			__StartLogAudio(audio_file_name);
 		}
 		if (!m_logAudio) {
-			if (g_Config.bDumpAudio) {
+			if (!g_Config.bDumpAudio) {
+				m_logAudioFailed = false;
+			} else if (!m_logAudioFailed) {
 				// Use gameID_EmulatedTimestamp for filename
 				std::string discID = g_paramSFO.GetDiscID();
-				Path audio_file_name = GetSysDirectory(DIRECTORY_AUDIO) / StringFromFormat("%s_%s.wav", discID.c_str(), KernelTimeNowFormatted().c_str());
+				Path audio_file_name = GetSysDirectory(DIRECTORY_AUDIO) / StringFromFormat("%s_%s.%s", discID.c_str(), KernelTimeNowFormatted().c_str(), AudioDumpExtension());
 				INFO_LOG(Log::Common,"Recording audio to: %s", audio_file_name.c_str());
 				// Create the path just in case it doesn't exist
 				if (!File::Exists(GetSysDirectory(DIRECTORY_AUDIO)))
@@ -447,7 +451,7 @@ void __AudioUpdate(bool resetRecording) {
 				for (int i = 0; i < hwBlockSize * 2; i++) {
 					clampedMixBuffer[i] = clamp_s16(mixBuffer[i]);
 				}
-				g_wave_writer.AddStereoSamples(clampedMixBuffer, hwBlockSize);
+				g_audioCapture.Push(clampedMixBuffer, hwBlockSize);
 			} else {
 				__StopLogAudio();
 			}
@@ -459,9 +463,13 @@ void __AudioUpdate(bool resetRecording) {
 #ifndef MOBILE_DEVICE
 void __StartLogAudio(const Path& filename) {
 	if (!m_logAudio) {
+		if (!g_audioCapture.Start(filename, (AudioDumpFormat)g_Config.iAudioDumpFormat, hwSampleRate)) {
+			ERROR_LOG(Log::sceAudio, "Failed to start audio logging to %s", filename.c_str());
+			// Don't try again every block, only once dumping is toggled.
+			m_logAudioFailed = true;
+			return;
+		}
 		m_logAudio = true;
-		g_wave_writer.Start(filename, 44100);
-		g_wave_writer.SetSkipSilence(false);
 		NOTICE_LOG(Log::sceAudio, "Starting Audio logging");
 	} else {
 		WARN_LOG(Log::sceAudio, "Audio logging has already been started");
@@ -471,7 +479,7 @@ void __StartLogAudio(const Path& filename) {
 void __StopLogAudio() {
 	if (m_logAudio)	{
 		m_logAudio = false;
-		g_wave_writer.Stop();
+		g_audioCapture.Stop();
 		NOTICE_LOG(Log::sceAudio, "Stopping Audio logging");
 	} else {
 		WARN_LOG(Log::sceAudio, "Audio logging has already been stopped");
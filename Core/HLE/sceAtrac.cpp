@@ -28,6 +28,7 @@
 #include "Core/Config.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HW/MediaEngine.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/HW/BufferQueue.h"
 
 #include "Core/HLE/sceKernel.h"
@@ -265,7 +266,11 @@ static u32 sceAtracDecodeData(int atracID, u32 outAddr, u32 numSamplesAddr, u32
 	u32 numSamples = 0;
 	u32 finish = 0;
 	int remains = 0;
-	int ret = atrac->DecodeData(Memory::GetPointerWrite(outAddr), outAddr, &numSamples, &finish, &remains);
+	int ret;
+	{
+		AudioPerfScope perf(AudioPerfComponent::ATRAC_DECODE);
+		ret = atrac->DecodeData(Memory::GetPointerWrite(outAddr), outAddr, &numSamples, &finish, &remains);
+	}
 	if (ret != (int)ATRAC_ERROR_BAD_ATRACID && ret != (int)ATRAC_ERROR_NO_DATA) {
 		if (Memory::IsValidAddress(numSamplesAddr))
 			Memory::WriteUnchecked_U32(numSamples, numSamplesAddr);
@@ -976,7 +981,10 @@ static int sceAtracLowLevelDecode(int atracID, u32 sourceAddr, u32 sourceBytesCo
 	int bytesConsumed = 0;
 	int outSamples = 0;
 	int channels = atrac->GetOutputChannels();
-	atrac->Decoder()->Decode(srcp, atrac->GetTrack().BytesPerFrame(), &bytesConsumed, channels, outp, &outSamples);
+	{
+		AudioPerfScope perf(AudioPerfComponent::ATRAC_DECODE);
+		atrac->Decoder()->Decode(srcp, atrac->GetTrack().BytesPerFrame(), &bytesConsumed, channels, outp, &outSamples);
+	}
 	int bytesWritten = outSamples * channels * sizeof(int16_t);
 	*srcConsumed = bytesConsumed;
 	*outWritten = bytesWritten;
@@ -1096,7 +1096,7 @@ static bool __IoRead(int &result, int id, u32 data_addr, int size, int &us) {
 				// If there's a pending operation on this file, wait for it to finish and don't overwrite it.
 				useThread = !ioManager.HasOperation(f->handle);
 				if (!useThread) {
-					ioManager.SyncThread();
+					ioManager.SyncOperation(f->handle);
 				}
 			}
 			if (useThread) {
@@ -1234,7 +1234,7 @@ static bool __IoWrite(int &result, int id, u32 data_addr, int size, int &us) {
 			// If there's a pending operation on this file, wait for it to finish and don't overwrite it.
 			useThread = !ioManager.HasOperation(f->handle);
 			if (!useThread) {
-				ioManager.SyncThread();
+				ioManager.SyncOperation(f->handle);
 			}
 		}
 		if (useThread) {
@@ -1385,7 +1385,7 @@ static s64 __IoLseekDest(FileNode *f, s64 offset, int whence, FileMove &seek) {
 
 	// Let's make sure this isn't incorrect mid-operation.
 	if (ioManager.HasOperation(f->handle)) {
-		ioManager.SyncThread();
+		ioManager.SyncOperation(f->handle);
 	}
 
 	s64 newPos = 0;
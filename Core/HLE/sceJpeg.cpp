@@ -16,9 +16,11 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <vector>
 #include "ext/jpge/jpgd.h"
 
 #include "Common/CommonTypes.h"
+#include "Common/Data/Convert/YUVConv.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/Debugger/MemBlockInfo.h"
@@ -85,22 +87,7 @@ static int getWidthHeight(int width, int height) {
 	return (width << 16) | height;
 }
 
-// TODO: sceJpegCsc and sceJpegMJpegCsc use different factors.
-static u32 convertYCbCrToABGR(int y, int cb, int cr) {
-	//see http://en.wikipedia.org/wiki/Yuv#Y.27UV444_to_RGB888_conversion for more information.
-	cb = cb - 128;
-	cr = cr - 128;
-	int r = y + cr + (cr >> 2) + (cr >> 3) + (cr >> 5);
-	int g = y - ((cb >> 2) + (cb >> 4) + (cb >> 5)) - ((cr >> 1) + (cr >> 3) + (cr >> 4) + (cr >> 5));
-	int b = y + cb + (cb >> 1) + (cb >> 2) + (cb >> 6);
-
-	// check rgb value.
-	if (r > 0xFF) r = 0xFF; if(r < 0) r = 0;
-	if (g > 0xFF) g = 0xFF; if(g < 0) g = 0;
-	if (b > 0xFF) b = 0xFF; if(b < 0) b = 0;
-
-	return (b << 16) | (g << 8) | (r << 0);
-}
+// TODO: sceJpegCsc and sceJpegMJpegCsc use different factors.  Both use YCbCrToABGR_PSPJpeg for now.
 
 static int JpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bufferWidth, uint32_t chroma, int &usec) {
 	if ((chroma & 0x000FFFFF) != 0x00020202 && (chroma & 0x000FFFFF) != 0x00020201 && (chroma & 0x000FFFFF) != 0x00020101)
@@ -132,7 +119,8 @@ static int JpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bufferWidt
 	// Very approximate estimate based on tests on a PSP.  Usually under.
 	usec += 60 + 6 * height + width / 2 + width / 4;
 
-	if ((widthHeight & 0x00010001) == 0 && height > 1) {
+	if (bufferWidth < width && (widthHeight & 0x00010001) == 0 && height > 1) {
+		// The rows overlap, so this write order matters.
 		for (int y = 0; y < height; y += 2) {
 			for (int x = 0; x < width; x += 2) {
 				u8 y0 = Y[width * y + x];
@@ -142,21 +130,37 @@ static int JpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bufferWidt
 				u8 cb = Cb[(width >> widthShift) * (y >> heightShift) + (x >> widthShift)];
 				u8 cr = Cr[(width >> widthShift) * (y >> heightShift) + (x >> widthShift)];
 
-				imageBuffer[bufferWidth * y + x] = convertYCbCrToABGR(y0, cb, cr);
-				imageBuffer[bufferWidth * y + x + 1] = convertYCbCrToABGR(y1, cb, cr);
-				imageBuffer[bufferWidth * (y + 1) + x] = convertYCbCrToABGR(y2, cb, cr);
-				imageBuffer[bufferWidth * (y + 1) + x + 1] = convertYCbCrToABGR(y3, cb, cr);
+				imageBuffer[bufferWidth * y + x] = YCbCrToABGR_PSPJpeg(y0, cb, cr);
+				imageBuffer[bufferWidth * y + x + 1] = YCbCrToABGR_PSPJpeg(y1, cb, cr);
+				imageBuffer[bufferWidth * (y + 1) + x] = YCbCrToABGR_PSPJpeg(y2, cb, cr);
+				imageBuffer[bufferWidth * (y + 1) + x + 1] = YCbCrToABGR_PSPJpeg(y3, cb, cr);
 			}
 		}
 	} else {
+		// With an even width and height, each 2x2 block uses the chroma of its top left pixel.
+		// That only matters without subsampling (a shift of 0) in that direction.
+		const bool sharedChroma = (widthHeight & 0x00010001) == 0 && height > 1;
+		const int chromaMask = sharedChroma ? ~1 : ~0;
+		// The converter handles one chroma sample per pixel or per two, anything else is expanded first.
+		const bool expandChroma = widthShift != 1 && (widthShift != 0 || sharedChroma);
+		std::vector<u8> cbRow, crRow;
+		if (expandChroma) {
+			cbRow.resize(width);
+			crRow.resize(width);
+		}
 		for (int y = 0; y < height; ++y) {
-			for (int x = 0; x < width; ++x) {
-				u8 yy = Y[width * y + x];
-				u8 cb = Cb[(width >> widthShift) * (y >> heightShift) + (x >> widthShift)];
-				u8 cr = Cr[(width >> widthShift) * (y >> heightShift) + (x >> widthShift)];
-
-				imageBuffer[bufferWidth * y + x] = convertYCbCrToABGR(yy, cb, cr);
+			int chromaOffset = (width >> widthShift) * ((y & chromaMask) >> heightShift);
+			const u8 *cbPtr = Cb + chromaOffset;
+			const u8 *crPtr = Cr + chromaOffset;
+			if (expandChroma) {
+				for (int x = 0; x < width; ++x) {
+					cbRow[x] = cbPtr[(x & chromaMask) >> widthShift];
+					crRow[x] = crPtr[(x & chromaMask) >> widthShift];
+				}
+				cbPtr = cbRow.data();
+				crPtr = crRow.data();
 			}
+			ConvertYCbCrRowPSPJpeg((u32 *)&imageBuffer[bufferWidth * y], Y + width * y, cbPtr, crPtr, width, expandChroma ? 0 : widthShift);
 		}
 	}
 
@@ -202,10 +206,11 @@ static int JpegMJpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int buffe
 		// Seems to write based on zeros?  Maybe reuses some other value?
 		for (int y = 0; y < height; ++y) {
 			for (int x = 0; x < width; ++x) {
-				imageBuffer[bufferWidth * y + x] = convertYCbCrToABGR(0, 0, 0);
+				imageBuffer[bufferWidth * y + x] = YCbCrToABGR_PSPJpeg(0, 0, 0);
 			}
 		}
-	} else if ((widthHeight & 0x00010001) == 0 && height > 1) {
+	} else if (bufferWidth < width && (widthHeight & 0x00010001) == 0 && height > 1) {
+		// The rows overlap, so this write order matters.
 		for (int y = 0; y < height; y += 2) {
 			for (int x = 0; x < width; x += 2) {
 				u8 y0 = Y[width * y + x];
@@ -215,22 +220,17 @@ static int JpegMJpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int buffe
 				u8 cb = Cb[(width >> 1) * (y >> 1) + (x >> 1)];
 				u8 cr = Cr[(width >> 1) * (y >> 1) + (x >> 1)];
 
-				imageBuffer[bufferWidth * y + x] = convertYCbCrToABGR(y0, cb, cr);
-				imageBuffer[bufferWidth * y + x + 1] = convertYCbCrToABGR(y1, cb, cr);
-				imageBuffer[bufferWidth * (y + 1) + x] = convertYCbCrToABGR(y2, cb, cr);
-				imageBuffer[bufferWidth * (y + 1) + x + 1] = convertYCbCrToABGR(y3, cb, cr);
+				imageBuffer[bufferWidth * y + x] = YCbCrToABGR_PSPJpeg(y0, cb, cr);
+				imageBuffer[bufferWidth * y + x + 1] = YCbCrToABGR_PSPJpeg(y1, cb, cr);
+				imageBuffer[bufferWidth * (y + 1) + x] = YCbCrToABGR_PSPJpeg(y2, cb, cr);
+				imageBuffer[bufferWidth * (y + 1) + x + 1] = YCbCrToABGR_PSPJpeg(y3, cb, cr);
 			}
 		}
 		NotifyMemInfo(MemBlockFlags::READ, yCbCrAddr, sizeY + sizeCb + sizeCb, "JpegMJpegCsc");
 	} else {
 		for (int y = 0; y < height; ++y) {
-			for (int x = 0; x < width; ++x) {
-				u8 yy = Y[width * y + x];
-				u8 cb = Cb[(width >> 1) * (y >> 1) + (x >> 1)];
-				u8 cr = Cr[(width >> 1) * (y >> 1) + (x >> 1)];
-
-				imageBuffer[bufferWidth * y + x] = convertYCbCrToABGR(yy, cb, cr);
-			}
+			int chromaOffset = (width >> 1) * (y >> 1);
+			ConvertYCbCrRowPSPJpeg((u32 *)&imageBuffer[bufferWidth * y], Y + width * y, Cb + chromaOffset, Cr + chromaOffset, width, 1);
 		}
 		NotifyMemInfo(MemBlockFlags::READ, yCbCrAddr, sizeY + sizeCb + sizeCb, "JpegMJpegCsc");
 	}
@@ -75,6 +75,7 @@
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/HLE/sceMp3.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/HW/MediaEngine.h"
 #include "Core/HW/SimpleAudioDec.h"
 #include "Core/MemMap.h"
@@ -221,7 +222,11 @@ static int sceMp3Decode(u32 mp3, u32 outPcmPtr) {
 		return hleLogError(Log::ME, ERROR_MP3_NOT_YET_INIT_HANDLE, "not yet init");
 	}
 
-	int pcmBytes = ctx->AuDecode(outPcmPtr);
+	int pcmBytes;
+	{
+		AudioPerfScope perf(AudioPerfComponent::MP3_DECODE);
+		pcmBytes = ctx->AuDecode(outPcmPtr);
+	}
 	if (pcmBytes > 0) {
 		// decode data successfully, delay thread
 		return hleDelayResult(hleLogSuccessI(Log::ME, pcmBytes), "mp3 decode", mp3DecodeDelay);
@@ -744,7 +749,10 @@ static u32 sceMp3LowLevelDecode(u32 mp3, u32 sourceAddr, u32 sourceBytesConsumed
 	
 	int outSamples = 0;
 	int inbytesConsumed = 0;
-	ctx->decoder->Decode(inbuff, 4096, &inbytesConsumed, 2, outbuf, &outSamples);
+	{
+		AudioPerfScope perf(AudioPerfComponent::MP3_DECODE);
+		ctx->decoder->Decode(inbuff, 4096, &inbytesConsumed, 2, outbuf, &outSamples);
+	}
 	int outBytes = outSamples * sizeof(int16_t) * 2;
 	NotifyMemInfo(MemBlockFlags::WRITE, samplesAddr, outBytes, "Mp3LowLevelDecode");
 	
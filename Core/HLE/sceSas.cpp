@@ -41,6 +41,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/MIPS/MIPS.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/HW/SasAudio.h"
 #include "Core/MemMap.h"
 #include "Core/Reporting.h"
@@ -83,6 +84,7 @@ enum SasThreadState {
 	DISABLED,
 	READY,
 	QUEUED,
+	SPECULATING,
 };
 struct SasThreadParams {
 	u32 outAddr;
@@ -99,6 +101,8 @@ static std::condition_variable sasDone;
 static volatile int sasThreadState = SasThreadState::DISABLED;
 static SasThreadParams sasThreadParams;
 static int sasMixEvent = -1;
+// Only used with the SAS thread. It mixes the next grain while the game runs, see SasSpeculativeMix.
+static SasSpeculativeMix *sasSpeculation;
 
 int __SasThread() {
 	SetCurrentThreadName("SAS");
@@ -109,6 +113,12 @@ int __SasThread() {
 		if (sasThreadState == SasThreadState::QUEUED) {
 			sas->Mix(sasThreadParams.outAddr, sasThreadParams.inAddr, sasThreadParams.leftVol, sasThreadParams.rightVol);
 
+			std::lock_guard<std::mutex> doneGuard(sasDoneMutex);
+			sasThreadState = SasThreadState::READY;
+			sasDone.notify_one();
+		} else if (sasThreadState == SasThreadState::SPECULATING) {
+			sasSpeculation->Run();
+
 			std::lock_guard<std::mutex> doneGuard(sasDoneMutex);
 			sasThreadState = SasThreadState::READY;
 			sasDone.notify_one();
@@ -117,13 +127,37 @@ int __SasThread() {
 	return 0;
 }
 
-static void __SasDrain() {
+static void __SasDrain(SasThreadState busyState = SasThreadState::QUEUED) {
 	std::unique_lock<std::mutex> guard(sasDoneMutex);
-	while (sasThreadState == SasThreadState::QUEUED)
+	while (sasThreadState == busyState)
 		sasDone.wait(guard);
 }
 
+// Called when the mix finishes, in emulated time. The speculative mix doesn't touch sas, so nothing
+// needs to wait for it except the next mix.
+static void __SasStartSpeculation() {
+	if (!sasSpeculation || sasThreadState != SasThreadState::READY)
+		return;
+	if (!sasSpeculation->Prepare(*sas))
+		return;
+
+	sasWakeMutex.lock();
+	sasThreadState = SasThreadState::SPECULATING;
+	sasWake.notify_one();
+	sasWakeMutex.unlock();
+}
+
 static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0) {
+	if (sasSpeculation) {
+		__SasDrain(SasThreadState::SPECULATING);
+		if (sasSpeculation->Commit(*sas)) {
+			// The voices are already mixed, and the timing is still charged as usual by the caller.
+			AudioPerfScope perf(AudioPerfComponent::SAS_MIX, sasSpeculation->MixNanos());
+			sas->WriteOutput(outAddr, inAddr, leftVol, rightVol);
+			return;
+		}
+	}
+
 	if (sasThreadState == SasThreadState::DISABLED) {
 		// No thread, call it immediately.
 		sas->Mix(outAddr, inAddr, leftVol, rightVol);
@@ -150,6 +184,11 @@ static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int ri
 }
 
 static void __SasDisableThread() {
+	// Don't let the thread flip the state back to READY after we disable it.
+	__SasDrain(SasThreadState::SPECULATING);
+	delete sasSpeculation;
+	sasSpeculation = nullptr;
+
 	if (sasThreadState != SasThreadState::DISABLED) {
 		sasWakeMutex.lock();
 		sasThreadState = SasThreadState::DISABLED;
@@ -172,6 +211,7 @@ static void sasMixFinish(u64 userdata, int cycleslate) {
 	if (error == 0 && verify == 1) {
 		// Wait until it's actually complete before waking the thread.
 		__SasDrain();
+		__SasStartSpeculation();
 
 		__KernelResumeThreadFromWait(threadID, result);
 		__KernelReSchedule("woke from sas mix");
@@ -186,6 +226,9 @@ void __SasInit() {
 	sasMixEvent = CoreTiming::RegisterEvent("SasMix", sasMixFinish);
 
 	if (g_Config.bSeparateSASThread) {
+		if (g_Config.bSpeculativeSASMix) {
+			sasSpeculation = new SasSpeculativeMix();
+		}
 		sasThreadState = SasThreadState::READY;
 		sasThread = new std::thread(__SasThread);
 	} else {
@@ -22,12 +22,22 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Serialize/SerializeMap.h"
 #include "Common/Serialize/SerializeSet.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
 #include "Core/HW/AsyncIOManager.h"
 #include "Core/FileSystems/MetaFileSystem.h"
 
+// At most this many reads in flight through io_uring, more go to the thread.
+static const u32 RING_ENTRIES = 64;
+// Not a valid handle, used to wake up the completion thread.
+static const uint64_t RING_WAKE_UP = 0xFFFFFFFFFFFFFFFFULL;
+
+AsyncIOManager::~AsyncIOManager() {
+	StopRing();
+}
+
 bool AsyncIOManager::HasOperation(u32 handle) {
 	std::lock_guard<std::mutex> guard(resultsLock_);
 	if (resultsPending_.find(handle) != resultsPending_.end()) {
@@ -46,15 +56,139 @@ void AsyncIOManager::ScheduleOperation(const AsyncIOEvent &ev) {
 			ERROR_LOG_REPORT(Log::sceIo, "Scheduling operation for file %d while one is pending (type %d)", ev.handle, ev.type);
 		}
 	}
+	if (ev.type == IO_EVENT_READ && ScheduleHostRead(ev))
+		return;
 	ScheduleEvent(ev);
 }
 
+void AsyncIOManager::SyncOperation(u32 handle) {
+	SyncThread();
+	std::unique_lock<std::mutex> guard(resultsLock_);
+	while (HostReadPending(handle)) {
+		resultsWait_.wait(guard);
+	}
+}
+
 void AsyncIOManager::Shutdown() {
+	StopRing();
 	std::lock_guard<std::mutex> guard(resultsLock_);
 	resultsPending_.clear();
 	results_.clear();
 }
 
+bool AsyncIOManager::HostReadPending(u32 handle) {
+	// This is called under lock, no need to lock again.
+	return hostReads_.find(handle) != hostReads_.end();
+}
+
+bool AsyncIOManager::StartRing() {
+	if (ringState_ == RingState::UNTRIED) {
+		if (ring_.Init(RING_ENTRIES)) {
+			INFO_LOG(Log::sceIo, "Using io_uring for asynchronous reads");
+			ringFailed_ = false;
+			ringThread_ = std::thread(&AsyncIOManager::RingThread, this);
+			ringState_ = RingState::RUNNING;
+		} else {
+			ringState_ = RingState::UNAVAILABLE;
+		}
+	}
+	return ringState_ == RingState::RUNNING;
+}
+
+void AsyncIOManager::StopRing() {
+	if (ringState_ == RingState::RUNNING) {
+		// The reads point into PSP memory, they must be done before it goes away.
+		bool failed;
+		{
+			std::unique_lock<std::mutex> guard(resultsLock_);
+			while (!hostReads_.empty()) {
+				resultsWait_.wait(guard);
+			}
+			failed = ringFailed_;
+		}
+		if (!failed && !ring_.SubmitNop(RING_WAKE_UP)) {
+			// Make its wait fail instead, the rings stay mapped until it's gone.
+			WARN_LOG(Log::sceIo, "Unable to wake up the io_uring thread, interrupting it");
+			ring_.Interrupt();
+		}
+		ringThread_.join();
+		ring_.Shutdown();
+	}
+	// Might be available again next time, it's checked on the first read.
+	ringState_ = RingState::UNTRIED;
+}
+
+bool AsyncIOManager::ScheduleHostRead(const AsyncIOEvent &ev) {
+	// Without the thread, everything happens right away anyway.
+	if (!ThreadEnabled() || !StartRing())
+		return false;
+
+	HostRead read;
+	if (!pspFileSystem.BeginHostRead(ev.handle, ev.bytes, &read.file))
+		return false;
+	read.buf = ev.buf;
+	read.bytes = ev.bytes;
+	read.invalidateAddr = ev.invalidateAddr;
+
+	// Submit under the lock, so that the completion can't be handled before the read is known.
+	std::lock_guard<std::mutex> guard(resultsLock_);
+	if (ringFailed_ || hostReads_.size() >= RING_ENTRIES || HostReadPending(ev.handle))
+		return false;
+	hostReads_[ev.handle] = read;
+	if (!ring_.SubmitRead(read.file.fd, read.buf, (u32)read.file.size, read.file.offset, ev.handle)) {
+		hostReads_.erase(ev.handle);
+		return false;
+	}
+	return true;
+}
+
+void AsyncIOManager::RingThread() {
+	SetCurrentThreadName("IORing");
+
+	uint64_t userData;
+	int32_t res;
+	while (ring_.WaitCompletion(&userData, &res)) {
+		if (userData == RING_WAKE_UP)
+			return;
+
+		const u32 handle = (u32)userData;
+		HostRead read;
+		{
+			std::lock_guard<std::mutex> guard(resultsLock_);
+			read = hostReads_[handle];
+		}
+
+		s64 result;
+		int usec = 0;
+		if (res >= 0) {
+			result = res;
+			pspFileSystem.EndHostRead(handle, read.file, result);
+		} else {
+			// The position wasn't moved, so just let the file system handle the error as usual.
+			WARN_LOG(Log::sceIo, "io_uring read failed (%d), retrying normally", -res);
+			result = pspFileSystem.ReadFile(handle, read.buf, read.bytes, usec);
+		}
+
+		// Like EventResult, but the read must stop being pending at the same time.
+		std::lock_guard<std::mutex> guard(resultsLock_);
+		if (results_.find(handle) != results_.end()) {
+			ERROR_LOG_REPORT(Log::sceIo, "Overwriting previous result for file action on handle %d", handle);
+		}
+		results_[handle] = AsyncIOResult(result, usec, read.invalidateAddr);
+		hostReads_.erase(handle);
+		resultsWait_.notify_all();
+	}
+
+	// Shouldn't happen, but don't leave anyone waiting forever.
+	std::lock_guard<std::mutex> guard(resultsLock_);
+	ringFailed_ = true;
+	for (auto &it : hostReads_) {
+		results_[it.first] = AsyncIOResult(-1);
+	}
+	hostReads_.clear();
+	resultsWait_.notify_all();
+}
+
 bool AsyncIOManager::HasResult(u32 handle) {
 	std::lock_guard<std::mutex> guard(resultsLock_);
 	return results_.find(handle) != results_.end();
@@ -89,7 +223,7 @@ bool AsyncIOManager::ReadResult(u32 handle, AsyncIOResult &result) {
 bool AsyncIOManager::WaitResult(u32 handle, AsyncIOResult &result) {
 	std::unique_lock<std::mutex> guard(resultsLock_);
 	ScheduleEvent(IO_EVENT_SYNC);
-	while (HasEvents() && ThreadEnabled() && resultsPending_.find(handle) != resultsPending_.end()) {
+	while (((HasEvents() && ThreadEnabled()) || HostReadPending(handle)) && resultsPending_.find(handle) != resultsPending_.end()) {
 		if (PopResult(handle, result)) {
 			return true;
 		}
@@ -103,7 +237,7 @@ u64 AsyncIOManager::ResultFinishTicks(u32 handle) {
 
 	std::unique_lock<std::mutex> guard(resultsLock_);
 	ScheduleEvent(IO_EVENT_SYNC);
-	while (HasEvents() && ThreadEnabled() && resultsPending_.find(handle) != resultsPending_.end()) {
+	while (((HasEvents() && ThreadEnabled()) || HostReadPending(handle)) && resultsPending_.find(handle) != resultsPending_.end()) {
 		if (ReadResult(handle, result)) {
 			return result.finishTicks;
 		}
@@ -158,7 +292,10 @@ void AsyncIOManager::DoState(PointerWrap &p) {
 		return;
 
 	SyncThread();
-	std::lock_guard<std::mutex> guard(resultsLock_);
+	std::unique_lock<std::mutex> guard(resultsLock_);
+	while (!hostReads_.empty()) {
+		resultsWait_.wait(guard);
+	}
 	Do(p, resultsPending_);
 	if (s >= 2) {
 		Do(p, results_);
@@ -20,8 +20,11 @@
 #include <map>
 #include <set>
 #include <mutex>
+#include <thread>
 
+#include "Common/File/IOUring.h"
 #include "Core/Core.h"
+#include "Core/FileSystems/FileSystem.h"
 #include "Core/ThreadEventQueue.h"
 
 class NoBase {
@@ -81,10 +84,14 @@ struct AsyncIOResult {
 typedef ThreadEventQueue<NoBase, AsyncIOEvent, AsyncIOEventType, IO_EVENT_INVALID, IO_EVENT_SYNC, IO_EVENT_FINISH> IOThreadEventQueue;
 class AsyncIOManager : public IOThreadEventQueue {
 public:
+	~AsyncIOManager();
+
 	void DoState(PointerWrap &p);
 
 	bool HasOperation(u32 handle);
 	void ScheduleOperation(const AsyncIOEvent &ev);
+	// Waits until the operation on the file is done, so it can be used directly.
+	void SyncOperation(u32 handle);
 	void Shutdown();
 
 	bool HasResult(u32 handle);
@@ -105,8 +112,35 @@ class AsyncIOManager : public IOThreadEventQueue {
 
 	void EventResult(u32 handle, const AsyncIOResult &result);
 
+	// Reads of host files can go through io_uring where available, so several are in flight at once
+	// instead of one at a time on the thread. Everything else (and any read, without io_uring) uses the thread.
+	bool ScheduleHostRead(const AsyncIOEvent &ev);
+	bool StartRing();
+	void StopRing();
+	void RingThread();
+	bool HostReadPending(u32 handle);
+
+	struct HostRead {
+		HostFileRead file;
+		u8 *buf;
+		size_t bytes;
+		u32 invalidateAddr;
+	};
+
 	std::mutex resultsLock_;
 	std::condition_variable resultsWait_;
 	std::set<u32> resultsPending_;
 	std::map<u32, AsyncIOResult> results_;
+	// By handle, under resultsLock_.
+	std::map<u32, HostRead> hostReads_;
+	bool ringFailed_ = false;
+
+	enum class RingState {
+		UNTRIED,
+		RUNNING,
+		UNAVAILABLE,
+	};
+	RingState ringState_ = RingState::UNTRIED;
+	IOUring ring_;
+	std::thread ringThread_;
 };
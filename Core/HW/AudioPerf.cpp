@@ -0,0 +1,110 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/StringUtils.h"
+#include "Core/HW/AudioPerf.h"
+
+std::atomic<bool> g_audioPerfEnabled;
+
+struct AudioPerfCounters {
+	std::atomic<uint64_t> calls;
+	std::atomic<uint64_t> totalNanos;
+	std::atomic<uint64_t> maxNanos;
+};
+
+static AudioPerfCounters counters[(int)AudioPerfComponent::COUNT];
+
+static const char *const componentNames[] = {
+	"sas_mix",
+	"sas_reverb",
+	"atrac_decode",
+	"mp3_decode",
+	"resample",
+};
+static_assert(sizeof(componentNames) / sizeof(componentNames[0]) == (size_t)AudioPerfComponent::COUNT, "Missing audio perf component names");
+
+void AudioPerf_SetEnabled(bool enabled) {
+	g_audioPerfEnabled = enabled;
+}
+
+void AudioPerf_Reset() {
+	for (AudioPerfCounters &c : counters) {
+		c.calls = 0;
+		c.totalNanos = 0;
+		c.maxNanos = 0;
+	}
+}
+
+void AudioPerf_Record(AudioPerfComponent component, uint64_t nanos) {
+	AudioPerfCounters &c = counters[(int)component];
+	c.calls.fetch_add(1, std::memory_order_relaxed);
+	c.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+	uint64_t prevMax = c.maxNanos.load(std::memory_order_relaxed);
+	while (nanos > prevMax && !c.maxNanos.compare_exchange_weak(prevMax, nanos, std::memory_order_relaxed)) {
+	}
+}
+
+AudioPerfStats AudioPerf_GetStats(AudioPerfComponent component) {
+	const AudioPerfCounters &c = counters[(int)component];
+	AudioPerfStats stats;
+	stats.calls = c.calls.load(std::memory_order_relaxed);
+	stats.totalNanos = c.totalNanos.load(std::memory_order_relaxed);
+	stats.maxNanos = c.maxNanos.load(std::memory_order_relaxed);
+	return stats;
+}
+
+const char *AudioPerf_GetComponentName(AudioPerfComponent component) {
+	return componentNames[(int)component];
+}
+
+// The writer prints doubles at full precision, which is just noise here.
+static void WriteNumber(json::JsonWriter &writer, const char *name, double value) {
+	writer.writeRaw(name, StringFromFormat("%0.3f", value));
+}
+
+std::string AudioPerf_SummaryJSON(double emulatedSeconds, double wallSeconds) {
+	json::JsonWriter writer;
+	writer.begin();
+	WriteNumber(writer, "emulated_seconds", emulatedSeconds);
+	WriteNumber(writer, "wall_seconds", wallSeconds);
+
+	double totalMs = 0.0;
+	writer.pushDict("components");
+	for (int i = 0; i < (int)AudioPerfComponent::COUNT; i++) {
+		AudioPerfStats stats = AudioPerf_GetStats((AudioPerfComponent)i);
+		double ms = stats.totalNanos / 1000000.0;
+		// The reverb runs inside the SAS mix, don't count it twice.
+		if ((AudioPerfComponent)i != AudioPerfComponent::SAS_REVERB)
+			totalMs += ms;
+
+		writer.pushDict(componentNames[i]);
+		writer.writeUint("calls", (uint32_t)stats.calls);
+		WriteNumber(writer, "total_ms", ms);
+		WriteNumber(writer, "avg_us", stats.calls ? stats.totalNanos / 1000.0 / stats.calls : 0.0);
+		WriteNumber(writer, "max_us", stats.maxNanos / 1000.0);
+		// Share of one core needed to keep up in realtime.
+		WriteNumber(writer, "realtime_percent", emulatedSeconds > 0.0 ? ms / 10.0 / emulatedSeconds : 0.0);
+		writer.pop();
+	}
+	writer.pop();
+
+	WriteNumber(writer, "total_ms", totalMs);
+	WriteNumber(writer, "realtime_percent", emulatedSeconds > 0.0 ? totalMs / 10.0 / emulatedSeconds : 0.0);
+	writer.end();
+	return writer.str();
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Common/TimeUtil.h"
+
+// CPU time spent in each part of the audio pipeline, for benchmarking (see headless --audio-stats).
+// Unlike the frame profiler this is always compiled in. While disabled (the default) it costs a single
+// relaxed load per scope. Safe to use from any thread.
+
+enum class AudioPerfComponent {
+	// Voice mixing and output, including the reverb and any ATRAC3 voices.
+	SAS_MIX,
+	SAS_REVERB,
+	// sceAtrac decoding called by the game directly.
+	ATRAC_DECODE,
+	MP3_DECODE,
+	RESAMPLE,
+
+	COUNT,
+};
+
+struct AudioPerfStats {
+	uint64_t calls;
+	uint64_t totalNanos;
+	uint64_t maxNanos;
+};
+
+extern std::atomic<bool> g_audioPerfEnabled;
+
+void AudioPerf_SetEnabled(bool enabled);
+void AudioPerf_Reset();
+void AudioPerf_Record(AudioPerfComponent component, uint64_t nanos);
+AudioPerfStats AudioPerf_GetStats(AudioPerfComponent component);
+const char *AudioPerf_GetComponentName(AudioPerfComponent component);
+
+// emulatedSeconds is how much audio the measured run produced, to express the costs as a share of realtime.
+std::string AudioPerf_SummaryJSON(double emulatedSeconds, double wallSeconds);
+
+class AudioPerfScope {
+public:
+	// priorNanos is work for the same call that was already done elsewhere, like on another thread.
+	explicit AudioPerfScope(AudioPerfComponent component, uint64_t priorNanos = 0) : component_(component), priorNanos_(priorNanos) {
+		if (g_audioPerfEnabled.load(std::memory_order_relaxed))
+			start_ = time_now_d();
+	}
+	~AudioPerfScope() {
+		if (start_ >= 0.0)
+			AudioPerf_Record(component_, priorNanos_ + (uint64_t)((time_now_d() - start_) * 1000000000.0));
+	}
+
+	AudioPerfScope(const AudioPerfScope &) = delete;
+	AudioPerfScope &operator=(const AudioPerfScope &) = delete;
+
+private:
+	AudioPerfComponent component_;
+	uint64_t priorNanos_;
+	double start_ = -1.0;
+};
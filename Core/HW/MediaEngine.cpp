@@ -17,6 +17,8 @@
 
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Math/CrossSIMD.h"
+#include "Common/CPUDetect.h"
+#include "Common/Data/Convert/YUVConv.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/Debugger/MemBlockInfo.h"
@@ -77,6 +79,17 @@ static AVPixelFormat getSwsFormat(int pspFormat)
 	}
 }
 
+static YUVOutputFormat getYUVOutputFormat(int pspFormat) {
+	switch (pspFormat) {
+	case GE_CMODE_16BIT_BGR5650: return YUVOutputFormat::RGB565;
+	case GE_CMODE_16BIT_ABGR5551: return YUVOutputFormat::RGBA5551;
+	case GE_CMODE_16BIT_ABGR4444: return YUVOutputFormat::RGBA4444;
+	case GE_CMODE_32BIT_ABGR8888:
+	default:
+		return YUVOutputFormat::RGBA8888;
+	}
+}
+
 void ffmpeg_logger(void *, int level, const char *format, va_list va_args) {
 	// We're still called even if the level doesn't match.
 	if (level > av_log_get_level())
@@ -134,6 +147,9 @@ static int getPixelFormatBytes(int pspFormat)
 	}
 }
 
+// With frame threading, each thread adds a frame of latency.
+static const int MAX_VIDEO_DECODE_THREADS = 4;
+
 MediaEngine::MediaEngine() {
 	m_bufSize = 0x2000;
 
@@ -361,6 +377,8 @@ void MediaEngine::closeContext()
 		av_frame_free(&m_pFrameRGB);
 	if (m_pFrame)
 		av_frame_free(&m_pFrame);
+	if (m_pPendingFrame)
+		av_frame_free(&m_pPendingFrame);
 	if (m_pIOContext && m_pIOContext->buffer)
 		av_free(m_pIOContext->buffer);
 	if (m_pIOContext)
@@ -385,6 +403,7 @@ void MediaEngine::closeContext()
 	m_pIOContext = nullptr;
 #endif
 	m_buffer = nullptr;
+	m_pendingPixelMode = -1;
 }
 
 bool MediaEngine::loadStream(const u8 *buffer, int readSize, int RingbufferSize)
@@ -547,11 +566,21 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 		}
 #endif
 
-		m_pCodecCtx->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT | AV_CODEC_FLAG_LOW_DELAY;
+		m_pCodecCtx->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT;
 
 		AVDictionary *opt = nullptr;
-		// Allow ffmpeg to use any number of threads it wants.  Without this, it doesn't use threads.
-		av_dict_set(&opt, "threads", "0", 0);
+		if (g_Config.bMultithreadedVideoDecode) {
+			// PSMF video is almost always a single slice per frame, so only frame threading helps.
+			// That decodes the next few frames on FFmpeg's threads, but returns each one up to
+			// thread_count - 1 packets late, so we read further ahead in the ringbuffer than the game
+			// expects. Some games watch that closely, which is why this is opt-in.
+			m_pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+			m_pCodecCtx->thread_count = std::max(1, std::min(cpu_info.num_cores, MAX_VIDEO_DECODE_THREADS));
+		} else {
+			m_pCodecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+			// Allow ffmpeg to use any number of threads it wants.  Without this, it doesn't use threads.
+			av_dict_set(&opt, "threads", "0", 0);
+		}
 		int openResult = avcodec_open2(m_pCodecCtx, pCodec, &opt);
 		av_dict_free(&opt);
 		if (openResult < 0) {
@@ -590,6 +619,9 @@ bool MediaEngine::setVideoDim(int width, int height)
 	if (!m_pFrame) {
 		m_pFrame = av_frame_alloc();
 	}
+	if (!m_pPendingFrame) {
+		m_pPendingFrame = av_frame_alloc();
+	}
 
 	sws_freeContext(m_sws_ctx);
 	m_sws_ctx = nullptr;
@@ -658,6 +690,30 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 #endif
 }
 
+void MediaEngine::convertPendingFrame() {
+#ifdef USE_FFMPEG
+	if (m_pendingPixelMode == -1 || !m_pFrameRGB || !m_pPendingFrame->data[0])
+		return;
+
+	// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
+	// Update the linesize for the new format too.  We started with the largest size, so it should fit.
+	m_pFrameRGB->linesize[0] = getPixelFormatBytes(m_pendingPixelMode) * m_desWidth;
+
+	const AVFrame *frame = m_pPendingFrame;
+	if (frame->format == AV_PIX_FMT_YUV420P && frame->width == m_desWidth && frame->height == m_desHeight) {
+		// This is what PSMF always decodes to, and we never scale, so we can skip swscale.
+		ConvertYUV420ToRGB_BT601(getYUVOutputFormat(m_pendingPixelMode), m_pFrameRGB->data[0], m_pFrameRGB->linesize[0],
+			frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1], frame->data[2], frame->linesize[2],
+			frame->width, frame->height);
+	} else {
+		updateSwsFormat(m_pendingPixelMode);
+		sws_scale(m_sws_ctx, frame->data, frame->linesize, 0, frame->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+	}
+	av_frame_unref(m_pPendingFrame);
+#endif
+	m_pendingPixelMode = -1;
+}
+
 bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #ifdef USE_FFMPEG
 	auto codecIter = m_pCodecCtxs.find(m_videoStream);
@@ -689,8 +745,18 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #endif
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
-			if (packet.size != 0)
-				avcodec_send_packet(m_pCodecCtx, &packet);
+			if (packet.size != 0) {
+				if (avcodec_send_packet(m_pCodecCtx, &packet) == AVERROR_EOF) {
+					// We drained below, but more data showed up after all.
+					avcodec_flush_buffers(m_pCodecCtx);
+					avcodec_send_packet(m_pCodecCtx, &packet);
+				}
+			} else if ((m_pCodecCtx->active_thread_type & FF_THREAD_FRAME) && m_pdata->getQueueSize() == 0) {
+				// Frame threading holds the last few frames back until more packets arrive.  If we're
+				// about to run out of video, ask for them now.  Otherwise the game is just slow to feed us.
+				if (m_videopts + 3003 * m_pCodecCtx->thread_count >= m_lastTimeStamp - m_firstTimeStamp)
+					avcodec_send_packet(m_pCodecCtx, nullptr);
+			}
 			int result = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
 			if (result == 0) {
 				result = m_pFrame->pkt_size;
@@ -708,16 +774,6 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				if (!m_pFrameRGB) {
 					setVideoDim();
 				}
-				if (m_pFrameRGB && !skipFrame) {
-					updateSwsFormat(videoPixelMode);
-					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
-					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
-					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
-
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
-						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-				}
-
 #if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
 				int64_t bestPts = m_pFrame->best_effort_timestamp;
 				int64_t ptsDuration = m_pFrame->pkt_duration;
@@ -740,6 +796,18 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 					m_videopts += ptsDuration;
 					m_lastPts = m_videopts;
 				}
+				if (m_pFrameRGB && !skipFrame) {
+					// Hold on to the frame and convert it when (and if) it's written out.  Games often
+					// decode frames they never display, and this also keeps the conversion off the
+					// decode path.  Skipped frames leave the previous picture in place.
+					av_frame_unref(m_pPendingFrame);
+					av_frame_move_ref(m_pPendingFrame, m_pFrame);
+					m_pendingPixelMode = videoPixelMode;
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
+					// With the old API, the frame data is only valid until the next decode call.
+					convertPendingFrame();
+#endif
+				}
 				bGetFrame = true;
 			}
 			if (result <= 0 && dataEnd) {
@@ -856,6 +924,7 @@ int MediaEngine::writeVideoImage(u32 bufferPtr, int frameWidth, int videoPixelMo
 #ifdef USE_FFMPEG
 	if (!m_pFrame || !m_pFrameRGB)
 		return 0;
+	convertPendingFrame();
 
 	// lock the image size
 	int height = m_desHeight;
@@ -945,6 +1014,7 @@ int MediaEngine::writeVideoImageWithRange(u32 bufferPtr, int frameWidth, int vid
 #ifdef USE_FFMPEG
 	if (!m_pFrame || !m_pFrameRGB)
 		return 0;
+	convertPendingFrame();
 
 	// lock the image size
 	u8 *imgbuf = buffer;
@@ -1022,6 +1092,7 @@ int MediaEngine::writeVideoImageWithRange(u32 bufferPtr, int frameWidth, int vid
 
 u8 *MediaEngine::getFrameImage() {
 #ifdef USE_FFMPEG
+	convertPendingFrame();
 	return m_pFrameRGB->data[0];
 #else
 	return nullptr;
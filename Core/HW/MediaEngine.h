@@ -97,6 +97,7 @@ class MediaEngine {
 	bool SetupStreams();
 	bool setVideoDim(int width = 0, int height = 0);
 	void updateSwsFormat(int videoPixelMode);
+	void convertPendingFrame();
 	int getNextAudioFrame(u8 **buf, int *headerCode1, int *headerCode2);
 
 	static int MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size);
@@ -106,6 +107,8 @@ class MediaEngine {
 #ifdef USE_FFMPEG
 	std::map<int, AVCodecContext *> m_pCodecCtxs;
 	AVFrame *m_pFrame = nullptr;
+	// The last frame stepVideo() returned, until writeVideoImage() converts it into m_pFrameRGB.
+	AVFrame *m_pPendingFrame = nullptr;
 	AVFrame *m_pFrameRGB = nullptr;
 #endif
 
@@ -131,6 +134,8 @@ class MediaEngine {
 #endif
 
 	int m_sws_fmt = 0;
+	// Pixel mode to convert m_pPendingFrame to, or -1 if m_pFrameRGB is up to date.
+	int m_pendingPixelMode = -1;
 	int m_videoStream = -1;
 	int m_expectedVideoStreams = 0;
 
@@ -17,12 +17,16 @@
 
 #include <algorithm>
 
+#include "ext/xxhash.h"
+#include "Common/Math/CrossSIMD.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/MemMapHelpers.h"
 #include "Core/HLE/sceAtrac.h"
 #include "Core/Config.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/Reporting.h"
 #include "Core/Util/AudioFormat.h"
 #include "Core/Core.h"
@@ -49,6 +53,27 @@ static const u8 f[16][2] = {
 	{   0, 151 },
 };
 
+void SasReadLog::Clear() {
+	ranges_.clear();
+	hash_ = 0;
+}
+
+void SasReadLog::Add(u32 addr, const void *data, u32 size) {
+	ranges_.emplace_back(addr, size);
+	hash_ = XXH3_64bits_withSeed(data, size, hash_);
+}
+
+bool SasReadLog::Matches() const {
+	u64 hash = 0;
+	for (const auto &range : ranges_) {
+		const u8 *data = Memory::GetPointerRange(range.first, range.second);
+		if (!data)
+			return false;
+		hash = XXH3_64bits_withSeed(data, range.second, hash);
+	}
+	return hash == hash_;
+}
+
 void VagDecoder::Start(u32 data, u32 vagSize, bool loopEnabled) {
 	loopEnabled_ = loopEnabled;
 	loopAtNextBlock_ = false;
@@ -63,6 +88,47 @@ void VagDecoder::Start(u32 data, u32 vagSize, bool loopEnabled) {
 	s_2 = 0;
 }
 
+// Expands the 28 4-bit samples of a VAG block to 16 bits and applies the shift. Unlike the prediction
+// filter this doesn't depend on previous samples, so it can be done for the whole block at once.
+// out needs room for 32 samples.
+static void UnpackVagNibbles(s16 *out, const u8 *data, int shift_factor) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	// The data is only 14 bytes, don't read past the block.
+	u8 temp[16]{};
+	memcpy(temp, data, 14);
+#endif
+#if PPSSPP_ARCH(SSE2)
+	const __m128i bytes = _mm_loadu_si128((const __m128i *)temp);
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i lo = _mm_and_si128(bytes, mask);
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+	// Low nibble first, then put each nibble in the top 4 bits of a 16-bit lane and shift down.
+	const __m128i nibs0 = _mm_unpacklo_epi8(lo, hi);
+	const __m128i nibs1 = _mm_unpackhi_epi8(lo, hi);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shift = _mm_cvtsi32_si128(shift_factor);
+	_mm_storeu_si128((__m128i *)out + 0, _mm_sra_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(zero, nibs0), 4), shift));
+	_mm_storeu_si128((__m128i *)out + 1, _mm_sra_epi16(_mm_slli_epi16(_mm_unpackhi_epi8(zero, nibs0), 4), shift));
+	_mm_storeu_si128((__m128i *)out + 2, _mm_sra_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(zero, nibs1), 4), shift));
+	_mm_storeu_si128((__m128i *)out + 3, _mm_sra_epi16(_mm_slli_epi16(_mm_unpackhi_epi8(zero, nibs1), 4), shift));
+#elif PPSSPP_ARCH(ARM_NEON)
+	const uint8x16_t bytes = vld1q_u8(temp);
+	const uint8x16x2_t nibs = vzipq_u8(vandq_u8(bytes, vdupq_n_u8(0x0F)), vshrq_n_u8(bytes, 4));
+	// A negative shift count is an arithmetic right shift.
+	const int16x8_t shift = vdupq_n_s16(-shift_factor);
+	vst1q_s16(out + 0, vshlq_s16(vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(vget_low_u8(nibs.val[0])), 12)), shift));
+	vst1q_s16(out + 8, vshlq_s16(vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(vget_high_u8(nibs.val[0])), 12)), shift));
+	vst1q_s16(out + 16, vshlq_s16(vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(vget_low_u8(nibs.val[1])), 12)), shift));
+	vst1q_s16(out + 24, vshlq_s16(vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(vget_high_u8(nibs.val[1])), 12)), shift));
+#else
+	for (int i = 0; i < 14; i++) {
+		u8 d = data[i];
+		out[i * 2] = (short)((d & 0xf) << 12) >> shift_factor;
+		out[i * 2 + 1] = (short)((d & 0xf0) << 8) >> shift_factor;
+	}
+#endif
+}
+
 void VagDecoder::DecodeBlock(const u8 *&read_pointer) {
 	if (curBlock_ == numBlocks_ - 1) {
 		end_ = true;
@@ -97,13 +163,14 @@ void VagDecoder::DecodeBlock(const u8 *&read_pointer) {
 	int coef1 = f[predict_nr][0];
 	int coef2 = -f[predict_nr][1];
 
-	// TODO: Unroll once more and interleave the unpacking with the decoding more?
+	s16 unpacked[32];
+	UnpackVagNibbles(unpacked, readp, shift_factor);
+	readp += 14;
+
+	// The prediction filter is inherently serial.
 	for (int i = 0; i < 28; i += 2) {
-		u8 d = *readp++;
-		int sample1 = (short)((d & 0xf) << 12) >> shift_factor;
-		int sample2 = (short)((d & 0xf0) << 8) >> shift_factor;
-		s2 = clamp_s16(sample1 + ((s1 * coef1 + s2 * coef2) >> 6));
-		s1 = clamp_s16(sample2 + ((s2 * coef1 + s1 * coef2) >> 6));
+		s2 = clamp_s16(unpacked[i] + ((s1 * coef1 + s2 * coef2) >> 6));
+		s1 = clamp_s16(unpacked[i + 1] + ((s2 * coef1 + s1 * coef2) >> 6));
 		samples[i] = s2;
 		samples[i + 1] = s1;
 	}
@@ -116,7 +183,7 @@ void VagDecoder::DecodeBlock(const u8 *&read_pointer) {
 	read_pointer = readp;
 }
 
-void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
+void VagDecoder::GetSamples(s16 *outSamples, int numSamples, SasReadLog *readLog) {
 	if (end_) {
 		memset(outSamples, 0, numSamples * sizeof(s16));
 		return;
@@ -129,7 +196,8 @@ void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
 	const u8 *readp = Memory::GetPointerUnchecked(read_);
 	const u8 *origp = readp;
 
-	for (int i = 0; i < numSamples; i++) {
+	int i = 0;
+	while (i < numSamples) {
 		if (curSample == 28) {
 			if (loopAtNextBlock_) {
 				VERBOSE_LOG(Log::SasMix, "Looping VAG from block %d/%d to %d", curBlock_, numBlocks_, loopStartBlock_);
@@ -140,7 +208,17 @@ void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
 				curBlock_ = loopStartBlock_;
 				loopAtNextBlock_ = false;
 			}
-			DecodeBlock(readp);
+			if (readLog && curBlock_ < numBlocks_ - 1) {
+				// Decode from a copy, so the logged bytes are exactly the ones used.
+				u8 block[16];
+				memcpy(block, readp, sizeof(block));
+				readLog->Add(read_ + (u32)(readp - origp), block, sizeof(block));
+				const u8 *blockp = block;
+				DecodeBlock(blockp);
+				readp += blockp - block;
+			} else {
+				DecodeBlock(readp);
+			}
 			if (end_) {
 				// Clear the rest of the buffer and return.
 				memset(&outSamples[i], 0, (numSamples - i) * sizeof(s16));
@@ -148,7 +226,11 @@ void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
 			}
 		}
 		_dbg_assert_(curSample < 28);
-		outSamples[i] = samples[curSample++];
+		// Copy as much of the decoded block as we can at once.
+		int count = std::min(28 - curSample, numSamples - i);
+		memcpy(&outSamples[i], &samples[curSample], count * sizeof(s16));
+		curSample += count;
+		i += count;
 	}
 
 	if (readp > origp) {
@@ -462,11 +544,11 @@ int SasInstance::EstimateMixUs() {
 	return std::min(cycles, 1200);
 }
 
-void SasVoice::ReadSamples(s16 *output, int numSamples) {
+void SasVoice::ReadSamples(s16 *output, int numSamples, SasReadLog *readLog) {
 	// Read N samples into the resample buffer. Could do either PCM or VAG here.
 	switch (type) {
 	case VOICETYPE_VAG:
-		vag.GetSamples(output, numSamples);
+		vag.GetSamples(output, numSamples, readLog);
 		break;
 	case VOICETYPE_PCM:
 		{
@@ -479,6 +561,8 @@ void SasVoice::ReadSamples(s16 *output, int numSamples) {
 					break;
 				}
 				Memory::Memcpy(out, pcmAddr + pcmIndex * sizeof(s16), size * sizeof(s16), "SasVoicePCM");
+				if (readLog)
+					readLog->Add(pcmAddr + pcmIndex * sizeof(s16), out, size * sizeof(s16));
 				pcmIndex += size;
 				needed -= size;
 				out += size;
@@ -520,7 +604,87 @@ bool SasVoice::HaveSamplesEnded() const {
 	}
 }
 
-void SasInstance::MixVoice(SasVoice &voice) {
+u32 SasResampleLinear(s16 *out, const s16 *in, u32 sampleFrac, int pitch, int count) {
+	if (pitch == PSP_SAS_PITCH_BASE && (sampleFrac & PSP_SAS_PITCH_MASK) == 0) {
+		memcpy(out, in + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT), count * sizeof(s16));
+		return sampleFrac + count * pitch;
+	}
+
+	for (int i = 0; i < count; i++) {
+		const s16 *s = in + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+		// Linear interpolation. Good enough. Need to make resampleHist bigger if we want more.
+		// Note that this never quite reaches s[1], and is used even when f is 0 - matches hardware.
+		int f = sampleFrac & PSP_SAS_PITCH_MASK;
+		out[i] = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+		sampleFrac += pitch;
+	}
+	return sampleFrac;
+}
+
+#if PPSSPP_ARCH(SSE2)
+// SSE2 has no _mm_mullo_epi32. The low 32 bits of the product are the same whether signed or not.
+static inline __m128i MulLo32(__m128i a, __m128i b) {
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+void SasMixVoiceSamples(s32 *mix, s32 *send, const s16 *samples, const s32 *envelope, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i round = _mm_set1_epi32(1 << 14);
+	const __m128i volume = _mm_setr_epi32(volumeLeft, volumeRight, volumeLeft, volumeRight);
+	const __m128i effect = _mm_setr_epi32(effectLeft, effectRight, effectLeft, effectRight);
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadl_epi64((const __m128i *)(samples + i));
+		s = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i sample = _mm_srai_epi32(_mm_add_epi32(MulLo32(s, _mm_loadu_si128((const __m128i *)(envelope + i))), round), 15);
+		// Duplicate each sample for left and right.
+		__m128i sample01 = _mm_unpacklo_epi32(sample, sample);
+		__m128i sample23 = _mm_unpackhi_epi32(sample, sample);
+		__m128i *mixp = (__m128i *)(mix + i * 2);
+		__m128i *sendp = (__m128i *)(send + i * 2);
+		_mm_storeu_si128(mixp, _mm_add_epi32(_mm_loadu_si128(mixp), _mm_srai_epi32(MulLo32(sample01, volume), 12)));
+		_mm_storeu_si128(mixp + 1, _mm_add_epi32(_mm_loadu_si128(mixp + 1), _mm_srai_epi32(MulLo32(sample23, volume), 12)));
+		_mm_storeu_si128(sendp, _mm_add_epi32(_mm_loadu_si128(sendp), _mm_srai_epi32(MulLo32(sample01, effect), 12)));
+		_mm_storeu_si128(sendp + 1, _mm_add_epi32(_mm_loadu_si128(sendp + 1), _mm_srai_epi32(MulLo32(sample23, effect), 12)));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int32x4_t round = vdupq_n_s32(1 << 14);
+	const int32_t volumeLR[4] = { volumeLeft, volumeRight, volumeLeft, volumeRight };
+	const int32_t effectLR[4] = { effectLeft, effectRight, effectLeft, effectRight };
+	const int32x4_t volume = vld1q_s32(volumeLR);
+	const int32x4_t effect = vld1q_s32(effectLR);
+	for (; i + 4 <= count; i += 4) {
+		int32x4_t s = vmovl_s16(vld1_s16(samples + i));
+		int32x4_t sample = vshrq_n_s32(vaddq_s32(vmulq_s32(s, vld1q_s32(envelope + i)), round), 15);
+		// Duplicate each sample for left and right.
+		int32x4x2_t dup = vzipq_s32(sample, sample);
+		s32 *mixp = mix + i * 2;
+		s32 *sendp = send + i * 2;
+		vst1q_s32(mixp, vaddq_s32(vld1q_s32(mixp), vshrq_n_s32(vmulq_s32(dup.val[0], volume), 12)));
+		vst1q_s32(mixp + 4, vaddq_s32(vld1q_s32(mixp + 4), vshrq_n_s32(vmulq_s32(dup.val[1], volume), 12)));
+		vst1q_s32(sendp, vaddq_s32(vld1q_s32(sendp), vshrq_n_s32(vmulq_s32(dup.val[0], effect), 12)));
+		vst1q_s32(sendp + 4, vaddq_s32(vld1q_s32(sendp + 4), vshrq_n_s32(vmulq_s32(dup.val[1], effect), 12)));
+	}
+#endif
+	for (; i < count; i++) {
+		// We just scale by the envelope before we scale by volumes.
+		// Again, we round up by adding (1 << 14) first (*after* multiplying.)
+		int sample = ((samples[i] * envelope[i]) + (1 << 14)) >> 15;
+
+		// We mix into this 32-bit temp buffer and clip in a second loop
+		// Ideally, the shift right should be there too but for now I'm concerned about
+		// not overflowing.
+		mix[i * 2] += (sample * volumeLeft) >> 12;
+		mix[i * 2 + 1] += (sample * volumeRight) >> 12;
+		send[i * 2] += sample * effectLeft >> 12;
+		send[i * 2 + 1] += sample * effectRight >> 12;
+	}
+}
+
+void SasInstance::MixVoice(SasVoice &voice, SasReadLog *readLog) {
 	switch (voice.type) {
 	case VOICETYPE_VAG:
 		if (voice.type == VOICETYPE_VAG && !voice.vagAddr)
@@ -561,7 +725,7 @@ void SasInstance::MixVoice(SasVoice &voice) {
 			readPos = 0;
 			samplesToRead += 2;
 		}
-		voice.ReadSamples(&mixTemp_[readPos], samplesToRead);
+		voice.ReadSamples(&mixTemp_[readPos], samplesToRead, readLog);
 		int tempPos = readPos + samplesToRead;
 
 		for (int i = 0; i < delay; ++i) {
@@ -570,35 +734,19 @@ void SasInstance::MixVoice(SasVoice &voice) {
 			voice.envelope.Step();
 		}
 
-		const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
-		for (int i = delay; i < grainSize; i++) {
-			const int16_t *s = mixTemp_ + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+		// Each stage runs over the whole grain, so the resampling and mixing loops can be vectorized.
+		const int count = grainSize - delay;
+		if (count > 0) {
+			sampleFrac = SasResampleLinear(resampleTemp_, mixTemp_, sampleFrac, voicePitch, count);
 
-			// Linear interpolation. Good enough. Need to make resampleHist bigger if we want more.
-			int sample = s[0];
-			if (needsInterp) {
-				int f = sampleFrac & PSP_SAS_PITCH_MASK;
-				sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+			for (int i = 0; i < count; i++) {
+				// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
+				// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
+				envelopeTemp_[i] = (voice.envelope.GetHeight() + (1 << 14)) >> 15;
+				voice.envelope.Step();
 			}
-			sampleFrac += voicePitch;
 
-			// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
-			// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
-			int envelopeValue = voice.envelope.GetHeight();
-			voice.envelope.Step();
-			envelopeValue = (envelopeValue + (1 << 14)) >> 15;
-
-			// We just scale by the envelope before we scale by volumes.
-			// Again, we round up by adding (1 << 14) first (*after* multiplying.)
-			sample = ((sample * envelopeValue) + (1 << 14)) >> 15;
-
-			// We mix into this 32-bit temp buffer and clip in a second loop
-			// Ideally, the shift right should be there too but for now I'm concerned about
-			// not overflowing.
-			mixBuffer[i * 2] += (sample * voice.volumeLeft) >> 12;
-			mixBuffer[i * 2 + 1] += (sample * voice.volumeRight) >> 12;
-			sendBuffer[i * 2] += sample * voice.effectLeft >> 12;
-			sendBuffer[i * 2 + 1] += sample * voice.effectRight >> 12;
+			SasMixVoiceSamples(mixBuffer + delay * 2, sendBuffer + delay * 2, resampleTemp_, envelopeTemp_, count, voice.volumeLeft, voice.volumeRight, voice.effectLeft, voice.effectRight);
 		}
 
 		voice.resampleHist[0] = mixTemp_[tempPos - 2];
@@ -617,14 +765,22 @@ void SasInstance::MixVoice(SasVoice &voice) {
 }
 
 void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
+	AudioPerfScope perf(AudioPerfComponent::SAS_MIX);
+	MixVoices();
+	WriteOutput(outAddr, inAddr, leftVol, rightVol);
+}
+
+void SasInstance::MixVoices(SasReadLog *readLog) {
 	for (int v = 0; v < PSP_SAS_VOICES_MAX; v++) {
 		SasVoice &voice = voices[v];
 		if (!voice.playing || voice.paused)
 			continue;
-		MixVoice(voice);
+		MixVoice(voice, readLog);
 	}
+}
 
-	// Then mix the send buffer in with the rest.
+void SasInstance::WriteOutput(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
+	// Mix the send buffer in with the rest.
 
 	// Alright, all voices mixed. Let's convert and clip, and at the same time, wipe mixBuffer for next time. Could also dither.
 	s16 *outp = (s16 *)Memory::GetPointerWriteRange(outAddr, 4 * grainSize);
@@ -657,6 +813,38 @@ void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
 	memset(sendBuffer, 0, grainSize * sizeof(int) * 2);
 }
 
+// Adds the processed send buffer (if any) and clamps to 16 bits.
+static void ClampMixedOutput(s16 *outp, const s32 *dry, const s16 *wet, int count) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(dry + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(dry + i + 4));
+		if (wet) {
+			__m128i wet16 = _mm_loadu_si128((const __m128i *)(wet + i));
+			lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(wet16, wet16), 16));
+			hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(wet16, wet16), 16));
+		}
+		// The pack saturates, just like clamp_s16.
+		_mm_storeu_si128((__m128i *)(outp + i), _mm_packs_epi32(lo, hi));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	for (; i + 8 <= count; i += 8) {
+		int32x4_t lo = vld1q_s32(dry + i);
+		int32x4_t hi = vld1q_s32(dry + i + 4);
+		if (wet) {
+			int16x8_t wet16 = vld1q_s16(wet + i);
+			lo = vaddq_s32(lo, vmovl_s16(vget_low_s16(wet16)));
+			hi = vaddq_s32(hi, vmovl_s16(vget_high_s16(wet16)));
+		}
+		vst1q_s16(outp + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+#endif
+	for (; i < count; i++) {
+		outp[i] = clamp_s16(wet ? dry[i] + wet[i] : dry[i]);
+	}
+}
+
 void SasInstance::WriteMixedOutput(s16 *outp, const s16 *inp, int leftVol, int rightVol) {
 	const bool dry = waveformEffect.isDryOn != 0;
 	const bool wet = waveformEffect.isWetOn != 0;
@@ -682,15 +870,9 @@ void SasInstance::WriteMixedOutput(s16 *outp, const s16 *inp, int leftVol, int r
 	} else {
 		// These are the optimal cases.
 		if (dry && wet) {
-			for (int i = 0; i < grainSize * 2; i += 2) {
-				*outp++ = clamp_s16(mixBuffer[i + 0] + sendBufferProcessed[i + 0]);
-				*outp++ = clamp_s16(mixBuffer[i + 1] + sendBufferProcessed[i + 1]);
-			}
+			ClampMixedOutput(outp, mixBuffer, sendBufferProcessed, grainSize * 2);
 		} else if (dry) {
-			for (int i = 0; i < grainSize * 2; i += 2) {
-				*outp++ = clamp_s16(mixBuffer[i + 0]);
-				*outp++ = clamp_s16(mixBuffer[i + 1]);
-			}
+			ClampMixedOutput(outp, mixBuffer, nullptr, grainSize * 2);
 		} else {
 			// This is another uncommon case, dry must be off but let's keep it for clarity.
 			for (int i = 0; i < grainSize * 2; i += 2) {
@@ -777,6 +959,81 @@ void SasInstance::DoState(PointerWrap &p) {
 	}
 }
 
+void SasInstance::DoVoiceState(PointerWrap &p) {
+	int size = grainSize;
+	Do(p, size);
+	if (p.mode == p.MODE_READ && size != grainSize) {
+		if (size > 0) {
+			SetGrainSize(size);
+		} else {
+			ClearGrainSize();
+		}
+	}
+	DoArray(p, voices, ARRAY_SIZE(voices));
+}
+
+// CChunkFileReader wants a DoState().
+struct SasVoiceStateWrapper {
+	SasInstance *sas;
+	void DoState(PointerWrap &p) {
+		sas->DoVoiceState(p);
+	}
+};
+
+bool SasSpeculativeMix::Prepare(SasInstance &sas) {
+	ready_ = false;
+	if (sas.GetGrainSize() <= 0)
+		return false;
+	for (const SasVoice &voice : sas.voices) {
+		// ATRAC3 voices decode through sceAtrac, which has its own state.
+		if (voice.playing && !voice.paused && voice.type == VOICETYPE_ATRAC3)
+			return false;
+	}
+
+	SasVoiceStateWrapper wrapper{ &sas };
+	return CChunkFileReader::MeasureAndSavePtr(wrapper, &inputState_) == CChunkFileReader::ERROR_NONE;
+}
+
+void SasSpeculativeMix::Run() {
+	SasVoiceStateWrapper wrapper{ &instance_ };
+	std::string errorString;
+	if (CChunkFileReader::LoadPtr(inputState_.data(), wrapper, &errorString) != CChunkFileReader::ERROR_NONE) {
+		ERROR_LOG(Log::SasMix, "Failed to load speculative SAS state: %s", errorString.c_str());
+		return;
+	}
+
+	const int grainSize = instance_.GetGrainSize();
+	memset(instance_.mixBuffer, 0, grainSize * sizeof(int) * 2);
+	memset(instance_.sendBuffer, 0, grainSize * sizeof(int) * 2);
+	readLog_.Clear();
+	const double start = g_audioPerfEnabled.load(std::memory_order_relaxed) ? time_now_d() : -1.0;
+	instance_.MixVoices(&readLog_);
+	mixNanos_ = start >= 0.0 ? (uint64_t)((time_now_d() - start) * 1000000000.0) : 0;
+
+	ready_ = CChunkFileReader::MeasureAndSavePtr(wrapper, &outputState_) == CChunkFileReader::ERROR_NONE;
+}
+
+bool SasSpeculativeMix::Commit(SasInstance &sas) {
+	if (!ready_)
+		return false;
+	ready_ = false;
+
+	// Any change the game made to the voices since Prepare() shows up here.
+	SasVoiceStateWrapper wrapper{ &sas };
+	if (CChunkFileReader::MeasureAndSavePtr(wrapper, &currentState_) != CChunkFileReader::ERROR_NONE)
+		return false;
+	if (currentState_ != inputState_ || !readLog_.Matches())
+		return false;
+
+	std::string errorString;
+	if (CChunkFileReader::LoadPtr(outputState_.data(), wrapper, &errorString) != CChunkFileReader::ERROR_NONE)
+		return false;
+	// The buffers in sas are already cleared, and Run() clears them before reuse.
+	std::swap(sas.mixBuffer, instance_.mixBuffer);
+	std::swap(sas.sendBuffer, instance_.sendBuffer);
+	return true;
+}
+
 void SasVoice::Reset() {
 	resampleHist[0] = 0;
 	resampleHist[1] = 0;
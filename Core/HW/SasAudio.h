@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/BufferQueue.h"
 #include "Core/HW/SasReverb.h"
@@ -98,6 +101,20 @@ enum VoiceType {
 	VOICETYPE_ATRAC3,
 };
 
+// Records the PSP memory a mix read from, so that a mix done ahead of time can be checked against
+// the memory as it is later. Adds must be given the bytes that were actually used.
+class SasReadLog {
+public:
+	void Clear();
+	void Add(u32 addr, const void *data, u32 size);
+	// Whether the logged ranges still hold the same bytes.
+	bool Matches() const;
+
+private:
+	std::vector<std::pair<u32, u32>> ranges_;
+	u64 hash_ = 0;
+};
+
 // VAG is a Sony ADPCM audio compression format, which goes all the way back to the PSX.
 // It compresses 28 16-bit samples into a block of 16 bytes.
 class VagDecoder {
@@ -107,7 +124,7 @@ class VagDecoder {
 	}
 	void Start(u32 dataPtr, u32 vagSize, bool loopEnabled);
 
-	void GetSamples(s16 *outSamples, int numSamples);
+	void GetSamples(s16 *outSamples, int numSamples, SasReadLog *readLog = nullptr);
 
 	void DecodeBlock(const u8 *&readp);
 	bool End() const { return end_; }
@@ -246,7 +263,7 @@ struct SasVoice {
 
 	void DoState(PointerWrap &p);
 
-	void ReadSamples(s16 *output, int numSamples);
+	void ReadSamples(s16 *output, int numSamples, SasReadLog *readLog = nullptr);
 	bool HaveSamplesEnded() const;
 
 	// For debugging.
@@ -293,6 +310,12 @@ struct SasVoice {
 	SasAtrac3 atrac3;
 };
 
+// The per-sample work of SasInstance::MixVoice, split into loops over a whole grain.
+// Resamples count samples from in, starting at sampleFrac (in 1/4096ths), and returns the new position.
+u32 SasResampleLinear(s16 *out, const s16 *in, u32 sampleFrac, int pitch, int count);
+// Scales samples by the (15-bit) envelope, then accumulates them with the volumes into interleaved stereo buffers.
+void SasMixVoiceSamples(s32 *mix, s32 *send, const s16 *samples, const s32 *envelope, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight);
+
 class SasInstance {
 public:
 	SasInstance();
@@ -315,7 +338,10 @@ class SasInstance {
 	FILE *audioDump = nullptr;
 
 	void Mix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0);
-	void MixVoice(SasVoice &voice);
+	// The two halves of Mix(). MixVoices() only depends on the voices and the sample data.
+	void MixVoices(SasReadLog *readLog = nullptr);
+	void WriteOutput(u32 outAddr, u32 inAddr, int leftVol, int rightVol);
+	void MixVoice(SasVoice &voice, SasReadLog *readLog = nullptr);
 
 	// Applies reverb to send buffer, according to waveformEffect.
 	void ApplyWaveformEffect();
@@ -325,6 +351,8 @@ class SasInstance {
 	void GetDebugText(char *text, size_t bufsize);
 
 	void DoState(PointerWrap &p);
+	// Just the state that MixVoices() uses and changes.
+	void DoVoiceState(PointerWrap &p);
 
 	SasVoice voices[PSP_SAS_VOICES_MAX];
 	WaveformEffect waveformEffect;
@@ -333,6 +361,33 @@ class SasInstance {
 	SasReverb reverb_;
 	int grainSize = 0;
 	int16_t mixTemp_[PSP_SAS_MAX_GRAIN * 4 + 2 + 16];  // some extra margin for very high pitches.
+	int16_t resampleTemp_[PSP_SAS_MAX_GRAIN];
+	int32_t envelopeTemp_[PSP_SAS_MAX_GRAIN];
 };
 
 const char *ADSRCurveModeAsString(SasADSRCurveMode mode);
+
+// Mixes the voices of the next grain ahead of time, so it can be done on another thread. The result
+// is only used if the voice state and all the sample data it read are the same when the game actually
+// mixes the grain, so it's exactly what mixing at that point would have produced.
+class SasSpeculativeMix {
+public:
+	// Call right after a grain is mixed. Returns false if the voices can't be mixed ahead (ATRAC3.)
+	bool Prepare(SasInstance &sas);
+	// Can be called on any thread, after Prepare().
+	void Run();
+	// Call when the game mixes the next grain. If the speculative mix is still valid, moves its result
+	// into sas and returns true. Then only sas->WriteOutput() is left to do.
+	bool Commit(SasInstance &sas);
+	// Time Run() spent mixing, if audio perf stats were enabled, to charge to the grain it was used for.
+	uint64_t MixNanos() const { return mixNanos_; }
+
+private:
+	SasInstance instance_;
+	SasReadLog readLog_;
+	std::vector<u8> inputState_;
+	std::vector<u8> outputState_;
+	std::vector<u8> currentState_;
+	uint64_t mixNanos_ = 0;
+	bool ready_ = false;
+};
@@ -15,11 +15,14 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
+#include "Common/Math/CrossSIMD.h"
 #include "Common/Math/math_util.h"
 #include "Core/Config.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/HW/SasReverb.h"
 #include "Core/Util/AudioFormat.h"
 
@@ -168,14 +171,145 @@ const char *SasReverb::GetPresetName(int preset) {
 	return presets[preset].name;
 }
 
+// Every buffer access of one sample in the loop in ProcessSamples(), in the order it makes them.
+// (The all-pass filters read their input tap once more after the write, which doesn't matter here.)
+enum ReverbTap {
+	TAP_LSAME_WALL,
+	TAP_LSAME_PREV,
+	TAP_LSAME,
+	TAP_RSAME_WALL,
+	TAP_RSAME_PREV,
+	TAP_RSAME,
+	TAP_LDIFF_WALL,
+	TAP_LDIFF_PREV,
+	TAP_LDIFF,
+	TAP_RDIFF_WALL,
+	TAP_RDIFF_PREV,
+	TAP_RDIFF,
+	TAP_LCOMB1,
+	TAP_LCOMB2,
+	TAP_LCOMB3,
+	TAP_LCOMB4,
+	TAP_RCOMB1,
+	TAP_RCOMB2,
+	TAP_RCOMB3,
+	TAP_RCOMB4,
+	TAP_LAPF1_IN,
+	TAP_LAPF1,
+	TAP_RAPF1_IN,
+	TAP_RAPF1,
+	TAP_LAPF2_IN,
+	TAP_LAPF2,
+	TAP_RAPF2_IN,
+	TAP_RAPF2,
+
+	TAP_COUNT,
+};
+
+// The order ProcessBlocks() runs the stages in, each over the whole block.
+// The combs go first since that lets their taps be furthest apart from the reflections in time.
+enum ReverbStage {
+	STAGE_COMB,
+	STAGE_REFLECT,
+	STAGE_LAPF1,
+	STAGE_RAPF1,
+	STAGE_LAPF2,
+	STAGE_RAPF2,
+};
+
+struct ReverbTapInfo {
+	uint8_t stage;
+	bool write;
+};
+
+static const ReverbTapInfo tapInfo[TAP_COUNT] = {
+	{ STAGE_REFLECT, false }, { STAGE_REFLECT, false }, { STAGE_REFLECT, true },
+	{ STAGE_REFLECT, false }, { STAGE_REFLECT, false }, { STAGE_REFLECT, true },
+	{ STAGE_REFLECT, false }, { STAGE_REFLECT, false }, { STAGE_REFLECT, true },
+	{ STAGE_REFLECT, false }, { STAGE_REFLECT, false }, { STAGE_REFLECT, true },
+	{ STAGE_COMB, false }, { STAGE_COMB, false }, { STAGE_COMB, false }, { STAGE_COMB, false },
+	{ STAGE_COMB, false }, { STAGE_COMB, false }, { STAGE_COMB, false }, { STAGE_COMB, false },
+	{ STAGE_LAPF1, false }, { STAGE_LAPF1, true },
+	{ STAGE_RAPF1, false }, { STAGE_RAPF1, true },
+	{ STAGE_LAPF2, false }, { STAGE_LAPF2, true },
+	{ STAGE_RAPF2, false }, { STAGE_RAPF2, true },
+};
+
+static void GetTapOffsets(const SasReverbData &d, int offsets[TAP_COUNT]) {
+	offsets[TAP_LSAME_WALL] = d.dLSAME;
+	offsets[TAP_LSAME_PREV] = d.mLSAME - 1;
+	offsets[TAP_LSAME] = d.mLSAME;
+	offsets[TAP_RSAME_WALL] = d.dRSAME;
+	offsets[TAP_RSAME_PREV] = d.mRSAME - 1;
+	offsets[TAP_RSAME] = d.mRSAME;
+	offsets[TAP_LDIFF_WALL] = d.dRDIFF;
+	offsets[TAP_LDIFF_PREV] = d.mLDIFF - 1;
+	offsets[TAP_LDIFF] = d.mLDIFF;
+	offsets[TAP_RDIFF_WALL] = d.dLDIFF;
+	offsets[TAP_RDIFF_PREV] = d.mRDIFF - 1;
+	offsets[TAP_RDIFF] = d.mRDIFF;
+	offsets[TAP_LCOMB1] = d.mLCOMB1;
+	offsets[TAP_LCOMB2] = d.mLCOMB2;
+	offsets[TAP_LCOMB3] = d.mLCOMB3;
+	offsets[TAP_LCOMB4] = d.mLCOMB4;
+	offsets[TAP_RCOMB1] = d.mRCOMB1;
+	offsets[TAP_RCOMB2] = d.mRCOMB2;
+	offsets[TAP_RCOMB3] = d.mRCOMB3;
+	offsets[TAP_RCOMB4] = d.mRCOMB4;
+	offsets[TAP_LAPF1_IN] = d.mLAPF1 - d.dAPF1;
+	offsets[TAP_LAPF1] = d.mLAPF1;
+	offsets[TAP_RAPF1_IN] = d.mRAPF1 - d.dAPF1;
+	offsets[TAP_RAPF1] = d.mRAPF1;
+	offsets[TAP_LAPF2_IN] = d.mLAPF2 - d.dAPF2;
+	offsets[TAP_LAPF2] = d.mLAPF2;
+	offsets[TAP_RAPF2_IN] = d.mRAPF2 - d.dAPF2;
+	offsets[TAP_RAPF2] = d.mRAPF2;
+}
+
+// Running the stages one after another over a block of n samples reorders the buffer accesses.
+// That gives the same result as the sample by sample loop as long as no two accesses of different
+// stages (at least one of them a write) that hit the same address end up swapped. Access p at
+// sample tp and q at sample tq (p's stage first) collide when tq - tp == (offset p - offset q) mod size,
+// which is only out of order if that's negative, so n must stay below the wrapped distance.
+static int SafeBlockLength(const SasReverbData &d) {
+	// The all-pass filters are vectorized over 8 samples, which would miss the feedback if it's any closer.
+	if (d.dAPF1 < 8 || d.dAPF2 < 8)
+		return 0;
+
+	int offsets[TAP_COUNT];
+	GetTapOffsets(d, offsets);
+
+	int limit = d.size;
+	for (int p = 0; p < TAP_COUNT; p++) {
+		for (int q = 0; q < TAP_COUNT; q++) {
+			if (tapInfo[p].stage >= tapInfo[q].stage || (!tapInfo[p].write && !tapInfo[q].write))
+				continue;
+			int distance = ((offsets[p] - offsets[q]) % d.size + d.size) % d.size;
+			if (distance == 0) {
+				// Same sample, so it only works if the loop did them in this order too.
+				if (q < p)
+					return 0;
+			} else {
+				limit = std::min(limit, d.size - distance);
+			}
+		}
+	}
+	return limit;
+}
+
 void SasReverb::SetPreset(int preset) {
 	if (preset < (int)ARRAY_SIZE(presets))
 		preset_ = preset;
 	if (preset_ != -1) {
 		pos_ = BUFSIZE - presets[preset_].size;
 		memset(workspace_, 0, sizeof(int16_t) * BUFSIZE);
+		blockLength_ = std::min(SafeBlockLength(presets[preset_]), (int)MAX_BLOCK);
+		// Some presets have taps too close together (Room, Echo, Delay), those always go sample by sample.
+		if (blockLength_ < MIN_BLOCK)
+			blockLength_ = 0;
 	} else {
 		pos_ = 0;
+		blockLength_ = 0;
 	}
 }
 
@@ -208,6 +342,7 @@ class BufferWrapper {
 };
 
 void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight) {
+	AudioPerfScope perf(AudioPerfComponent::SAS_REVERB);
 	// This means replicate the input signal in the processed buffer.
 	// Can also be used to verify that the error is in here...
 	if (preset_ == -1) {
@@ -231,13 +366,18 @@ void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inpu
 	}
 
 	const SasReverbData &d = presets[preset_];
+	if (blockLength_ != 0 && !forceReference_)
+		ProcessBlocks(d, output, input, inputSize, volLeft, volRight, finalShift);
+	else
+		ProcessSamples(d, output, input, inputSize, volLeft, volRight, finalShift);
+}
 
+void SasReverb::ProcessSamples(const SasReverbData &d, int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight, int finalShift) {
 	// We put this on the stack instead of in the object to let the compiler optimize better (avoid mem r/w).
 	BufferWrapper<BUFSIZE> b(workspace_, pos_, d.size);
 
 	// This runs at 22khz.
-	// Very unoptimized, straight from the description. Can probably be reformulated into something way more efficient.
-	// Or we could actually template the whole thing with the parameters as template arguments, as the presets are fixed.
+	// Straight from the description. This is the reference that ProcessBlocks() has to match.
 	for (size_t i = 0; i < inputSize; i++) {
 		// Dividing by two here is an incorrect hack. Some multiplication factor is needed to prevent the reverb from getting too loud, though.
 		int16_t LeftInput = input[i * 2] >> 1;
@@ -278,3 +418,184 @@ void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inpu
 	pos_ = b.GetPosition();
 }
 
+#if PPSSPP_ARCH(SSE2)
+// SSE2 has no 32-bit multiply (that's SSE4.1), only the low halves matter anyway.
+static inline __m128i MulLo32(__m128i a, __m128i b) {
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+static void CombFilter(int32_t *out, const int16_t *c1, const int16_t *c2, const int16_t *c3, const int16_t *c4, const SasReverbData &d, int n) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	// Interleaving two taps lets madd do two of the products and their sum in one go.
+	const __m128i v12 = _mm_set1_epi32((uint16_t)d.vCOMB1 | ((uint32_t)(uint16_t)d.vCOMB2 << 16));
+	const __m128i v34 = _mm_set1_epi32((uint16_t)d.vCOMB3 | ((uint32_t)(uint16_t)d.vCOMB4 << 16));
+	for (; i + 8 <= n; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(c1 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(c2 + i));
+		__m128i c = _mm_loadu_si128((const __m128i *)(c3 + i));
+		__m128i e = _mm_loadu_si128((const __m128i *)(c4 + i));
+		__m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), v12), _mm_madd_epi16(_mm_unpacklo_epi16(c, e), v34));
+		__m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), v12), _mm_madd_epi16(_mm_unpackhi_epi16(c, e), v34));
+		_mm_store_si128((__m128i *)(out + i), _mm_srai_epi32(lo, 15));
+		_mm_store_si128((__m128i *)(out + i + 4), _mm_srai_epi32(hi, 15));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t a = vld1q_s16(c1 + i);
+		int16x8_t b = vld1q_s16(c2 + i);
+		int16x8_t c = vld1q_s16(c3 + i);
+		int16x8_t e = vld1q_s16(c4 + i);
+		int32x4_t lo = vmull_n_s16(vget_low_s16(a), d.vCOMB1);
+		lo = vmlal_n_s16(lo, vget_low_s16(b), d.vCOMB2);
+		lo = vmlal_n_s16(lo, vget_low_s16(c), d.vCOMB3);
+		lo = vmlal_n_s16(lo, vget_low_s16(e), d.vCOMB4);
+		int32x4_t hi = vmull_n_s16(vget_high_s16(a), d.vCOMB1);
+		hi = vmlal_n_s16(hi, vget_high_s16(b), d.vCOMB2);
+		hi = vmlal_n_s16(hi, vget_high_s16(c), d.vCOMB3);
+		hi = vmlal_n_s16(hi, vget_high_s16(e), d.vCOMB4);
+		vst1q_s32(out + i, vshrq_n_s32(lo, 15));
+		vst1q_s32(out + i + 4, vshrq_n_s32(hi, 15));
+	}
+#endif
+	for (; i < n; i++)
+		out[i] = (d.vCOMB1 * c1[i] + d.vCOMB2 * c2[i] + d.vCOMB3 * c3[i] + d.vCOMB4 * c4[i]) >> 15;
+}
+
+// in is the same buffer as m, some distance (at least 8) back, so it sees what earlier iterations wrote.
+static void AllPassFilter(int32_t *out, int16_t *m, const int16_t *in, int16_t v, int n) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i vv = _mm_set1_epi16(v);
+	for (; i + 8 <= n; i += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+		__m128i xlo = _mm_mullo_epi16(x, vv);
+		__m128i xhi = _mm_mulhi_epi16(x, vv);
+		__m128i m0 = _mm_sub_epi32(_mm_load_si128((const __m128i *)(out + i)), _mm_srai_epi32(_mm_unpacklo_epi16(xlo, xhi), 15));
+		__m128i m1 = _mm_sub_epi32(_mm_load_si128((const __m128i *)(out + i + 4)), _mm_srai_epi32(_mm_unpackhi_epi16(xlo, xhi), 15));
+		// packs does the clamp_s16.
+		__m128i mv = _mm_packs_epi32(m0, m1);
+		_mm_storeu_si128((__m128i *)(m + i), mv);
+
+		__m128i mlo = _mm_mullo_epi16(mv, vv);
+		__m128i mhi = _mm_mulhi_epi16(mv, vv);
+		__m128i o0 = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), _mm_srai_epi32(_mm_unpacklo_epi16(mlo, mhi), 15));
+		__m128i o1 = _mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), _mm_srai_epi32(_mm_unpackhi_epi16(mlo, mhi), 15));
+		_mm_store_si128((__m128i *)(out + i), o0);
+		_mm_store_si128((__m128i *)(out + i + 4), o1);
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t x = vld1q_s16(in + i);
+		int32x4_t m0 = vsubq_s32(vld1q_s32(out + i), vshrq_n_s32(vmull_n_s16(vget_low_s16(x), v), 15));
+		int32x4_t m1 = vsubq_s32(vld1q_s32(out + i + 4), vshrq_n_s32(vmull_n_s16(vget_high_s16(x), v), 15));
+		int16x8_t mv = vcombine_s16(vqmovn_s32(m0), vqmovn_s32(m1));
+		vst1q_s16(m + i, mv);
+
+		vst1q_s32(out + i, vaddq_s32(vmovl_s16(vget_low_s16(x)), vshrq_n_s32(vmull_n_s16(vget_low_s16(mv), v), 15)));
+		vst1q_s32(out + i + 4, vaddq_s32(vmovl_s16(vget_high_s16(x)), vshrq_n_s32(vmull_n_s16(vget_high_s16(mv), v), 15)));
+	}
+#endif
+	for (; i < n; i++) {
+		m[i] = clamp_s16(out[i] - (v * in[i] >> 15));
+		out[i] = in[i] + (m[i] * v >> 15);
+	}
+}
+
+static void OutputBlock(int16_t *output, const int32_t *lout, const int32_t *rout, uint16_t volLeft, uint16_t volRight, int finalShift, int n) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i vl = _mm_set1_epi32(volLeft);
+	const __m128i vr = _mm_set1_epi32(volRight);
+	const __m128i shift = _mm_cvtsi32_si128(finalShift);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= n; i += 8) {
+		__m128i l0 = _mm_sra_epi32(MulLo32(_mm_load_si128((const __m128i *)(lout + i)), vl), shift);
+		__m128i l1 = _mm_sra_epi32(MulLo32(_mm_load_si128((const __m128i *)(lout + i + 4)), vl), shift);
+		__m128i r0 = _mm_sra_epi32(MulLo32(_mm_load_si128((const __m128i *)(rout + i)), vr), shift);
+		__m128i r1 = _mm_sra_epi32(MulLo32(_mm_load_si128((const __m128i *)(rout + i + 4)), vr), shift);
+		__m128i l = _mm_packs_epi32(l0, l1);
+		__m128i r = _mm_packs_epi32(r0, r1);
+		// Each sample is L, R, 0, 0.
+		__m128i lr0 = _mm_unpacklo_epi16(l, r);
+		__m128i lr1 = _mm_unpackhi_epi16(l, r);
+		_mm_storeu_si128((__m128i *)(output + i * 4), _mm_unpacklo_epi32(lr0, zero));
+		_mm_storeu_si128((__m128i *)(output + i * 4 + 8), _mm_unpackhi_epi32(lr0, zero));
+		_mm_storeu_si128((__m128i *)(output + i * 4 + 16), _mm_unpacklo_epi32(lr1, zero));
+		_mm_storeu_si128((__m128i *)(output + i * 4 + 24), _mm_unpackhi_epi32(lr1, zero));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int32x4_t vl = vdupq_n_s32(volLeft);
+	const int32x4_t vr = vdupq_n_s32(volRight);
+	const int32x4_t shift = vdupq_n_s32(-finalShift);
+	int16x4x4_t lr0;
+	lr0.val[2] = vdup_n_s16(0);
+	lr0.val[3] = vdup_n_s16(0);
+	for (; i + 4 <= n; i += 4) {
+		lr0.val[0] = vqmovn_s32(vshlq_s32(vmulq_s32(vld1q_s32(lout + i), vl), shift));
+		lr0.val[1] = vqmovn_s32(vshlq_s32(vmulq_s32(vld1q_s32(rout + i), vr), shift));
+		vst4_s16(output + i * 4, lr0);
+	}
+#endif
+	for (; i < n; i++) {
+		output[i * 4 + 0] = clamp_s16((lout[i] * volLeft) >> finalShift);
+		output[i * 4 + 1] = clamp_s16((rout[i] * volRight) >> finalShift);
+		output[i * 4 + 2] = 0;
+		output[i * 4 + 3] = 0;
+	}
+}
+
+// Same as ProcessSamples(), but each stage runs over a block of samples at a time (see SafeBlockLength()),
+// so that everything except the reflections (which feed back on the previous sample) can use SIMD.
+void SasReverb::ProcessBlocks(const SasReverbData &d, int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight, int finalShift) {
+	int offsets[TAP_COUNT];
+	GetTapOffsets(d, offsets);
+
+	alignas(16) int32_t lout[MAX_BLOCK];
+	alignas(16) int32_t rout[MAX_BLOCK];
+	int16_t *t[TAP_COUNT];
+	const int base = BUFSIZE - d.size;
+
+	while (inputSize > 0) {
+		// End the block wherever a tap wraps around, so each one is just a pointer.
+		int n = (int)std::min(inputSize, (size_t)blockLength_);
+		for (int i = 0; i < TAP_COUNT; i++) {
+			int addr = pos_ + offsets[i];
+			if (addr >= BUFSIZE)
+				addr -= d.size;
+			if (addr < base)
+				addr += d.size;
+			t[i] = workspace_ + addr;
+			n = std::min(n, BUFSIZE - addr);
+		}
+
+		CombFilter(lout, t[TAP_LCOMB1], t[TAP_LCOMB2], t[TAP_LCOMB3], t[TAP_LCOMB4], d, n);
+		CombFilter(rout, t[TAP_RCOMB1], t[TAP_RCOMB2], t[TAP_RCOMB3], t[TAP_RCOMB4], d, n);
+
+		for (int i = 0; i < n; i++) {
+			int16_t Lin = input[i * 2] >> 1;
+			int16_t Rin = input[i * 2 + 1] >> 1;
+			t[TAP_LSAME][i] = clamp_s16(Lin + (t[TAP_LSAME_WALL][i] * d.vWALL >> 15) - (t[TAP_LSAME_PREV][i] * d.vIIR >> 15) + t[TAP_LSAME_PREV][i]);
+			t[TAP_RSAME][i] = clamp_s16(Rin + (t[TAP_RSAME_WALL][i] * d.vWALL >> 15) - (t[TAP_RSAME_PREV][i] * d.vIIR >> 15) + t[TAP_RSAME_PREV][i]);
+			t[TAP_LDIFF][i] = clamp_s16(Lin + (t[TAP_LDIFF_WALL][i] * d.vWALL >> 15) - (t[TAP_LDIFF_PREV][i] * d.vIIR >> 15) + t[TAP_LDIFF_PREV][i]);
+			t[TAP_RDIFF][i] = clamp_s16(Rin + (t[TAP_RDIFF_WALL][i] * d.vWALL >> 15) - (t[TAP_RDIFF_PREV][i] * d.vIIR >> 15) + t[TAP_RDIFF_PREV][i]);
+		}
+
+		AllPassFilter(lout, t[TAP_LAPF1], t[TAP_LAPF1_IN], d.vAPF1, n);
+		AllPassFilter(rout, t[TAP_RAPF1], t[TAP_RAPF1_IN], d.vAPF1, n);
+		AllPassFilter(lout, t[TAP_LAPF2], t[TAP_LAPF2_IN], d.vAPF2, n);
+		AllPassFilter(rout, t[TAP_RAPF2], t[TAP_RAPF2_IN], d.vAPF2, n);
+
+		OutputBlock(output, lout, rout, volLeft, volRight, finalShift, n);
+
+		pos_ += n;
+		if (pos_ >= BUFSIZE)
+			pos_ -= d.size;
+		input += n * 2;
+		output += n * 4;
+		inputSize -= n;
+	}
+}
@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 struct SasReverbData;
 
 class SasReverb {
@@ -33,12 +36,25 @@ class SasReverb {
 	// Output is written back at 44khz.
 	void ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight);
 
+	// For testing. Always runs the plain sample by sample loop, which the block path must match exactly.
+	void SetForceReference(bool force) { forceReference_ = force; }
+
 private:
 	enum {
 		BUFSIZE = 0x20000,
+		// Scratch space for the block path, in samples.
+		MAX_BLOCK = 256,
+		// Below this, the block path isn't worth it.
+		MIN_BLOCK = 16,
 	};
 
+	void ProcessSamples(const SasReverbData &d, int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight, int finalShift);
+	void ProcessBlocks(const SasReverbData &d, int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight, int finalShift);
+
 	int16_t *workspace_;
 	int preset_;
 	int pos_;
-};
\ No newline at end of file
+	// How many samples of the current preset can go through the block path at once, 0 if none.
+	int blockLength_ = 0;
+	bool forceReference_ = false;
+};
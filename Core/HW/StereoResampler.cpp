@@ -33,6 +33,8 @@
 #define CONTROL_AVG     32.0f
 
 #include "ppsspp_config.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <atomic>
 
@@ -44,6 +46,7 @@
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
+#include "Core/HW/AudioPerf.h"
 #include "Core/HW/StereoResampler.h"
 #include "Core/HLE/__sceAudio.h"
 #include "Core/Util/AudioFormat.h"  // for clamp_u8
@@ -62,9 +65,9 @@
 
 StereoResampler::StereoResampler() noexcept
 		: m_maxBufsize(MAX_BUFSIZE_DEFAULT)
-	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT) {
-	// Need to have space for the worst case in case it changes.
-	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2]();
+	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT)
+	  // Need to have space for the worst case in case it changes.
+	  , m_buffer(MAX_BUFSIZE_EXTRA * 2) {
 
 	// Some Android devices are v-synced to non-60Hz framerates. We simply timestretch audio to fit.
 	// TODO: should only do this if auto frameskip is off?
@@ -80,10 +83,7 @@ StereoResampler::StereoResampler() noexcept
 	UpdateBufferSize();
 }
 
-StereoResampler::~StereoResampler() {
-	delete[] m_buffer;
-	m_buffer = nullptr;
-}
+StereoResampler::~StereoResampler() {}
 
 void StereoResampler::UpdateBufferSize() {
 	if (g_Config.bExtraAudioBuffering) {
@@ -161,7 +161,8 @@ inline void ClampBufferToS16WithVolume(s16 *out, const s32 *in, size_t size) {
 }
 
 void StereoResampler::Clear() {
-	memset(m_buffer, 0, m_maxBufsize * 2 * sizeof(int16_t));
+	// Only the audio thread may move the read position, so let it do the dropping.
+	clearRequested_ = true;
 }
 
 inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
@@ -174,30 +175,168 @@ inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
 		return (int16_t)value;
 }
 
+static double BesselI0(double x) {
+	// The series converges quickly for the arguments a Kaiser window uses.
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+void SincFilterBank::Build(float cutoff) {
+	const double beta = 7.0;
+	const double halfWidth = TAPS / 2;
+	for (int p = 0; p <= PHASES; p++) {
+		double h[TAPS];
+		double sum = 0.0;
+		for (int k = 0; k < TAPS; k++) {
+			// Distance from the interpolation point, which is HISTORY + p / PHASES.
+			double x = k - HISTORY - (double)p / PHASES;
+			double u = x / halfWidth;
+			double window = fabs(u) < 1.0 ? BesselI0(beta * sqrt(1.0 - u * u)) / BesselI0(beta) : 0.0;
+			double arg = M_PI * cutoff * x;
+			h[k] = (x == 0.0 ? 1.0 : sin(arg) / arg) * window;
+			sum += h[k];
+		}
+
+		// Normalize for unity gain at DC, and put the rounding error on the center tap so it stays exact.
+		int16_t *c = &coefs_[p * TAPS];
+		int total = 0;
+		int center = HISTORY;
+		for (int k = 0; k < TAPS; k++) {
+			c[k] = (int16_t)lrint(h[k] / sum * 16384.0);
+			total += c[k];
+			if (h[k] > h[center])
+				center = k;
+		}
+		c[center] += 16384 - total;
+	}
+	cutoff_ = cutoff;
+}
+
+u32 StereoResampleSinc(s16 *out, u32 outFrames, const s16 *in, u32 inFrames, const SincFilterBank &bank, u32 ratio, u32 *frac, u32 *inPos) {
+	enum { TAPS = SincFilterBank::TAPS };
+	u32 f = *frac;
+	u32 pos = *inPos;
+	u32 n = 0;
+	// Each output is computed for the two nearest phases, then blended. The dot products are exact in
+	// 32-bit integers, only the blend and scale back down are done as floats.
+#ifdef _M_SSE
+	const __m128 scale = _mm_set1_ps(1.0f / 16384.0f);
+	for (; n < outFrames && pos + TAPS <= inFrames; n++) {
+		const s16 *src = in + pos * 2;
+		const int phase = f >> 8;
+		const __m128 t = _mm_set1_ps((float)(f & 0xFF) * (1.0f / 256.0f));
+		__m128i accA = _mm_setzero_si128();
+		__m128i accB = _mm_setzero_si128();
+		for (int k = 0; k < TAPS; k += 8) {
+			// Four frames at a time, rearranged to L0 L1 R0 R1 L2 L3 R2 R3, so that madd with c0 c1 c0 c1 c2 c3 c2 c3
+			// gives partial sums for each channel.
+			__m128i d0 = _mm_loadu_si128((const __m128i *)(src + k * 2));
+			__m128i d1 = _mm_loadu_si128((const __m128i *)(src + k * 2 + 8));
+			d0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d0, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+			d1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d1, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+			__m128i cA = _mm_load_si128((const __m128i *)(bank.Phase(phase) + k));
+			__m128i cB = _mm_load_si128((const __m128i *)(bank.Phase(phase + 1) + k));
+			accA = _mm_add_epi32(accA, _mm_madd_epi16(d0, _mm_unpacklo_epi32(cA, cA)));
+			accA = _mm_add_epi32(accA, _mm_madd_epi16(d1, _mm_unpackhi_epi32(cA, cA)));
+			accB = _mm_add_epi32(accB, _mm_madd_epi16(d0, _mm_unpacklo_epi32(cB, cB)));
+			accB = _mm_add_epi32(accB, _mm_madd_epi16(d1, _mm_unpackhi_epi32(cB, cB)));
+		}
+		// LA RA LB RB
+		__m128 sum = _mm_cvtepi32_ps(_mm_add_epi32(_mm_unpacklo_epi64(accA, accB), _mm_unpackhi_epi64(accA, accB)));
+		__m128 diff = _mm_sub_ps(_mm_movehl_ps(sum, sum), sum);
+		__m128 result = _mm_mul_ps(_mm_add_ps(sum, _mm_mul_ps(diff, t)), scale);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(result), _mm_cvtps_epi32(result));
+		*(u32 *)(out + n * 2) = (u32)_mm_cvtsi128_si32(packed);
+
+		f += ratio;
+		pos += f >> 16;
+		f &= 0xFFFF;
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const float32x2_t half = vdup_n_f32(0.5f);
+	for (; n < outFrames && pos + TAPS <= inFrames; n++) {
+		const s16 *src = in + pos * 2;
+		const int phase = f >> 8;
+		const float t = (float)(f & 0xFF) * (1.0f / 256.0f);
+		int32x4_t accLA = vdupq_n_s32(0), accRA = vdupq_n_s32(0);
+		int32x4_t accLB = vdupq_n_s32(0), accRB = vdupq_n_s32(0);
+		for (int k = 0; k < TAPS; k += 8) {
+			// Eight frames at a time, split into channels.
+			int16x8x2_t d = vld2q_s16(src + k * 2);
+			int16x8_t cA = vld1q_s16(bank.Phase(phase) + k);
+			int16x8_t cB = vld1q_s16(bank.Phase(phase + 1) + k);
+			accLA = vmlal_s16(vmlal_s16(accLA, vget_low_s16(d.val[0]), vget_low_s16(cA)), vget_high_s16(d.val[0]), vget_high_s16(cA));
+			accRA = vmlal_s16(vmlal_s16(accRA, vget_low_s16(d.val[1]), vget_low_s16(cA)), vget_high_s16(d.val[1]), vget_high_s16(cA));
+			accLB = vmlal_s16(vmlal_s16(accLB, vget_low_s16(d.val[0]), vget_low_s16(cB)), vget_high_s16(d.val[0]), vget_high_s16(cB));
+			accRB = vmlal_s16(vmlal_s16(accRB, vget_low_s16(d.val[1]), vget_low_s16(cB)), vget_high_s16(d.val[1]), vget_high_s16(cB));
+		}
+		int32x2_t sumA = vpadd_s32(vadd_s32(vget_low_s32(accLA), vget_high_s32(accLA)), vadd_s32(vget_low_s32(accRA), vget_high_s32(accRA)));
+		int32x2_t sumB = vpadd_s32(vadd_s32(vget_low_s32(accLB), vget_high_s32(accLB)), vadd_s32(vget_low_s32(accRB), vget_high_s32(accRB)));
+		float32x2_t a = vcvt_f32_s32(sumA);
+		float32x2_t result = vmul_n_f32(vadd_f32(a, vmul_n_f32(vsub_f32(vcvt_f32_s32(sumB), a), t)), 1.0f / 16384.0f);
+		// Round to nearest, the conversion truncates.
+		uint32x2_t negative = vclt_f32(result, vdup_n_f32(0.0f));
+		result = vadd_f32(result, vbsl_f32(negative, vneg_f32(half), half));
+		int16x4_t packed = vqmovn_s32(vcombine_s32(vcvt_s32_f32(result), vcvt_s32_f32(result)));
+		vst1_lane_s32((int32_t *)(out + n * 2), vreinterpret_s32_s16(packed), 0);
+
+		f += ratio;
+		pos += f >> 16;
+		f &= 0xFFFF;
+	}
+#else
+	for (; n < outFrames && pos + TAPS <= inFrames; n++) {
+		const s16 *src = in + pos * 2;
+		const int16_t *cA = bank.Phase(f >> 8);
+		const int16_t *cB = bank.Phase((f >> 8) + 1);
+		const float t = (float)(f & 0xFF) * (1.0f / 256.0f);
+		for (int ch = 0; ch < 2; ch++) {
+			int32_t sumA = 0, sumB = 0;
+			for (int k = 0; k < TAPS; k++) {
+				sumA += src[k * 2 + ch] * cA[k];
+				sumB += src[k * 2 + ch] * cB[k];
+			}
+			float value = ((float)sumA + ((float)sumB - (float)sumA) * t) * (1.0f / 16384.0f);
+			out[n * 2 + ch] = clamp_s16((int)lrintf(value));
+		}
+
+		f += ratio;
+		pos += f >> 16;
+		f &= 0xFFFF;
+	}
+#endif
+	*frac = f;
+	*inPos = pos;
+	return n;
+}
+
 // Executed from sound stream thread, pulling sound out of the buffer.
 unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool consider_framelimit, int sample_rate) {
 	if (!samples)
 		return 0;
 
+	AudioPerfScope perf(AudioPerfComponent::RESAMPLE);
 	unsigned int currentSample;
 
-	// Cache access in non-volatile variable
-	// This is the only function changing the read value, so it's safe to
-	// cache it locally although it's written here.
-	// The writing pointer will be modified outside, but it will only increase,
-	// so we will just ignore new written data while interpolating (until it wraps...).
-	// Without this cache, the compiler wouldn't be allowed to optimize the
-	// interpolation loop.
-	u32 indexR = m_indexR.load();
-	u32 indexW = m_indexW.load();
+	if (clearRequested_.exchange(false)) {
+		m_buffer.Consume(m_buffer.ReadAvailable());
+	}
 
-	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
+	// Samples pushed while we're interpolating are simply picked up next time.
+	// Without this snapshot, the compiler wouldn't be allowed to optimize the
+	// interpolation loop.
+	const u32 available = (u32)m_buffer.ReadAvailable();
 
 	// This is only for debug visualization, not used for anything.
-	lastBufSize_ = ((indexW - indexR) & INDEX_MASK) / 2;
+	lastBufSize_ = available / 2;
 
 	// Drift prevention mechanism.
-	float numLeft = (float)(((indexW - indexR) & INDEX_MASK) / 2);
+	float numLeft = (float)(available / 2);
 	// If we had to discard samples the last frame due to underrun,
 	// apply an adjustment here. Otherwise we'll overestimate how many
 	// samples we need.
@@ -219,47 +358,81 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	output_sample_rate_ = (float)(m_input_sample_rate + offset);
 	const u32 ratio = (u32)(65536.0 * output_sample_rate_ / (double)sample_rate);
 	ratio_ = ratio;
-	// TODO: consider a higher-quality resampling algorithm.
 	// TODO: Add a fast path for 1:1.
+	u32 indexR = 0;
+	if (g_Config.iAudioResampleMode == (int)AudioResampleMode::SINC) {
+		currentSample = MixSinc(samples, numSamples, available, ratio, sample_rate, &indexR) * 2;
+	} else {
+		currentSample = MixLinear(samples, numSamples, available, ratio, &indexR) * 2;
+	}
+	if (currentSample < numSamples * 2) {
+		// Ran out!
+		underrunCount_++;
+	}
+
+	// Let's not count the underrun padding here.
+	outputSampleCount_ += currentSample / 2;
+
+	// Padding with the last value to reduce clicking
+	if (currentSample >= 2) {
+		lastSample_[0] = samples[currentSample - 2];
+		lastSample_[1] = samples[currentSample - 1];
+	}
+	for (; currentSample < numSamples * 2; currentSample += 2) {
+		samples[currentSample] = lastSample_[0];
+		samples[currentSample + 1] = lastSample_[1];
+	}
+
+	// A large step at the end can skip past what's been written.
+	m_buffer.Consume(std::min(indexR, available));
+
+	// TODO: What should we actually return here?
+	return currentSample / 2;
+}
+
+u32 StereoResampler::MixLinear(short *samples, unsigned int numSamples, u32 available, u32 ratio, u32 *indexR) {
 	u32 frac = m_frac;
+	u32 readIndex = 0;
+	u32 currentSample;
 	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
-		if (((indexW - indexR) & INDEX_MASK) <= 2) {
-			// Ran out!
-			// int missing = numSamples * 2 - currentSample;
-			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
-			underrunCount_++;
+		if (available <= readIndex + 2) {
 			break;
 		}
-		u32 indexR2 = indexR + 2; //next sample
-		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
-		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
-		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
-		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
+		u32 readIndex2 = readIndex + 2; //next sample
+		s16 l1 = m_buffer.Peek(readIndex); //current
+		s16 r1 = m_buffer.Peek(readIndex + 1); //current
+		s16 l2 = m_buffer.Peek(readIndex2); //next
+		s16 r2 = m_buffer.Peek(readIndex2 + 1); //next
 		samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
 		samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
 		frac += ratio;
-		indexR += 2 * (frac >> 16);
+		readIndex += 2 * (frac >> 16);
 		frac &= 0xffff;
 	}
 	m_frac = frac;
+	*indexR = readIndex;
+	return currentSample / 2;
+}
 
-	// Let's not count the underrun padding here.
-	outputSampleCount_ += currentSample / 2;
-
-	// Padding with the last value to reduce clicking
-	short s[2];
-	s[0] = clamp_s16(m_buffer[(indexR - 1) & INDEX_MASK]);
-	s[1] = clamp_s16(m_buffer[(indexR - 2) & INDEX_MASK]);
-	for (; currentSample < numSamples * 2; currentSample += 2) {
-		samples[currentSample] = s[0];
-		samples[currentSample + 1] = s[1];
+u32 StereoResampler::MixSinc(short *samples, unsigned int numSamples, u32 available, u32 ratio, int sampleRate, u32 *indexR) {
+	// When the output rate is lower, the cutoff has to come down with it to avoid aliasing.
+	// Some headroom is left for the transition band, which is wide with this few taps.
+	float cutoff = 0.9f * std::min(1.0f, (float)sampleRate / (float)m_input_sample_rate);
+	if (cutoff != sincBank_.Cutoff()) {
+		sincBank_.Build(cutoff);
 	}
 
-	// Flush cached variable
-	m_indexR.store(indexR);
+	// The filter wants contiguous input, so copy out what this call can use.
+	u32 frames = std::min(available / 2, (u32)(((u64)numSamples * ratio + m_frac) >> 16) + SincFilterBank::TAPS + 1);
+	if (sincInput_.size() < frames * 2) {
+		sincInput_.resize(frames * 2);
+	}
+	m_buffer.PeekRange(0, sincInput_.data(), frames * 2);
 
-	// TODO: What should we actually return here?
-	return currentSample / 2;
+	u32 pos = 0;
+	u32 produced = StereoResampleSinc(samples, numSamples, sincInput_.data(), frames, sincBank_, ratio, &m_frac, &pos);
+	*indexR = pos * 2;
+	return produced;
 }
 
 // Executes on the emulator thread, pushing sound into the buffer.
@@ -267,11 +440,6 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 	inputSampleCount_ += numSamples;
 
 	UpdateBufferSize();
-	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
-	// Cache access in non-volatile variable
-	// indexR isn't allowed to cache in the audio throttling loop as it
-	// needs to get updates to not deadlock.
-	u32 indexW = m_indexW.load();
 
 	u32 cap = m_maxBufsize * 2;
 	// If fast-forwarding, no need to fill up the entire buffer, just screws up timing after releasing the fast-forward button.
@@ -279,9 +447,10 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 		cap = m_targetBufsize * 2;
 	}
 
-	// Check if we have enough free space
-	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (numSamples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= cap) {
+	// Check if we have enough free space. The fill level we see here can only be too high, never too low.
+	int16_t *dest1, *dest2;
+	size_t sz1, sz2;
+	if (numSamples * 2 + m_buffer.SizeApprox() >= cap || !m_buffer.BeginWrite(numSamples * 2, &dest1, &sz1, &dest2, &sz2)) {
 		if (!PSP_CoreParameter().fastForward) {
 			overrunCount_++;
 		}
@@ -289,16 +458,12 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 		return;
 	}
 
-	// Check if we need to roll over to the start of the buffer during the copy.
-	unsigned int indexW_left_samples = m_maxBufsize * 2 - (indexW & INDEX_MASK);
-	if (numSamples * 2 > indexW_left_samples) {
-		ClampBufferToS16WithVolume(&m_buffer[indexW & INDEX_MASK], samples, indexW_left_samples);
-		ClampBufferToS16WithVolume(&m_buffer[0], samples + indexW_left_samples, numSamples * 2 - indexW_left_samples);
-	} else {
-		ClampBufferToS16WithVolume(&m_buffer[indexW & INDEX_MASK], samples, numSamples * 2);
+	ClampBufferToS16WithVolume(dest1, samples, sz1);
+	if (dest2) {
+		ClampBufferToS16WithVolume(dest2, samples + sz1, sz2);
 	}
 
-	m_indexW += numSamples * 2;
+	m_buffer.EndWrite(numSamples * 2);
 	lastPushSize_ = numSamples;
 }
 
@@ -21,11 +21,40 @@
 
 #include <cstdint>
 #include <atomic>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Data/Collections/SPSCRing.h"
 
 struct AudioDebugStats;
 
+// Windowed-sinc interpolation filters, precomputed for PHASES evenly spaced fractional positions.
+// Output between two phases is interpolated linearly, which is plenty at this phase count.
+class SincFilterBank {
+public:
+	enum {
+		TAPS = 24,
+		PHASES = 256,
+		// How many input frames before the interpolation point the filter reaches.
+		HISTORY = TAPS / 2 - 1,
+	};
+
+	// cutoff is relative to the input Nyquist frequency.
+	void Build(float cutoff);
+	float Cutoff() const { return cutoff_; }
+	// TAPS coefficients in Q14, phase can go up to PHASES inclusive.
+	const int16_t *Phase(int phase) const { return &coefs_[phase * TAPS]; }
+
+private:
+	float cutoff_ = 0.0f;
+	alignas(16) int16_t coefs_[(PHASES + 1) * TAPS]{};
+};
+
+// Resamples interleaved stereo from in, which holds inFrames frames. Output frame n is interpolated at
+// input frame *inPos + HISTORY + *frac / 65536, then *frac advances by ratio (16.16). Stops when out is
+// full or the filter would run past the input, returns the number of frames written.
+u32 StereoResampleSinc(s16 *out, u32 outFrames, const s16 *in, u32 inFrames, const SincFilterBank &bank, u32 ratio, u32 *frac, u32 *inPos);
+
 class StereoResampler {
 public:
 	StereoResampler() noexcept;
@@ -38,6 +67,7 @@ class StereoResampler {
 	// This clamps the samples to 16-bit before starting to work on them.
 	void PushSamples(const s32* samples, unsigned int num_samples);
 
+	// Can be called from any thread. The buffered samples are dropped on the next Mix.
 	void Clear();
 
 	void GetAudioDebugStats(char *buf, size_t bufSize);
@@ -45,15 +75,22 @@ class StereoResampler {
 
 private:
 	void UpdateBufferSize();
+	u32 MixLinear(short *samples, unsigned int numSamples, u32 available, u32 ratio, u32 *indexR);
+	u32 MixSinc(short *samples, unsigned int numSamples, u32 available, u32 ratio, int sampleRate, u32 *indexR);
 
 	int m_maxBufsize;
 	int m_targetBufsize;
 
 	unsigned int m_input_sample_rate = 44100;
-	int16_t *m_buffer;
-	std::atomic<u32> m_indexW;
-	std::atomic<u32> m_indexR;
+	// Interleaved stereo. Always allocated for the largest buffer size, m_maxBufsize only limits the fill.
+	SPSCRing<int16_t> m_buffer;
+	std::atomic<bool> clearRequested_{};
 	float m_numLeftI = 0.0f;
+	int16_t lastSample_[2]{};
+
+	SincFilterBank sincBank_;
+	// Linear copy of the part of m_buffer that the sinc filter reads.
+	std::vector<int16_t> sincInput_;
 
 	u32 m_frac = 0;
 	float output_sample_rate_ = 0.0;
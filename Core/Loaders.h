@@ -83,6 +83,17 @@ class FileLoader {
 		return ReadAt(absolutePos, 1, bytes, data, flags);
 	}
 
+	// Maps the whole file into memory, if the loader and platform can. Reads then become a memcpy, and
+	// DataPointer() gives direct access. An I/O error while reading a mapped file crashes instead of failing
+	// the read, so this is only for local files, and only done when g_Config.bMemoryMapIso is set.
+	virtual bool MapIntoMemory() {
+		return false;
+	}
+	// The data at absolutePos, if the file is mapped and the whole range is inside it. Read only.
+	virtual const u8 *DataPointer(s64 absolutePos, size_t bytes) {
+		return nullptr;
+	}
+
 	// Cancel any operations that might block, if possible.
 	virtual void Cancel() {}
 
@@ -129,6 +140,12 @@ class ProxiedFileLoader : public FileLoader {
 	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override {
 		return backend_->ReadAt(absolutePos, bytes, data, flags);
 	}
+	bool MapIntoMemory() override {
+		return backend_->MapIntoMemory();
+	}
+	const u8 *DataPointer(s64 absolutePos, size_t bytes) override {
+		return backend_->DataPointer(absolutePos, bytes);
+	}
 
 protected:
 	FileLoader *backend_;
@@ -83,6 +83,7 @@ void InitMemoryForGameISO(FileLoader *fileLoader) {
 
 	std::shared_ptr<IFileSystem> fileSystem;
 	std::shared_ptr<IFileSystem> blockSystem;
+	std::shared_ptr<ISOFileSystem> iso;
 
 	if (fileLoader->IsDirectory()) {
 		fileSystem = std::make_shared<VirtualDiscFileSystem>(&pspFileSystem, fileLoader->GetPath());
@@ -93,7 +94,8 @@ void InitMemoryForGameISO(FileLoader *fileLoader) {
 		if (!bd)
 			return;
 
-		fileSystem = std::make_shared<ISOFileSystem>(&pspFileSystem, bd);
+		iso = std::make_shared<ISOFileSystem>(&pspFileSystem, bd);
+		fileSystem = iso;
 		blockSystem = std::make_shared<ISOBlockSystem>(fileSystem);
 	}
 
@@ -124,6 +126,11 @@ void InitMemoryForGameISO(FileLoader *fileLoader) {
 		}
 	}
 
+	// Tests should read the same way every time, so no prefetching for headless.
+	if (iso && !gameID.empty() && !PSP_CoreParameter().headLess) {
+		iso->StartPrefetcher(GetSysDirectory(DIRECTORY_CACHE) / "UmdTraces" / (gameID + ".trace"));
+	}
+
 	for (size_t i = 0; i < g_HDRemastersCount; i++) {
 		const auto &entry = g_HDRemasters[i];
 		if (entry.gameID != gameID) {
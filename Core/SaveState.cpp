@@ -16,11 +16,18 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <mutex>
 
+#include <zstd.h>
+
 #include "Common/Data/Text/I18n.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/System/System.h"
@@ -100,175 +107,184 @@ namespace SaveState
 		return CChunkFileReader::LoadPtr(&data[0], state, errorString);
 	}
 
-	// This ring buffer of states is for rewind save states, which are kept in RAM.
-	// Save states are compressed against one of two reference saves (bases_), and the reference
-	// is switched to a fresh save every N saves, where N is BASE_USAGE_INTERVAL.
-	// The compression is a simple block based scheme where 0 means to copy a block from the base,
-	// and 1 means that the following bytes are the next block. See Compress/LockedDecompress.
-	class StateRingbuffer {
-	public:
-		StateRingbuffer() {
-			size_ = REWIND_NUM_STATES;
-			states_.resize(size_);
-			baseMapping_.resize(size_);
+	static const size_t REWIND_CHUNK_SIZE = 1024 * 1024;
+	static const int REWIND_ZSTD_LEVEL = 1;
+
+	// How to get from a rewind state to the one before it: the XOR of the two, compressed a chunk at a time.
+	struct RewindDelta {
+		// Of the older state.
+		size_t size = 0;
+		std::vector<std::vector<u8>> chunks;
+
+		std::mutex lock;
+		std::condition_variable cond;
+		int pending = 0;
+		bool failed = false;
+		size_t compressedSize = 0;
+
+		void Wait() {
+			std::unique_lock<std::mutex> guard(lock);
+			cond.wait(guard, [this] { return pending == 0; });
 		}
 
-		~StateRingbuffer() {
-			if (compressThread_.joinable()) {
-				compressThread_.join();
-			}
+		bool Pending() {
+			std::lock_guard<std::mutex> guard(lock);
+			return pending != 0;
 		}
 
-		CChunkFileReader::Error Save()
-		{
-			rewindLastTime_ = time_now_d();
+		// While it's still being made, the two states it's made from are counted by StateRingbuffer.
+		size_t MemoryUsage() {
+			std::lock_guard<std::mutex> guard(lock);
+			return compressedSize;
+		}
+	};
 
-			// Make sure we're not processing a previous save. That'll cause a hitch though, but at least won't
-			// crash due to contention over buffer_.
-			if (compressThread_.joinable())
-				compressThread_.join();
+	typedef std::shared_ptr<std::vector<u8>> StateBufferPtr;
 
-			std::lock_guard<std::mutex> guard(lock_);
+	class RewindDeltaTask : public Task {
+	public:
+		RewindDeltaTask(const std::shared_ptr<RewindDelta> &delta, const StateBufferPtr &older, const StateBufferPtr &newer, size_t index)
+			: delta_(delta), older_(older), newer_(newer), index_(index) {}
 
-			int n = next_++ % size_;
-			if ((next_ % size_) == first_)
-				++first_;
+		TaskType Type() const override {
+			return TaskType::CPU_COMPUTE;
+		}
 
-			std::vector<u8> *compressBuffer = &buffer_;
-			CChunkFileReader::Error err;
+		TaskPriority Priority() const override {
+			return TaskPriority::LOW;
+		}
 
-			if (base_ == -1 || ++baseUsage_ > BASE_USAGE_INTERVAL)
-			{
-				base_ = (base_ + 1) % ARRAY_SIZE(bases_);
-				baseUsage_ = 0;
-				err = SaveToRam(bases_[base_]);
-				// Let's not bother savestating twice.
-				compressBuffer = &bases_[base_];
+		void Run() override {
+			const std::vector<u8> &older = *older_;
+			const std::vector<u8> &newer = *newer_;
+			const size_t start = index_ * REWIND_CHUNK_SIZE;
+			const size_t end = std::min(start + REWIND_CHUNK_SIZE, older.size());
+			// The states can differ in size, past the end of the newer one it's just the older one.
+			const size_t overlapEnd = std::min(end, std::max(start, newer.size()));
+
+			std::vector<u8> xored(end - start);
+			for (size_t i = start; i < overlapEnd; i++) {
+				xored[i - start] = older[i] ^ newer[i];
+			}
+			if (overlapEnd < end) {
+				memcpy(&xored[overlapEnd - start], &older[overlapEnd], end - overlapEnd);
 			}
-			else
-				err = SaveToRam(buffer_);
 
-			if (err == CChunkFileReader::ERROR_NONE)
-				ScheduleCompress(&states_[n], compressBuffer, &bases_[base_]);
-			else
-				states_[n].clear();
+			std::vector<u8> compressed(ZSTD_compressBound(xored.size()));
+			size_t result = ZSTD_compress(compressed.data(), compressed.size(), xored.data(), xored.size(), REWIND_ZSTD_LEVEL);
+			if (!ZSTD_isError(result)) {
+				compressed.resize(result);
+				compressed.shrink_to_fit();
+			}
 
-			baseMapping_[n] = base_;
-			return err;
+			std::lock_guard<std::mutex> guard(delta_->lock);
+			if (ZSTD_isError(result)) {
+				delta_->failed = true;
+			} else {
+				delta_->compressedSize += compressed.size();
+				delta_->chunks[index_] = std::move(compressed);
+			}
+			if (--delta_->pending == 0) {
+				delta_->cond.notify_all();
+			}
 		}
 
-		CChunkFileReader::Error Restore(std::string *errorString)
-		{
-			std::lock_guard<std::mutex> guard(lock_);
-
-			// No valid states left.
-			if (Empty())
-				return CChunkFileReader::ERROR_BAD_FILE;
-
-			int n = (--next_ + size_) % size_;
-			if (states_[n].empty())
-				return CChunkFileReader::ERROR_BAD_FILE;
+	private:
+		std::shared_ptr<RewindDelta> delta_;
+		StateBufferPtr older_;
+		StateBufferPtr newer_;
+		size_t index_;
+	};
 
-			static std::vector<u8> buffer;
-			LockedDecompress(buffer, states_[n], bases_[baseMapping_[n]]);
-			CChunkFileReader::Error error = LoadFromRam(buffer, errorString);
+	// This is for rewind save states, which are kept in RAM.
+	// The newest state is kept as is. Going back from there, each state is kept as a RewindDelta against the
+	// one after it. Most of memory doesn't change between snapshots, so those compress to very little.
+	// Deltas are made on the worker threads, so Save() only costs the snapshot itself. Only one is made at a
+	// time, so at most two full states are around besides the newest. The oldest states are dropped to stay
+	// within g_Config.iRewindMemoryBudget.
+	class StateRingbuffer {
+	public:
+		CChunkFileReader::Error Save()
+		{
+			{
+				// If the workers haven't caught up yet, try again next frame rather than pinning more states.
+				std::lock_guard<std::mutex> guard(lock_);
+				if (building_ && building_->Pending())
+					return CChunkFileReader::ERROR_NONE;
+				building_.reset();
+			}
 			rewindLastTime_ = time_now_d();
-			return error;
-		}
 
-		void ScheduleCompress(std::vector<u8> *result, const std::vector<u8> *state, const std::vector<u8> *base)
-		{
-			if (compressThread_.joinable())
-				compressThread_.join();
-			compressThread_ = std::thread([=]{
-				SetCurrentThreadName("SaveStateCompress");
-
-				// Should do no I/O, so no JNI thread context needed.
-				Compress(*result, *state, *base);
-			});
-		}
+			// The buffer the deltas were last made from can be reused, if they're done with it.
+			StateBufferPtr state = spare_.use_count() == 1 ? spare_ : std::make_shared<std::vector<u8>>();
+			spare_.reset();
+			CChunkFileReader::Error err = SaveToRam(*state);
+			if (err != CChunkFileReader::ERROR_NONE)
+				return err;
 
-		void Compress(std::vector<u8> &result, const std::vector<u8> &state, const std::vector<u8> &base)
-		{
 			std::lock_guard<std::mutex> guard(lock_);
-			// Bail if we were cleared before locking.
-			if (first_ == 0 && next_ == 0)
-				return;
-
-			double start_time = time_now_d();
-			result.clear();
-			result.reserve(512 * 1024);
-			for (size_t i = 0; i < state.size(); i += BLOCK_SIZE)
-			{
-				int blockSize = std::min(BLOCK_SIZE, (int)(state.size() - i));
-				if (i + blockSize > base.size() || memcmp(&state[i], &base[i], blockSize) != 0)
-				{
-					result.push_back(1);
-					result.insert(result.end(), state.begin() + i, state.begin() + i + blockSize);
+			if (last_) {
+				auto delta = std::make_shared<RewindDelta>();
+				delta->size = last_->size();
+				size_t count = (delta->size + REWIND_CHUNK_SIZE - 1) / REWIND_CHUNK_SIZE;
+				delta->chunks.resize(count);
+				delta->pending = (int)count;
+				for (size_t i = 0; i < count; i++) {
+					g_threadManager.EnqueueTask(new RewindDeltaTask(delta, last_, state, i));
 				}
-				else
-					result.push_back(0);
+				deltas_.push_back(delta);
+				building_ = delta;
+				spare_ = last_;
 			}
+			last_ = state;
 
-			double taken_s = time_now_d() - start_time;
-			DEBUG_LOG(Log::SaveState, "Rewind: Compressed save from %d bytes to %d in %0.2f ms.", (int)state.size(), (int)result.size(), taken_s * 1000.0);
+			Trim();
+			return err;
 		}
 
-		void LockedDecompress(std::vector<u8> &result, const std::vector<u8> &compressed, const std::vector<u8> &base)
+		CChunkFileReader::Error Restore(std::string *errorString)
 		{
-			result.clear();
-			result.reserve(base.size());
-			auto basePos = base.begin();
-			for (size_t i = 0; i < compressed.size(); )
-			{
-				if (compressed[i] == 0)
-				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(base.size() - result.size()));
-					result.insert(result.end(), basePos, basePos + blockSize);
-					basePos += blockSize;
-				}
-				else
-				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(compressed.size() - i));
-					result.insert(result.end(), compressed.begin() + i, compressed.begin() + i + blockSize);
-					i += blockSize;
-					// This check is to avoid advancing basePos out of range, which MSVC catches.
-					// When this happens, we're at the end of decoding anyway.
-					if (base.end() - basePos >= blockSize) {
-						basePos += blockSize;
-					}
+			std::lock_guard<std::mutex> guard(lock_);
+
+			// No valid states left.
+			if (!last_)
+				return CChunkFileReader::ERROR_BAD_FILE;
+
+			// Step back first. If this one is broken, HandleLoadFailure() tries the one before.
+			StateBufferPtr state = last_;
+			last_.reset();
+			if (!deltas_.empty()) {
+				std::shared_ptr<RewindDelta> delta = deltas_.back();
+				deltas_.pop_back();
+				StateBufferPtr older = std::make_shared<std::vector<u8>>();
+				if (ApplyDelta(*delta, *state, older.get())) {
+					last_ = older;
+				} else {
+					ERROR_LOG(Log::SaveState, "Rewind: Unable to restore older states");
+					deltas_.clear();
 				}
 			}
+
+			CChunkFileReader::Error error = LoadFromRam(*state, errorString);
+			rewindLastTime_ = time_now_d();
+			return error;
 		}
 
 		void Clear()
 		{
-			if (compressThread_.joinable())
-				compressThread_.join();
-
-			// This lock is mainly for shutdown.
 			std::lock_guard<std::mutex> guard(lock_);
-			first_ = 0;
-			next_ = 0;
-			for (auto &b : bases_) {
-				b.clear();
-			}
-			baseMapping_.clear();
-			baseMapping_.resize(size_);
-			for (auto &s : states_) {
-				s.clear();
-			}
-			buffer_.clear();
-			base_ = -1;
-			baseUsage_ = 0;
+			// Deltas still being made hold on to what they need, and are just thrown away when done.
+			// building_ stays, so the next one still waits for it.
+			deltas_.clear();
+			last_.reset();
+			spare_.reset();
 			rewindLastTime_ = time_now_d();
 		}
 
-		bool Empty() const
+		bool Empty()
 		{
-			return next_ == first_;
+			std::lock_guard<std::mutex> guard(lock_);
+			return !last_;
 		}
 
 		void Process() {
@@ -295,26 +311,61 @@ namespace SaveState
 		}
 
 	private:
-		const int BLOCK_SIZE = 8192;
-		const int REWIND_NUM_STATES = 20;
-		// TODO: Instead, based on size of compressed state?
-		const int BASE_USAGE_INTERVAL = 15;
+		static bool ApplyDelta(RewindDelta &delta, const std::vector<u8> &newer, std::vector<u8> *older)
+		{
+			delta.Wait();
+			if (delta.failed)
+				return false;
 
-		typedef std::vector<u8> StateBuffer;
+			double start_time = time_now_d();
+			older->resize(delta.size);
+			// Not vector<bool>, the threads write next to each other.
+			std::vector<u8> success(delta.chunks.size());
+			ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+				for (int i = lower; i < upper; i++) {
+					const size_t start = i * REWIND_CHUNK_SIZE;
+					const size_t end = std::min(start + REWIND_CHUNK_SIZE, delta.size);
+					const std::vector<u8> &chunk = delta.chunks[i];
+					size_t result = ZSTD_decompress(older->data() + start, end - start, chunk.data(), chunk.size());
+					if (ZSTD_isError(result) || result != end - start)
+						continue;
+
+					const size_t overlapEnd = std::min(end, std::max(start, newer.size()));
+					for (size_t j = start; j < overlapEnd; j++) {
+						(*older)[j] ^= newer[j];
+					}
+					success[i] = 1;
+				}
+			}, 0, (int)delta.chunks.size(), 1);
 
-		int first_ = 0;
-		int next_ = 0;
-		int size_;
+			double taken_s = time_now_d() - start_time;
+			DEBUG_LOG(Log::SaveState, "Rewind: Restored %d bytes from %d in %0.2f ms.", (int)delta.size, (int)delta.compressedSize, taken_s * 1000.0);
+			return std::all_of(success.begin(), success.end(), [](u8 s) { return s != 0; });
+		}
 
-		std::vector<StateBuffer> states_;
-		StateBuffer bases_[2];
-		std::vector<int> baseMapping_;
-		std::mutex lock_;
-		std::thread compressThread_;
-		std::vector<u8> buffer_;
+		// Drops the oldest states until the rest fit in the budget. The newest is always kept.
+		void Trim()
+		{
+			const size_t budget = (size_t)std::max(g_Config.iRewindMemoryBudget, 0) * 1024 * 1024;
+			// spare_ is kept for the next snapshot, and until then it's what the newest delta is made from.
+			size_t used = (last_ ? last_->size() : 0) + (spare_ ? spare_->size() : 0);
+			size_t keep = 0;
+			for (auto it = deltas_.rbegin(); it != deltas_.rend(); ++it) {
+				used += (*it)->MemoryUsage();
+				if (used > budget)
+					break;
+				keep++;
+			}
+			deltas_.erase(deltas_.begin(), deltas_.end() - keep);
+		}
 
-		int base_ = -1;
-		int baseUsage_ = 0;
+		// Oldest first.
+		std::deque<std::shared_ptr<RewindDelta>> deltas_;
+		StateBufferPtr last_;
+		StateBufferPtr spare_;
+		// The newest delta, until it's done. Not dropped by Clear() or Trim().
+		std::shared_ptr<RewindDelta> building_;
+		std::mutex lock_;
 
 		double rewindLastTime_ = 0.0f;
 	};
@@ -337,6 +388,55 @@ namespace SaveState
 	static const int SCREENSHOT_FAILURE_RETRIES = 15;
 	static StateRingbuffer rewindStates;
 
+	// A save state that has been taken, but is still being compressed and written out.
+	// Only one is in flight at a time, so they finish (and SaveSlot renames them) in order.
+	struct PendingWrite {
+		PendingWrite(const Operation &op_, const std::string &slotPrefix_) : op(op_), slotPrefix(slotPrefix_) {}
+
+		Operation op;
+		std::string slotPrefix;
+		CChunkFileReader::Error result = CChunkFileReader::ERROR_NONE;
+		bool done = false;
+	};
+
+	// Only touched on the emu thread, except result and done (under pendingWriteLock.)
+	static PendingWrite *pendingWrite = nullptr;
+	static std::mutex pendingWriteLock;
+	static std::condition_variable pendingWriteCond;
+
+	class SaveStateWriteTask : public Task {
+	public:
+		// Takes ownership of buffer (malloc/free.)
+		SaveStateWriteTask(PendingWrite *write, const std::string &title, u8 *buffer, size_t sz, std::vector<SerializeCheckpoint> &&sections)
+			: write_(write), filename_(write->op.filename), title_(title), buffer_(buffer), sz_(sz), sections_(std::move(sections)) {}
+
+		TaskType Type() const override {
+			return TaskType::IO_BLOCKING;
+		}
+
+		TaskPriority Priority() const override {
+			return TaskPriority::HIGH;
+		}
+
+		void Run() override {
+			// The compression itself is spread over the compute threads.
+			CChunkFileReader::Error result = CChunkFileReader::SaveFile(filename_, title_, PPSSPP_GIT_VERSION, buffer_, sz_, sections_);
+
+			std::lock_guard<std::mutex> guard(pendingWriteLock);
+			write_->result = result;
+			write_->done = true;
+			pendingWriteCond.notify_all();
+		}
+
+	private:
+		PendingWrite *write_;
+		Path filename_;
+		std::string title_;
+		u8 *buffer_;
+		size_t sz_;
+		std::vector<SerializeCheckpoint> sections_;
+	};
+
 	void SaveStart::DoState(PointerWrap &p)
 	{
 		auto s = p.Section("SaveStart", 1, 3);
@@ -910,9 +1010,56 @@ namespace SaveState
 		return Status::SUCCESS;
 	}
 
+	static void ResetAVDumping() {
+#ifndef MOBILE_DEVICE
+		if (g_Config.bSaveLoadResetsAVdumping) {
+			if (g_Config.bDumpFrames) {
+				AVIDump::Stop();
+				AVIDump::Start(PSP_CoreParameter().renderWidth, PSP_CoreParameter().renderHeight);
+			}
+			if (g_Config.bDumpAudio) {
+				WAVDump::Reset();
+			}
+		}
+#endif
+	}
+
+	// Calls back for the save state being written, if it's done (or wait is set.)
+	static void FinishPendingWrite(bool wait) {
+		if (!pendingWrite)
+			return;
+
+		{
+			std::unique_lock<std::mutex> guard(pendingWriteLock);
+			if (!pendingWrite->done && !wait)
+				return;
+			pendingWriteCond.wait(guard, [] { return pendingWrite->done; });
+		}
+
+		PendingWrite *write = pendingWrite;
+		pendingWrite = nullptr;
+
+		auto sc = GetI18NCategory(I18NCat::SCREEN);
+		Status callbackResult;
+		std::string callbackMessage;
+		if (write->result == CChunkFileReader::ERROR_NONE) {
+			callbackMessage = write->slotPrefix + std::string(sc->T("Saved State"));
+			callbackResult = Status::SUCCESS;
+		} else {
+			callbackMessage = sc->T("Failed to save state");
+			callbackResult = Status::FAILURE;
+		}
+
+		// The callback may queue more operations, like the load after saving the load undo state.
+		if (write->op.callback)
+			write->op.callback(callbackResult, callbackMessage, write->op.cbUserData);
+		delete write;
+	}
+
 	// NOTE: This can cause ending of the current renderpass, due to the readback needed for the screenshot.
 	bool Process() {
 		rewindStates.Process();
+		FinishPendingWrite(false);
 
 		if (!needsProcess)
 			return false;
@@ -934,8 +1081,12 @@ namespace SaveState
 			CChunkFileReader::Error result;
 			Status callbackResult;
 			bool tempResult;
+			bool callbackLater = false;
 			std::string callbackMessage;
 			std::string title;
+			u8 *saveBuffer;
+			size_t saveSize;
+			std::vector<SerializeCheckpoint> saveSections;
 
 			auto sc = GetI18NCategory(I18NCat::SCREEN);
 			const char *i18nLoadFailure = sc->T_cstr("Failed to load state");
@@ -948,6 +1099,8 @@ namespace SaveState
 			{
 			case SAVESTATE_LOAD:
 				INFO_LOG(Log::SaveState, "Loading state from '%s'", op.filename.c_str());
+				// It might be the state we're still writing.
+				FinishPendingWrite(true);
 				// Use the state's latest version as a guess for saveStateInitialGitVersion.
 				result = CChunkFileReader::Load(op.filename, &saveStateInitialGitVersion, state, &errorString);
 				if (result == CChunkFileReader::ERROR_NONE) {
@@ -959,17 +1112,7 @@ namespace SaveState
 					if (!slot_prefix.empty())
 						callbackMessage = slot_prefix + callbackMessage;
 
-#ifndef MOBILE_DEVICE
-					if (g_Config.bSaveLoadResetsAVdumping) {
-						if (g_Config.bDumpFrames) {
-							AVIDump::Stop();
-							AVIDump::Start(PSP_CoreParameter().renderWidth, PSP_CoreParameter().renderHeight);
-						}
-						if (g_Config.bDumpAudio) {
-							WAVDump::Reset();
-						}
-					}
-#endif
+					ResetAVDumping();
 				} else if (result == CChunkFileReader::ERROR_BROKEN_STATE) {
 					HandleLoadFailure(false);
 					callbackMessage = std::string(i18nLoadFailure) + ": " + errorString;
@@ -990,21 +1133,19 @@ namespace SaveState
 					std::size_t lslash = title.find_last_of('/');
 					title = title.substr(lslash + 1);
 				}
-				result = CChunkFileReader::Save(op.filename, title, PPSSPP_GIT_VERSION, state);
+				// Let the previous one land first, its callback may still rename files.
+				FinishPendingWrite(true);
+				// Only the snapshot is taken here. It's compressed and written in the background,
+				// and FinishPendingWrite() calls back once it's on disk.
+				saveBuffer = nullptr;
+				saveSize = 0;
+				result = CChunkFileReader::MeasureAndSavePtr(state, &saveBuffer, &saveSize, &saveSections);
 				if (result == CChunkFileReader::ERROR_NONE) {
-					callbackMessage = slot_prefix + std::string(sc->T("Saved State"));
-					callbackResult = Status::SUCCESS;
-#ifndef MOBILE_DEVICE
-					if (g_Config.bSaveLoadResetsAVdumping) {
-						if (g_Config.bDumpFrames) {
-							AVIDump::Stop();
-							AVIDump::Start(PSP_CoreParameter().renderWidth, PSP_CoreParameter().renderHeight);
-						}
-						if (g_Config.bDumpAudio) {
-							WAVDump::Reset();
-						}
-					}
-#endif
+					// The dump restarts at the frame the state was taken, not whenever the write lands.
+					ResetAVDumping();
+					pendingWrite = new PendingWrite(op, slot_prefix);
+					g_threadManager.EnqueueTask(new SaveStateWriteTask(pendingWrite, title, saveBuffer, saveSize, std::move(saveSections)));
+					callbackLater = true;
 				} else if (result == CChunkFileReader::ERROR_BROKEN_STATE) {
 					// TODO: What else might we want to do here? This should be very unusual.
 					callbackMessage = i18nSaveFailure;
@@ -1075,7 +1216,7 @@ namespace SaveState
 				break;
 			}
 
-			if (op.callback)
+			if (op.callback && !callbackLater)
 				op.callback(callbackResult, callbackMessage, op.cbUserData);
 		}
 		if (operations.size()) {
@@ -1124,6 +1265,9 @@ namespace SaveState
 
 	void Shutdown()
 	{
+		// Make sure the last save makes it to disk.
+		FinishPendingWrite(true);
+
 		std::lock_guard<std::mutex> guard(mutex);
 		rewindStates.Clear();
 	}
@@ -418,11 +418,18 @@ bool PSP_InitStart(const CoreParameter &coreParam, std::string *error_string) {
 
 	Path filename = g_CoreParameter.fileToStart;
 	FileLoader *loadedFile = ResolveFileLoaderTarget(ConstructFileLoader(filename));
+	bool cachedInRam = false;
 #if PPSSPP_ARCH(AMD64)
 	if (g_Config.bCacheFullIsoInRam) {
 		loadedFile = new RamCachingFileLoader(loadedFile);
+		cachedInRam = true;
 	}
 #endif
+	// Only when asked for. If the storage goes away (USB stick, network share), reading a mapped file
+	// crashes rather than failing the read. If it can't be mapped, it's just read normally.
+	if (g_Config.bMemoryMapIso && !cachedInRam) {
+		loadedFile->MapIntoMemory();
+	}
 
 	if (g_Config.bAchievementsEnable) {
 		// Need to re-identify after ResolveFileLoaderTarget - although in practice probably not,
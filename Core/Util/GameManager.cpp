@@ -301,7 +301,7 @@ void DetectZipFileContents(struct zip *z, ZipFileInfo *info) {
 				INFO_LOG(Log::HLE, "Wrong number of slashes (%i) in '%s'", slashCount, fn);
 			}
 			// TODO: Extract icon and param.sfo from the pbp to be able to display it on the install screen.
-		} else if (endsWith(zippedName, ".iso") || endsWith(zippedName, ".cso") || endsWith(zippedName, ".chd")) {
+		} else if (endsWith(zippedName, ".iso") || endsWith(zippedName, ".cso") || endsWith(zippedName, ".zso") || endsWith(zippedName, ".chd")) {
 			if (slashCount <= 1) {
 				// We only do this if the ISO file is in the root or one level down.
 				isZippedISO = true;
@@ -392,7 +392,7 @@ void GameManager::InstallZipContents(ZipFileTask task) {
 	std::string urlExtension = task.url.GetFileExtension();
 	// Examine the URL to guess out what we're installing.
 	// TODO: Bad idea due to Android content api where we don't always get the filename.
-	if (urlExtension == ".cso" || urlExtension == ".iso" || urlExtension == ".chd") {
+	if (urlExtension == ".cso" || urlExtension == ".zso" || urlExtension == ".iso" || urlExtension == ".chd") {
 		// It's a raw ISO or CSO file. We just copy it to the destination, which is the
 		// currently selected directory in the game browser. Note: This might not be a good option!
 		Path destPath = Path(g_Config.currentDirectory) / task.url.GetFilename();
@@ -23,6 +23,7 @@
 #include "Common/LogReporting.h"
 #include "Common/Math/CrossSIMD.h"
 #include "Common/Math/lin/matrix4x4.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/SplineCommon.h"
@@ -36,6 +37,12 @@ enum {
 	TRANSFORMED_VERTEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * sizeof(TransformedVertex)
 };
 
+// Below this many vertices in a flush, the overhead of waking up the worker threads isn't worth it.
+enum {
+	PARALLEL_DECODE_MIN_VERTS = 12288,
+	PARALLEL_DECODE_MIN_VERTS_PER_TASK = 4096,
+};
+
 DrawEngineCommon::DrawEngineCommon() : decoderMap_(16) {
 	if (g_Config.bVertexDecoderJit && (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR)) {
 		decJitCache_ = new VertexDecoderJitCache();
@@ -1040,10 +1047,13 @@ bool DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 
 void DrawEngineCommon::DecodeVerts(u8 *dest) {
 	// Note that this should be able to continue a partial decode - we don't necessarily start from zero here (although we do most of the time).
-	int i = decodeVertsCounter_;
-	int stride = (int)dec_->GetDecVtxFmt().stride;
+	const int first = decodeVertsCounter_;
+	const int startDecodedVerts = numDecodedVerts_;
+
+	// First lay out the draws in the decoded buffer. This is cheap and has to be sequential.
+	int i = first;
 	for (; i < numDrawVerts_; i++) {
-		DeferredVerts &dv = drawVerts_[i];
+		const DeferredVerts &dv = drawVerts_[i];
 
 		int indexLowerBound = dv.indexLowerBound;
 		drawVertexOffsets_[i] = numDecodedVerts_ - indexLowerBound;
@@ -1055,11 +1065,43 @@ void DrawEngineCommon::DecodeVerts(u8 *dest) {
 			break;
 		}
 
-		// Decode the verts (and at the same time apply morphing/skinning). Simple.
-		dec_->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
 		numDecodedVerts_ += indexUpperBound - indexLowerBound + 1;
 	}
 	decodeVertsCounter_ = i;
+
+	const int last = i;
+	const int numVerts = numDecodedVerts_ - startDecodedVerts;
+	if (numVerts >= PARALLEL_DECODE_MIN_VERTS && dec_->SupportsParallelDecode() && g_threadManager.GetNumLooperThreads() > 1) {
+		PROFILE_THIS_SCOPE("vertdec_mt");
+		// Each task gets a disjoint range of the output buffer, which may span several draws or part of one.
+		ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+			DecodeVertRange(dest, first, last, lower, upper);
+		}, startDecodedVerts, numDecodedVerts_, PARALLEL_DECODE_MIN_VERTS_PER_TASK, TaskPriority::HIGH);
+	} else {
+		PROFILE_THIS_SCOPE("vertdec");
+		DecodeVertRange(dest, first, last, startDecodedVerts, numDecodedVerts_);
+	}
+}
+
+// Decodes the vertices that land in [lower, upper) of the decoded buffer, from the already laid out draws [first, last).
+void DrawEngineCommon::DecodeVertRange(u8 *dest, int first, int last, int lower, int upper) const {
+	const int stride = (int)dec_->GetDecVtxFmt().stride;
+	for (int i = first; i < last; i++) {
+		const DeferredVerts &dv = drawVerts_[i];
+		const int drawStart = (int)drawVertexOffsets_[i] + dv.indexLowerBound;
+		const int drawEnd = drawStart + dv.indexUpperBound + 1 - dv.indexLowerBound;
+		if (drawEnd <= lower) {
+			continue;
+		}
+		if (drawStart >= upper) {
+			break;
+		}
+
+		const int start = std::max(drawStart, lower);
+		const int end = std::min(drawEnd, upper);
+		// Decode the verts (and at the same time apply morphing/skinning). Simple.
+		dec_->DecodeVerts(dest + start * stride, dv.verts, &dv.uvScale, dv.indexLowerBound + (start - drawStart), dv.indexLowerBound + (end - drawStart) - 1);
+	}
 }
 
 int DrawEngineCommon::DecodeInds() {
@@ -157,6 +157,7 @@ class DrawEngineCommon {
 	void UpdatePlanes();
 
 	void DecodeVerts(u8 *dest);
+	void DecodeVertRange(u8 *dest, int first, int last, int lower, int upper) const;
 	int DecodeInds();
 
 	// Preprocessing for spline/bezier
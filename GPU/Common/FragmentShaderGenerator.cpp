@@ -129,6 +129,9 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 	}
 
 	ShaderDepalMode shaderDepalMode = (ShaderDepalMode)id.Bits(FS_BIT_SHADER_DEPAL_MODE, 2);
+	if (id.Bit(FS_BIT_SHADER_DEPAL_INDEXED)) {
+		shaderDepalMode = ShaderDepalMode::CLUT_INDEXED;
+	}
 	if (texture3D) {
 		shaderDepalMode = ShaderDepalMode::OFF;
 	}
@@ -851,6 +854,48 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 				p.C("  }\n");
 				p.C("  t = ").LoadTexture2D("pal", "ivec2(index, 0)", 0).C(";\n");
 				break;
+			case ShaderDepalMode::CLUT_INDEXED:
+				// Ordinary CLUT4/CLUT8 texture uploaded as raw 8-bit indices. The palette is a row of the CLUT atlas.
+				// Filtering has to be done manually after the lookup, like in NORMAL.
+				if (doTextureProjection) {
+					p.F("  vec2 uv = %s.xy/%s.z;\n  vec2 uv_round;\n", texcoord, texcoord);
+				} else {
+					p.F("  vec2 uv = %s.xy;\n  vec2 uv_round;\n", texcoord);
+				}
+				p.C("  vec2 tsize = vec2(textureSize(tex, 0).xy);\n");
+				p.C("  vec2 fraction;\n");
+				p.C("  bool bilinear = (u_depal_mask_shift_off_fmt >> 0x1Fu) != 0x0u;\n");
+				p.C("  if (bilinear) {\n");
+				p.C("    uv_round = uv * tsize - vec2(0.5, 0.5);\n");
+				p.C("    fraction = fract(uv_round);\n");
+				p.C("    uv_round = (uv_round - fraction + vec2(0.5, 0.5)) / tsize;\n");
+				p.C("  } else {\n");
+				p.C("    uv_round = uv;\n");
+				p.C("  }\n");
+				p.C("  highp vec4 t = ").SampleTexture2D("tex", "uv_round").C(";\n");
+				p.C("  uint depalMask = (u_depal_mask_shift_off_fmt & 0xFFu);\n");
+				p.C("  uint depalShift = (u_depal_mask_shift_off_fmt >> 0x8u) & 0xFFu;\n");
+				p.C("  uint depalOffset = ((u_depal_mask_shift_off_fmt >> 0x10u) & 0xFFu) << 0x4u;\n");
+				p.C("  uint depalRow = (u_depal_mask_shift_off_fmt >> 0x18u) & 0x7Fu;\n");
+				p.C("  uint index0 = ((uint(t.r * 255.99) >> depalShift) & depalMask) | depalOffset;\n");
+				p.C("  t = ").LoadTexture2D("pal", "ivec2(index0, depalRow)", 0).C(";\n");
+				p.C("  if (bilinear) {\n");
+				p.C("    highp vec4 t1 = ").SampleTexture2DOffset("tex", "uv_round", 1, 0).C(";\n");
+				p.C("    highp vec4 t2 = ").SampleTexture2DOffset("tex", "uv_round", 0, 1).C(";\n");
+				p.C("    highp vec4 t3 = ").SampleTexture2DOffset("tex", "uv_round", 1, 1).C(";\n");
+				p.C("    uint index1 = ((uint(t1.r * 255.99) >> depalShift) & depalMask) | depalOffset;\n");
+				p.C("    uint index2 = ((uint(t2.r * 255.99) >> depalShift) & depalMask) | depalOffset;\n");
+				p.C("    uint index3 = ((uint(t3.r * 255.99) >> depalShift) & depalMask) | depalOffset;\n");
+				p.C("    if (!(index0 == index1 && index1 == index2 && index2 == index3)) {\n");
+				p.C("      t1 = ").LoadTexture2D("pal", "ivec2(index1, depalRow)", 0).C(";\n");
+				p.C("      t2 = ").LoadTexture2D("pal", "ivec2(index2, depalRow)", 0).C(";\n");
+				p.C("      t3 = ").LoadTexture2D("pal", "ivec2(index3, depalRow)", 0).C(";\n");
+				p.C("      t = mix(t, t1, fraction.x);\n");
+				p.C("      t2 = mix(t2, t3, fraction.x);\n");
+				p.C("      t = mix(t, t2, fraction.y);\n");
+				p.C("    }\n");
+				p.C("  }\n");
+				break;
 			}
 
 			WRITE(p, "  vec4 p = v_color0;\n");
@@ -464,17 +464,31 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 
 	level.fileRef = fileRef;
 
+	// Once read into memory, close right away. Some backends (ZipFileReader) hold a lock until then, which
+	// would serialize decoding. Only a pointer from DataPointer() needs the file to stay open.
+	auto closeFile = [&]() {
+		if (openFile) {
+			vfs_->CloseFile(openFile);
+			openFile = nullptr;
+		}
+	};
+
 	if (imageType == ReplacedImageType::KTX2) {
-		// Just slurp the whole file in one go and feed to the decoder.
+		// Just slurp the whole file in one go and feed to the decoder, unless it's already in memory.
 		std::vector<uint8_t> buffer;
-		buffer.resize(fileSize);
-		buffer.resize(vfs_->Read(openFile, &buffer[0], buffer.size()));
-		vfs_->CloseFile(openFile);
+		const uint8_t *fileData = vfs_->DataPointer(openFile);
+		if (!fileData) {
+			buffer.resize(fileSize);
+			buffer.resize(vfs_->Read(openFile, &buffer[0], buffer.size()));
+			closeFile();
+			fileData = buffer.data();
+			fileSize = buffer.size();
+		}
 
 		basist::ktx2_transcoder transcoder;
-		if (!transcoder.init(buffer.data(), (int)buffer.size())) {
+		if (!transcoder.init(fileData, (int)fileSize)) {
 			WARN_LOG(Log::TexReplacement, "Error reading KTX file");
-			vfs_->CloseFile(openFile);
+			closeFile();
 			return LoadLevelResult::LOAD_ERROR;
 		}
 
@@ -514,7 +528,7 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 			}
 		} else {
 			WARN_LOG(Log::TexReplacement, "PPSSPP currently only supports KTX for basis/UASTC textures. This may change in the future.");
-			vfs_->CloseFile(openFile);
+			closeFile();
 			return LoadLevelResult::LOAD_ERROR;
 		}
 
@@ -559,6 +573,7 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 			levels_.push_back(level);
 		}
 		transcoder.clear();
+		closeFile();
 
 		return LoadLevelResult::DONE;  // don't read more levels
 	} else if (imageType == ReplacedImageType::DDS) {
@@ -601,31 +616,38 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 			if (i != 0)
 				level.fileRef = nullptr;  // We only provide a fileref on level 0 if we have mipmaps.
 		}
-		vfs_->CloseFile(openFile);
+		closeFile();
 
 		return LoadLevelResult::DONE;  // don't read more levels
 
 	} else if (imageType == ReplacedImageType::ZIM) {
 
-		auto zim = std::make_unique<uint8_t[]>(fileSize);
-		if (!zim) {
-			ERROR_LOG(Log::TexReplacement, "Failed to allocate memory for texture replacement");
-			vfs_->CloseFile(openFile);
-			return LoadLevelResult::LOAD_ERROR;
-		}
+		std::unique_ptr<uint8_t[]> zim;
+		const uint8_t *zimData = vfs_->DataPointer(openFile);
+		if (!zimData) {
+			zim = std::make_unique<uint8_t[]>(fileSize);
+			if (!zim) {
+				ERROR_LOG(Log::TexReplacement, "Failed to allocate memory for texture replacement");
+				closeFile();
+				return LoadLevelResult::LOAD_ERROR;
+			}
 
-		if (vfs_->Read(openFile, &zim[0], fileSize) != fileSize) {
-			ERROR_LOG(Log::TexReplacement, "Could not load texture replacement: %s - failed to read ZIM", filename.c_str());
-			vfs_->CloseFile(openFile);
-			return LoadLevelResult::LOAD_ERROR;
+			if (vfs_->Read(openFile, &zim[0], fileSize) != fileSize) {
+				ERROR_LOG(Log::TexReplacement, "Could not load texture replacement: %s - failed to read ZIM", filename.c_str());
+				closeFile();
+				return LoadLevelResult::LOAD_ERROR;
+			}
+			closeFile();
+			zimData = &zim[0];
 		}
-		vfs_->CloseFile(openFile);
 
 		int w, h, f;
 		uint8_t *image;
 		std::vector<uint8_t> &out = data_[mipLevel];
 		// TODO: Zim files can actually hold mipmaps (although no tool has ever been made to create them :P)
-		if (LoadZIMPtr(&zim[0], fileSize, &w, &h, &f, &image)) {
+		int zimResult = LoadZIMPtr(zimData, fileSize, &w, &h, &f, &image);
+		closeFile();
+		if (zimResult) {
 			if (w > level.w || h > level.h) {
 				ERROR_LOG(Log::TexReplacement, "Texture replacement changed since header read: %s", filename.c_str());
 				return LoadLevelResult::LOAD_ERROR;
@@ -657,15 +679,23 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 		png.version = PNG_IMAGE_VERSION;
 
 		std::string pngdata;
-		pngdata.resize(fileSize);
-		pngdata.resize(vfs_->Read(openFile, &pngdata[0], fileSize));
-		vfs_->CloseFile(openFile);
-		if (!png_image_begin_read_from_memory(&png, &pngdata[0], pngdata.size())) {
+		const uint8_t *pngData = vfs_->DataPointer(openFile);
+		if (!pngData) {
+			pngdata.resize(fileSize);
+			pngdata.resize(vfs_->Read(openFile, &pngdata[0], fileSize));
+			closeFile();
+			pngData = (const uint8_t *)pngdata.data();
+			fileSize = pngdata.size();
+		}
+		if (!png_image_begin_read_from_memory(&png, pngData, fileSize)) {
 			ERROR_LOG(Log::TexReplacement, "Could not load texture replacement info: %s - %s (zip)", filename.c_str(), png.message);
+			closeFile();
 			return LoadLevelResult::LOAD_ERROR;
 		}
 		if (png.width > (uint32_t)level.w || png.height > (uint32_t)level.h) {
 			ERROR_LOG(Log::TexReplacement, "Texture replacement changed since header read: %s", filename.c_str());
+			png_image_free(&png);
+			closeFile();
 			return LoadLevelResult::LOAD_ERROR;
 		}
 
@@ -684,11 +714,12 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 		out.resize(level.w * level.h * 4);
 		if (!png_image_finish_read(&png, nullptr, &out[0], level.w * 4, nullptr)) {
 			ERROR_LOG(Log::TexReplacement, "Could not load texture replacement: %s - %s", filename.c_str(), png.message);
-			vfs_->CloseFile(openFile);
+			closeFile();
 			out.resize(0);
 			return LoadLevelResult::LOAD_ERROR;
 		}
 		png_image_free(&png);
+		closeFile();
 
 		if (!checkedAlpha) {
 			// This will only check the hashed bits.
@@ -702,7 +733,7 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 		return LoadLevelResult::CONTINUE;
 	} else {
 		WARN_LOG(Log::TexReplacement, "Don't know how to load this image type! %d", (int)imageType);
-		vfs_->CloseFile(openFile);
+		closeFile();
 	}
 	return LoadLevelResult::LOAD_ERROR;
 }
@@ -0,0 +1,265 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include "ext/xxhash.h"
+#include "Common/File/DirListing.h"
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/StringUtils.h"
+#include "Core/Config.h"
+#include "Core/System.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/ShaderGenCache.h"
+
+ShaderGenCache g_shaderGenCache;
+
+// Stored in front of every entry. The key hash is repeated so a misnamed file can't be picked up,
+// and the payload hash catches truncated writes.
+struct ShaderGenCacheHeader {
+	uint32_t magic;
+	uint32_t payloadSize;
+	uint64_t keyHashLow;
+	uint64_t keyHashHigh;
+	uint64_t payloadHash;
+};
+
+static const uint32_t SHADERGEN_CACHE_MAGIC = 0x43475350;  // "PSGC"
+
+static void AppendBytes(std::string *key, const void *data, size_t size) {
+	key->append((const char *)data, size);
+}
+
+template <typename T>
+static void AppendValue(std::string *key, T value) {
+	AppendBytes(key, &value, sizeof(value));
+}
+
+static void AppendCString(std::string *key, const char *str, size_t maxLen = 256) {
+	if (str) {
+		size_t len = strnlen(str, maxLen);
+		AppendValue(key, (uint32_t)len);
+		AppendBytes(key, str, len);
+	} else {
+		AppendValue(key, (uint32_t)0xFFFFFFFF);
+	}
+}
+
+void ShaderGenCache::SetDirectory(const Path &dir) {
+	if (dir.Valid() && !File::Exists(dir) && !File::CreateFullPath(dir)) {
+		WARN_LOG(Log::G3D, "Failed to create shader generation cache directory %s", dir.c_str());
+		dir_.clear();
+		return;
+	}
+	dir_ = dir;
+	if (dir_.Valid()) {
+		Trim(SHADERGEN_CACHE_MAX_SIZE);
+	}
+}
+
+void ShaderGenCache::Trim(uint64_t maxSize) {
+	if (!Enabled())
+		return;
+
+	std::vector<File::FileInfo> files;
+	File::GetFilesInDir(dir_, &files);
+	uint64_t totalSize = 0;
+	std::vector<const File::FileInfo *> entries;
+	for (const File::FileInfo &file : files) {
+		if (file.isDirectory)
+			continue;
+		if (endsWith(file.name, ".tmp")) {
+			// Left behind by a crash during Store.
+			File::Delete(file.fullName);
+			continue;
+		}
+		totalSize += file.size;
+		entries.push_back(&file);
+	}
+	if (totalSize <= maxSize)
+		return;
+
+	// Leave some room, so this doesn't run again right away.
+	const uint64_t targetSize = maxSize / 4 * 3;
+	std::sort(entries.begin(), entries.end(), [](const File::FileInfo *a, const File::FileInfo *b) {
+		return a->mtime < b->mtime;
+	});
+	int deleted = 0;
+	for (const File::FileInfo *entry : entries) {
+		if (totalSize <= targetSize)
+			break;
+		if (File::Delete(entry->fullName)) {
+			totalSize -= entry->size;
+			deleted++;
+		}
+	}
+	INFO_LOG(Log::G3D, "Trimmed the shader generation cache, deleted %d entries", deleted);
+}
+
+void ShaderGenCache::ResetStats() {
+	hits_ = 0;
+	misses_ = 0;
+}
+
+std::string ShaderGenCache::SourceKey(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs) const {
+	std::string key;
+	key.reserve(512);
+	AppendValue(&key, (uint32_t)SHADERGEN_CACHE_VERSION);
+	AppendValue(&key, kind);
+	AppendValue(&key, id.d[0]);
+	AppendValue(&key, id.d[1]);
+
+	AppendValue(&key, compat.shaderLanguage);
+	AppendValue(&key, compat.glslVersionNumber);
+	const bool compatBools[] = { compat.gles, compat.vertexIndex, compat.glslES30, compat.bitwiseOps, compat.forceMatrix4x4, compat.coefsFromBuffers };
+	AppendBytes(&key, compatBools, sizeof(compatBools));
+	const char *compatStrings[] = {
+		compat.varying_fs, compat.varying_vs, compat.attribute, compat.fragColor0, compat.fragColor1,
+		compat.texture, compat.texture3D, compat.texelFetch, compat.lastFragData, compat.framebufferFetchExtension,
+		compat.vsOutPrefix, compat.viewportYSign,
+	};
+	for (const char *str : compatStrings) {
+		AppendCString(&key, str);
+	}
+	AppendCString(&key, compat.driverInfo, sizeof(compat.driverInfo));
+
+	uint32_t bugFlags = 0;
+	for (uint32_t i = 0; i < bugs.MaxBugIndex(); i++) {
+		if (bugs.Has(i))
+			bugFlags |= 1 << i;
+	}
+	AppendValue(&key, bugFlags);
+
+	// The rest of the global state the generators look at.
+	AppendValue(&key, gstate_c.UseFlags());
+	AppendValue(&key, g_Config.bVendorBugChecksEnabled);
+	if (gstate_c.Use(GPU_USE_VIRTUAL_REALITY)) {
+		AppendValue(&key, PSP_CoreParameter().compat.vrCompat().UnitsPerMeter);
+	}
+	return key;
+}
+
+Path ShaderGenCache::EntryPath(const std::string &key) const {
+	XXH128_hash_t hash = XXH3_128bits(key.data(), key.size());
+	return dir_ / StringFromFormat("%016llx%016llx.sgc", (unsigned long long)hash.high64, (unsigned long long)hash.low64);
+}
+
+bool ShaderGenCache::Load(const std::string &key, std::string *payload) {
+	if (!Enabled())
+		return false;
+
+	XXH128_hash_t keyHash = XXH3_128bits(key.data(), key.size());
+	std::string data;
+	if (!File::ReadBinaryFileToString(EntryPath(key), &data) || data.size() < sizeof(ShaderGenCacheHeader)) {
+		misses_++;
+		return false;
+	}
+
+	ShaderGenCacheHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+	const char *body = data.data() + sizeof(header);
+	bool valid = header.magic == SHADERGEN_CACHE_MAGIC;
+	valid = valid && header.keyHashLow == keyHash.low64 && header.keyHashHigh == keyHash.high64;
+	valid = valid && header.payloadSize == data.size() - sizeof(header);
+	valid = valid && header.payloadHash == XXH3_64bits(body, header.payloadSize);
+	if (!valid) {
+		WARN_LOG(Log::G3D, "Ignoring corrupt shader generation cache entry %s", EntryPath(key).c_str());
+		misses_++;
+		return false;
+	}
+
+	payload->assign(body, header.payloadSize);
+	hits_++;
+	// Marks it as used for Trim.
+	File::ChangeMTime(EntryPath(key), time(nullptr));
+	return true;
+}
+
+void ShaderGenCache::Store(const std::string &key, const void *data, size_t size) {
+	if (!Enabled())
+		return;
+
+	XXH128_hash_t keyHash = XXH3_128bits(key.data(), key.size());
+	ShaderGenCacheHeader header{};
+	header.magic = SHADERGEN_CACHE_MAGIC;
+	header.payloadSize = (uint32_t)size;
+	header.keyHashLow = keyHash.low64;
+	header.keyHashHigh = keyHash.high64;
+	header.payloadHash = XXH3_64bits(data, size);
+
+	std::string contents;
+	contents.reserve(sizeof(header) + size);
+	AppendBytes(&contents, &header, sizeof(header));
+	AppendBytes(&contents, data, size);
+
+	// Write to a unique temp name and rename into place, so concurrent readers (or another instance)
+	// never see a partial entry. If two threads race on the same key, the contents are identical anyway.
+	Path path = EntryPath(key);
+	Path tempPath = dir_ / StringFromFormat("%s.%u.tmp", path.GetFilename().c_str(), tempCounter_++);
+	if (!File::WriteDataToFile(false, contents.data(), contents.size(), tempPath)) {
+		return;
+	}
+	if (!File::Rename(tempPath, path)) {
+		File::Delete(tempPath);
+	}
+}
+
+bool ShaderGenCache::LoadSource(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::string *payload) {
+	if (!Enabled())
+		return false;
+	return Load(SourceKey(kind, id, compat, bugs), payload);
+}
+
+void ShaderGenCache::StoreSource(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs, const std::string &payload) {
+	if (!Enabled())
+		return;
+	Store(SourceKey(kind, id, compat, bugs), payload.data(), payload.size());
+}
+
+static std::string SPIRVKey(ShaderStage stage, const char *source) {
+	std::string key;
+	size_t len = strlen(source);
+	key.reserve(len + 16);
+	AppendValue(&key, (uint32_t)SPIRV_CACHE_VERSION);
+	AppendValue(&key, ShaderGenCacheKind::SPIRV);
+	AppendValue(&key, stage);
+	AppendBytes(&key, source, len);
+	return key;
+}
+
+bool ShaderGenCache::LoadSPIRV(ShaderStage stage, const char *source, std::vector<uint32_t> *spirv) {
+	if (!Enabled())
+		return false;
+	std::string payload;
+	if (!Load(SPIRVKey(stage, source), &payload))
+		return false;
+	if (payload.empty() || (payload.size() & 3) != 0) {
+		return false;
+	}
+	spirv->resize(payload.size() / sizeof(uint32_t));
+	memcpy(spirv->data(), payload.data(), payload.size());
+	return true;
+}
+
+void ShaderGenCache::StoreSPIRV(ShaderStage stage, const char *source, const std::vector<uint32_t> &spirv) {
+	if (!Enabled() || spirv.empty())
+		return;
+	Store(SPIRVKey(stage, source), spirv.data(), spirv.size() * sizeof(uint32_t));
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common/File/Path.h"
+#include "Common/GPU/Shader.h"
+#include "Common/GPU/thin3d.h"
+#include "GPU/Common/ShaderId.h"
+
+// On-disk cache of generated shader source, and of the SPIR-V compiled from it, shared between games
+// and backends. Entries are content-addressed: the file name is a 128-bit hash of everything that
+// affects the output, so there's nothing to invalidate - a changed input simply misses.
+//
+// Source entries are keyed by the shader ID plus everything else the generators read: the
+// ShaderLanguageDesc, driver bugs, gstate_c's use flags and a few config bits. SPIR-V entries are keyed
+// by the GLSL source itself, so identical source from different IDs or backends shares the entry.
+//
+// Bump SHADERGEN_CACHE_VERSION when a generator change alters the output for the same inputs, and
+// SPIRV_CACHE_VERSION when glslang is updated.
+//
+// Loads bump the modification time of the entry, and SetDirectory trims the cache to
+// SHADERGEN_CACHE_MAX_SIZE by deleting the least recently used entries, so that shaders from old
+// versions, drivers and games don't pile up forever.
+//
+// Loads and stores are safe to call from multiple threads.
+
+enum : uint32_t {
+	SHADERGEN_CACHE_VERSION = 1,
+	SPIRV_CACHE_VERSION = 1,
+	SHADERGEN_CACHE_MAX_SIZE = 64 * 1024 * 1024,
+};
+
+enum class ShaderGenCacheKind : uint8_t {
+	VERTEX = 1,
+	FRAGMENT = 2,
+	GEOMETRY = 3,
+	SPIRV = 4,
+};
+
+class ShaderGenCache {
+public:
+	// An empty path disables the cache, which is the default.
+	void SetDirectory(const Path &dir);
+	bool Enabled() const { return dir_.Valid(); }
+	// Deletes the least recently used entries until the rest fits in 3/4 of maxSize, if over it.
+	void Trim(uint64_t maxSize);
+
+	// Generated source. The key is built from the current global state, so call these in the same
+	// state that the generator would run in. The payload is opaque here, see ShaderPrecompile.
+	bool LoadSource(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::string *payload);
+	void StoreSource(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs, const std::string &payload);
+
+	// SPIR-V compiled (for Vulkan) from a GLSL source.
+	bool LoadSPIRV(ShaderStage stage, const char *source, std::vector<uint32_t> *spirv);
+	void StoreSPIRV(ShaderStage stage, const char *source, const std::vector<uint32_t> &spirv);
+
+	int Hits() const { return hits_; }
+	int Misses() const { return misses_; }
+	void ResetStats();
+
+private:
+	std::string SourceKey(ShaderGenCacheKind kind, const ShaderID &id, const ShaderLanguageDesc &compat, Draw::Bugs bugs) const;
+	Path EntryPath(const std::string &key) const;
+	bool Load(const std::string &key, std::string *payload);
+	void Store(const std::string &key, const void *data, size_t size);
+
+	// Written only while no loads or stores are in flight.
+	Path dir_;
+
+	std::atomic<int> hits_{};
+	std::atomic<int> misses_{};
+	std::atomic<uint32_t> tempCounter_{};
+};
+
+extern ShaderGenCache g_shaderGenCache;
@@ -202,7 +202,9 @@ std::string FragmentShaderDesc(const FShaderID &id) {
 	case ShaderDepalMode::NORMAL: desc << "Depal ";  break;
 	case ShaderDepalMode::SMOOTHED: desc << "SmoothDepal "; break;
 	case ShaderDepalMode::CLUT8_8888: desc << "CLUT8From8888Depal"; break;
+	default: break;
 	}
+	if (id.Bit(FS_BIT_SHADER_DEPAL_INDEXED)) desc << "IndexedDepal ";
 	if (id.Bit(FS_BIT_COLOR_WRITEMASK)) desc << "WriteMask ";
 	if (id.Bit(FS_BIT_SHADER_TEX_CLAMP)) {
 		desc << "TClamp";
@@ -324,7 +326,11 @@ void ComputeFragmentShaderID(FShaderID *id_out, const ComputedPipelineState &pip
 				id.SetBit(FS_BIT_CLAMP_T, gstate.isTexCoordClampedT());
 			}
 			id.SetBit(FS_BIT_BGRA_TEXTURE, gstate_c.bgraTexture);
-			id.SetBits(FS_BIT_SHADER_DEPAL_MODE, 2, (int)shaderDepalMode);
+			if (shaderDepalMode == ShaderDepalMode::CLUT_INDEXED) {
+				id.SetBit(FS_BIT_SHADER_DEPAL_INDEXED);
+			} else {
+				id.SetBits(FS_BIT_SHADER_DEPAL_MODE, 2, (int)shaderDepalMode);
+			}
 			id.SetBit(FS_BIT_3D_TEXTURE, gstate_c.curTextureIs3D);
 		}
 
@@ -103,6 +103,7 @@ enum FShaderBit : uint8_t {
 	FS_BIT_USE_FRAMEBUFFER_FETCH = 59,
 	FS_BIT_UBERSHADER = 60,
 	FS_BIT_DEPTH_TEST_NEVER = 61,  // Only used on Mali. Set when depth == NEVER. We forcibly avoid writing to depth in this case, since it crashes the driver.
+	FS_BIT_SHADER_DEPAL_INDEXED = 62,  // ShaderDepalMode::CLUT_INDEXED, which doesn't fit in FS_BIT_SHADER_DEPAL_MODE.
 };
 
 static inline FShaderBit operator +(FShaderBit bit, int i) {
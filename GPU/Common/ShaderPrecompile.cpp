@@ -0,0 +1,174 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstring>
+#include <memory>
+
+#include "Common/Log.h"
+#include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "GPU/Common/ShaderPrecompile.h"
+#include "GPU/Common/ShaderGenCache.h"
+#include "GPU/Common/GeometryShaderGenerator.h"
+
+// Generating a shader is a fraction of a millisecond, so don't spread too thin.
+static constexpr int MIN_SHADERS_PER_TASK = 4;
+
+// Cache payloads are the fixed-size outputs of the generator followed by the code.
+template <typename T>
+static bool DecodePayload(const std::string &payload, T *header, std::string *code) {
+	if (payload.size() < sizeof(T))
+		return false;
+	memcpy(header, payload.data(), sizeof(T));
+	code->assign(payload.data() + sizeof(T), payload.size() - sizeof(T));
+	return true;
+}
+
+template <typename T>
+static std::string EncodePayload(const T &header, const std::string &code) {
+	std::string payload((const char *)&header, sizeof(T));
+	payload += code;
+	return payload;
+}
+
+struct VertexPayloadHeader {
+	uint64_t uniformMask;
+	uint32_t attrMask;
+	uint32_t flags;
+};
+
+struct FragmentPayloadHeader {
+	uint64_t uniformMask;
+	uint32_t flags;
+	uint32_t pad;
+};
+
+struct GeometryPayloadHeader {
+	uint32_t pad;
+};
+
+void GenerateVertexShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledVertexShader *result) {
+	std::string payload;
+	VertexPayloadHeader header{};
+	if (g_shaderGenCache.LoadSource(ShaderGenCacheKind::VERTEX, result->id, compat, bugs, &payload) && DecodePayload(payload, &header, &result->code)) {
+		result->uniformMask = header.uniformMask;
+		result->attrMask = header.attrMask;
+		result->flags = (VertexShaderFlags)header.flags;
+		result->success = true;
+		return;
+	}
+
+	std::string errorString;
+	buffer[0] = '\0';
+	result->success = GenerateVertexShader(result->id, buffer, compat, bugs, &result->attrMask, &result->uniformMask, &result->flags, &errorString);
+	if (result->success) {
+		_assert_msg_(strlen(buffer) < PRECOMPILE_CODE_BUFFER_SIZE, "VS length error: %d", (int)strlen(buffer));
+		result->code = buffer;
+		header.uniformMask = result->uniformMask;
+		header.attrMask = result->attrMask;
+		header.flags = (uint32_t)result->flags;
+		g_shaderGenCache.StoreSource(ShaderGenCacheKind::VERTEX, result->id, compat, bugs, EncodePayload(header, result->code));
+	} else {
+		ERROR_LOG(Log::G3D, "Failed to generate vertex shader %s: %s", VertexShaderDesc(result->id).c_str(), errorString.c_str());
+	}
+}
+
+void GenerateFragmentShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledFragmentShader *result) {
+	std::string payload;
+	FragmentPayloadHeader header{};
+	if (g_shaderGenCache.LoadSource(ShaderGenCacheKind::FRAGMENT, result->id, compat, bugs, &payload) && DecodePayload(payload, &header, &result->code)) {
+		result->uniformMask = header.uniformMask;
+		result->flags = (FragmentShaderFlags)header.flags;
+		result->success = true;
+		return;
+	}
+
+	std::string errorString;
+	buffer[0] = '\0';
+	result->success = GenerateFragmentShader(result->id, buffer, compat, bugs, &result->uniformMask, &result->flags, &errorString);
+	if (result->success) {
+		_assert_msg_(strlen(buffer) < PRECOMPILE_CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(buffer));
+		result->code = buffer;
+		header.uniformMask = result->uniformMask;
+		header.flags = (uint32_t)result->flags;
+		g_shaderGenCache.StoreSource(ShaderGenCacheKind::FRAGMENT, result->id, compat, bugs, EncodePayload(header, result->code));
+	} else {
+		ERROR_LOG(Log::G3D, "Failed to generate fragment shader %s: %s", FragmentShaderDesc(result->id).c_str(), errorString.c_str());
+	}
+}
+
+void GenerateGeometryShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledGeometryShader *result) {
+	std::string payload;
+	GeometryPayloadHeader header{};
+	if (g_shaderGenCache.LoadSource(ShaderGenCacheKind::GEOMETRY, result->id, compat, bugs, &payload) && DecodePayload(payload, &header, &result->code)) {
+		result->success = true;
+		return;
+	}
+
+	std::string errorString;
+	buffer[0] = '\0';
+	result->success = GenerateGeometryShader(result->id, buffer, compat, bugs, &errorString);
+	if (result->success) {
+		_assert_msg_(strlen(buffer) < PRECOMPILE_CODE_BUFFER_SIZE, "GS length error: %d", (int)strlen(buffer));
+		result->code = buffer;
+		g_shaderGenCache.StoreSource(ShaderGenCacheKind::GEOMETRY, result->id, compat, bugs, EncodePayload(header, result->code));
+	} else {
+		ERROR_LOG(Log::G3D, "Failed to generate geometry shader %s: %s", GeometryShaderDesc(result->id).c_str(), errorString.c_str());
+	}
+}
+
+void PrecompileVertexShaders(const std::vector<VShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledVertexShader> *results) {
+	PROFILE_THIS_SCOPE("shaderprecompile");
+	results->clear();
+	results->resize(ids.size());
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		std::unique_ptr<char[]> buffer(new char[PRECOMPILE_CODE_BUFFER_SIZE]);
+		for (int i = lower; i < upper; i++) {
+			PrecompiledVertexShader &result = (*results)[i];
+			result.id = ids[i];
+			GenerateVertexShaderCached(compat, bugs, buffer.get(), &result);
+		}
+	}, 0, (int)ids.size(), MIN_SHADERS_PER_TASK);
+}
+
+void PrecompileFragmentShaders(const std::vector<FShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledFragmentShader> *results) {
+	PROFILE_THIS_SCOPE("shaderprecompile");
+	results->clear();
+	results->resize(ids.size());
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		std::unique_ptr<char[]> buffer(new char[PRECOMPILE_CODE_BUFFER_SIZE]);
+		for (int i = lower; i < upper; i++) {
+			PrecompiledFragmentShader &result = (*results)[i];
+			result.id = ids[i];
+			GenerateFragmentShaderCached(compat, bugs, buffer.get(), &result);
+		}
+	}, 0, (int)ids.size(), MIN_SHADERS_PER_TASK);
+}
+
+void PrecompileGeometryShaders(const std::vector<GShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledGeometryShader> *results) {
+	PROFILE_THIS_SCOPE("shaderprecompile");
+	results->clear();
+	results->resize(ids.size());
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		std::unique_ptr<char[]> buffer(new char[PRECOMPILE_CODE_BUFFER_SIZE]);
+		for (int i = lower; i < upper; i++) {
+			PrecompiledGeometryShader &result = (*results)[i];
+			result.id = ids[i];
+			GenerateGeometryShaderCached(compat, bugs, buffer.get(), &result);
+		}
+	}, 0, (int)ids.size(), MIN_SHADERS_PER_TASK);
+}
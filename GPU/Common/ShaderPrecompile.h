@@ -0,0 +1,70 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common/GPU/Shader.h"
+#include "Common/GPU/thin3d.h"
+#include "GPU/Common/ShaderId.h"
+#include "GPU/Common/VertexShaderGenerator.h"
+#include "GPU/Common/FragmentShaderGenerator.h"
+
+// When loading a shader cache, we know all the shader IDs up front, so generating the source
+// doesn't have to happen one by one on the emu thread. These run the generators for a list of IDs
+// across the worker threads, and the backend then only has to create the shader objects.
+// The results are in the same order as the IDs. Reads gstate_c's use flags, so set those first.
+// If g_shaderGenCache is enabled, generated source is fetched from and stored to it.
+
+// Same as the backends use.
+static constexpr size_t PRECOMPILE_CODE_BUFFER_SIZE = 32768;
+
+struct PrecompiledVertexShader {
+	VShaderID id;
+	std::string code;
+	uint32_t attrMask = 0;
+	uint64_t uniformMask = 0;
+	VertexShaderFlags flags{};
+	bool success = false;
+};
+
+struct PrecompiledFragmentShader {
+	FShaderID id;
+	std::string code;
+	uint64_t uniformMask = 0;
+	FragmentShaderFlags flags{};
+	bool success = false;
+};
+
+struct PrecompiledGeometryShader {
+	GShaderID id;
+	std::string code;
+	bool success = false;
+};
+
+void PrecompileVertexShaders(const std::vector<VShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledVertexShader> *results);
+void PrecompileFragmentShaders(const std::vector<FShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledFragmentShader> *results);
+void PrecompileGeometryShaders(const std::vector<GShaderID> &ids, const ShaderLanguageDesc &compat, Draw::Bugs bugs, std::vector<PrecompiledGeometryShader> *results);
+
+// Single-shader versions of the above, also going through g_shaderGenCache.
+// buffer is scratch space of PRECOMPILE_CODE_BUFFER_SIZE bytes, result->id must be set.
+void GenerateVertexShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledVertexShader *result);
+void GenerateFragmentShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledFragmentShader *result);
+void GenerateGeometryShaderCached(const ShaderLanguageDesc &compat, Draw::Bugs bugs, char *buffer, PrecompiledGeometryShader *result);
@@ -273,7 +273,8 @@ void BaseUpdateUniforms(UB_VS_FS_Base *ub, uint64_t dirtyUniforms, bool flipView
 		int indexMask = gstate.getClutIndexMask();
 		int indexShift = gstate.getClutIndexShift();
 		int indexOffset = gstate.getClutIndexStartPos() >> 4;
-		int format = gstate_c.depalFramebufferFormat;
+		// Indexed depal has no framebuffer format, so the CLUT atlas row goes in that byte instead.
+		int format = gstate_c.shaderDepalMode == ShaderDepalMode::CLUT_INDEXED ? gstate_c.depalClutRow : (int)gstate_c.depalFramebufferFormat;
 		uint32_t val = BytesToUint32(indexMask, indexShift, indexOffset, format);
 		// Poke in a bilinear filter flag in the top bit.
 		if (gstate.isMagnifyFilteringEnabled())
@@ -440,7 +440,13 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 				// TODO: Unify this as far as possible (I think only GLES backend really needs its own implementation due to different component order).
 				UpdateCurrentClut(gstate.getClutPaletteFormat(), gstate.getClutIndexStartPos(), gstate.isClutIndexSimple());
 			}
-			cluthash = clutHash_ ^ gstate.clutformat;
+			if (CanDepalettizeInShader(texFormat)) {
+				// Decoded to indices like a dynamic CLUT, so the entry doesn't depend on the CLUT at all.
+				hasClutGPU = true;
+				cluthash = 0;
+			} else {
+				cluthash = clutHash_ ^ gstate.clutformat;
+			}
 		}
 	} else {
 		cluthash = 0;
@@ -645,11 +651,13 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		}
 
 		if (hasClutGPU) {
-			WARN_LOG_N_TIMES(clutUseRender, 5, Log::G3D, "Using texture with dynamic CLUT: texfmt=%d, clutfmt=%d", gstate.getTextureFormat(), gstate.getClutPaletteFormat());
+			if (clutRenderAddress_ != 0xFFFFFFFF) {
+				WARN_LOG_N_TIMES(clutUseRender, 5, Log::G3D, "Using texture with dynamic CLUT: texfmt=%d, clutfmt=%d", gstate.getTextureFormat(), gstate.getClutPaletteFormat());
+			}
 			entry->status |= TexCacheEntry::STATUS_CLUT_GPU;
 		}
 
-		if (hasClut && clutRenderAddress_ == 0xFFFFFFFF) {
+		if (hasClut && !hasClutGPU) {
 			const u64 cachekeyMin = (u64)(texaddr & 0x3FFFFFFF) << 32;
 			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
 
@@ -677,6 +685,12 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	entry->format = texFormat;
 	entry->maxLevel = maxLevel;
 	entry->status &= ~TexCacheEntry::STATUS_BGRA;
+	// Might be a rebuild of an entry that was decoded the other way before.
+	if (hasClutGPU) {
+		entry->status |= TexCacheEntry::STATUS_CLUT_GPU;
+	} else {
+		entry->status &= ~TexCacheEntry::STATUS_CLUT_GPU;
+	}
 
 	entry->bufw = bufw;
 
@@ -2167,9 +2181,13 @@ void TextureCacheCommon::ApplyTexture() {
 	gstate_c.SetTextureIsVideo((entry->status & TexCacheEntry::STATUS_VIDEO) != 0);
 	if (entry->status & TexCacheEntry::STATUS_CLUT_GPU) {
 		// Special process.
-		ApplyTextureDepal(entry);
+		if (clutRenderAddress_ == 0xFFFFFFFF) {
+			ApplyTextureShaderDepal(entry);
+		} else {
+			ApplyTextureDepal(entry);
+			gstate_c.SetTextureFullAlpha(false);
+		}
 		entry->lastFrame = gpuStats.numFlips;
-		gstate_c.SetTextureFullAlpha(false);
 		gstate_c.SetTextureIs3D(false);
 		gstate_c.SetTextureIsArray(false);
 		gstate_c.SetTextureIsBGRA(false);
@@ -2420,6 +2438,58 @@ void TextureCacheCommon::ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer
 	gstate_c.Dirty(DIRTY_ALL_RENDER_STATE);
 }
 
+// Whether a normal (non-framebuffer) CLUT texture can be decoded to raw indices and depalettized in the
+// game's fragment shader, so that palette changes don't require decoding and uploading it again.
+bool TextureCacheCommon::CanDepalettizeInShader(GETextureFormat texFormat) const {
+	if (!g_Config.bShaderDepalettize || (texFormat != GE_TFMT_CLUT4 && texFormat != GE_TFMT_CLUT8)) {
+		return false;
+	}
+	// Indexed textures are built with a single level, and can't be scaled or replaced.
+	if (gstate.getTextureMaxLevel() != 0 || standardScaleFactor_ != 1 || replacer_.Enabled()) {
+		return false;
+	}
+	const ShaderLanguageDesc &shaderLanguageDesc = draw_->GetShaderLanguageDesc();
+	switch (shaderLanguageDesc.shaderLanguage) {
+	case ShaderLanguage::HLSL_D3D9:
+	case ShaderLanguage::GLSL_1xx:
+		return false;
+	default:
+		return shaderLanguageDesc.bitwiseOps;
+	}
+}
+
+// Binds a normal texture pre-decoded to CLUT8 indices, and its palette, for ShaderDepalMode::CLUT_INDEXED.
+void TextureCacheCommon::ApplyTextureShaderDepal(TexCacheEntry *entry) {
+	const GEPaletteFormat clutFormat = gstate.getClutPaletteFormat();
+
+	Draw::Texture *clutTexture = nullptr;
+	int clutRow = 0;
+	if (!textureShaderCache_->GetClutAtlasRow(clutFormat, clutHash_, clutBufRaw_, &clutTexture, &clutRow)) {
+		// Not in the atlas yet. A plain CLUT texture is just a single-row atlas.
+		clutTexture = textureShaderCache_->GetClutTexture(clutFormat, clutHash_, clutBufRaw_).texture;
+		clutRow = 0;
+	}
+
+	BindTexture(entry);
+	// The indices must not be filtered, the shader filters manually after the lookup.
+	SamplerCacheKey samplerKey = GetSamplingParams(0, entry);
+	samplerKey.magFilt = false;
+	samplerKey.minFilt = false;
+	samplerKey.mipEnable = false;
+	ApplySamplingParams(samplerKey);
+	// Needs to come after BindTexture, which resets the CLUT binding on some backends.
+	BindAsClutTexture(clutTexture, false);
+
+	gstate_c.SetUseShaderDepal(ShaderDepalMode::CLUT_INDEXED);
+	gstate_c.depalClutRow = clutRow;
+	gstate_c.Dirty(DIRTY_DEPAL);
+
+	const u32 bytesPerColor = clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16);
+	const u32 clutTotalColors = clutMaxBytes_ / bytesPerColor;
+	CheckAlphaResult alphaStatus = CheckCLUTAlpha((const uint8_t *)clutBufRaw_, clutFormat, clutTotalColors);
+	gstate_c.SetTextureFullAlpha(alphaStatus == CHECKALPHA_FULL);
+}
+
 // Applies depal to a normal (non-framebuffer) texture, pre-decoded to CLUT8 format.
 void TextureCacheCommon::ApplyTextureDepal(TexCacheEntry *entry) {
 	uint32_t clutMode = gstate.clutformat & 0xFFFFFF;
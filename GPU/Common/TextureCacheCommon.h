@@ -394,6 +394,8 @@ class TextureCacheCommon {
 
 	void ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer, GETextureFormat texFormat, RasterChannel channel);
 	void ApplyTextureDepal(TexCacheEntry *entry);
+	void ApplyTextureShaderDepal(TexCacheEntry *entry);
+	bool CanDepalettizeInShader(GETextureFormat texFormat) const;
 
 	void HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete);
 	virtual void BuildTexture(TexCacheEntry *const entry) = 0;
@@ -32,6 +32,7 @@
 #include "Common/Data/Text/I18n.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/File/VFS/DirectoryReader.h"
+#include "Common/File/VFS/MappedZipFileReader.h"
 #include "Common/File/VFS/ZipFileReader.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/VFS/VFS.h"
@@ -137,8 +138,11 @@ bool TextureReplacer::LoadIni(std::string *error) {
 
 	Path zipPath = basePath_ / ZIP_FILENAME;
 
-	// First, check for textures.zip, which is used to reduce IO.
-	VFSBackend *dir = ZipFileReader::Create(zipPath, "", false);
+	// First, check for textures.zip, which is used to reduce IO. Mapping it lets textures load in parallel.
+	VFSBackend *dir = MappedZipFileReader::Create(zipPath, "", false);
+	if (!dir) {
+		dir = ZipFileReader::Create(zipPath, "", false);
+	}
 	if (!dir) {
 		INFO_LOG(Log::TexReplacement, "%s wasn't a zip file - opening the directory %s instead.", zipPath.c_str(), basePath_.c_str());
 		vfsIsZip_ = false;
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <cstring>
 #include <map>
 
 #include "Common/Log.h"
@@ -52,6 +53,25 @@ void TextureShaderCache::DeviceLost() {
 	draw_ = nullptr;
 }
 
+// Returns 512 RGBA8888 entries, either rawClut itself (32-bit) or converted into convTemp.
+static const uint8_t *ClutToRGBA8888(GEPaletteFormat clutFormat, const u32 *rawClut, uint8_t convTemp[2048]) {
+	const int maxClutEntries = 512;
+	switch (clutFormat) {
+	case GEPaletteFormat::GE_CMODE_32BIT_ABGR8888:
+		return (const uint8_t *)rawClut;
+	case GEPaletteFormat::GE_CMODE_16BIT_BGR5650:
+		ConvertRGB565ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
+		break;
+	case GEPaletteFormat::GE_CMODE_16BIT_ABGR5551:
+		ConvertRGBA5551ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
+		break;
+	case GEPaletteFormat::GE_CMODE_16BIT_ABGR4444:
+		ConvertRGBA4444ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
+		break;
+	}
+	return convTemp;
+}
+
 ClutTexture TextureShaderCache::GetClutTexture(GEPaletteFormat clutFormat, const u32 clutHash, const u32 *rawClut) {
 	// Simplistic, but works well enough.
 	u32 clutId = clutHash ^ (uint32_t)clutFormat;
@@ -76,24 +96,7 @@ ClutTexture TextureShaderCache::GetClutTexture(GEPaletteFormat clutFormat, const
 	desc.format = Draw::DataFormat::R8G8B8A8_UNORM;  // TODO: Also support an BGR format. We won't bother with the 16-bit formats here.
 
 	uint8_t convTemp[2048]{};
-
-	switch (clutFormat) {
-	case GEPaletteFormat::GE_CMODE_32BIT_ABGR8888:
-		desc.initData.push_back((const uint8_t *)rawClut);
-		break;
-	case GEPaletteFormat::GE_CMODE_16BIT_BGR5650:
-		ConvertRGB565ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
-		desc.initData.push_back(convTemp);
-		break;
-	case GEPaletteFormat::GE_CMODE_16BIT_ABGR5551:
-		ConvertRGBA5551ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
-		desc.initData.push_back(convTemp);
-		break;
-	case GEPaletteFormat::GE_CMODE_16BIT_ABGR4444:
-		ConvertRGBA4444ToRGBA8888((u32 *)convTemp, (const u16 *)rawClut, maxClutEntries);
-		desc.initData.push_back(convTemp);
-		break;
-	}
+	desc.initData.push_back(ClutToRGBA8888(clutFormat, rawClut, convTemp));
 
 
 	for (int i = 0; i < 3; i++) {
@@ -137,6 +140,108 @@ ClutTexture TextureShaderCache::GetClutTexture(GEPaletteFormat clutFormat, const
 	return *tex;
 }
 
+bool TextureShaderCache::GetClutAtlasRow(GEPaletteFormat clutFormat, const u32 clutHash, const u32 *rawClut, Draw::Texture **atlas, int *row) {
+	// Not numFlips, which doesn't advance while paused even though we keep presenting frames.
+	const int frame = draw_->GetFrameCount();
+	if (clutAtlasDirty_ && frame != clutAtlasUploadFrame_) {
+		UploadClutAtlas(frame);
+	}
+
+	u32 clutId = clutHash ^ (uint32_t)clutFormat;
+	int index;
+	auto iter = clutAtlasRowMap_.find(clutId);
+	if (iter != clutAtlasRowMap_.end()) {
+		index = iter->second;
+	} else {
+		// Take a free row, or else the least recently used one.
+		index = 0;
+		for (int i = 0; i < CLUT_ATLAS_ROWS; i++) {
+			if (!clutAtlasRows_[i].used) {
+				index = i;
+				break;
+			}
+			if (clutAtlasRows_[i].lastFrame < clutAtlasRows_[index].lastFrame) {
+				index = i;
+			}
+		}
+		ClutAtlasRow &victim = clutAtlasRows_[index];
+		if (victim.used) {
+			if (victim.lastFrame == frame) {
+				// More palettes in use this frame than we have rows, no point in thrashing.
+				return false;
+			}
+			clutAtlasRowMap_.erase(victim.clutId);
+		}
+
+		if (clutAtlasData_.empty()) {
+			clutAtlasData_.resize(512 * CLUT_ATLAS_ROWS);
+		}
+		uint8_t convTemp[2048]{};
+		memcpy(&clutAtlasData_[512 * index], ClutToRGBA8888(clutFormat, rawClut, convTemp), sizeof(convTemp));
+
+		victim.clutId = clutId;
+		victim.used = true;
+		victim.uploaded = false;
+		clutAtlasRowMap_[clutId] = index;
+		clutAtlasDirty_ = true;
+	}
+
+	ClutAtlasRow &entry = clutAtlasRows_[index];
+	entry.lastFrame = frame;
+	if (!entry.uploaded) {
+		return false;
+	}
+
+	clutAtlasTextures_[curClutAtlas_].lastFrame = frame;
+	*atlas = clutAtlasTextures_[curClutAtlas_].texture;
+	*row = index;
+	return true;
+}
+
+void TextureShaderCache::UploadClutAtlas(int frame) {
+	int slot = -1;
+	for (int i = 0; i < CLUT_ATLAS_TEXTURES; i++) {
+		if (i != curClutAtlas_ && (!clutAtlasTextures_[i].texture || clutAtlasTextures_[i].lastFrame < frame - 3)) {
+			slot = i;
+			break;
+		}
+	}
+	if (slot < 0) {
+		// All of them might still be in use, try again next frame.
+		return;
+	}
+
+	const uint8_t *data = (const uint8_t *)clutAtlasData_.data();
+	ClutAtlasTexture &dest = clutAtlasTextures_[slot];
+	if (dest.texture) {
+		draw_->UpdateTextureLevels(dest.texture, &data, nullptr, 1);
+	} else {
+		Draw::TextureDesc desc{};
+		desc.width = 512;
+		desc.height = CLUT_ATLAS_ROWS;
+		desc.depth = 1;
+		desc.mipLevels = 1;
+		desc.tag = "clut_atlas";
+		desc.type = Draw::TextureType::LINEAR2D;
+		desc.format = Draw::DataFormat::R8G8B8A8_UNORM;
+		desc.initData.push_back(data);
+		dest.texture = draw_->CreateTexture(desc);
+		if (!dest.texture) {
+			return;
+		}
+	}
+	dest.lastFrame = frame;
+	curClutAtlas_ = slot;
+
+	for (auto &row : clutAtlasRows_) {
+		if (row.used) {
+			row.uploaded = true;
+		}
+	}
+	clutAtlasDirty_ = false;
+	clutAtlasUploadFrame_ = frame;
+}
+
 void TextureShaderCache::Clear() {
 	for (auto shader = depalCache_.begin(); shader != depalCache_.end(); ++shader) {
 		if (shader->second->pipeline) {
@@ -150,6 +255,20 @@ void TextureShaderCache::Clear() {
 		delete tex->second;
 	}
 	texCache_.clear();
+	for (auto &atlas : clutAtlasTextures_) {
+		if (atlas.texture) {
+			atlas.texture->Release();
+		}
+		atlas = {};
+	}
+	for (auto &row : clutAtlasRows_) {
+		row = {};
+	}
+	clutAtlasRowMap_.clear();
+	clutAtlasData_.clear();
+	curClutAtlas_ = -1;
+	clutAtlasUploadFrame_ = -1;
+	clutAtlasDirty_ = false;
 	if (nearestSampler_) {
 		nearestSampler_->Release();
 		nearestSampler_ = nullptr;
@@ -46,6 +46,10 @@ class TextureShaderCache {
 	Draw2DPipeline *GetDepalettizeShader(uint32_t clutMode, GETextureFormat texFormat, GEBufferFormat pixelFormat, bool smoothedDepal, u32 depthUpperBits);
 	ClutTexture GetClutTexture(GEPaletteFormat clutFormat, const u32 clutHash, const u32 *rawClut);
 
+	// For ShaderDepalMode::CLUT_INDEXED. Finds or allocates the atlas row for the palette. Returns false if it
+	// isn't uploaded yet (it will be next frame), or the atlas is full - use GetClutTexture for now in that case.
+	bool GetClutAtlasRow(GEPaletteFormat clutFormat, const u32 clutHash, const u32 *rawClut, Draw::Texture **atlas, int *row);
+
 	Draw::SamplerState *GetSampler(bool linearFilter);
 
 	void Clear();
@@ -62,6 +66,30 @@ class TextureShaderCache {
 	Draw::SamplerState *linearSampler_ = nullptr;
 	Draw2D *draw2D_;
 
+	void UploadClutAtlas(int frame);
+
 	std::map<u64, Draw2DPipeline *> depalCache_;
 	std::map<u32, ClutTexture *> texCache_;
+
+	// The CLUT atlas: 512 RGBA8888 entries per row, one palette per row. Rows are added to a CPU copy, which is
+	// uploaded at most once per frame to whichever of the atlas textures hasn't been used for a few frames,
+	// so we never modify a texture that's still in flight.
+	enum { CLUT_ATLAS_ROWS = 64, CLUT_ATLAS_TEXTURES = 4 };
+	struct ClutAtlasRow {
+		u32 clutId;
+		int lastFrame;
+		bool used;
+		bool uploaded;
+	};
+	struct ClutAtlasTexture {
+		Draw::Texture *texture;
+		int lastFrame;
+	};
+	std::map<u32, int> clutAtlasRowMap_;
+	ClutAtlasRow clutAtlasRows_[CLUT_ATLAS_ROWS]{};
+	std::vector<u32> clutAtlasData_;
+	ClutAtlasTexture clutAtlasTextures_[CLUT_ATLAS_TEXTURES]{};
+	int curClutAtlas_ = -1;
+	int clutAtlasUploadFrame_ = -1;
+	bool clutAtlasDirty_ = false;
 };
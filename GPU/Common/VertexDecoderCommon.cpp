@@ -1373,6 +1373,22 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, const UVScale
 	}
 }
 
+bool VertexDecoder::SupportsParallelDecode() const {
+	// The step interpreter keeps state in prescaleUV_, through mode tracks vertBounds with a non-atomic
+	// min/max, and the skinning jit rebuilds a shared bone matrix table in its prologue.
+	// The handwritten decoders (no jittedSize_) assign vertexFullAlpha from their own chunk, so the last
+	// chunk to finish would win. Generated code on x64, ARM and RISC-V only ever stores false to it, so
+	// chunks can't disagree, and the join orders those stores before the flag is read.
+	// 32-bit x86 has no register to spare and ANDs into it in memory per vertex, which can lose a
+	// concurrent clear.
+#if PPSSPP_ARCH(X86)
+	return false;
+#else
+	bool handwritten = jitted_ && jittedSize_ == 0;
+	return jitted_ && !handwritten && !validateJit && !throughmode && !skinInDecode;
+#endif
+}
+
 static float LargestAbsDiff(Vec4f a, Vec4f b, int n) {
 	Vec4f delta = a - b;
 	float largest = 0;
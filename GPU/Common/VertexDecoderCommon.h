@@ -339,6 +339,9 @@ class VertexDecoder {
 
 	void DecodeVerts(u8 *decoded, const void *verts, const UVScale *uvScaleOffset, int indexLowerBound, int indexUpperBound) const;
 
+	// Whether DecodeVerts can be called on disjoint ranges from several threads at once.
+	bool SupportsParallelDecode() const;
+
 	int VertexSize() const { return size; }  // PSP format size
 
 	std::string GetString(DebugShaderStringType stringType) const;
@@ -515,6 +518,13 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) const;
 	void Clear();
 
+	// Allows the jit to use VEX-encoded ops and FMA for skinning (x86-64 with AVX + FMA3). Skinned positions
+	// and normals can then differ from the SSE path in the last bit or so.
+	// On by default, mainly useful to turn off for comparisons.
+	void SetAllowFMA(bool allow) {
+		allowFMA_ = allow;
+	}
+
 	void Jit_WeightsU8();
 	void Jit_WeightsU16();
 	void Jit_WeightsU8ToFloat();
@@ -594,6 +604,9 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	bool CompileStep(const VertexDecoder &dec, int i);
 	void Jit_ApplyWeights();
 	void Jit_WriteMatrixMul(int outOff, bool pos);
+#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+	void Jit_AccumulateSkinMatrix(Gen::X64Reg weight, bool first);
+#endif
 	void Jit_WriteMorphColor(int outOff, bool checkAlpha = true);
 	void Jit_AnyS8ToFloat(int srcoff);
 	void Jit_AnyS16ToFloat(int srcoff);
@@ -604,6 +617,9 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_AnyFloatMorph(int srcoff, int dstoff);
 
 	const VertexDecoder *dec_ = nullptr;
+	bool allowFMA_ = true;
+	// Set per Compile() when the FMA code paths are allowed and supported.
+	bool useFMA_ = false;
 #if PPSSPP_ARCH(ARM64)
 	Arm64Gen::ARM64FloatEmitter fp;
 #endif
@@ -616,6 +632,7 @@ class VertexDecoderJitCache : public FakeGen::FakeXCodeBlock {
 	JittedVertexDecoder Compile(const VertexDecoder &dec, int32_t *jittedSize) {
 		return nullptr;
 	}
+	void SetAllowFMA(bool allow) {}
 	void Clear();
 };
 #endif
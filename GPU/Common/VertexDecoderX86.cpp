@@ -170,6 +170,9 @@ static const JitLookup jitLookup[] = {
 
 JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int32_t *jittedSize) {
 	dec_ = &dec;
+#if PPSSPP_ARCH(AMD64)
+	useFMA_ = allowFMA_ && cpu_info.bAVX && cpu_info.bFMA3;
+#endif
 	BeginWrite(4096);
 	const u8 *start = this->AlignCode16();
 
@@ -498,6 +501,49 @@ void VertexDecoderJitCache::Jit_WeightsFloat() {
 	}
 }
 
+// Accumulates the bone matrix at tempReg2, scaled by weight, into XMM4-XMM7.
+void VertexDecoderJitCache::Jit_AccumulateSkinMatrix(X64Reg weight, bool first) {
+	if (useFMA_) {
+		// The bone table is aligned, but VEX ops don't care anyway, so we can use it directly as an operand.
+		if (first) {
+			VMULPS(128, XMM4, weight, MDisp(tempReg2, 0));
+			VMULPS(128, XMM5, weight, MDisp(tempReg2, 16));
+			VMULPS(128, XMM6, weight, MDisp(tempReg2, 32));
+			VMULPS(128, XMM7, weight, MDisp(tempReg2, 48));
+		} else {
+			VFMADD231PS(128, XMM4, weight, MDisp(tempReg2, 0));
+			VFMADD231PS(128, XMM5, weight, MDisp(tempReg2, 16));
+			VFMADD231PS(128, XMM6, weight, MDisp(tempReg2, 32));
+			VFMADD231PS(128, XMM7, weight, MDisp(tempReg2, 48));
+		}
+		return;
+	}
+
+	if (first) {
+		MOVAPS(XMM4, MDisp(tempReg2, 0));
+		MOVAPS(XMM5, MDisp(tempReg2, 16));
+		MOVAPS(XMM6, MDisp(tempReg2, 32));
+		MOVAPS(XMM7, MDisp(tempReg2, 48));
+		MULPS(XMM4, R(weight));
+		MULPS(XMM5, R(weight));
+		MULPS(XMM6, R(weight));
+		MULPS(XMM7, R(weight));
+	} else {
+		MOVAPS(XMM2, MDisp(tempReg2, 0));
+		MOVAPS(XMM3, MDisp(tempReg2, 16));
+		MULPS(XMM2, R(weight));
+		MULPS(XMM3, R(weight));
+		ADDPS(XMM4, R(XMM2));
+		ADDPS(XMM5, R(XMM3));
+		MOVAPS(XMM2, MDisp(tempReg2, 32));
+		MOVAPS(XMM3, MDisp(tempReg2, 48));
+		MULPS(XMM2, R(weight));
+		MULPS(XMM3, R(weight));
+		ADDPS(XMM6, R(XMM2));
+		ADDPS(XMM7, R(XMM3));
+	}
+}
+
 void VertexDecoderJitCache::Jit_WeightsU8Skin() {
 	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
 
@@ -581,29 +627,7 @@ void VertexDecoderJitCache::Jit_WeightsU8Skin() {
 		MULSS(weight, M(&by128));  // rip accessible (x86)
 		SHUFPS(weight, R(weight), _MM_SHUFFLE(0, 0, 0, 0));
 #endif
-		if (j == 0) {
-			MOVAPS(XMM4, MDisp(tempReg2, 0));
-			MOVAPS(XMM5, MDisp(tempReg2, 16));
-			MOVAPS(XMM6, MDisp(tempReg2, 32));
-			MOVAPS(XMM7, MDisp(tempReg2, 48));
-			MULPS(XMM4, R(weight));
-			MULPS(XMM5, R(weight));
-			MULPS(XMM6, R(weight));
-			MULPS(XMM7, R(weight));
-		} else {
-			MOVAPS(XMM2, MDisp(tempReg2, 0));
-			MOVAPS(XMM3, MDisp(tempReg2, 16));
-			MULPS(XMM2, R(weight));
-			MULPS(XMM3, R(weight));
-			ADDPS(XMM4, R(XMM2));
-			ADDPS(XMM5, R(XMM3));
-			MOVAPS(XMM2, MDisp(tempReg2, 32));
-			MOVAPS(XMM3, MDisp(tempReg2, 48));
-			MULPS(XMM2, R(weight));
-			MULPS(XMM3, R(weight));
-			ADDPS(XMM6, R(XMM2));
-			ADDPS(XMM7, R(XMM3));
-		}
+		Jit_AccumulateSkinMatrix(weight, j == 0);
 		ADD(PTRBITS, R(tempReg2), Imm8(4 * 16));
 	}
 }
@@ -695,29 +719,7 @@ void VertexDecoderJitCache::Jit_WeightsU16Skin() {
 		MULSS(weight, M(&by32768));  // rip accessible (x86)
 		SHUFPS(weight, R(weight), _MM_SHUFFLE(0, 0, 0, 0));
 #endif
-		if (j == 0) {
-			MOVAPS(XMM4, MDisp(tempReg2, 0));
-			MOVAPS(XMM5, MDisp(tempReg2, 16));
-			MOVAPS(XMM6, MDisp(tempReg2, 32));
-			MOVAPS(XMM7, MDisp(tempReg2, 48));
-			MULPS(XMM4, R(weight));
-			MULPS(XMM5, R(weight));
-			MULPS(XMM6, R(weight));
-			MULPS(XMM7, R(weight));
-		} else {
-			MOVAPS(XMM2, MDisp(tempReg2, 0));
-			MOVAPS(XMM3, MDisp(tempReg2, 16));
-			MULPS(XMM2, R(weight));
-			MULPS(XMM3, R(weight));
-			ADDPS(XMM4, R(XMM2));
-			ADDPS(XMM5, R(XMM3));
-			MOVAPS(XMM2, MDisp(tempReg2, 32));
-			MOVAPS(XMM3, MDisp(tempReg2, 48));
-			MULPS(XMM2, R(weight));
-			MULPS(XMM3, R(weight));
-			ADDPS(XMM6, R(XMM2));
-			ADDPS(XMM7, R(XMM3));
-		}
+		Jit_AccumulateSkinMatrix(weight, j == 0);
 		ADD(PTRBITS, R(tempReg2), Imm8(4 * 16));
 	}
 }
@@ -725,31 +727,13 @@ void VertexDecoderJitCache::Jit_WeightsU16Skin() {
 void VertexDecoderJitCache::Jit_WeightsFloatSkin() {
 	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
 	for (int j = 0; j < dec_->nweights; j++) {
-		MOVSS(XMM1, MDisp(srcReg, dec_->weightoff + j * 4));
-		SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
-		if (j == 0) {
-			MOVAPS(XMM4, MDisp(tempReg2, 0));
-			MOVAPS(XMM5, MDisp(tempReg2, 16));
-			MOVAPS(XMM6, MDisp(tempReg2, 32));
-			MOVAPS(XMM7, MDisp(tempReg2, 48));
-			MULPS(XMM4, R(XMM1));
-			MULPS(XMM5, R(XMM1));
-			MULPS(XMM6, R(XMM1));
-			MULPS(XMM7, R(XMM1));
+		if (useFMA_) {
+			VBROADCASTSS(128, XMM1, MDisp(srcReg, dec_->weightoff + j * 4));
 		} else {
-			MOVAPS(XMM2, MDisp(tempReg2, 0));
-			MOVAPS(XMM3, MDisp(tempReg2, 16));
-			MULPS(XMM2, R(XMM1));
-			MULPS(XMM3, R(XMM1));
-			ADDPS(XMM4, R(XMM2));
-			ADDPS(XMM5, R(XMM3));
-			MOVAPS(XMM2, MDisp(tempReg2, 32));
-			MOVAPS(XMM3, MDisp(tempReg2, 48));
-			MULPS(XMM2, R(XMM1));
-			MULPS(XMM3, R(XMM1));
-			ADDPS(XMM6, R(XMM2));
-			ADDPS(XMM7, R(XMM3));
+			MOVSS(XMM1, MDisp(srcReg, dec_->weightoff + j * 4));
+			SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
 		}
+		Jit_AccumulateSkinMatrix(XMM1, j == 0);
 		ADD(PTRBITS, R(tempReg2), Imm8(4 * 16));
 	}
 }
@@ -1361,8 +1345,24 @@ void VertexDecoderJitCache::Jit_NormalFloat() {
 	}
 }
 
-// This could be a bit shorter with AVX 3-operand instructions and FMA.
+// With FMA, the products are summed without rounding in between, so the result can differ from the
+// SSE path and the steps in the last bit or so.
 void VertexDecoderJitCache::Jit_WriteMatrixMul(int outOff, bool pos) {
+	if (useFMA_) {
+		VSHUFPS(128, XMM1, XMM3, R(XMM3), _MM_SHUFFLE(0, 0, 0, 0));
+		VSHUFPS(128, XMM2, XMM3, R(XMM3), _MM_SHUFFLE(1, 1, 1, 1));
+		VSHUFPS(128, XMM3, XMM3, R(XMM3), _MM_SHUFFLE(2, 2, 2, 2));
+		if (pos) {
+			VFMADD213PS(128, XMM1, XMM4, R(XMM7));
+		} else {
+			VMULPS(128, XMM1, XMM1, R(XMM4));
+		}
+		VFMADD231PS(128, XMM1, XMM2, R(XMM5));
+		VFMADD231PS(128, XMM1, XMM3, R(XMM6));
+		MOVUPS(MDisp(dstReg, outOff), XMM1);
+		return;
+	}
+
 	MOVAPS(XMM1, R(XMM3));
 	MOVAPS(XMM2, R(XMM3));
 	SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
@@ -36,6 +36,7 @@
 #include "GPU/ge_constants.h"
 #include "GPU/GeDisasm.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Common/ShaderGenCache.h"
 #include "GPU/GLES/ShaderManagerGLES.h"
 #include "GPU/GLES/GPU_GLES.h"
 #include "GPU/GLES/FramebufferManagerGLES.h"
@@ -86,7 +87,10 @@ GPU_GLES::GPU_GLES(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 
 	textureCache_->NotifyConfigChanged();
 
-	// Load shader cache.
+	// Load shader cache. The generation cache isn't per game, so it doesn't need a disc ID (same as Vulkan).
+	if (g_Config.bShaderCache) {
+		g_shaderGenCache.SetDirectory(GetSysDirectory(DIRECTORY_APP_CACHE) / "shadergen");
+	}
 	std::string discID = g_paramSFO.GetDiscID();
 	if (discID.size()) {
 		if (g_Config.bShaderCache) {
@@ -134,6 +138,7 @@ GPU_GLES::~GPU_GLES() {
 		}
 	}
 	fragmentTestCache_.Clear();
+	g_shaderGenCache.SetDirectory(Path());
 }
 
 // Take the raw GL extension and versioning data and turn into feature flags.
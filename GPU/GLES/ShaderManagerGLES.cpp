@@ -402,7 +402,8 @@ void LinkedShader::UpdateUniforms(const ShaderID &vsid, bool useBufferedRenderin
 		int indexMask = gstate.getClutIndexMask();
 		int indexShift = gstate.getClutIndexShift();
 		int indexOffset = gstate.getClutIndexStartPos() >> 4;
-		int format = gstate_c.depalFramebufferFormat;
+		// Indexed depal has no framebuffer format, so the CLUT atlas row goes in that byte instead.
+		int format = gstate_c.shaderDepalMode == ShaderDepalMode::CLUT_INDEXED ? gstate_c.depalClutRow : (int)gstate_c.depalFramebufferFormat;
 		uint32_t val = BytesToUint32(indexMask, indexShift, indexOffset, format);
 		// Poke in a bilinear filter flag in the top bit.
 		val |= gstate.isMagnifyFilteringEnabled() << 31;
@@ -759,6 +760,12 @@ Shader *ShaderManagerGLES::CompileFragmentShader(FShaderID FSID) {
 	return new Shader(render_, codeBuffer_, desc, params);
 }
 
+Shader *ShaderManagerGLES::CreateFragmentShader(const PrecompiledFragmentShader &shader) {
+	std::string desc = FragmentShaderDesc(shader.id);
+	ShaderDescGLES params{ GL_FRAGMENT_SHADER, 0, shader.uniformMask };
+	return new Shader(render_, shader.code.c_str(), desc, params);
+}
+
 // Can only fail by failing to generate the code (bad VSID).
 // Any actual failures driver-side happens later in the render manager.
 Shader *ShaderManagerGLES::CompileVertexShader(VShaderID VSID) {
@@ -778,6 +785,13 @@ Shader *ShaderManagerGLES::CompileVertexShader(VShaderID VSID) {
 	return new Shader(render_, codeBuffer_, desc, params);
 }
 
+Shader *ShaderManagerGLES::CreateVertexShader(const PrecompiledVertexShader &shader) {
+	std::string desc = VertexShaderDesc(shader.id);
+	ShaderDescGLES params{ GL_VERTEX_SHADER, shader.attrMask, shader.uniformMask };
+	params.useHWTransform = shader.id.Bit(VS_BIT_USE_HW_TRANSFORM);
+	return new Shader(render_, shader.code.c_str(), desc, params);
+}
+
 Shader *ShaderManagerGLES::ApplyVertexShader(bool useHWTransform, bool useHWTessellation, VertexDecoder *decoder, bool weightsAsFloat, bool useSkinInDecode, VShaderID *VSID) {
 	if (gstate_c.IsDirty(DIRTY_VERTEXSHADER_STATE)) {
 		gstate_c.Clean(DIRTY_VERTEXSHADER_STATE);
@@ -1088,44 +1102,49 @@ bool ShaderManagerGLES::LoadCache(File::IOFile &f) {
 		return true;
 	}
 
-	double start = time_now_d();
+	for (const VShaderID &id : pending.vert) {
+		if (id.Bit(VS_BIT_IS_THROUGH) && id.Bit(VS_BIT_USE_HW_TRANSFORM)) {
+			// Clearly corrupt, bailing.
+			ERROR_LOG_REPORT(Log::G3D, "Corrupt shader cache: Both IS_THROUGH and USE_HW_TRANSFORM set.");
+			pending.Clear();
+			return false;
+		}
+	}
+
+	// Generate all the source up front across the worker threads. Creating the GL shaders
+	// still needs to happen here, it just queues them up for the render thread.
+	std::vector<PrecompiledVertexShader> vertexShaders;
+	std::vector<PrecompiledFragmentShader> fragmentShaders;
+	PrecompileVertexShaders(pending.vert, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &vertexShaders);
+	PrecompileFragmentShaders(pending.frag, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &fragmentShaders);
 
 	for (size_t &i = pending.vertPos; i < pending.vert.size(); i++) {
-		const VShaderID &id = pending.vert[i];
-		if (!vsCache_.ContainsKey(id)) {
-			if (id.Bit(VS_BIT_IS_THROUGH) && id.Bit(VS_BIT_USE_HW_TRANSFORM)) {
-				// Clearly corrupt, bailing.
-				ERROR_LOG_REPORT(Log::G3D, "Corrupt shader cache: Both IS_THROUGH and USE_HW_TRANSFORM set.");
-				pending.Clear();
-				return false;
-			}
-
-			Shader *vs = CompileVertexShader(id);
-			if (!vs) {
+		const PrecompiledVertexShader &shader = vertexShaders[i];
+		if (!vsCache_.ContainsKey(shader.id)) {
+			if (!shader.success) {
 				// Give up on using the cache, just bail. We can't safely create the fallback shaders here
 				// without trying to deduce the vertType from the VSID.
 				ERROR_LOG(Log::G3D, "Failed to compile a vertex shader loading from cache. Skipping rest of shader cache.");
 				pending.Clear();
 				return false;
 			}
-			vsCache_.Insert(id, vs);
+			vsCache_.Insert(shader.id, CreateVertexShader(shader));
 		} else {
 			WARN_LOG(Log::G3D, "Duplicate vertex shader found in GL shader cache, ignoring");
 		}
 	}
 
 	for (size_t &i = pending.fragPos; i < pending.frag.size(); i++) {
-		const FShaderID &id = pending.frag[i];
-		if (!fsCache_.ContainsKey(id)) {
-			Shader *fs = CompileFragmentShader(id);
-			if (!fs) {
+		const PrecompiledFragmentShader &shader = fragmentShaders[i];
+		if (!fsCache_.ContainsKey(shader.id)) {
+			if (!shader.success) {
 				// Give up on using the cache - something went wrong.
 				// We'll still keep the shaders we generated so far around.
 				ERROR_LOG(Log::G3D, "Failed to compile a fragment shader loading from cache. Skipping rest of shader cache.");
 				pending.Clear();
 				return false;
 			}
-			fsCache_.Insert(id, fs);
+			fsCache_.Insert(shader.id, CreateFragmentShader(shader));
 		} else {
 			WARN_LOG(Log::G3D, "Duplicate fragment shader found in GL shader cache, ignoring");
 		}
@@ -26,6 +26,7 @@
 #include "GPU/Common/ShaderId.h"
 #include "GPU/Common/VertexShaderGenerator.h"
 #include "GPU/Common/FragmentShaderGenerator.h"
+#include "GPU/Common/ShaderPrecompile.h"
 
 class DrawEngineGLES;
 class Shader;
@@ -189,6 +190,8 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 	void Clear();
 	Shader *CompileFragmentShader(FShaderID id);
 	Shader *CompileVertexShader(VShaderID id);
+	Shader *CreateFragmentShader(const PrecompiledFragmentShader &shader);
+	Shader *CreateVertexShader(const PrecompiledVertexShader &shader);
 
 	struct LinkedShaderCacheEntry {
 		LinkedShaderCacheEntry(Shader *vs_, Shader *fs_, LinkedShader *ls_)
@@ -45,6 +45,7 @@ enum class ShaderDepalMode {
 	NORMAL = 1,
 	SMOOTHED = 2,
 	CLUT8_8888 = 3,  // Read 8888 framebuffer as 8-bit CLUT.
+	CLUT_INDEXED = 4,  // Read a CLUT4/CLUT8 texture uploaded as raw indices, palette from a row of the CLUT atlas.
 };
 
 // Global GPU-related utility functions. 
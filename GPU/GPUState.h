@@ -718,6 +718,7 @@ struct GPUStateCache {
 
 	ShaderDepalMode shaderDepalMode;
 	GEBufferFormat depalFramebufferFormat;
+	int depalClutRow;  // Row of the CLUT atlas, for ShaderDepalMode::CLUT_INDEXED.
 
 	u32 getRelativeAddress(u32 data) const;
 	static void Reset();
@@ -38,6 +38,7 @@
 #include "GPU/ge_constants.h"
 #include "GPU/GeDisasm.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Common/ShaderGenCache.h"
 #include "GPU/Vulkan/ShaderManagerVulkan.h"
 #include "GPU/Vulkan/GPU_Vulkan.h"
 #include "GPU/Vulkan/FramebufferManagerVulkan.h"
@@ -89,6 +90,9 @@ GPU_Vulkan::GPU_Vulkan(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 	textureCache_->NotifyConfigChanged();
 
 	// Load shader cache.
+	if (g_Config.bShaderCache) {
+		g_shaderGenCache.SetDirectory(GetSysDirectory(DIRECTORY_APP_CACHE) / "shadergen");
+	}
 	std::string discID = g_paramSFO.GetDiscID();
 	if (discID.size()) {
 		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
@@ -181,6 +185,8 @@ GPU_Vulkan::~GPU_Vulkan() {
 	DestroyDeviceObjects();
 	drawEngine_.DeviceLost();
 	shaderManager_->ClearShaders();
+	// No more shader compiles in flight.
+	g_shaderGenCache.SetDirectory(Path());
 
 	// other managers are deleted in ~GPUCommonHW.
 	if (draw_) {
@@ -41,6 +41,8 @@
 #include "GPU/Common/FragmentShaderGenerator.h"
 #include "GPU/Common/VertexShaderGenerator.h"
 #include "GPU/Common/GeometryShaderGenerator.h"
+#include "GPU/Common/ShaderPrecompile.h"
+#include "GPU/Common/ShaderGenCache.h"
 #include "GPU/Vulkan/ShaderManagerVulkan.h"
 #include "GPU/Vulkan/DrawEngineVulkan.h"
 #include "GPU/Vulkan/FramebufferManagerVulkan.h"
@@ -56,7 +58,21 @@ static Promise<VkShaderModule> *CompileShaderModuleAsync(VulkanContext *vulkan,
 		std::string errorMessage;
 		std::vector<uint32_t> spirv;
 
-		bool success = GLSLtoSPV(stage, code, GLSLVariant::VULKAN, spirv, &errorMessage);
+		ShaderStage cacheStage = ShaderStage::Vertex;
+		switch (stage) {
+		case VK_SHADER_STAGE_FRAGMENT_BIT: cacheStage = ShaderStage::Fragment; break;
+		case VK_SHADER_STAGE_GEOMETRY_BIT: cacheStage = ShaderStage::Geometry; break;
+		case VK_SHADER_STAGE_COMPUTE_BIT: cacheStage = ShaderStage::Compute; break;
+		default: break;
+		}
+
+		bool success = g_shaderGenCache.LoadSPIRV(cacheStage, code, &spirv);
+		if (!success) {
+			success = GLSLtoSPV(stage, code, GLSLVariant::VULKAN, spirv, &errorMessage);
+			if (success) {
+				g_shaderGenCache.StoreSPIRV(cacheStage, code, spirv);
+			}
+		}
 
 		if (!errorMessage.empty()) {
 			if (success) {
@@ -536,95 +552,112 @@ bool ShaderManagerVulkan::LoadCacheFlags(FILE *f, DrawEngineVulkan *drawEngine)
 	return true;
 }
 
-bool ShaderManagerVulkan::LoadCache(FILE *f) {
+bool ShaderManagerVulkan::ReadCacheIDs(FILE *f, VulkanCacheIDs *ids) {
 	VulkanCacheHeader header{};
-	bool success = fread(&header, sizeof(header), 1, f) == 1;
-	// We don't need to validate magic/version again, done in LoadCacheFlags().
+	if (fread(&header, sizeof(header), 1, f) != 1) {
+		ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in header)");
+		return false;
+	}
+	// Normally already validated by LoadCacheFlags(), but this is also used standalone.
+	if (header.magic != CACHE_HEADER_MAGIC || header.version != CACHE_VERSION) {
+		WARN_LOG(Log::G3D, "Shader cache magic or version mismatch");
+		return false;
+	}
+	if (header.numVertexShaders < 0 || header.numFragmentShaders < 0 || header.numGeometryShaders < 0) {
+		ERROR_LOG(Log::G3D, "Corrupt Vulkan shader cache header");
+		return false;
+	}
+
+	ids->useFlags = header.useFlags;
+	ids->vert.resize(header.numVertexShaders);
+	ids->frag.resize(header.numFragmentShaders);
+	ids->geom.resize(header.numGeometryShaders);
+	if (!ids->vert.empty() && fread(&ids->vert[0], sizeof(VShaderID), ids->vert.size(), f) != ids->vert.size()) {
+		ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in VertexShaders)");
+		return false;
+	}
+	if (!ids->frag.empty() && fread(&ids->frag[0], sizeof(FShaderID), ids->frag.size(), f) != ids->frag.size()) {
+		ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in FragmentShaders)");
+		return false;
+	}
+	if (!ids->geom.empty() && fread(&ids->geom[0], sizeof(GShaderID), ids->geom.size(), f) != ids->geom.size()) {
+		ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in GeometryShaders)");
+		return false;
+	}
+	return true;
+}
+
+bool ShaderManagerVulkan::LoadCache(FILE *f) {
+	VulkanCacheIDs ids;
+	if (!ReadCacheIDs(f, &ids)) {
+		return false;
+	}
 
-	if (header.useFlags != gstate_c.GetUseFlags()) {
+	if (ids.useFlags != gstate_c.GetUseFlags()) {
 		// This can simply be a result of sawExactEqualDepth_ having been flipped to true in the previous run.
 		// Let's just keep going.
-		WARN_LOG(Log::G3D, "Shader cache useFlags mismatch, %08x, expected %08x", header.useFlags, gstate_c.GetUseFlags());
+		WARN_LOG(Log::G3D, "Shader cache useFlags mismatch, %08x, expected %08x", ids.useFlags, gstate_c.GetUseFlags());
 	} else {
 		// We're compiling shaders now, so they haven't changed anymore.
 		gstate_c.useFlagsChanged = false;
 	}
 
+	// If it's not enabled, don't create shaders cached from earlier runs - creation will likely fail.
+	if (!gstate_c.Use(GPU_USE_GS_CULLING)) {
+		ids.geom.clear();
+	}
+
+	double start = time_now_d();
+
+	// Generate all the source code up front on the worker threads. The shader objects below
+	// then kick off the GLSL to SPIR-V compiles, which are also spread across threads.
+	std::vector<PrecompiledVertexShader> vertexShaders;
+	std::vector<PrecompiledFragmentShader> fragmentShaders;
+	std::vector<PrecompiledGeometryShader> geometryShaders;
+	PrecompileVertexShaders(ids.vert, compat_, draw_->GetBugs(), &vertexShaders);
+	PrecompileFragmentShaders(ids.frag, compat_, draw_->GetBugs(), &fragmentShaders);
+	PrecompileGeometryShaders(ids.geom, compat_, draw_->GetBugs(), &geometryShaders);
+
 	int failCount = 0;
 
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
-	for (int i = 0; i < header.numVertexShaders; i++) {
-		VShaderID id;
-		if (fread(&id, sizeof(id), 1, f) != 1) {
-			ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in VertexShaders)");
-			return false;
-		}
-		bool useHWTransform = id.Bit(VS_BIT_USE_HW_TRANSFORM);
-		std::string genErrorString;
-		uint32_t attributeMask = 0;
-		uint64_t uniformMask = 0;
-		VertexShaderFlags flags;
-		if (!GenerateVertexShader(id, codeBuffer_, compat_, draw_->GetBugs(), &attributeMask, &uniformMask, &flags, &genErrorString)) {
-			ERROR_LOG(Log::G3D, "Failed to generate vertex shader during cache load");
+	for (const PrecompiledVertexShader &shader : vertexShaders) {
+		if (!shader.success) {
 			// We just ignore this one and carry on.
 			failCount++;
 			continue;
 		}
-		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "VS length error: %d", (int)strlen(codeBuffer_));
 		// Don't add the new shader if already compiled - though this should no longer happen.
-		if (!vsCache_.ContainsKey(id)) {
-			VulkanVertexShader *vs = new VulkanVertexShader(vulkan, id, flags, codeBuffer_, useHWTransform);
-			vsCache_.Insert(id, vs);
+		if (!vsCache_.ContainsKey(shader.id)) {
+			bool useHWTransform = shader.id.Bit(VS_BIT_USE_HW_TRANSFORM);
+			VulkanVertexShader *vs = new VulkanVertexShader(vulkan, shader.id, shader.flags, shader.code.c_str(), useHWTransform);
+			vsCache_.Insert(shader.id, vs);
 		}
 	}
-	uint32_t vendorID = vulkan->GetPhysicalDeviceProperties().properties.vendorID;
 
-	for (int i = 0; i < header.numFragmentShaders; i++) {
-		FShaderID id;
-		if (fread(&id, sizeof(id), 1, f) != 1) {
-			ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in FragmentShaders)");
-			return false;
-		}
-		std::string genErrorString;
-		uint64_t uniformMask = 0;
-		FragmentShaderFlags flags;
-		if (!GenerateFragmentShader(id, codeBuffer_, compat_, draw_->GetBugs(), &uniformMask, &flags, &genErrorString)) {
-			ERROR_LOG(Log::G3D, "Failed to generate fragment shader during cache load");
-			// We just ignore this one and carry on.
+	for (const PrecompiledFragmentShader &shader : fragmentShaders) {
+		if (!shader.success) {
 			failCount++;
 			continue;
 		}
-		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(codeBuffer_));
-		if (!fsCache_.ContainsKey(id)) {
-			VulkanFragmentShader *fs = new VulkanFragmentShader(vulkan, id, flags, codeBuffer_);
-			fsCache_.Insert(id, fs);
+		if (!fsCache_.ContainsKey(shader.id)) {
+			VulkanFragmentShader *fs = new VulkanFragmentShader(vulkan, shader.id, shader.flags, shader.code.c_str());
+			fsCache_.Insert(shader.id, fs);
 		}
 	}
 
-	// If it's not enabled, don't create shaders cached from earlier runs - creation will likely fail.
-	if (gstate_c.Use(GPU_USE_GS_CULLING)) {
-		for (int i = 0; i < header.numGeometryShaders; i++) {
-			GShaderID id;
-			if (fread(&id, sizeof(id), 1, f) != 1) {
-				ERROR_LOG(Log::G3D, "Vulkan shader cache truncated (in GeometryShaders)");
-				return false;
-			}
-			std::string genErrorString;
-			if (!GenerateGeometryShader(id, codeBuffer_, compat_, draw_->GetBugs(), &genErrorString)) {
-				ERROR_LOG(Log::G3D, "Failed to generate geometry shader during cache load");
-				// We just ignore this one and carry on.
-				failCount++;
-				continue;
-			}
-			_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "GS length error: %d", (int)strlen(codeBuffer_));
-			if (!gsCache_.ContainsKey(id)) {
-				VulkanGeometryShader *gs = new VulkanGeometryShader(vulkan, id, codeBuffer_);
-				gsCache_.Insert(id, gs);
-			}
+	for (const PrecompiledGeometryShader &shader : geometryShaders) {
+		if (!shader.success) {
+			failCount++;
+			continue;
+		}
+		if (!gsCache_.ContainsKey(shader.id)) {
+			VulkanGeometryShader *gs = new VulkanGeometryShader(vulkan, shader.id, shader.code.c_str());
+			gsCache_.Insert(shader.id, gs);
 		}
 	}
 
-	NOTICE_LOG(Log::G3D, "ShaderCache: Loaded %d vertex, %d fragment shaders and %d geometry shaders (failed %d)", header.numVertexShaders, header.numFragmentShaders, header.numGeometryShaders, failCount);
+	NOTICE_LOG(Log::G3D, "ShaderCache: Loaded %d vertex, %d fragment shaders and %d geometry shaders (failed %d) in %0.1f ms", (int)ids.vert.size(), (int)ids.frag.size(), (int)ids.geom.size(), failCount, (time_now_d() - start) * 1000.0);
 	return true;
 }
 
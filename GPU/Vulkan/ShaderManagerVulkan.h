@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <mutex>
+#include <vector>
 
 #include "Common/Thread/Promise.h"
 #include "Common/Data/Collections/Hashmaps.h"
@@ -36,6 +37,14 @@ class VulkanContext;
 class DrawEngineVulkan;
 class VulkanPushPool;
 
+// The shader part of a Vulkan shader cache file.
+struct VulkanCacheIDs {
+	uint32_t useFlags = 0;
+	std::vector<VShaderID> vert;
+	std::vector<FShaderID> frag;
+	std::vector<GShaderID> geom;
+};
+
 class VulkanFragmentShader {
 public:
 	VulkanFragmentShader(VulkanContext *vulkan, FShaderID id, FragmentShaderFlags flags, const char *code);
@@ -158,6 +167,8 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 	}
 
 	static bool LoadCacheFlags(FILE *f, DrawEngineVulkan *drawEngine);
+	// Just reads the shader IDs, also usable without a device.
+	static bool ReadCacheIDs(FILE *f, VulkanCacheIDs *ids);
 	bool LoadCache(FILE *f);
 	void SaveCache(FILE *f, DrawEngineVulkan *drawEngine);
 
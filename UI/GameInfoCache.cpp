@@ -41,6 +41,7 @@
 #include "Core/Util/GameManager.h"
 #include "Core/Config.h"
 #include "UI/GameInfoCache.h"
+#include "UI/GameInfoIndex.h"
 
 GameInfoCache *g_gameInfoCache;
 
@@ -360,6 +361,44 @@ void GameInfo::SetTitle(const std::string &newTitle) {
 	title = newTitle;
 }
 
+GameInfoFlags GameInfo::ApplyIndexEntry(const GameInfoIndexEntry &entry) {
+	fileType = (IdentifiedFileType)entry.fileType;
+	paramSFO.ReadSFO((const u8 *)entry.paramSFO.data(), entry.paramSFO.size());
+	title = entry.title;
+	id = entry.id;
+	id_version = entry.idVersion;
+	disc_total = entry.discTotal;
+	disc_number = entry.discNumber;
+	region = entry.region;
+
+	GameInfoFlags flags = GameInfoFlags::FILE_TYPE | GameInfoFlags::PARAM_SFO;
+	if (entry.hasIcon) {
+		icon.data = entry.icon;
+		icon.dataLoaded = true;
+		flags |= GameInfoFlags::ICON;
+	}
+	return flags;
+}
+
+void GameInfo::FillIndexEntry(GameInfoIndexEntry *entry, bool withIcon) {
+	entry->fileType = (uint32_t)fileType;
+	u8 *sfoData = nullptr;
+	size_t sfoSize = 0;
+	paramSFO.WriteSFO(&sfoData, &sfoSize);
+	entry->paramSFO.assign((const char *)sfoData, sfoSize);
+	delete[] sfoData;
+	entry->title = title;
+	entry->id = id;
+	entry->idVersion = id_version;
+	entry->discTotal = disc_total;
+	entry->discNumber = disc_number;
+	entry->region = region;
+	entry->hasIcon = withIcon;
+	if (withIcon) {
+		entry->icon = icon.data;
+	}
+}
+
 void GameInfo::FinishPendingTextureLoads(Draw::DrawContext *draw) {
 	if (draw && icon.dataLoaded && !icon.texture) {
 		SetupTexture(draw, icon);
@@ -453,6 +492,26 @@ static bool ReadVFSToString(const char *filename, std::string *contents, std::mu
 	return true;
 }
 
+// Only games that are a single file need to be opened to get their info, those are worth remembering.
+static bool IsIndexable(IdentifiedFileType fileType) {
+	switch (fileType) {
+	case IdentifiedFileType::PSP_ISO:
+	case IdentifiedFileType::PSP_ISO_NP:
+	case IdentifiedFileType::PSP_PBP:
+	case IdentifiedFileType::PSP_PBP_DIRECTORY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// The file that the index entry stays valid with.
+static Path IndexedFilePath(const Path &gamePath, IdentifiedFileType fileType) {
+	if (fileType == IdentifiedFileType::PSP_PBP_DIRECTORY)
+		return ResolvePBPFile(gamePath);
+	return gamePath;
+}
+
 class GameInfoWorkItem : public Task {
 public:
 	GameInfoWorkItem(const Path &gamePath, std::shared_ptr<GameInfo> &info, GameInfoFlags flags)
@@ -495,6 +554,14 @@ class GameInfoWorkItem : public Task {
 			info_->fileType = Identify_File(info_->GetFileLoader().get(), &errorString);
 		}
 
+		// To remember what we find for next time, see GameInfoIndex. Checked before reading, so that if the
+		// file changes while we're at it, the entry is just considered outdated next time.
+		File::FileInfo indexFileInfo;
+		const bool indexable = (flags_ & GameInfoFlags::PARAM_SFO) && IsIndexable(info_->fileType) &&
+			File::GetFileInfo(IndexedFilePath(gamePath_, info_->fileType), &indexFileInfo);
+		bool sfoFound = false;
+		bool iconFromGame = false;
+
 		switch (info_->fileType) {
 		case IdentifiedFileType::PSP_PBP:
 		case IdentifiedFileType::PSP_PBP_DIRECTORY:
@@ -537,6 +604,7 @@ class GameInfoWorkItem : public Task {
 							info_->region = GAMEREGION_MAX + 1; // Homebrew
 						}
 						info_->MarkReadyNoLock(GameInfoFlags::PARAM_SFO);
+						sfoFound = true;
 					}
 				}
 
@@ -544,7 +612,7 @@ class GameInfoWorkItem : public Task {
 				if (flags_ & GameInfoFlags::ICON) {
 					if (pbp.GetSubFileSize(PBP_ICON0_PNG) > 0) {
 						std::lock_guard<std::mutex> lock(info_->lock);
-						pbp.GetSubFileAsString(PBP_ICON0_PNG, &info_->icon.data);
+						iconFromGame = pbp.GetSubFileAsString(PBP_ICON0_PNG, &info_->icon.data);
 					} else {
 						Path screenshot_jpg = GetSysDirectory(DIRECTORY_SCREENSHOT) / (info_->id + "_00000.jpg");
 						Path screenshot_png = GetSysDirectory(DIRECTORY_SCREENSHOT) / (info_->id + "_00000.png");
@@ -742,6 +810,7 @@ class GameInfoWorkItem : public Task {
 							// quick-update the info while we have the lock, so we don't need to wait for the image load to display the title.
 							info_->MarkReadyNoLock(GameInfoFlags::PARAM_SFO);
 						}
+						sfoFound = true;
 					}
 				}
 
@@ -770,6 +839,7 @@ class GameInfoWorkItem : public Task {
 						}
 					} else {
 						info_->icon.dataLoaded = true;
+						iconFromGame = true;
 					}
 				}
 				break;
@@ -828,6 +898,17 @@ class GameInfoWorkItem : public Task {
 			info_->gameSizeUncompressed = info_->GetSizeUncompressedInBytes();
 		}
 
+		if (indexable && sfoFound) {
+			GameInfoIndexEntry entry;
+			entry.size = indexFileInfo.size;
+			entry.mtime = indexFileInfo.mtime;
+			{
+				std::lock_guard<std::mutex> lock(info_->lock);
+				info_->FillIndexEntry(&entry, iconFromGame);
+			}
+			g_gameInfoIndex.Put(gamePath_.ToString(), std::move(entry));
+		}
+
 		// Time to update the flags.
 		std::unique_lock<std::mutex> lock(info_->lock);
 		info_->MarkReadyNoLock(flags_);
@@ -842,6 +923,48 @@ class GameInfoWorkItem : public Task {
 	DISALLOW_COPY_AND_ASSIGN(GameInfoWorkItem);
 };
 
+// Checks that an index entry that GetInfo used is still valid.
+class GameInfoIndexCheckItem : public Task {
+public:
+	GameInfoIndexCheckItem(const Path &gamePath, std::shared_ptr<GameInfo> &info, const GameInfoIndexEntry &entry)
+		: gamePath_(gamePath), info_(info), size_(entry.size), mtime_(entry.mtime) {}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	TaskPriority Priority() const override {
+		// Loading what isn't known yet is more important.
+		return TaskPriority::LOW;
+	}
+
+	void Run() override {
+		File::FileInfo fileInfo;
+		if (!File::GetFileInfo(IndexedFilePath(gamePath_, info_->fileType), &fileInfo) || fileInfo.size != size_ || fileInfo.mtime != mtime_) {
+			INFO_LOG(Log::Loader, "%s has changed, reloading its info", gamePath_.ToVisualString().c_str());
+			g_gameInfoIndex.Remove(gamePath_.ToString());
+			info_->stale = true;
+			return;
+		}
+
+		// Normally fetched with the PARAM.SFO, but this is a local file so it's cheap to do here.
+		std::string id;
+		{
+			std::lock_guard<std::mutex> lock(info_->lock);
+			id = info_->id;
+		}
+		info_->hasConfig = g_Config.hasGameConfig(id);
+	}
+
+private:
+	Path gamePath_;
+	std::shared_ptr<GameInfo> info_;
+	uint64_t size_;
+	uint64_t mtime_;
+
+	DISALLOW_COPY_AND_ASSIGN(GameInfoIndexCheckItem);
+};
+
 GameInfoCache::GameInfoCache() {
 	Init();
 }
@@ -943,6 +1066,11 @@ std::shared_ptr<GameInfo> GameInfoCache::GetInfo(Draw::DrawContext *draw, const
 	mapLock_.lock();
 
 	auto iter = info_.find(pathStr);
+	if (iter != info_.end() && iter->second->stale) {
+		// Came from the index, but the file has changed. Load it again.
+		info_.erase(iter);
+		iter = info_.end();
+	}
 	if (iter != info_.end()) {
 		// There's already a structure about this game. Let's check.
 		std::shared_ptr<GameInfo> info = iter->second;
@@ -967,13 +1095,25 @@ std::shared_ptr<GameInfo> GameInfoCache::GetInfo(Draw::DrawContext *draw, const
 	}
 
 	std::shared_ptr<GameInfo> info = std::make_shared<GameInfo>(gamePath);
+	// If we've seen the game before, show what we found then right away, and check that it's still valid in the background.
+	GameInfoIndexEntry indexEntry;
+	const bool fromIndex = g_gameInfoIndex.Get(pathStr, &indexEntry);
+	if (fromIndex) {
+		info->hasFlags = info->ApplyIndexEntry(indexEntry);
+		wantFlags &= ~info->hasFlags;
+	}
 	info->pendingFlags = wantFlags;
 	info->lastAccessedTime = time_now_d();
 	info_.insert(std::make_pair(pathStr, info));
 	mapLock_.unlock();
 
-	// Just get all the stuff we wanted.
-	GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wantFlags);
-	g_threadManager.EnqueueTask(item);
+	if (fromIndex) {
+		g_threadManager.EnqueueTask(new GameInfoIndexCheckItem(gamePath, info, indexEntry));
+	}
+	if (wantFlags != (GameInfoFlags)0) {
+		// Just get all the stuff we wanted.
+		GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wantFlags);
+		g_threadManager.EnqueueTask(item);
+	}
 	return info;
 }
@@ -63,6 +63,7 @@ ENUM_CLASS_BITOPS(GameInfoFlags);
 
 class FileLoader;
 enum class IdentifiedFileType;
+struct GameInfoIndexEntry;
 
 struct GameInfoTex {
 	std::string data;
@@ -112,6 +113,10 @@ class GameInfo {
 	}
 	void FinishPendingTextureLoads(Draw::DrawContext *draw);
 
+	// See GameInfoIndex. Call under lock, or before anyone else has the pointer.
+	GameInfoFlags ApplyIndexEntry(const GameInfoIndexEntry &entry);
+	void FillIndexEntry(GameInfoIndexEntry *entry, bool withIcon);
+
 	std::vector<Path> GetSaveDataDirectories();
 
 	std::string GetTitle();
@@ -170,6 +175,9 @@ class GameInfo {
 	std::string sndFileData;
 	std::atomic<bool> sndDataLoaded{};
 
+	// Set when the info came from the index but the file has changed since. GetInfo starts over then.
+	std::atomic<bool> stale{};
+
 	double lastAccessedTime = 0.0;
 
 	u64 gameSizeUncompressed = 0;
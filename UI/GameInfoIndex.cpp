@@ -0,0 +1,220 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <ctime>
+#include <vector>
+
+#include "Common/Log.h"
+#include "UI/GameInfoIndex.h"
+
+#define GAME_INFO_INDEX_VERSION 1
+#define MK_FOURCC(str) (str[0] | ((uint8_t)str[1] << 8) | ((uint8_t)str[2] << 16) | ((uint8_t)str[3] << 24))
+
+// Icons are around 10-30 KB, so this is plenty for a big collection.
+#define MAX_SAVED_INDEX_SIZE (1024 * 1024 * 32)
+
+const uint32_t GAME_INFO_INDEX_MAGIC = MK_FOURCC("pGII");
+
+GameInfoIndex g_gameInfoIndex;
+
+struct DiskIndexHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+};
+
+struct DiskIndexEntry {
+	uint32_t keyLen;
+	uint32_t paramSFOLen;
+	uint32_t titleLen;
+	uint32_t idLen;
+	uint32_t idVersionLen;
+	uint32_t iconLen;
+	uint64_t size;
+	uint64_t mtime;
+	uint64_t usedTime;
+	uint32_t fileType;
+	int32_t discTotal;
+	int32_t discNumber;
+	int32_t region;
+	uint32_t hasIcon;
+};
+
+static size_t EntrySize(const std::string &key, const GameInfoIndexEntry &entry) {
+	return sizeof(DiskIndexEntry) + key.size() + entry.paramSFO.size() + entry.title.size() + entry.id.size() + entry.idVersion.size() + entry.icon.size();
+}
+
+static bool ReadString(FILE *file, uint32_t len, uint32_t maxLen, std::string *str) {
+	if (len > maxLen) {
+		// Probably a corrupted file.
+		return false;
+	}
+	str->resize(len);
+	return len == 0 || fread(&(*str)[0], 1, len, file) == len;
+}
+
+bool GameInfoIndex::Get(const std::string &key, GameInfoIndexEntry *entry) {
+	std::unique_lock<std::mutex> lock(lock_);
+	auto iter = entries_.find(key);
+	if (iter == entries_.end()) {
+		return false;
+	}
+	iter->second.usedTime = (uint64_t)time(nullptr);
+	*entry = iter->second;
+	return true;
+}
+
+void GameInfoIndex::Put(const std::string &key, GameInfoIndexEntry &&entry) {
+	std::unique_lock<std::mutex> lock(lock_);
+	auto iter = entries_.find(key);
+	if (iter != entries_.end() && !entry.hasIcon && iter->second.hasIcon && iter->second.size == entry.size && iter->second.mtime == entry.mtime) {
+		// The icon wasn't asked for this time, but it's still good.
+		entry.hasIcon = true;
+		entry.icon = std::move(iter->second.icon);
+	}
+	entry.usedTime = (uint64_t)time(nullptr);
+	entries_[key] = std::move(entry);
+}
+
+void GameInfoIndex::Remove(const std::string &key) {
+	std::unique_lock<std::mutex> lock(lock_);
+	entries_.erase(key);
+}
+
+void GameInfoIndex::SaveToFile(FILE *file) {
+	std::unique_lock<std::mutex> lock(lock_);
+
+	Decimate(MAX_SAVED_INDEX_SIZE);
+
+	DiskIndexHeader header{};
+	header.magic = GAME_INFO_INDEX_MAGIC;
+	header.version = GAME_INFO_INDEX_VERSION;
+	header.entryCount = (uint32_t)entries_.size();
+
+	fwrite(&header, 1, sizeof(header), file);
+
+	for (auto &iter : entries_) {
+		const GameInfoIndexEntry &entry = iter.second;
+		DiskIndexEntry entryHeader{};
+		entryHeader.keyLen = (uint32_t)iter.first.size();
+		entryHeader.paramSFOLen = (uint32_t)entry.paramSFO.size();
+		entryHeader.titleLen = (uint32_t)entry.title.size();
+		entryHeader.idLen = (uint32_t)entry.id.size();
+		entryHeader.idVersionLen = (uint32_t)entry.idVersion.size();
+		entryHeader.iconLen = (uint32_t)entry.icon.size();
+		entryHeader.size = entry.size;
+		entryHeader.mtime = entry.mtime;
+		entryHeader.usedTime = entry.usedTime;
+		entryHeader.fileType = entry.fileType;
+		entryHeader.discTotal = entry.discTotal;
+		entryHeader.discNumber = entry.discNumber;
+		entryHeader.region = entry.region;
+		entryHeader.hasIcon = entry.hasIcon ? 1 : 0;
+		fwrite(&entryHeader, 1, sizeof(entryHeader), file);
+		fwrite(iter.first.data(), 1, iter.first.size(), file);
+		fwrite(entry.paramSFO.data(), 1, entry.paramSFO.size(), file);
+		fwrite(entry.title.data(), 1, entry.title.size(), file);
+		fwrite(entry.id.data(), 1, entry.id.size(), file);
+		fwrite(entry.idVersion.data(), 1, entry.idVersion.size(), file);
+		fwrite(entry.icon.data(), 1, entry.icon.size(), file);
+	}
+}
+
+bool GameInfoIndex::LoadFromFile(FILE *file) {
+	std::unique_lock<std::mutex> lock(lock_);
+
+	DiskIndexHeader header{};
+	if (fread(&header, 1, sizeof(header), file) != sizeof(DiskIndexHeader)) {
+		return false;
+	}
+	if (header.magic != GAME_INFO_INDEX_MAGIC || header.version != GAME_INFO_INDEX_VERSION) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.entryCount; i++) {
+		DiskIndexEntry entryHeader{};
+		if (fread(&entryHeader, 1, sizeof(entryHeader), file) != sizeof(entryHeader)) {
+			break;
+		}
+
+		std::string key;
+		GameInfoIndexEntry entry;
+		// If anything is cut short, keep what was read so far.
+		if (!ReadString(file, entryHeader.keyLen, 0x1000, &key) ||
+			!ReadString(file, entryHeader.paramSFOLen, 0x10000, &entry.paramSFO) ||
+			!ReadString(file, entryHeader.titleLen, 0x1000, &entry.title) ||
+			!ReadString(file, entryHeader.idLen, 0x1000, &entry.id) ||
+			!ReadString(file, entryHeader.idVersionLen, 0x1000, &entry.idVersion) ||
+			!ReadString(file, entryHeader.iconLen, 0x400000, &entry.icon)) {
+			WARN_LOG(Log::Loader, "Game info index is truncated, got %d of %d entries", i, header.entryCount);
+			break;
+		}
+
+		entry.size = entryHeader.size;
+		entry.mtime = entryHeader.mtime;
+		entry.usedTime = entryHeader.usedTime;
+		entry.fileType = entryHeader.fileType;
+		entry.discTotal = entryHeader.discTotal;
+		entry.discNumber = entryHeader.discNumber;
+		entry.region = entryHeader.region;
+		entry.hasIcon = entryHeader.hasIcon != 0;
+		// Anything added in the meantime is newer.
+		entries_.emplace(std::move(key), std::move(entry));
+	}
+
+	INFO_LOG(Log::Loader, "Loaded game info index with %d entries", (int)entries_.size());
+	return true;
+}
+
+void GameInfoIndex::Decimate(size_t maxSize) {
+	// Call this under the lock.
+
+	size_t totalSize = 0;
+	for (auto &iter : entries_) {
+		totalSize += EntrySize(iter.first, iter.second);
+	}
+
+	if (totalSize <= maxSize) {
+		return;
+	}
+
+	// Drop the games that haven't been seen for the longest first.
+	struct SortEntry {
+		std::string key;
+		uint64_t usedTime;
+		size_t size;
+	};
+
+	std::vector<SortEntry> sortEntries;
+	sortEntries.reserve(entries_.size());
+	for (const auto &iter : entries_) {
+		sortEntries.push_back({ iter.first, iter.second.usedTime, EntrySize(iter.first, iter.second) });
+	}
+
+	std::sort(sortEntries.begin(), sortEntries.end(), [](const SortEntry &a, const SortEntry &b) {
+		return a.usedTime < b.usedTime;
+	});
+
+	for (const SortEntry &sortEntry : sortEntries) {
+		if (totalSize <= maxSize) {
+			break;
+		}
+		entries_.erase(sortEntry.key);
+		totalSize -= sortEntry.size;
+	}
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+// What the game browser shows for a game (see GameInfoCache), as found last time.
+struct GameInfoIndexEntry {
+	// Of the file the info was read from, to notice when it changes.
+	uint64_t size = 0;
+	uint64_t mtime = 0;
+
+	uint32_t fileType = 0;  // IdentifiedFileType
+	std::string paramSFO;
+	std::string title;
+	std::string id;
+	std::string idVersion;
+	int32_t discTotal = 0;
+	int32_t discNumber = 0;
+	int32_t region = -1;
+
+	// ICON0.PNG from the game. Not set if it has none, then the fallbacks are looked up as usual.
+	bool hasIcon = false;
+	std::string icon;
+
+	// Wall clock seconds, the least recently used entries are dropped first when there's too much.
+	uint64_t usedTime = 0;
+};
+
+// Keeps the parsed PARAM.SFO and the icon of every game in the game browser across runs, so that
+// the grid can be filled in right away instead of opening every ISO, CSO and PBP again, which is
+// slow on network shares and SD cards. Entries are keyed by path and stay valid while the size and
+// modification time of the file match. GameInfoCache checks that in the background.
+class GameInfoIndex {
+public:
+	// It's okay to call these from any thread.
+	bool Get(const std::string &key, GameInfoIndexEntry *entry);
+	void Put(const std::string &key, GameInfoIndexEntry &&entry);
+	void Remove(const std::string &key);
+
+	void SaveToFile(FILE *file);
+	bool LoadFromFile(FILE *file);
+
+private:
+	void Decimate(size_t maxSize);
+
+	std::map<std::string, GameInfoIndexEntry> entries_;
+	std::mutex lock_;
+};
+
+extern GameInfoIndex g_gameInfoIndex;
@@ -701,6 +701,10 @@ void GameSettingsScreen::CreateAudioSettings(UI::ViewGroup *audioSettings) {
 	}
 #endif
 
+	static const char *resampleModes[] = { "Linear", "Windowed sinc (higher quality)" };
+	PopupMultiChoice *resampleMode = audioSettings->Add(new PopupMultiChoice(&g_Config.iAudioResampleMode, a->T("Resampling"), resampleModes, 0, ARRAY_SIZE(resampleModes), I18NCat::AUDIO, screenManager()));
+	resampleMode->SetEnabledPtr(&g_Config.bEnableSound);
+
 	std::vector<std::string> micList = Microphone::getDeviceList();
 	if (!micList.empty()) {
 		audioSettings->Add(new ItemHeader(a->T("Microphone")));
@@ -1247,6 +1251,13 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 	PopupSliderChoice *rewindInterval = systemSettings->Add(new PopupSliderChoice(&g_Config.iRewindSnapshotInterval, 0, 60, 0, sy->T("Rewind Snapshot Interval"), screenManager(), di->T("seconds, 0:off")));
 	rewindInterval->SetFormat(di->T("%d seconds"));
 	rewindInterval->SetZeroLabel(sy->T("Off"));
+	auto ga = GetI18NCategory(I18NCat::GAME);
+	// The budget includes the newest state and a spare one, each the size of a save state (about 40 MB,
+	// more with extra memory), so anything much smaller wouldn't leave room to go back at all.
+	PopupSliderChoice *rewindBudget = systemSettings->Add(new PopupSliderChoice(&g_Config.iRewindMemoryBudget, 128, 4096, 256, sy->T("Rewind Memory Budget"), 16, screenManager(), ga->T("MB")));
+	rewindBudget->SetEnabledFunc([] {
+		return g_Config.iRewindSnapshotInterval > 0;
+	});
 
 	systemSettings->Add(new ItemHeader(sy->T("General")));
 
@@ -1272,6 +1283,8 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 		systemSettings->Add(new CheckBox(&g_Config.bBypassOSKWithKeyboard, sy->T("Use system native keyboard")));
 
 	systemSettings->Add(new CheckBox(&g_Config.bCacheFullIsoInRam, sy->T("Cache ISO in RAM", "Cache full ISO in RAM")))->SetEnabled(!PSP_IsInited());
+	// Not safe for removable or network storage, see FileLoader::MapIntoMemory().
+	systemSettings->Add(new CheckBox(&g_Config.bMemoryMapIso, sy->T("Memory map ISO (local drives only)")))->SetEnabled(!PSP_IsInited());
 	systemSettings->Add(new CheckBox(&g_Config.bCheckForNewVersion, sy->T("VersionCheck", "Check for new versions of PPSSPP")));
 	systemSettings->Add(new CheckBox(&g_Config.bScreenshotsAsPNG, sy->T("Screenshots as PNG")));
 	// TODO: Make this setting available on Mac too.
@@ -1309,6 +1322,8 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 	systemSettings->Add(new CheckBox(&g_Config.bUseFFV1, sy->T("Use Lossless Video Codec (FFV1)")));
 	systemSettings->Add(new CheckBox(&g_Config.bDumpVideoOutput, sy->T("Use output buffer (with overlay) for recording")));
 	systemSettings->Add(new CheckBox(&g_Config.bDumpAudio, sy->T("Record Audio")));
+	static const char *audioDumpFormats[] = { "WAV", "FLAC" };
+	systemSettings->Add(new PopupMultiChoice(&g_Config.iAudioDumpFormat, sy->T("Audio recording format"), audioDumpFormats, 0, ARRAY_SIZE(audioDumpFormats), I18NCat::SYSTEM, screenManager()));
 	systemSettings->Add(new CheckBox(&g_Config.bSaveLoadResetsAVdumping, sy->T("Reset Recording on Save/Load State")));
 #endif
 }
@@ -118,6 +118,7 @@
 #include "UI/DiscordIntegration.h"
 #include "UI/EmuScreen.h"
 #include "UI/GameInfoCache.h"
+#include "UI/GameInfoIndex.h"
 #include "UI/GameSettingsScreen.h"
 #include "UI/GPUDriverTestScreen.h"
 #include "UI/MiscScreens.h"
@@ -747,6 +748,12 @@ void NativeInit(int argc, const char *argv[], const char *savegame_dir, const ch
 		}
 	}
 
+	FILE *gameInfoIndexFile = File::OpenCFile(GetSysDirectory(DIRECTORY_CACHE) / "gameinfo.cache", "rb");
+	if (gameInfoIndexFile) {
+		g_gameInfoIndex.LoadFromFile(gameInfoIndexFile);
+		fclose(gameInfoIndexFile);
+	}
+
 	DEBUG_LOG(Log::System, "ScreenManager!");
 	g_screenManager = new ScreenManager();
 	if (g_Config.memStickDirectory.empty()) {
@@ -1459,6 +1466,12 @@ void NativeShutdown() {
 		}
 	}
 
+	FILE *gameInfoIndexFile = File::OpenCFile(GetSysDirectory(DIRECTORY_CACHE) / "gameinfo.cache", "wb");
+	if (gameInfoIndexFile) {
+		g_gameInfoIndex.SaveToFile(gameInfoIndexFile);
+		fclose(gameInfoIndexFile);
+	}
+
 	if (g_screenManager) {
 		g_screenManager->shutdown();
 		delete g_screenManager;
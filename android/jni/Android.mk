@@ -290,8 +290,10 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/Data/Color/RGBAUtil.cpp \
   $(SRC)/Common/Data/Convert/ColorConv.cpp \
   $(SRC)/Common/Data/Convert/SmallDataConvert.cpp \
+  $(SRC)/Common/Data/Convert/YUVConv.cpp \
   $(SRC)/Common/Data/Encoding/Base64.cpp \
   $(SRC)/Common/Data/Encoding/Compression.cpp \
+  $(SRC)/Common/Data/Encoding/LZ4.cpp \
   $(SRC)/Common/Data/Encoding/Utf8.cpp \
   $(SRC)/Common/Data/Format/RIFF.cpp \
   $(SRC)/Common/Data/Format/IniFile.cpp \
@@ -299,6 +301,8 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/Data/Format/JSONWriter.cpp \
   $(SRC)/Common/Data/Format/DDSLoad.cpp \
   $(SRC)/Common/Data/Format/DDSLoad.h \
+  $(SRC)/Common/Data/Format/FLACEncoder.cpp \
+  $(SRC)/Common/Data/Format/FLACEncoder.h \
   $(SRC)/Common/Data/Format/PNGLoad.cpp \
   $(SRC)/Common/Data/Format/PNGLoad.h \
   $(SRC)/Common/Data/Format/ZIMLoad.cpp \
@@ -313,6 +317,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/File/AndroidContentURI.cpp \
   $(SRC)/Common/File/VFS/VFS.cpp \
   $(SRC)/Common/File/VFS/ZipFileReader.cpp \
+  $(SRC)/Common/File/VFS/MappedZipFileReader.cpp \
   $(SRC)/Common/File/VFS/DirectoryReader.cpp \
   $(SRC)/Common/File/DiskFree.cpp \
   $(SRC)/Common/File/Path.cpp \
@@ -320,6 +325,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/File/FileUtil.cpp \
   $(SRC)/Common/File/DirListing.cpp \
   $(SRC)/Common/File/FileDescriptor.cpp \
+  $(SRC)/Common/File/IOUring.cpp \
   $(SRC)/Common/GPU/thin3d.cpp \
   $(SRC)/Common/GPU/GPUBackendCommon.cpp \
   $(SRC)/Common/GPU/Shader.cpp \
@@ -542,6 +548,8 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/GPU/Common/TextureDecoder.cpp \
   $(SRC)/GPU/Common/PostShader.cpp \
   $(SRC)/GPU/Common/ShaderUniforms.cpp \
+  $(SRC)/GPU/Common/ShaderPrecompile.cpp \
+  $(SRC)/GPU/Common/ShaderGenCache.cpp \
   $(SRC)/GPU/Common/VertexShaderGenerator.cpp \
   $(SRC)/GPU/Common/GeometryShaderGenerator.cpp \
   $(SRC)/GPU/Common/TextureReplacer.cpp \
@@ -578,6 +586,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/ELF/ParamSFO.cpp \
   $(SRC)/Core/HW/SimpleAudioDec.cpp \
   $(SRC)/Core/HW/Atrac3Standalone.cpp \
+  $(SRC)/Core/HW/AudioPerf.cpp \
   $(SRC)/Core/HW/AsyncIOManager.cpp \
   $(SRC)/Core/HW/BufferQueue.cpp \
   $(SRC)/Core/HW/Camera.cpp \
@@ -735,6 +744,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/FileSystems/BlobFileSystem.cpp \
   $(SRC)/Core/FileSystems/BlockDevices.cpp \
   $(SRC)/Core/FileSystems/ISOFileSystem.cpp \
+  $(SRC)/Core/FileSystems/UmdPrefetcher.cpp \
   $(SRC)/Core/FileSystems/FileSystem.cpp \
   $(SRC)/Core/FileSystems/MetaFileSystem.cpp \
   $(SRC)/Core/FileSystems/DirectoryFileSystem.cpp \
@@ -901,6 +911,7 @@ LOCAL_SRC_FILES := \
   $(SRC)/UI/GamepadEmu.cpp \
   $(SRC)/UI/JoystickHistoryView.cpp \
   $(SRC)/UI/GameInfoCache.cpp \
+  $(SRC)/UI/GameInfoIndex.cpp \
   $(SRC)/UI/GameScreen.cpp \
   $(SRC)/UI/ControlMappingScreen.cpp \
   $(SRC)/UI/GameSettingsScreen.cpp \
@@ -935,7 +946,8 @@ ifeq ($(HEADLESS),1)
   LOCAL_SRC_FILES := \
     $(SRC)/headless/Headless.cpp \
     $(SRC)/headless/HeadlessHost.cpp \
-    $(SRC)/headless/Compare.cpp
+    $(SRC)/headless/Compare.cpp \
+    $(SRC)/headless/ShaderCacheTool.cpp
 
   include $(BUILD_EXECUTABLE)
 endif
@@ -981,6 +993,14 @@ ifeq ($(UNITTEST),1)
     $(SRC)/unittest/TestThreadManager.cpp \
     $(SRC)/unittest/TestVertexJit.cpp \
     $(SRC)/unittest/TestVFS.cpp \
+    $(SRC)/unittest/TestSasAudio.cpp \
+    $(SRC)/unittest/TestAt3Dsp.cpp \
+    $(SRC)/unittest/TestAudioResampler.cpp \
+    $(SRC)/unittest/TestYUVConv.cpp \
+    $(SRC)/unittest/TestFLACEncoder.cpp \
+    $(SRC)/unittest/TestSasReverb.cpp \
+    $(SRC)/unittest/TestBlockDevices.cpp \
+    $(SRC)/unittest/TestSaveState.cpp \
     $(TESTARMEMITTER_FILE) \
     $(SRC)/unittest/UnitTest.cpp
 
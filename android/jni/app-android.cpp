@@ -70,6 +70,7 @@ struct JNIEnv {};
 #include "Common/File/DirListing.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/DirectoryReader.h"
+#include "Common/File/VFS/MappedZipFileReader.h"
 #include "Common/File/VFS/ZipFileReader.h"
 #include "Common/File/AndroidStorage.h"
 #include "Common/Input/InputState.h"
@@ -742,7 +743,11 @@ extern "C" void Java_org_ppsspp_ppsspp_NativeApp_init
 	deviceType = jdeviceType;
 
 	Path apkPath(GetJavaString(env, japkpath));
-	g_VFS.Register("", ZipFileReader::Create(apkPath, "assets/"));
+	VFSBackend *assets = MappedZipFileReader::Create(apkPath, "assets/", false);
+	if (!assets) {
+		assets = ZipFileReader::Create(apkPath, "assets/");
+	}
+	g_VFS.Register("", assets);
 
 	systemName = GetJavaString(env, jmodel);
 	langRegion = GetJavaString(env, jlangRegion);
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "Common/Math/CrossSIMD.h"
 #include "atrac.h"
 
 float av_atrac_sf_table[64];
@@ -134,7 +135,29 @@ void ff_atrac_iqmf(float *inlo, float *inhi, unsigned int nIn, float *pOut,
     p3 = temp + 46;
 
     /* loop1 */
-    for(i=0; i<(int)nIn; i+=2){
+    i = 0;
+    if (ff_at3_use_simd) {
+#if PPSSPP_ARCH(SSE2)
+        for (; i + 4 <= (int)nIn; i += 4) {
+            __m128 lo = _mm_loadu_ps(inlo + i);
+            __m128 hi = _mm_loadu_ps(inhi + i);
+            __m128 sum = _mm_add_ps(lo, hi);
+            __m128 diff = _mm_sub_ps(lo, hi);
+            _mm_storeu_ps(p3 + 2 * i, _mm_unpacklo_ps(sum, diff));
+            _mm_storeu_ps(p3 + 2 * i + 4, _mm_unpackhi_ps(sum, diff));
+        }
+#elif PPSSPP_ARCH(ARM_NEON)
+        for (; i + 4 <= (int)nIn; i += 4) {
+            float32x4_t lo = vld1q_f32(inlo + i);
+            float32x4_t hi = vld1q_f32(inhi + i);
+            float32x4x2_t sd;
+            sd.val[0] = vaddq_f32(lo, hi);
+            sd.val[1] = vsubq_f32(lo, hi);
+            vst2q_f32(p3 + 2 * i, sd);
+        }
+#endif
+    }
+    for(; i<(int)nIn; i+=2){
         p3[2*i+0] = inlo[i  ] + inhi[i  ];
         p3[2*i+1] = inlo[i  ] - inhi[i  ];
         p3[2*i+2] = inlo[i+1] + inhi[i+1];
@@ -143,7 +166,42 @@ void ff_atrac_iqmf(float *inlo, float *inhi, unsigned int nIn, float *pOut,
 
     /* loop2 */
     p1 = temp;
-    for (j = (int)nIn; j != 0; j--) {
+    j = (int)nIn;
+    if (ff_at3_use_simd) {
+        // Four outputs at a time, as (s1, s2) pairs. The window taps are summed in the same order as below.
+#if PPSSPP_ARCH(SSE2)
+        for (; j >= 4; j -= 4) {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            for (i = 0; i < 48; i += 2) {
+                __m128 w = _mm_castpd_ps(_mm_load1_pd((const double *)(qmf_window + i)));
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(p1 + i), w));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(p1 + i + 4), w));
+            }
+            _mm_storeu_ps(pOut, _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(2, 3, 0, 1)));
+            _mm_storeu_ps(pOut + 4, _mm_shuffle_ps(acc1, acc1, _MM_SHUFFLE(2, 3, 0, 1)));
+            p1 += 8;
+            pOut += 8;
+        }
+#elif PPSSPP_ARCH(ARM_NEON)
+        for (; j >= 4; j -= 4) {
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            for (i = 0; i < 48; i += 2) {
+                float32x2_t w2 = vld1_f32(qmf_window + i);
+                float32x4_t w = vcombine_f32(w2, w2);
+                // Not vmlaq, which may be fused and round differently from the C loop.
+                acc0 = vaddq_f32(acc0, vmulq_f32(vld1q_f32(p1 + i), w));
+                acc1 = vaddq_f32(acc1, vmulq_f32(vld1q_f32(p1 + i + 4), w));
+            }
+            vst1q_f32(pOut, vrev64q_f32(acc0));
+            vst1q_f32(pOut + 4, vrev64q_f32(acc1));
+            p1 += 8;
+            pOut += 8;
+        }
+#endif
+    }
+    for (; j != 0; j--) {
         float s1 = 0.0;
         float s2 = 0.0;
 
@@ -4,6 +4,9 @@
 #include "compat.h"
 #include "Common/Log.h"
 
+// Only ever changed by tests, see compat.h.
+bool ff_at3_use_simd = true;
+
 void av_log(int level, const char *fmt, ...) {
 	char buffer[512];
 	va_list vl;
@@ -79,3 +79,8 @@ void av_log(int level, const char *fmt, ...) av_printf_format(3, 4);
 #define AV_BSWAP16C(x) (((x) << 8 & 0xff00)  | ((x) >> 8 & 0x00ff))
 #define AV_BSWAP32C(x) (AV_BSWAP16C(x) << 16 | AV_BSWAP16C((x) >> 16))
 #define av_be2ne32(x) AV_BSWAP32C((x))
+
+// The DSP functions (FFT/IMDCT, IQMF, float_dsp.h) use SSE2 or NEON when the build targets them
+// (PPSSPP_ARCH checks at compile time, there's no CPU detection). Test-only: TestAt3Dsp clears this
+// to compare against the plain C versions. Not synchronized, don't change it while decoding.
+extern bool ff_at3_use_simd;
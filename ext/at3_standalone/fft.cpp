@@ -32,6 +32,7 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include "Common/Math/CrossSIMD.h"
 #include "mem.h"
 #include "fft.h"
 
@@ -182,6 +183,89 @@ void ff_fft_end(FFTContext *s)
     BUTTERFLIES(a0,a1,a2,a3)\
 }
 
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+#define HAVE_PASS_SIMD 1
+
+/*
+ * The loop of PASS below, two complex values at a time. Does exactly the same float operations as
+ * TRANSFORM, just rearranged (a - b is computed as a + -b, which rounds the same), so the result is
+ * identical. The first pair is left to the C code, as TRANSFORM_ZERO doesn't multiply.
+ */
+static void pass_simd(FFTComplex *z, const FFTSample *wre, const FFTSample *wim, int o1, unsigned int n)
+{
+    float *z0 = (float *)z;
+    float *z1 = (float *)(z + o1);
+    float *z2 = (float *)(z + o1 * 2);
+    float *z3 = (float *)(z + o1 * 3);
+#if PPSSPP_ARCH(SSE2)
+    const __m128 signOdd = _mm_castsi128_ps(_mm_setr_epi32(0, 0x80000000, 0, 0x80000000));
+    const __m128 signEven = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0x80000000, 0));
+    do {
+        __m128 wr = _mm_castpd_ps(_mm_load_sd((const double *)wre));
+        wr = _mm_unpacklo_ps(wr, wr);  // wre[0], wre[0], wre[1], wre[1]
+        __m128 wi = _mm_castpd_ps(_mm_load_sd((const double *)(wim - 1)));
+        wi = _mm_shuffle_ps(wi, wi, _MM_SHUFFLE(0, 0, 1, 1));  // wim[0], wim[0], wim[-1], wim[-1]
+
+        __m128 a0 = _mm_loadu_ps(z0);
+        __m128 a1 = _mm_loadu_ps(z1);
+        __m128 a2 = _mm_loadu_ps(z2);
+        __m128 a3 = _mm_loadu_ps(z3);
+        __m128 a2sw = _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 a3sw = _mm_shuffle_ps(a3, a3, _MM_SHUFFLE(2, 3, 0, 1));
+        // t1, t2 and t5, t6 of TRANSFORM.
+        __m128 t12 = _mm_add_ps(_mm_mul_ps(a2, wr), _mm_xor_ps(_mm_mul_ps(a2sw, wi), signOdd));
+        __m128 t56 = _mm_add_ps(_mm_mul_ps(a3, wr), _mm_xor_ps(_mm_mul_ps(a3sw, wi), signEven));
+        // The new t5, t6, and t3, t4 of BUTTERFLIES.
+        __m128 sum = _mm_add_ps(t56, t12);
+        __m128 diff = _mm_xor_ps(_mm_sub_ps(t56, t12), signOdd);
+        diff = _mm_shuffle_ps(diff, diff, _MM_SHUFFLE(2, 3, 0, 1));  // t4, t3
+
+        _mm_storeu_ps(z2, _mm_sub_ps(a0, sum));
+        _mm_storeu_ps(z0, _mm_add_ps(a0, sum));
+        _mm_storeu_ps(z3, _mm_sub_ps(a1, diff));
+        _mm_storeu_ps(z1, _mm_add_ps(a1, diff));
+
+        z0 += 4; z1 += 4; z2 += 4; z3 += 4;
+        wre += 2;
+        wim -= 2;
+    } while (--n);
+#else
+    static const uint32_t signOddBits[4] = { 0, 0x80000000, 0, 0x80000000 };
+    static const uint32_t signEvenBits[4] = { 0x80000000, 0, 0x80000000, 0 };
+    const uint32x4_t signOdd = vld1q_u32(signOddBits);
+    const uint32x4_t signEven = vld1q_u32(signEvenBits);
+    do {
+        float32x2x2_t wrz = vzip_f32(vld1_f32(wre), vld1_f32(wre));
+        float32x4_t wr = vcombine_f32(wrz.val[0], wrz.val[1]);  // wre[0], wre[0], wre[1], wre[1]
+        float32x2x2_t wiz = vzip_f32(vld1_f32(wim - 1), vld1_f32(wim - 1));
+        float32x4_t wi = vcombine_f32(wiz.val[1], wiz.val[0]);  // wim[0], wim[0], wim[-1], wim[-1]
+
+        float32x4_t a0 = vld1q_f32(z0);
+        float32x4_t a1 = vld1q_f32(z1);
+        float32x4_t a2 = vld1q_f32(z2);
+        float32x4_t a3 = vld1q_f32(z3);
+        // Separate multiplies and adds, a fused multiply-add would round differently.
+        float32x4_t t12 = vaddq_f32(vmulq_f32(a2, wr), vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vmulq_f32(vrev64q_f32(a2), wi)), signOdd)));
+        float32x4_t t56 = vaddq_f32(vmulq_f32(a3, wr), vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vmulq_f32(vrev64q_f32(a3), wi)), signEven)));
+        float32x4_t sum = vaddq_f32(t56, t12);
+        float32x4_t diff = vrev64q_f32(vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vsubq_f32(t56, t12)), signOdd)));
+
+        vst1q_f32(z2, vsubq_f32(a0, sum));
+        vst1q_f32(z0, vaddq_f32(a0, sum));
+        vst1q_f32(z3, vsubq_f32(a1, diff));
+        vst1q_f32(z1, vaddq_f32(a1, diff));
+
+        z0 += 4; z1 += 4; z2 += 4; z3 += 4;
+        wre += 2;
+        wim -= 2;
+    } while (--n);
+#endif
+}
+#else
+#define HAVE_PASS_SIMD 0
+static void pass_simd(FFTComplex *z, const FFTSample *wre, const FFTSample *wim, int o1, unsigned int n) {}
+#endif
+
 /* z[0...8n-1], w[1...2n-1] */
 #define PASS(name)\
 static void name(FFTComplex *z, const FFTSample *wre, unsigned int n)\
@@ -195,6 +279,10 @@ static void name(FFTComplex *z, const FFTSample *wre, unsigned int n)\
 \
     TRANSFORM_ZERO(z[0],z[o1],z[o2],z[o3]);\
     TRANSFORM(z[1],z[o1+1],z[o2+1],z[o3+1],wre[1],wim[-1]);\
+    if (HAVE_PASS_SIMD && ff_at3_use_simd) {\
+        pass_simd(z + 2, wre + 2, wim - 2, o1, n);\
+        return;\
+    }\
     do {\
         z += 2;\
         wre += 2;\
@@ -356,7 +444,46 @@ void imdct_half(FFTContext *s, FFTSample *output, const FFTSample *input)
 	/* pre rotation */
 	in1 = input;
 	in2 = input + n2 - 1;
-	for (k = 0; k < n4; k++) {
+	k = 0;
+	if (ff_at3_use_simd) {
+		// Computed four at a time, then scattered.
+#if PPSSPP_ARCH(SSE2)
+		for (; k + 4 <= n4; k += 4) {
+			__m128 lo0 = _mm_loadu_ps(in1), lo1 = _mm_loadu_ps(in1 + 4);
+			__m128 hi0 = _mm_loadu_ps(in2 - 7), hi1 = _mm_loadu_ps(in2 - 3);
+			__m128 v1 = _mm_shuffle_ps(lo0, lo1, _MM_SHUFFLE(2, 0, 2, 0));  // in1[0], in1[2], in1[4], in1[6]
+			__m128 v2 = _mm_shuffle_ps(hi1, hi0, _MM_SHUFFLE(1, 3, 1, 3));  // in2[0], in2[-2], in2[-4], in2[-6]
+			__m128 c = _mm_loadu_ps(tcos + k), s = _mm_loadu_ps(tsin + k);
+			__m128 re = _mm_sub_ps(_mm_mul_ps(v2, c), _mm_mul_ps(v1, s));
+			__m128 im = _mm_add_ps(_mm_mul_ps(v2, s), _mm_mul_ps(v1, c));
+			__m128 z01 = _mm_unpacklo_ps(re, im), z23 = _mm_unpackhi_ps(re, im);
+			_mm_storel_pi((__m64 *)&z[revtab[k + 0]], z01);
+			_mm_storeh_pi((__m64 *)&z[revtab[k + 1]], z01);
+			_mm_storel_pi((__m64 *)&z[revtab[k + 2]], z23);
+			_mm_storeh_pi((__m64 *)&z[revtab[k + 3]], z23);
+			in1 += 8;
+			in2 -= 8;
+		}
+#elif PPSSPP_ARCH(ARM_NEON)
+		for (; k + 4 <= n4; k += 4) {
+			float32x4_t v1 = vld2q_f32(in1).val[0];  // in1[0], in1[2], in1[4], in1[6]
+			float32x4_t hi = vld2q_f32(in2 - 7).val[1];  // in2[-6], in2[-4], in2[-2], in2[0]
+			hi = vrev64q_f32(hi);
+			float32x4_t v2 = vcombine_f32(vget_high_f32(hi), vget_low_f32(hi));
+			float32x4_t c = vld1q_f32(tcos + k), s = vld1q_f32(tsin + k);
+			float32x4_t re = vsubq_f32(vmulq_f32(v2, c), vmulq_f32(v1, s));
+			float32x4_t im = vaddq_f32(vmulq_f32(v2, s), vmulq_f32(v1, c));
+			float32x4x2_t zz = vzipq_f32(re, im);
+			vst1_f32(&z[revtab[k + 0]].re, vget_low_f32(zz.val[0]));
+			vst1_f32(&z[revtab[k + 1]].re, vget_high_f32(zz.val[0]));
+			vst1_f32(&z[revtab[k + 2]].re, vget_low_f32(zz.val[1]));
+			vst1_f32(&z[revtab[k + 3]].re, vget_high_f32(zz.val[1]));
+			in1 += 8;
+			in2 -= 8;
+		}
+#endif
+	}
+	for (; k < n4; k++) {
 		j = revtab[k];
 		CMUL(z[j].re, z[j].im, *in2, *in1, tcos[k], tsin[k]);
 		in1 += 2;
@@ -365,7 +492,59 @@ void imdct_half(FFTContext *s, FFTSample *output, const FFTSample *input)
 	fft_calc(s, z);
 
 	/* post rotation + reordering */
-	for (k = 0; k < n8; k++) {
+	k = 0;
+	if (ff_at3_use_simd && (n8 & 1) == 0) {
+		// Two values from each end at a time. Each rotation works out like CMUL below.
+#if PPSSPP_ARCH(SSE2)
+		const __m128 signEven = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0x80000000, 0));
+		const __m128 maskEven = _mm_castsi128_ps(_mm_setr_epi32(-1, 0, -1, 0));
+		auto rotate = [&](__m128 v, int idx) {
+			__m128 s = _mm_castpd_ps(_mm_load_sd((const double *)(tsin + idx)));
+			__m128 c = _mm_castpd_ps(_mm_load_sd((const double *)(tcos + idx)));
+			__m128 im = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 re = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+			return _mm_add_ps(_mm_mul_ps(im, _mm_unpacklo_ps(s, c)), _mm_xor_ps(_mm_mul_ps(re, _mm_unpacklo_ps(c, s)), signEven));
+		};
+		for (; k < n8; k += 2) {
+			float *fwd = &z[n8 + k].re;
+			float *bwd = &z[n8 - k - 2].re;
+			__m128 f = rotate(_mm_loadu_ps(fwd), n8 + k);
+			__m128 b = rotate(_mm_loadu_ps(bwd), n8 - k - 2);
+			// Swap the two complex values, so each lines up with its partner from the other end.
+			__m128 fsw = _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 0, 3, 2));
+			__m128 bsw = _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2));
+			_mm_storeu_ps(fwd, _mm_or_ps(_mm_and_ps(maskEven, f), _mm_andnot_ps(maskEven, bsw)));
+			_mm_storeu_ps(bwd, _mm_or_ps(_mm_and_ps(maskEven, b), _mm_andnot_ps(maskEven, fsw)));
+		}
+#elif PPSSPP_ARCH(ARM_NEON)
+		static const uint32_t signEvenBits[4] = { 0x80000000, 0, 0x80000000, 0 };
+		static const uint32_t maskEvenBits[4] = { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0 };
+		const uint32x4_t signEven = vld1q_u32(signEvenBits);
+		const uint32x4_t maskEven = vld1q_u32(maskEvenBits);
+		auto rotate = [&](float32x4_t v, int idx) {
+			float32x2_t s = vld1_f32(tsin + idx);
+			float32x2_t c = vld1_f32(tcos + idx);
+			float32x2x2_t sc = vzip_f32(s, c);
+			float32x2x2_t cs = vzip_f32(c, s);
+			float32x4x2_t ri = vuzpq_f32(v, v);  // re0 re1 re0 re1, im0 im1 im0 im1
+			float32x4_t re = vzipq_f32(ri.val[0], ri.val[0]).val[0];  // re0 re0 re1 re1
+			float32x4_t im = vzipq_f32(ri.val[1], ri.val[1]).val[0];
+			float32x4_t reTerm = vmulq_f32(re, vcombine_f32(cs.val[0], cs.val[1]));
+			return vaddq_f32(vmulq_f32(im, vcombine_f32(sc.val[0], sc.val[1])), vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(reTerm), signEven)));
+		};
+		for (; k < n8; k += 2) {
+			float *fwd = &z[n8 + k].re;
+			float *bwd = &z[n8 - k - 2].re;
+			float32x4_t f = rotate(vld1q_f32(fwd), n8 + k);
+			float32x4_t b = rotate(vld1q_f32(bwd), n8 - k - 2);
+			float32x4_t fsw = vcombine_f32(vget_high_f32(f), vget_low_f32(f));
+			float32x4_t bsw = vcombine_f32(vget_high_f32(b), vget_low_f32(b));
+			vst1q_f32(fwd, vbslq_f32(maskEven, f, bsw));
+			vst1q_f32(bwd, vbslq_f32(maskEven, b, fsw));
+		}
+#endif
+	}
+	for (; k < n8; k++) {
 		FFTSample r0, i0, r1, i1;
 		CMUL(r0, i1, z[n8 - k - 1].im, z[n8 - k - 1].re, tsin[n8 - k - 1], tcos[n8 - k - 1]);
 		CMUL(r1, i0, z[n8 + k].im, z[n8 + k].re, tsin[n8 + k], tcos[n8 + k]);
@@ -390,7 +569,26 @@ void imdct_calc(FFTContext *s, FFTSample *output, const FFTSample *input)
 
 	imdct_half(s, output + n4, input);
 
-	for (k = 0; k < n4; k++) {
+	k = 0;
+	if (ff_at3_use_simd) {
+#if PPSSPP_ARCH(SSE2)
+		const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+		for (; k + 4 <= n4; k += 4) {
+			__m128 a = _mm_loadu_ps(output + n2 - k - 4);
+			__m128 b = _mm_loadu_ps(output + n2 + k);
+			_mm_storeu_ps(output + k, _mm_xor_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)), sign));
+			_mm_storeu_ps(output + n - k - 4, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)));
+		}
+#elif PPSSPP_ARCH(ARM_NEON)
+		for (; k + 4 <= n4; k += 4) {
+			float32x4_t a = vrev64q_f32(vld1q_f32(output + n2 - k - 4));
+			float32x4_t b = vrev64q_f32(vld1q_f32(output + n2 + k));
+			vst1q_f32(output + k, vnegq_f32(vcombine_f32(vget_high_f32(a), vget_low_f32(a))));
+			vst1q_f32(output + n - k - 4, vcombine_f32(vget_high_f32(b), vget_low_f32(b)));
+		}
+#endif
+	}
+	for (; k < n4; k++) {
 		output[k] = -output[n2 - k - 1];
 		output[n - k - 1] = output[n2 + k];
 	}
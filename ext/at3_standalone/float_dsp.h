@@ -18,10 +18,21 @@
 
 #pragma once
 
+#include "Common/Math/CrossSIMD.h"
 #include "compat.h"
 
 inline void vector_fmul(float * av_restrict dst, const float * av_restrict src, int len) {
-    for (int i = 0; i < len; i++)
+    int i = 0;
+    if (ff_at3_use_simd) {
+#if PPSSPP_ARCH(SSE2)
+        for (; i + 4 <= len; i += 4)
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+#elif PPSSPP_ARCH(ARM_NEON)
+        for (; i + 4 <= len; i += 4)
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+#endif
+    }
+    for (; i < len; i++)
         dst[i] = dst[i] * src[i];
 }
 
@@ -30,7 +41,18 @@ inline void vector_fmul(float * av_restrict dst, const float * av_restrict src,
 * destination vectors must overlap exactly or not at all.
 */
 inline void vector_fmul_scalar(float *dst, float mul, int len) {
-    for (int i = 0; i < len; i++)
+    int i = 0;
+    if (ff_at3_use_simd) {
+#if PPSSPP_ARCH(SSE2)
+        const __m128 m = _mm_set1_ps(mul);
+        for (; i + 4 <= len; i += 4)
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), m));
+#elif PPSSPP_ARCH(ARM_NEON)
+        for (; i + 4 <= len; i += 4)
+            vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(dst + i), mul));
+#endif
+    }
+    for (; i < len; i++)
         dst[i] *= mul;
 }
 
@@ -48,6 +70,22 @@ inline void vector_fmul_scalar(float *dst, float mul, int len) {
 */
 inline void vector_fmul_reverse(float * av_restrict dst, const float * av_restrict src, int len) {
     src += len - 1;
-    for (int i = 0; i < len; i++)
+    int i = 0;
+    if (ff_at3_use_simd) {
+#if PPSSPP_ARCH(SSE2)
+        for (; i + 4 <= len; i += 4) {
+            __m128 s = _mm_loadu_ps(src - i - 3);
+            s = _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 1, 2, 3));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), s));
+        }
+#elif PPSSPP_ARCH(ARM_NEON)
+        for (; i + 4 <= len; i += 4) {
+            float32x4_t s = vrev64q_f32(vld1q_f32(src - i - 3));
+            s = vcombine_f32(vget_high_f32(s), vget_low_f32(s));
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), s));
+        }
+#endif
+    }
+    for (; i < len; i++)
         dst[i] *= src[-i];
 }
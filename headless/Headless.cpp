@@ -38,12 +38,16 @@
 #include "Core/System.h"
 #include "Core/WebServer.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/HW/AudioPerf.h"
+#include "Core/HW/StereoResampler.h"
 #include "Core/SaveState.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Common/ShaderGenCache.h"
 #include "Common/Log.h"
 #include "Common/Log/LogManager.h"
 
 #include "Compare.h"
+#include "ShaderCacheTool.h"
 #include "HeadlessHost.h"
 #if defined(_WIN32)
 #include "WindowsHeadlessHost.h"
@@ -139,7 +143,28 @@ void System_AskForPermission(SystemPermission permission) {}
 PermissionStatus System_GetPermissionStatus(SystemPermission permission) { return PERMISSION_STATUS_GRANTED; }
 void System_AudioGetDebugStats(char *buf, size_t bufSize) { if (buf) buf[0] = '\0'; }
 void System_AudioClear() {}
-void System_AudioPushSamples(const s32 *audio, int numSamples) {}
+
+// With --audio-stats, audio goes through the resampler as usual, into a null sink that pulls 48 kHz.
+static StereoResampler *g_audioSink;
+static uint64_t g_audioSinkPushedFrames;
+static double g_audioSinkOwedFrames;
+
+void System_AudioPushSamples(const s32 *audio, int numSamples) {
+	if (!g_audioSink)
+		return;
+	g_audioSink->PushSamples(audio, numSamples);
+	g_audioSinkPushedFrames += numSamples;
+
+	// Pull in bigger chunks like a real backend, which also keeps some buffered so that it doesn't just underrun.
+	static const int SINK_RATE = 48000;
+	static const int SINK_CHUNK = 256;
+	static short sinkBuffer[SINK_CHUNK * 2];
+	g_audioSinkOwedFrames += numSamples * (double)SINK_RATE / 44100.0;
+	while (g_audioSinkOwedFrames >= SINK_CHUNK) {
+		g_audioSink->Mix(sinkBuffer, SINK_CHUNK, false, SINK_RATE);
+		g_audioSinkOwedFrames -= SINK_CHUNK;
+	}
+}
 
 // TODO: To avoid having to define these here, these should probably be turned into system "requests".
 bool NativeSaveSecret(std::string_view nameOfSecret, std::string_view data) { return false; }
@@ -172,6 +197,11 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  -j                    use jit (default)\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "  --bench               run multiple times and output speed\n");
+	fprintf(stderr, "  --audio-stats=FILE    enable audio into a null sink and write the CPU time of each\n");
+	fprintf(stderr, "                        part of the audio pipeline as JSON to FILE (- for stdout)\n");
+	fprintf(stderr, "  --validate-shadercache=FILE\n");
+	fprintf(stderr, "                        generate and compile all shaders in a .vkshadercache, no GPU needed\n");
+	fprintf(stderr, "  --shadergen-cache=DIR use (and fill) a shader generation cache while validating\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
 
 	return 1;
@@ -351,6 +381,9 @@ int main(int argc, const char* argv[])
 	const char *mountIso = nullptr;
 	const char *mountRoot = nullptr;
 	const char *screenshotFilename = nullptr;
+	std::vector<std::string> shaderCachesToValidate;
+	Path shaderGenCacheDir;
+	const char *audioStatsFilename = nullptr;
 
 	for (int i = 1; i < argc; i++)
 	{
@@ -422,6 +455,12 @@ int main(int argc, const char* argv[])
 			teamCityMode = true;
 		else if (!strncmp(argv[i], "--state=", strlen("--state=")) && strlen(argv[i]) > strlen("--state="))
 			stateToLoad = argv[i] + strlen("--state=");
+		else if (!strncmp(argv[i], "--validate-shadercache=", strlen("--validate-shadercache=")) && strlen(argv[i]) > strlen("--validate-shadercache="))
+			shaderCachesToValidate.push_back(argv[i] + strlen("--validate-shadercache="));
+		else if (!strncmp(argv[i], "--shadergen-cache=", strlen("--shadergen-cache=")) && strlen(argv[i]) > strlen("--shadergen-cache="))
+			shaderGenCacheDir = Path(argv[i] + strlen("--shadergen-cache="));
+		else if (!strncmp(argv[i], "--audio-stats=", strlen("--audio-stats=")) && strlen(argv[i]) > strlen("--audio-stats="))
+			audioStatsFilename = argv[i] + strlen("--audio-stats=");
 		else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
 			return printUsage(argv[0], NULL);
 		else
@@ -431,7 +470,7 @@ int main(int argc, const char* argv[])
 	if (testFilenames.size() == 1 && testFilenames[0][0] == '@')
 		testFilenames = ReadFromListFile(testFilenames[0].substr(1));
 
-	if (testFilenames.empty())
+	if (testFilenames.empty() && shaderCachesToValidate.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
 
 	g_Config.bEnableLogging = (fullLog || outputDebugStringLog);
@@ -451,6 +490,19 @@ int main(int argc, const char* argv[])
 	// Needs to be after log so we don't interfere with test output.
 	g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
 
+	if (!shaderCachesToValidate.empty()) {
+		g_shaderGenCache.SetDirectory(shaderGenCacheDir);
+		bool allValid = true;
+		for (const std::string &filename : shaderCachesToValidate) {
+			allValid = ValidateVulkanShaderCache(Path(filename), testOptions.verbose) && allValid;
+		}
+		g_shaderGenCache.SetDirectory(Path());
+		if (testFilenames.empty() || !allValid) {
+			g_threadManager.Teardown();
+			return allValid ? 0 : 1;
+		}
+	}
+
 	HeadlessHost *headlessHost = getHost(gpuCore);
 	g_headlessHost = headlessHost;
 
@@ -572,6 +624,15 @@ int main(int argc, const char* argv[])
 	if (stateToLoad != NULL)
 		SaveState::Load(Path(stateToLoad), -1);
 
+	double audioStatsStart = 0.0;
+	if (audioStatsFilename) {
+		g_Config.bEnableSound = true;
+		g_audioSink = new StereoResampler();
+		AudioPerf_Reset();
+		AudioPerf_SetEnabled(true);
+		audioStatsStart = time_now_d();
+	}
+
 	std::vector<std::string> failedTests;
 	std::vector<std::string> passedTests;
 	for (size_t i = 0; i < testFilenames.size(); ++i)
@@ -618,6 +679,18 @@ int main(int argc, const char* argv[])
 		}
 	}
 
+	if (audioStatsFilename) {
+		AudioPerf_SetEnabled(false);
+		std::string json = AudioPerf_SummaryJSON(g_audioSinkPushedFrames / 44100.0, time_now_d() - audioStatsStart);
+		if (!strcmp(audioStatsFilename, "-")) {
+			printf("%s\n", json.c_str());
+		} else if (!File::WriteStringToFile(true, json, Path(audioStatsFilename))) {
+			fprintf(stderr, "Unable to write audio stats to '%s'\n", audioStatsFilename);
+		}
+		delete g_audioSink;
+		g_audioSink = nullptr;
+	}
+
 	if (debuggerPort > 0) {
 		ShutdownWebServer();
 	}
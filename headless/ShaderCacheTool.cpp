@@ -0,0 +1,106 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <atomic>
+#include <cstdio>
+
+#include "Common/File/FileUtil.h"
+#include "Common/GPU/Vulkan/VulkanContext.h"
+#include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/TimeUtil.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/ShaderPrecompile.h"
+#include "GPU/Common/ShaderGenCache.h"
+#include "GPU/Vulkan/ShaderManagerVulkan.h"
+#include "headless/ShaderCacheTool.h"
+
+template <typename T>
+static int CompileAll(const std::vector<T> &shaders, VkShaderStageFlagBits stage, ShaderStage cacheStage, bool verbose) {
+	std::atomic<int> failed{};
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		for (int i = lower; i < upper; i++) {
+			const T &shader = shaders[i];
+			if (!shader.success) {
+				// Already logged by the generator.
+				failed++;
+				continue;
+			}
+			std::vector<uint32_t> spirv;
+			std::string errorMessage;
+			if (g_shaderGenCache.LoadSPIRV(cacheStage, shader.code.c_str(), &spirv)) {
+				continue;
+			}
+			if (!GLSLtoSPV(stage, shader.code.c_str(), GLSLVariant::VULKAN, spirv, &errorMessage)) {
+				failed++;
+				if (verbose) {
+					printf("Failed to compile shader:\n%s\n%s\n", errorMessage.c_str(), LineNumberString(shader.code).c_str());
+				}
+			} else {
+				g_shaderGenCache.StoreSPIRV(cacheStage, shader.code.c_str(), spirv);
+			}
+		}
+	}, 0, (int)shaders.size(), 4);
+	return failed;
+}
+
+bool ValidateVulkanShaderCache(const Path &filename, bool verbose) {
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f) {
+		printf("%s: Could not open file\n", filename.c_str());
+		return false;
+	}
+	VulkanCacheIDs ids;
+	bool success = ShaderManagerVulkan::ReadCacheIDs(f, &ids);
+	fclose(f);
+	if (!success) {
+		printf("%s: Not a valid Vulkan shader cache (or wrong version)\n", filename.c_str());
+		return false;
+	}
+
+	// The generators key some decisions off the use flags, so make sure they're what the game ran with.
+	gstate_c.SetUseFlags(ids.useFlags);
+	init_glslang();
+
+	g_shaderGenCache.ResetStats();
+	double start = time_now_d();
+	const ShaderLanguageDesc compat(ShaderLanguage::GLSL_VULKAN);
+	const Draw::Bugs bugs;
+	std::vector<PrecompiledVertexShader> vertexShaders;
+	std::vector<PrecompiledFragmentShader> fragmentShaders;
+	std::vector<PrecompiledGeometryShader> geometryShaders;
+	PrecompileVertexShaders(ids.vert, compat, bugs, &vertexShaders);
+	PrecompileFragmentShaders(ids.frag, compat, bugs, &fragmentShaders);
+	PrecompileGeometryShaders(ids.geom, compat, bugs, &geometryShaders);
+	double generated = time_now_d();
+
+	int failed = 0;
+	failed += CompileAll(vertexShaders, VK_SHADER_STAGE_VERTEX_BIT, ShaderStage::Vertex, verbose);
+	failed += CompileAll(fragmentShaders, VK_SHADER_STAGE_FRAGMENT_BIT, ShaderStage::Fragment, verbose);
+	failed += CompileAll(geometryShaders, VK_SHADER_STAGE_GEOMETRY_BIT, ShaderStage::Geometry, verbose);
+	double compiled = time_now_d();
+
+	finalize_glslang();
+
+	printf("%s: %d vertex, %d fragment, %d geometry shaders, %d failed (generate %0.1f ms, compile %0.1f ms)\n",
+		filename.c_str(), (int)ids.vert.size(), (int)ids.frag.size(), (int)ids.geom.size(), failed,
+		(generated - start) * 1000.0, (compiled - generated) * 1000.0);
+	if (g_shaderGenCache.Enabled()) {
+		printf("%s: shader generation cache: %d hits, %d misses\n", filename.c_str(), g_shaderGenCache.Hits(), g_shaderGenCache.Misses());
+	}
+	return failed == 0;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "Common/File/Path.h"
+
+// Runs every shader in a .vkshadercache file through the shader generators and glslang,
+// without needing a GPU. Returns false if the file couldn't be read or any shader failed.
+// If g_shaderGenCache has a directory set, it's used (and filled) along the way, so this can also
+// warm the cache ahead of time. Note that the entries only match devices without shader-affecting
+// driver bugs, since no device is involved here.
+bool ValidateVulkanShaderCache(const Path &filename, bool verbose);
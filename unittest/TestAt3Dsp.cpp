@@ -0,0 +1,279 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "ppsspp_config.h"
+#include "Common/TimeUtil.h"
+#include "Common/Data/Random/Rng.h"
+#include "ext/at3_standalone/atrac.h"
+#include "ext/at3_standalone/atrac3plus.h"
+#include "ext/at3_standalone/fft.h"
+#include "ext/at3_standalone/float_dsp.h"
+#include "unittest/UnitTest.h"
+
+// The SIMD paths in at3_standalone are checked against the plain C ones, selected with ff_at3_use_simd.
+// On SSE2 they do the same float operations in the same order, so the output must match exactly.
+// On ARM the compiler is free to fuse the C loops into multiply-adds, so allow a little slack there.
+
+struct At3SimdSwitch {
+	explicit At3SimdSwitch(bool enable) : prev_(ff_at3_use_simd) { ff_at3_use_simd = enable; }
+	~At3SimdSwitch() { ff_at3_use_simd = prev_; }
+	bool prev_;
+};
+
+static bool CompareSamples(const char *what, const float *actual, const float *expected, int count) {
+	float range = 0.0f;
+	for (int i = 0; i < count; i++)
+		range = std::max(range, fabsf(expected[i]));
+
+	for (int i = 0; i < count; i++) {
+#if PPSSPP_ARCH(SSE2)
+		bool same = actual[i] == expected[i];
+#else
+		bool same = fabsf(actual[i] - expected[i]) <= range * 1e-5f;
+#endif
+		if (!same) {
+			printf("%s: mismatch at %d: %0.9f != expected %0.9f\n", what, i, actual[i], expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void RandomFloats(GMRng &rng, float *out, int count, float scale) {
+	for (int i = 0; i < count; i++)
+		out[i] = (rng.F() * 2.0f - 1.0f) * scale;
+}
+
+static bool TestImdct(GMRng &rng) {
+	// The transform sizes used by ATRAC3 (9), ATRAC3+ (8) and the ATRAC3+ IPQF (5).
+	static const struct { int nbits; double scale; } configs[] = {
+		{ 9, 1.0 / 32768 }, { 8, -1.0 }, { 5, 32.0 / 32768.0 },
+	};
+
+	for (const auto &config : configs) {
+		FFTContext ctx{};
+		EXPECT_EQ_INT(ff_mdct_init(&ctx, config.nbits, 1, config.scale), 0);
+		const int n = 1 << config.nbits;
+
+		std::vector<float> input(n / 2), simd(n), plain(n);
+		for (int iter = 0; iter < 8; iter++) {
+			RandomFloats(rng, input.data(), n / 2, 32768.0f);
+			{
+				At3SimdSwitch sw(true);
+				imdct_calc(&ctx, simd.data(), input.data());
+			}
+			{
+				At3SimdSwitch sw(false);
+				imdct_calc(&ctx, plain.data(), input.data());
+			}
+			if (!CompareSamples("imdct_calc", simd.data(), plain.data(), n)) {
+				printf("  (nbits %d)\n", config.nbits);
+				ff_mdct_end(&ctx);
+				return false;
+			}
+
+			{
+				At3SimdSwitch sw(true);
+				imdct_half(&ctx, simd.data(), input.data());
+			}
+			{
+				At3SimdSwitch sw(false);
+				imdct_half(&ctx, plain.data(), input.data());
+			}
+			if (!CompareSamples("imdct_half", simd.data(), plain.data(), n / 2)) {
+				printf("  (nbits %d)\n", config.nbits);
+				ff_mdct_end(&ctx);
+				return false;
+			}
+		}
+		ff_mdct_end(&ctx);
+	}
+	return true;
+}
+
+static bool TestFloatDsp(GMRng &rng) {
+	// Odd lengths too, to cover the scalar tails.
+	for (int len : { 3, 16, 64, 127, 128 }) {
+		std::vector<float> src(len), dst(len), simd(len), plain(len);
+		RandomFloats(rng, src.data(), len, 1.0f);
+		RandomFloats(rng, dst.data(), len, 100.0f);
+
+		simd = dst;
+		plain = dst;
+		{
+			At3SimdSwitch sw(true);
+			vector_fmul(simd.data(), src.data(), len);
+		}
+		{
+			At3SimdSwitch sw(false);
+			vector_fmul(plain.data(), src.data(), len);
+		}
+		RET(CompareSamples("vector_fmul", simd.data(), plain.data(), len));
+
+		simd = dst;
+		plain = dst;
+		{
+			At3SimdSwitch sw(true);
+			vector_fmul_reverse(simd.data(), src.data(), len);
+		}
+		{
+			At3SimdSwitch sw(false);
+			vector_fmul_reverse(plain.data(), src.data(), len);
+		}
+		RET(CompareSamples("vector_fmul_reverse", simd.data(), plain.data(), len));
+
+		simd = dst;
+		plain = dst;
+		{
+			At3SimdSwitch sw(true);
+			vector_fmul_scalar(simd.data(), 0.3f, len);
+		}
+		{
+			At3SimdSwitch sw(false);
+			vector_fmul_scalar(plain.data(), 0.3f, len);
+		}
+		RET(CompareSamples("vector_fmul_scalar", simd.data(), plain.data(), len));
+	}
+	return true;
+}
+
+static bool TestIqmf(GMRng &rng) {
+	ff_atrac_generate_tables();
+
+	for (unsigned int nIn : { 256u, 512u }) {
+		// Run a few frames so the delay buffers get exercised, like in the decoder.
+		float delaySimd[46]{}, delayPlain[46]{};
+		std::vector<float> temp(46 + 2 * nIn);
+		std::vector<float> lo(nIn), hi(nIn), simd(nIn * 2), plain(nIn * 2);
+		for (int frame = 0; frame < 4; frame++) {
+			RandomFloats(rng, lo.data(), nIn, 1.0f);
+			RandomFloats(rng, hi.data(), nIn, 1.0f);
+			{
+				At3SimdSwitch sw(true);
+				ff_atrac_iqmf(lo.data(), hi.data(), nIn, simd.data(), delaySimd, temp.data());
+			}
+			{
+				At3SimdSwitch sw(false);
+				ff_atrac_iqmf(lo.data(), hi.data(), nIn, plain.data(), delayPlain, temp.data());
+			}
+			if (!CompareSamples("ff_atrac_iqmf", simd.data(), plain.data(), nIn * 2)) {
+				printf("  (nIn %d, frame %d)\n", nIn, frame);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool TestIpqf(GMRng &rng) {
+	FFTContext dct{};
+	EXPECT_EQ_INT(ff_mdct_init(&dct, 5, 1, 32.0 / 32768.0), 0);
+
+	Atrac3pIPQFChannelCtx histSimd{}, histPlain{};
+	std::vector<float> input(ATRAC3P_FRAME_SAMPLES), simd(ATRAC3P_FRAME_SAMPLES), plain(ATRAC3P_FRAME_SAMPLES);
+	bool success = true;
+	for (int frame = 0; frame < 4 && success; frame++) {
+		RandomFloats(rng, input.data(), ATRAC3P_FRAME_SAMPLES, 1.0f);
+		{
+			At3SimdSwitch sw(true);
+			ff_atrac3p_ipqf(&dct, &histSimd, input.data(), simd.data());
+		}
+		{
+			At3SimdSwitch sw(false);
+			ff_atrac3p_ipqf(&dct, &histPlain, input.data(), plain.data());
+		}
+		success = CompareSamples("ff_atrac3p_ipqf", simd.data(), plain.data(), ATRAC3P_FRAME_SAMPLES);
+	}
+	ff_mdct_end(&dct);
+	return success;
+}
+
+// Measures the transform and filter bank work of a stereo frame, which is most of what's left once
+// the bitstream is unpacked.
+static void BenchmarkDsp(GMRng &rng) {
+	FFTContext at3pMdct{}, ipqfDct{}, at3Mdct{};
+	ff_atrac3p_init_imdct(&at3pMdct);
+	ff_mdct_init(&ipqfDct, 5, 1, 32.0 / 32768.0);
+	ff_mdct_init(&at3Mdct, 9, 1, 1.0 / 32768);
+	ff_atrac_generate_tables();
+
+	std::vector<float> spectrum(ATRAC3P_FRAME_SAMPLES), imdctOut(ATRAC3P_SUBBAND_SAMPLES * 2), time(ATRAC3P_FRAME_SAMPLES), out(ATRAC3P_FRAME_SAMPLES);
+	std::vector<float> window(512), at3Out(1024), temp(46 + 1024);
+	Atrac3pIPQFChannelCtx hist[2]{};
+	float delay[3][46]{};
+	RandomFloats(rng, spectrum.data(), ATRAC3P_FRAME_SAMPLES, 1.0f);
+	RandomFloats(rng, window.data(), 512, 1.0f);
+
+	auto at3pFrame = [&] {
+		for (int ch = 0; ch < 2; ch++) {
+			for (int sb = 0; sb < ATRAC3P_SUBBANDS; sb++) {
+				ff_atrac3p_imdct(&at3pMdct, &spectrum[sb * ATRAC3P_SUBBAND_SAMPLES], imdctOut.data(), 0, sb);
+				memcpy(&time[sb * ATRAC3P_SUBBAND_SAMPLES], imdctOut.data(), ATRAC3P_SUBBAND_SAMPLES * sizeof(float));
+			}
+			ff_atrac3p_ipqf(&ipqfDct, &hist[ch], time.data(), out.data());
+		}
+	};
+	auto at3Frame = [&] {
+		for (int ch = 0; ch < 2; ch++) {
+			for (int band = 0; band < 4; band++) {
+				imdct_calc(&at3Mdct, &at3Out[0], &spectrum[band * 256]);
+				vector_fmul(&at3Out[0], window.data(), 512);
+			}
+			ff_atrac_iqmf(&at3Out[0], &at3Out[256], 256, &at3Out[0], delay[0], temp.data());
+			ff_atrac_iqmf(&at3Out[512], &at3Out[768], 256, &at3Out[512], delay[1], temp.data());
+			ff_atrac_iqmf(&at3Out[0], &at3Out[512], 512, &at3Out[0], delay[2], temp.data());
+		}
+	};
+
+	auto measure = [&](bool useSimd, const std::function<void()> &frame) {
+		At3SimdSwitch sw(useSimd);
+		int frames = 0;
+		double st = time_now_d();
+		do {
+			for (int i = 0; i < 64; i++)
+				frame();
+			frames += 64;
+		} while (time_now_d() - st < 0.25);
+		return frames / (time_now_d() - st);
+	};
+
+	printf("ATRAC3+ DSP: %0.0f frames/s (C %0.0f)\n", measure(true, at3pFrame), measure(false, at3pFrame));
+	printf("ATRAC3 DSP: %0.0f frames/s (C %0.0f)\n", measure(true, at3Frame), measure(false, at3Frame));
+
+	ff_mdct_end(&at3pMdct);
+	ff_mdct_end(&ipqfDct);
+	ff_mdct_end(&at3Mdct);
+}
+
+bool TestAt3Dsp() {
+	GMRng rng;
+	rng.Init(0x1234);
+
+	RET(TestImdct(rng));
+	RET(TestFloatDsp(rng));
+	RET(TestIqmf(rng));
+	RET(TestIpqf(rng));
+	BenchmarkDsp(rng);
+	return true;
+}
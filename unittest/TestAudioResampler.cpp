@@ -0,0 +1,194 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/TimeUtil.h"
+#include "Core/HW/StereoResampler.h"
+#include "unittest/UnitTest.h"
+
+// Offline checks of the audio output resampling: sine sweeps are resampled from 44.1 kHz to common
+// output rates, and compared against the exact sweep evaluated at each output's position in the input.
+
+static const int INPUT_RATE = 44100;
+static const double SWEEP_START = 50.0;
+static const double SWEEP_END = 16000.0;
+static const double SWEEP_SECONDS = 2.0;
+static const double SWEEP_AMPLITUDE = 16000.0;
+
+// Exponential sweep, as a function of time in input frames.
+static double SweepPhase(double frame) {
+	double t = frame / INPUT_RATE;
+	double k = log(SWEEP_END / SWEEP_START) / SWEEP_SECONDS;
+	return 2.0 * M_PI * SWEEP_START * (exp(k * t) - 1.0) / k;
+}
+
+static double SweepFrequency(double frame) {
+	double k = log(SWEEP_END / SWEEP_START) / SWEEP_SECONDS;
+	return SWEEP_START * exp(k * frame / INPUT_RATE);
+}
+
+static std::vector<s16> GenerateSweep(int frames) {
+	std::vector<s16> data(frames * 2);
+	for (int i = 0; i < frames; i++) {
+		double phase = SweepPhase(i);
+		// Different signals on the channels, so mixing them up would show.
+		data[i * 2 + 0] = (s16)lrint(SWEEP_AMPLITUDE * sin(phase));
+		data[i * 2 + 1] = (s16)lrint(SWEEP_AMPLITUDE * cos(phase));
+	}
+	return data;
+}
+
+// The scalar linear interpolation StereoResampler has always used.
+static u32 ReferenceResampleLinear(s16 *out, u32 outFrames, const s16 *in, u32 inFrames, u32 ratio, u32 *frac, u32 *inPos) {
+	auto mix = [](int s1, int s2, u32 f) -> s16 {
+		int value = s1 + (((s2 - s1) * (int)(u16)f) >> 16);
+		return (s16)std::min(32767, std::max(-32767, value));
+	};
+	u32 f = *frac;
+	u32 pos = *inPos;
+	u32 n = 0;
+	for (; n < outFrames && pos + 1 < inFrames; n++) {
+		out[n * 2 + 0] = mix(in[pos * 2 + 0], in[pos * 2 + 2], f);
+		out[n * 2 + 1] = mix(in[pos * 2 + 1], in[pos * 2 + 3], f);
+		f += ratio;
+		pos += f >> 16;
+		f &= 0xFFFF;
+	}
+	*frac = f;
+	*inPos = pos;
+	return n;
+}
+
+struct SweepResult {
+	// Signal to error ratios in dB, over the parts of the sweep below and above 8 kHz.
+	double snrLow;
+	double snrHigh;
+};
+
+// Resamples the sweep in chunks like the audio callback does, and measures the error against the
+// exact sweep. offset is the filter's delay in input frames.
+template <typename Func>
+static SweepResult MeasureSweep(const std::vector<s16> &input, int outputRate, double offset, Func resample) {
+	const u32 inFrames = (u32)input.size() / 2;
+	const u32 ratio = (u32)(65536.0 * INPUT_RATE / outputRate);
+	std::vector<s16> out(((u64)inFrames * outputRate / INPUT_RATE + 1024) * 2);
+
+	u32 frac = 0, pos = 0, produced = 0;
+	while (true) {
+		u32 n = resample(&out[produced * 2], 480, input.data(), inFrames, ratio, &frac, &pos);
+		if (n == 0)
+			break;
+		produced += n;
+	}
+
+	double signal[2]{}, error[2]{};
+	double position = offset;
+	for (u32 i = 0; i < produced; i++, position += ratio / 65536.0) {
+		// Skip the start, where the filter sees the silence before the sweep.
+		if (position < 32.0)
+			continue;
+		int band = SweepFrequency(position) < 8000.0 ? 0 : 1;
+		double phase = SweepPhase(position);
+		double expected[2] = { SWEEP_AMPLITUDE * sin(phase), SWEEP_AMPLITUDE * cos(phase) };
+		for (int ch = 0; ch < 2; ch++) {
+			double e = out[i * 2 + ch] - expected[ch];
+			signal[band] += expected[ch] * expected[ch];
+			error[band] += e * e;
+		}
+	}
+
+	SweepResult result;
+	result.snrLow = 10.0 * log10(signal[0] / std::max(error[0], 1.0));
+	result.snrHigh = 10.0 * log10(signal[1] / std::max(error[1], 1.0));
+	return result;
+}
+
+static bool TestSincQuality(const std::vector<s16> &sweep, const SincFilterBank &bank) {
+	for (int outputRate : { 48000, 44100, 96000 }) {
+		SweepResult linear = MeasureSweep(sweep, outputRate, 0.0, ReferenceResampleLinear);
+		SweepResult sinc = MeasureSweep(sweep, outputRate, SincFilterBank::HISTORY, [&](s16 *out, u32 outFrames, const s16 *in, u32 inFrames, u32 ratio, u32 *frac, u32 *pos) {
+			return StereoResampleSinc(out, outFrames, in, inFrames, bank, ratio, frac, pos);
+		});
+		printf("44100 -> %d Hz: linear %0.1f dB / %0.1f dB, sinc %0.1f dB / %0.1f dB (below / above 8 kHz)\n", outputRate, linear.snrLow, linear.snrHigh, sinc.snrLow, sinc.snrHigh);
+
+		EXPECT_TRUE(sinc.snrLow > 70.0);
+		EXPECT_TRUE(sinc.snrHigh > 65.0);
+		// At 1:1, linear interpolation just copies the input, so there's nothing to beat.
+		if (outputRate != INPUT_RATE) {
+			EXPECT_TRUE(sinc.snrLow > linear.snrLow + 20.0);
+			EXPECT_TRUE(sinc.snrHigh > linear.snrHigh + 20.0);
+		}
+	}
+	return true;
+}
+
+static bool TestSincDC(const SincFilterBank &bank) {
+	// The phases are normalized, so a constant has to come out unchanged at every fraction.
+	std::vector<s16> input(64 * 2);
+	for (size_t i = 0; i < input.size(); i += 2) {
+		input[i] = 12345;
+		input[i + 1] = -32768;
+	}
+	s16 out[2 * 200];
+	u32 frac = 0, pos = 0;
+	u32 n = StereoResampleSinc(out, 200, input.data(), 64, bank, 65536 * 7 / 31, &frac, &pos);
+	EXPECT_TRUE(n > 100);
+	for (u32 i = 0; i < n; i++) {
+		EXPECT_EQ_INT(out[i * 2], 12345);
+		EXPECT_EQ_INT(out[i * 2 + 1], -32768);
+	}
+	return true;
+}
+
+static void BenchmarkResample(const std::vector<s16> &sweep, const SincFilterBank &bank) {
+	const u32 inFrames = (u32)sweep.size() / 2;
+	const u32 ratio = (u32)(65536.0 * INPUT_RATE / 48000);
+	std::vector<s16> out(512 * 2);
+
+	auto measure = [&](auto resample) {
+		double st = time_now_d();
+		u64 frames = 0;
+		do {
+			u32 frac = 0, pos = 0;
+			while (u32 n = resample(out.data(), 512, sweep.data(), inFrames, ratio, &frac, &pos))
+				frames += n;
+		} while (time_now_d() - st < 0.25);
+		return frames / (time_now_d() - st) / 1000000.0;
+	};
+
+	double linear = measure(ReferenceResampleLinear);
+	double sinc = measure([&](s16 *out, u32 outFrames, const s16 *in, u32 inFrames, u32 ratio, u32 *frac, u32 *pos) {
+		return StereoResampleSinc(out, outFrames, in, inFrames, bank, ratio, frac, pos);
+	});
+	printf("Resampling to 48 kHz: sinc %0.1f Mframes/s, linear %0.1f Mframes/s\n", sinc, linear);
+}
+
+bool TestAudioResampler() {
+	std::vector<s16> sweep = GenerateSweep((int)(INPUT_RATE * SWEEP_SECONDS));
+
+	SincFilterBank bank;
+	bank.Build(0.9f);
+	RET(TestSincDC(bank));
+	RET(TestSincQuality(sweep, bank));
+	BenchmarkResample(sweep, bank);
+	return true;
+}
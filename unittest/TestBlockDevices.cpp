@@ -0,0 +1,337 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "zlib.h"
+
+#include "Common/CPUDetect.h"
+#include "Common/TimeUtil.h"
+#include "Common/Data/Encoding/LZ4.h"
+#include "Common/Data/Random/Rng.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Core/Loaders.h"
+#include "Core/FileSystems/BlockDevices.h"
+#include "Core/FileSystems/UmdPrefetcher.h"
+#include "unittest/UnitTest.h"
+
+// Builds CSO and ZSO images of a synthetic disc in memory, and checks that every way of reading them
+// gives back the original data. Also compares how fast each format can be read, with and without
+// worker threads to decompress larger reads.
+
+class MemoryFileLoader : public FileLoader {
+public:
+	MemoryFileLoader(std::vector<u8> &&data, bool mappable = false) : data_(std::move(data)), mappable_(mappable) {}
+
+	bool Exists() override { return true; }
+	bool IsDirectory() override { return false; }
+	s64 FileSize() override { return (s64)data_.size(); }
+	Path GetPath() const override { return Path("memory.iso"); }
+
+	size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override {
+		if (absolutePos >= (s64)data_.size() || bytes == 0)
+			return 0;
+		count = std::min(count, (size_t)((data_.size() - absolutePos) / bytes));
+		memcpy(data, &data_[absolutePos], bytes * count);
+		bytesRead_ += bytes * count;
+		return count;
+	}
+
+	size_t BytesRead() const {
+		return bytesRead_;
+	}
+
+	// Pretends to be a local file that can be memory mapped.
+	bool MapIntoMemory() override {
+		mapped_ = mappable_;
+		return mapped_;
+	}
+	const u8 *DataPointer(s64 absolutePos, size_t bytes) override {
+		if (!mapped_ || absolutePos < 0 || absolutePos > (s64)data_.size() || bytes > data_.size() - absolutePos)
+			return nullptr;
+		return &data_[absolutePos];
+	}
+
+private:
+	std::vector<u8> data_;
+	bool mappable_;
+	bool mapped_ = false;
+	std::atomic<size_t> bytesRead_{};
+};
+
+static const int SECTOR_SIZE = 2048;
+
+// A mix of the kinds of sectors found on real discs, some of them compressible.
+static std::vector<u8> MakeDisc(int sectors) {
+	static const char text[] = "PSP GAME SYSTEM DATA USRDIR EBOOT.BIN PARAM.SFO ";
+	GMRng rng;
+	rng.Init(1234);
+	std::vector<u8> disc((size_t)sectors * SECTOR_SIZE);
+	for (int s = 0; s < sectors; s++) {
+		u8 *p = &disc[(size_t)s * SECTOR_SIZE];
+		switch (rng.R32() % 4) {
+		case 0:
+			// Zero padding.
+			break;
+		case 1:
+			for (int i = 0; i < SECTOR_SIZE; i++)
+				p[i] = text[(i + s) % (sizeof(text) - 1)];
+			break;
+		case 2:
+			for (int i = 0; i < SECTOR_SIZE; i++)
+				p[i] = (u8)rng.R32();
+			break;
+		default:
+			for (int i = 0; i < SECTOR_SIZE; i++)
+				p[i] = (u8)((i >> 3) + (rng.R32() & 3));
+			break;
+		}
+	}
+	return disc;
+}
+
+static int DeflateFrame(const u8 *src, int size, u8 *dst, int capacity) {
+	z_stream z{};
+	if (deflateInit2(&z, 9, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return 0;
+	z.next_in = (Bytef *)src;
+	z.avail_in = size;
+	z.next_out = dst;
+	z.avail_out = capacity;
+	int status = deflate(&z, Z_FINISH);
+	int written = status == Z_STREAM_END ? (int)z.total_out : 0;
+	deflateEnd(&z);
+	return written;
+}
+
+// The same layout for both: a CSO v1 header, the index, then the frames (plain if they don't shrink).
+static std::vector<u8> MakeCompressedImage(const std::vector<u8> &disc, bool zso, u32 frameSize, int align) {
+	const u32 numFrames = (u32)((disc.size() + frameSize - 1) / frameSize);
+	std::vector<u32> index(numFrames + 1);
+	std::vector<u8> image(0x18 + index.size() * 4);
+
+	std::vector<u8> compressed(frameSize * 2);
+	for (u32 f = 0; f < numFrames; f++) {
+		image.resize((image.size() + (1 << align) - 1) & ~(size_t)((1 << align) - 1));
+		const u8 *src = &disc[(size_t)f * frameSize];
+		const int srcSize = (int)std::min((size_t)frameSize, disc.size() - (size_t)f * frameSize);
+		int size = zso ? LZ4CompressBlock(src, srcSize, compressed.data(), (int)compressed.size()) : DeflateFrame(src, srcSize, compressed.data(), (int)compressed.size());
+		index[f] = (u32)(image.size() >> align);
+		if (size == 0 || size >= srcSize) {
+			index[f] |= 0x80000000;
+			image.insert(image.end(), src, src + srcSize);
+		} else {
+			image.insert(image.end(), compressed.data(), compressed.data() + size);
+		}
+	}
+	image.resize((image.size() + (1 << align) - 1) & ~(size_t)((1 << align) - 1));
+	index[numFrames] = (u32)(image.size() >> align);
+
+	u8 *header = image.data();
+	memcpy(header, zso ? "ZISO" : "CISO", 4);
+	const u32 headerSize = 0x18;
+	const u64 totalBytes = disc.size();
+	memcpy(header + 4, &headerSize, 4);
+	memcpy(header + 8, &totalBytes, 8);
+	memcpy(header + 0x10, &frameSize, 4);
+	header[0x14] = 1;
+	header[0x15] = (u8)align;
+	memcpy(header + 0x18, index.data(), index.size() * 4);
+	return image;
+}
+
+// Plain ISOs fail reads past the end, the compressed formats fill them with zeros.
+static bool CheckDevice(const char *name, BlockDevice *device, const std::vector<u8> &disc, bool readsPastEnd = true) {
+	const int numBlocks = (int)(disc.size() / SECTOR_SIZE);
+	if ((int)device->GetNumBlocks() != numBlocks) {
+		printf("%s: %d blocks, expected %d\n", name, device->GetNumBlocks(), numBlocks);
+		return false;
+	}
+
+	std::vector<u8> block(SECTOR_SIZE);
+	for (int b = 0; b < numBlocks; b++) {
+		if (!device->ReadBlock(b, block.data()) || memcmp(block.data(), &disc[(size_t)b * SECTOR_SIZE], SECTOR_SIZE) != 0) {
+			printf("%s: block %d differs\n", name, b);
+			return false;
+		}
+	}
+
+	// Random runs, from single blocks to many frames, some running off the end.
+	GMRng rng;
+	rng.Init(99);
+	std::vector<u8> blocks;
+	for (int i = 0; i < 300; i++) {
+		int count = 1 + (int)(rng.R32() % (i < 100 ? 8 : 600));
+		int start = (int)(rng.R32() % numBlocks);
+		if (!readsPastEnd)
+			count = std::min(count, numBlocks - start);
+		blocks.assign((size_t)count * SECTOR_SIZE, 0xCC);
+		bool result = device->ReadBlocks(start, count, blocks.data());
+		int valid = std::min(count, numBlocks - start);
+		if (!result || memcmp(blocks.data(), &disc[(size_t)start * SECTOR_SIZE], (size_t)valid * SECTOR_SIZE) != 0) {
+			printf("%s: ReadBlocks(%d, %d) differs\n", name, start, count);
+			return false;
+		}
+		for (size_t j = (size_t)valid * SECTOR_SIZE; j < blocks.size(); j++) {
+			if (blocks[j] != 0) {
+				printf("%s: ReadBlocks(%d, %d) didn't clear past the end\n", name, start, count);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// How fast the whole disc can be read, in the 64 KB chunks the UMD code tends to use.
+static double BenchmarkDevice(BlockDevice *device) {
+	const int chunk = 32;
+	std::vector<u8> buffer(chunk * SECTOR_SIZE);
+	double bytes = 0.0;
+	double st = time_now_d();
+	do {
+		for (u32 b = 0; b + chunk <= device->GetNumBlocks(); b += chunk)
+			device->ReadBlocks(b, chunk, buffer.data());
+		bytes += (double)device->GetNumBlocks() * SECTOR_SIZE;
+	} while (time_now_d() - st < 0.2);
+	return bytes / (time_now_d() - st) / (1024.0 * 1024.0);
+}
+
+static bool TestPrefetcher(const std::vector<u8> &disc) {
+	MemoryFileLoader loader{ std::vector<u8>(disc) };
+	std::unique_ptr<BlockDevice> device(constructBlockDevice(&loader));
+
+	// A first session: a file open followed by a read in two parts, then a jump elsewhere.
+	std::vector<u8> trace;
+	{
+		UmdPrefetcher first(device.get(), Path());
+		first.OnOpen(100);
+		first.OnRead(100, 16);
+		first.OnRead(116, 16);
+		first.OnRead(100, 8);
+		first.OnRead(2000, 32);
+		first.OnOpen(3000);
+		first.OnRead(3000, 64);
+		first.Serialize(&trace);
+	}
+	// The header, then the open, the merged reads, the jump, the second open and its read.
+	EXPECT_EQ_INT((int)trace.size(), 16 + 5 * 8);
+
+	// Next time, the first open should bring in everything that followed it.
+	UmdPrefetcher second(device.get(), Path());
+	EXPECT_TRUE(second.Deserialize(trace));
+	size_t before = loader.BytesRead();
+	second.OnOpen(100);
+	second.WaitUntilIdle();
+	EXPECT_EQ_INT((int)(loader.BytesRead() - before), (32 + 32 + 64) * SECTOR_SIZE);
+
+	// Nothing is prefetched twice.
+	before = loader.BytesRead();
+	second.OnRead(2000, 32);
+	second.WaitUntilIdle();
+	EXPECT_EQ_INT((int)(loader.BytesRead() - before), 0);
+
+	// This session's open and read come first, then what's left of the old trace.
+	std::vector<u8> merged;
+	second.Serialize(&merged);
+	EXPECT_EQ_INT((int)merged.size(), 16 + 5 * 8);
+
+	// A trace from another image of the game is ignored.
+	MemoryFileLoader otherLoader{ std::vector<u8>(disc.begin(), disc.end() - SECTOR_SIZE) };
+	std::unique_ptr<BlockDevice> otherDevice(constructBlockDevice(&otherLoader));
+	UmdPrefetcher other(otherDevice.get(), Path());
+	EXPECT_FALSE(other.Deserialize(trace));
+	return true;
+}
+
+bool TestBlockDevices() {
+	// 8 MB, plus an odd sector at the end so the last large frame is short.
+	const std::vector<u8> disc = MakeDisc(4097);
+
+	struct Variant {
+		const char *name;
+		bool zso;
+		u32 frameSize;
+		int align;
+	};
+	static const Variant variants[] = {
+		{ "CSO 2K", false, 2048, 0 },
+		{ "CSO 8K", false, 8192, 0 },
+		{ "CSO 16K align 2", false, 16384, 2 },
+		{ "ZSO 2K", true, 2048, 0 },
+		{ "ZSO 8K align 2", true, 8192, 2 },
+		{ "ZSO 16K align 4", true, 16384, 4 },
+	};
+	const int numVariants = (int)(sizeof(variants) / sizeof(variants[0]));
+
+	std::vector<std::unique_ptr<FileLoader>> loaders;
+	for (const Variant &v : variants)
+		loaders.emplace_back(new MemoryFileLoader(MakeCompressedImage(disc, v.zso, v.frameSize, v.align)));
+
+	// Plain ISOs, read normally or straight from memory.
+	for (bool mappable : { false, true }) {
+		const char *name = mappable ? "ISO mapped" : "ISO";
+		MemoryFileLoader loader(std::vector<u8>(disc), mappable);
+		// Like PSP_InitStart() does with the setting on.
+		loader.MapIntoMemory();
+		std::unique_ptr<BlockDevice> device(constructBlockDevice(&loader));
+		if (!device || !CheckDevice(name, device.get(), disc, false))
+			return false;
+		const u8 *data = device->DataPointer(SECTOR_SIZE + 5, SECTOR_SIZE * 3);
+		EXPECT_EQ_INT(data != nullptr, mappable);
+		if (data)
+			EXPECT_TRUE(memcmp(data, &disc[SECTOR_SIZE + 5], SECTOR_SIZE * 3) == 0);
+		EXPECT_TRUE(device->DataPointer(disc.size() - 10, 11) == nullptr);
+	}
+
+	if (!TestPrefetcher(disc))
+		return false;
+
+	// Without the thread manager, everything is decompressed on this thread. Check both ways and compare.
+	bool initThreads = !g_threadManager.IsInitialized();
+	double serial[numVariants]{};
+	bool success = true;
+	if (initThreads) {
+		for (int i = 0; i < numVariants && success; i++) {
+			std::unique_ptr<BlockDevice> device(constructBlockDevice(loaders[i].get()));
+			success = device && CheckDevice(variants[i].name, device.get(), disc);
+			if (success)
+				serial[i] = BenchmarkDevice(device.get());
+		}
+		g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+	}
+
+	for (int i = 0; i < numVariants && success; i++) {
+		std::unique_ptr<BlockDevice> device(constructBlockDevice(loaders[i].get()));
+		success = device && CheckDevice(variants[i].name, device.get(), disc);
+		if (!success)
+			break;
+		double threaded = BenchmarkDevice(device.get());
+		if (initThreads)
+			printf("%s: %0.0f MB/s, with %d threads %0.0f MB/s\n", variants[i].name, serial[i], g_threadManager.GetNumLooperThreads(), threaded);
+		else
+			printf("%s: %0.0f MB/s\n", variants[i].name, threaded);
+	}
+
+	if (initThreads)
+		g_threadManager.Teardown();
+	return success;
+}
@@ -0,0 +1,314 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Common/Crypto/md5.h"
+#include "Common/Data/Format/FLACEncoder.h"
+#include "Common/Data/Random/Rng.h"
+#include "unittest/UnitTest.h"
+
+// A bare bones decoder for exactly what FLACEncoder produces (fixed predictors, Rice coding, 16-bit
+// stereo), checking every CRC on the way, so the encoder can be round-tripped.
+
+class TestBitReader {
+public:
+	TestBitReader(const std::vector<uint8_t> &data, size_t pos) : data_(data), pos_(pos * 8) {}
+
+	uint32_t Get(int count) {
+		uint32_t value = 0;
+		for (int i = 0; i < count; i++) {
+			if ((pos_ >> 3) >= data_.size()) {
+				overrun_ = true;
+				return 0;
+			}
+			value = (value << 1) | ((data_[pos_ >> 3] >> (7 - (pos_ & 7))) & 1);
+			pos_++;
+		}
+		return value;
+	}
+	int32_t GetSigned(int count) {
+		uint32_t v = Get(count);
+		return (int32_t)(v << (32 - count)) >> (32 - count);
+	}
+	uint32_t GetUnary() {
+		uint32_t count = 0;
+		while (Get(1) == 0 && !overrun_)
+			count++;
+		return count;
+	}
+	void Align() { pos_ = (pos_ + 7) & ~(size_t)7; }
+	size_t BytePos() const { return pos_ >> 3; }
+	bool Overrun() const { return overrun_; }
+
+private:
+	const std::vector<uint8_t> &data_;
+	size_t pos_;
+	bool overrun_ = false;
+};
+
+static uint8_t TestCRC8(const uint8_t *data, size_t size) {
+	uint8_t crc = 0;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= data[i];
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+static uint16_t TestCRC16(const uint8_t *data, size_t size) {
+	uint16_t crc = 0;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+static bool DecodeSubframe(TestBitReader &bits, int count, int bps, int32_t *out) {
+	EXPECT_EQ_INT(bits.Get(1), 0);
+	uint32_t type = bits.Get(6);
+	EXPECT_EQ_INT(bits.Get(1), 0);
+	if (type == 0) {
+		int32_t value = bits.GetSigned(bps);
+		for (int i = 0; i < count; i++)
+			out[i] = value;
+	} else if (type == 1) {
+		for (int i = 0; i < count; i++)
+			out[i] = bits.GetSigned(bps);
+	} else if ((type & 0x38) == 8 && (type & 7) <= 4) {
+		static const int coefs[5][4] = { {}, { 1 }, { 2, -1 }, { 3, -3, 1 }, { 4, -6, 4, -1 } };
+		int order = type & 7;
+		for (int i = 0; i < order; i++)
+			out[i] = bits.GetSigned(bps);
+		EXPECT_EQ_INT(bits.Get(2), 0);
+		int partitionOrder = bits.Get(4);
+		int size = count >> partitionOrder;
+		int i = order;
+		for (int p = 0; p < (1 << partitionOrder); p++) {
+			int k = bits.Get(4);
+			EXPECT_FALSE(k == 15);
+			for (int end = (p + 1) * size; i < end; i++) {
+				uint32_t u = (bits.GetUnary() << k) | bits.Get(k);
+				int32_t residual = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+				int32_t prediction = 0;
+				for (int j = 0; j < order; j++)
+					prediction += coefs[order][j] * out[i - 1 - j];
+				out[i] = prediction + residual;
+			}
+		}
+	} else {
+		printf("Unexpected subframe type %d\n", type);
+		return false;
+	}
+	return !bits.Overrun();
+}
+
+static bool DecodeFLAC(const std::vector<uint8_t> &data, uint32_t sampleRate, std::vector<int16_t> *samples) {
+	EXPECT_TRUE(data.size() >= FLACEncoder::HEADER_SIZE);
+	EXPECT_TRUE(memcmp(data.data(), "fLaC", 4) == 0);
+
+	TestBitReader header(data, 4);
+	EXPECT_EQ_INT(header.Get(1), 1);
+	EXPECT_EQ_INT(header.Get(7), 0);
+	EXPECT_EQ_INT(header.Get(24), 34);
+	EXPECT_EQ_INT(header.Get(16), FLACEncoder::BLOCK_SIZE);
+	EXPECT_EQ_INT(header.Get(16), FLACEncoder::BLOCK_SIZE);
+	uint32_t minFrameBytes = header.Get(24);
+	uint32_t maxFrameBytes = header.Get(24);
+	EXPECT_EQ_INT(header.Get(20), sampleRate);
+	EXPECT_EQ_INT(header.Get(3), 1);
+	EXPECT_EQ_INT(header.Get(5), 15);
+	uint64_t totalFrames = (uint64_t)header.Get(4) << 32;
+	totalFrames |= header.Get(32);
+	uint8_t md5[16];
+	for (uint8_t &b : md5)
+		b = (uint8_t)header.Get(8);
+
+	samples->clear();
+	size_t pos = FLACEncoder::HEADER_SIZE;
+	std::vector<int32_t> ch[2];
+	uint32_t frameNumber = 0;
+	while (pos < data.size()) {
+		const size_t start = pos;
+		TestBitReader bits(data, pos);
+		EXPECT_EQ_INT(bits.Get(14), 0x3FFE);
+		EXPECT_EQ_INT(bits.Get(2), 0);
+		int blockSizeCode = bits.Get(4);
+		bits.Get(4);
+		int channelCode = bits.Get(4);
+		EXPECT_EQ_INT(bits.Get(3), 4);
+		EXPECT_EQ_INT(bits.Get(1), 0);
+
+		uint32_t number = bits.Get(8);
+		if (number & 0x80) {
+			int extra = 0;
+			while (number & (0x40 >> extra))
+				extra++;
+			number &= 0x3F >> extra;
+			for (int i = 0; i < extra; i++)
+				number = (number << 6) | (bits.Get(8) & 0x3F);
+		}
+		EXPECT_EQ_INT(number, frameNumber);
+
+		int count = 0;
+		if (blockSizeCode == 12)
+			count = 4096;
+		else if (blockSizeCode == 6)
+			count = bits.Get(8) + 1;
+		else if (blockSizeCode == 7)
+			count = bits.Get(16) + 1;
+		EXPECT_TRUE(count != 0);
+		uint8_t crc8 = TestCRC8(&data[start], bits.BytePos() - start);
+		EXPECT_EQ_INT(bits.Get(8), crc8);
+
+		for (auto &c : ch)
+			c.resize(count);
+		int sideChannel = channelCode == 8 ? 1 : (channelCode == 9 || channelCode == 10 ? (channelCode == 9 ? 0 : 1) : -1);
+		for (int c = 0; c < 2; c++)
+			RET(DecodeSubframe(bits, count, c == sideChannel ? 17 : 16, ch[c].data()));
+
+		bits.Align();
+		uint16_t crc16 = TestCRC16(&data[start], bits.BytePos() - start);
+		EXPECT_EQ_INT(bits.Get(16), crc16);
+		pos = bits.BytePos();
+		uint32_t frameBytes = (uint32_t)(pos - start);
+		EXPECT_TRUE(frameBytes >= minFrameBytes && frameBytes <= maxFrameBytes);
+
+		for (int i = 0; i < count; i++) {
+			int32_t a = ch[0][i], b = ch[1][i];
+			int32_t l, r;
+			switch (channelCode) {
+			case 1: l = a; r = b; break;
+			case 8: l = a; r = a - b; break;
+			case 9: l = a + b; r = b; break;
+			case 10: {
+				int32_t mid = (a << 1) | (b & 1);
+				l = (mid + b) >> 1;
+				r = (mid - b) >> 1;
+				break;
+			}
+			default:
+				printf("Unexpected channel assignment %d\n", channelCode);
+				return false;
+			}
+			samples->push_back((int16_t)l);
+			samples->push_back((int16_t)r);
+		}
+		frameNumber++;
+	}
+
+	EXPECT_EQ_INT(totalFrames, samples->size() / 2);
+	uint8_t expectedMD5[16];
+	ppsspp_md5((unsigned char *)samples->data(), (int)(samples->size() * sizeof(int16_t)), expectedMD5);
+	EXPECT_TRUE(memcmp(md5, expectedMD5, 16) == 0);
+	return true;
+}
+
+static std::vector<uint8_t> EncodeFLAC(const std::vector<int16_t> &samples, uint32_t sampleRate) {
+	FLACEncoder encoder(sampleRate);
+	std::vector<uint8_t> data;
+	encoder.Header(&data);
+	size_t frames = samples.size() / 2;
+	for (size_t pos = 0; pos < frames; pos += FLACEncoder::BLOCK_SIZE) {
+		int count = (int)std::min(frames - pos, (size_t)FLACEncoder::BLOCK_SIZE);
+		encoder.EncodeFrame(&samples[pos * 2], count, &data);
+	}
+	std::vector<uint8_t> header;
+	encoder.Header(&header);
+	memcpy(data.data(), header.data(), header.size());
+	return data;
+}
+
+static bool RoundTrip(const char *name, const std::vector<int16_t> &samples, uint32_t sampleRate, double *ratio) {
+	std::vector<uint8_t> data = EncodeFLAC(samples, sampleRate);
+	std::vector<int16_t> decoded;
+	if (!DecodeFLAC(data, sampleRate, &decoded)) {
+		printf("  (%s)\n", name);
+		return false;
+	}
+	if (decoded != samples) {
+		printf("%s: decoded samples don't match\n", name);
+		return false;
+	}
+	*ratio = (double)data.size() / (samples.size() * sizeof(int16_t));
+	return true;
+}
+
+bool TestFLACEncoder() {
+	GMRng rng;
+	rng.Init(0x4242);
+
+	// Something musical: a few detuned tones with a little noise, different in each channel.
+	std::vector<int16_t> tones(44100 * 2 * 2 + 2 * 1234);
+	for (size_t i = 0; i < tones.size() / 2; i++) {
+		double t = i / 44100.0;
+		double l = 9000 * sin(t * 440 * 6.2832) + 4000 * sin(t * 661 * 6.2832) + (rng.F() - 0.5f) * 200;
+		double r = 9000 * sin(t * 442 * 6.2832) + 3000 * sin(t * 1320 * 6.2832) + (rng.F() - 0.5f) * 200;
+		tones[i * 2] = (int16_t)l;
+		tones[i * 2 + 1] = (int16_t)r;
+	}
+
+	// Full scale noise (verbatim), silence and DC (constant), identical channels (side is constant),
+	// and extremes that overflow a 16-bit side channel.
+	std::vector<int16_t> noise(4096 * 2 * 2 + 2 * 17);
+	for (auto &s : noise)
+		s = (int16_t)rng.R32();
+	std::vector<int16_t> special;
+	for (int i = 0; i < 4096; i++) {
+		special.push_back(0);
+		special.push_back(0);
+	}
+	for (int i = 0; i < 4096; i++) {
+		special.push_back(-1234);
+		special.push_back(-1234);
+	}
+	for (int i = 0; i < 4096; i++) {
+		int16_t v = (int16_t)(rng.R32() >> 20);
+		special.push_back(v);
+		special.push_back(v);
+	}
+	for (int i = 0; i < 4096 + 3; i++) {
+		special.push_back((i & 1) ? 32767 : -32768);
+		special.push_back((i & 1) ? -32768 : 32767);
+	}
+
+	double ratio;
+	RET(RoundTrip("tones", tones, 44100, &ratio));
+	printf("FLAC tones: %0.1f%% of the original size\n", ratio * 100.0);
+	EXPECT_TRUE(ratio < 0.65);
+	RET(RoundTrip("noise", noise, 48000, &ratio));
+	EXPECT_TRUE(ratio < 1.01);
+	RET(RoundTrip("special", special, 32000, &ratio));
+	// A single short frame, and a stream with many frames for multi-byte frame numbers.
+	std::vector<int16_t> tiny(tones.begin(), tones.begin() + 2 * 3);
+	RET(RoundTrip("tiny", tiny, 22050, &ratio));
+	std::vector<int16_t> longer;
+	for (int i = 0; i < 40; i++)
+		longer.insert(longer.end(), tones.begin(), tones.end());
+	double st = time_now_d();
+	RET(RoundTrip("long", longer, 44100, &ratio));
+	double seconds = time_now_d() - st;
+	printf("FLAC round trip: %0.0fx realtime\n", (longer.size() / 2 / 44100.0) / seconds);
+	return true;
+}
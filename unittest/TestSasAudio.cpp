@@ -0,0 +1,317 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/TimeUtil.h"
+#include "Common/Data/Random/Rng.h"
+#include "Core/MemMap.h"
+#include "Core/MemMapHelpers.h"
+#include "Core/HW/SasAudio.h"
+#include "Core/Util/AudioFormat.h"
+#include "unittest/UnitTest.h"
+
+// The straightforward scalar versions of the SAS decode and mix loops, as they were before vectorizing.
+// The real ones must match these bit for bit.
+
+static const u8 referenceVagCoefs[16][2] = {
+	{ 0, 0 }, { 60, 0 }, { 115, 52 }, { 98, 55 }, { 122, 60 }, { 0, 0 }, { 0, 0 }, { 52, 0 },
+	{ 55, 2 }, { 60, 125 }, { 0, 0 }, { 0, 91 }, { 0, 0 }, { 2, 216 }, { 125, 6 }, { 0, 151 },
+};
+
+static void ReferenceVagDecode(s16 *out, const u8 *data, int numBlocks) {
+	int s1 = 0;
+	int s2 = 0;
+	for (int b = 0; b < numBlocks; b++) {
+		const u8 *readp = data + b * 16;
+		int predict_nr = *readp++;
+		int shift_factor = predict_nr & 0xf;
+		predict_nr >>= 4;
+		readp++;
+		int coef1 = referenceVagCoefs[predict_nr][0];
+		int coef2 = -referenceVagCoefs[predict_nr][1];
+		for (int i = 0; i < 28; i += 2) {
+			u8 d = *readp++;
+			int sample1 = (short)((d & 0xf) << 12) >> shift_factor;
+			int sample2 = (short)((d & 0xf0) << 8) >> shift_factor;
+			s2 = clamp_s16(sample1 + ((s1 * coef1 + s2 * coef2) >> 6));
+			s1 = clamp_s16(sample2 + ((s2 * coef1 + s1 * coef2) >> 6));
+			*out++ = s2;
+			*out++ = s1;
+		}
+	}
+}
+
+static u32 ReferenceResampleAndMix(s32 *mix, s32 *send, const s16 *in, const s32 *envelope, u32 sampleFrac, int pitch, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight) {
+	const bool needsInterp = pitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
+	for (int i = 0; i < count; i++) {
+		const s16 *s = in + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+		int sample = s[0];
+		if (needsInterp) {
+			int f = sampleFrac & PSP_SAS_PITCH_MASK;
+			sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+		}
+		sampleFrac += pitch;
+
+		sample = ((sample * envelope[i]) + (1 << 14)) >> 15;
+		mix[i * 2] += (sample * volumeLeft) >> 12;
+		mix[i * 2 + 1] += (sample * volumeRight) >> 12;
+		send[i * 2] += sample * effectLeft >> 12;
+		send[i * 2 + 1] += sample * effectRight >> 12;
+	}
+	return sampleFrac;
+}
+
+static s16 RandomSample(GMRng &rng) {
+	// Favor the extremes, where overflow bugs would show.
+	switch (rng.R32() & 7) {
+	case 0: return 32767;
+	case 1: return -32768;
+	default: return (s16)rng.R32();
+	}
+}
+
+static bool TestVagDecode(GMRng &rng) {
+	const u32 addr = PSP_GetUserMemoryBase();
+	const int numBlocks = 64;
+	std::vector<u8> data(numBlocks * 16);
+	for (int b = 0; b < numBlocks; b++) {
+		u8 *block = &data[b * 16];
+		// Walk through every filter and shift, including the out of range shifts.
+		block[0] = (u8)(((b & 15) << 4) | ((b * 7 + (b >> 4)) & 15));
+		// No loop or end flags.
+		block[1] = 0;
+		for (int i = 2; i < 16; i++)
+			block[i] = (u8)rng.R32();
+	}
+	Memory::Memcpy(addr, data.data(), (u32)data.size(), "TestSasAudio");
+
+	const int total = numBlocks * 28;
+	std::vector<s16> expected(total + 64);
+	ReferenceVagDecode(expected.data(), data.data(), numBlocks);
+
+	// Read past the end too, which should give silence.
+	std::vector<s16> actual(total + 64, 0x5555);
+	VagDecoder decoder;
+	decoder.Start(addr, numBlocks * 16, false);
+	int pos = 0;
+	while (pos < (int)actual.size()) {
+		int chunk = std::min((int)(rng.R32() % 97) + 1, (int)actual.size() - pos);
+		decoder.GetSamples(&actual[pos], chunk);
+		pos += chunk;
+	}
+
+	for (int i = 0; i < (int)actual.size(); i++) {
+		if (actual[i] != expected[i]) {
+			printf("VAG decode mismatch at sample %d (block %d): %d != expected %d\n", i, i / 28, actual[i], expected[i]);
+			return false;
+		}
+	}
+	EXPECT_TRUE(decoder.End());
+	return true;
+}
+
+static bool TestResampleAndMix(GMRng &rng) {
+	// Room for the max pitch, 4x.
+	s16 input[PSP_SAS_MAX_GRAIN * 4 + 2];
+	s16 resampled[PSP_SAS_MAX_GRAIN];
+	s32 envelope[PSP_SAS_MAX_GRAIN];
+	s32 mix[PSP_SAS_MAX_GRAIN * 2], send[PSP_SAS_MAX_GRAIN * 2];
+	s32 refMix[PSP_SAS_MAX_GRAIN * 2], refSend[PSP_SAS_MAX_GRAIN * 2];
+
+	for (int iter = 0; iter < 2000; iter++) {
+		for (s16 &s : input)
+			s = RandomSample(rng);
+		for (int i = 0; i < PSP_SAS_MAX_GRAIN; i++) {
+			// The envelope is at most 1 << 15 after rounding.
+			envelope[i] = (rng.R32() & 3) == 0 ? 1 << 15 : (s32)(rng.R32() % ((1 << 15) + 1));
+		}
+		for (int i = 0; i < PSP_SAS_MAX_GRAIN * 2; i++) {
+			refMix[i] = mix[i] = (s32)rng.R32() >> 8;
+			refSend[i] = send[i] = (s32)rng.R32() >> 8;
+		}
+
+		int count = (int)(rng.R32() % (PSP_SAS_MAX_GRAIN + 1));
+		int pitch;
+		u32 sampleFrac;
+		if ((iter & 3) == 0) {
+			// The copy path.
+			pitch = PSP_SAS_PITCH_BASE;
+			sampleFrac = (rng.R32() & 1) << PSP_SAS_PITCH_BASE_SHIFT;
+		} else {
+			pitch = (int)(rng.R32() % (PSP_SAS_PITCH_MAX + 1));
+			sampleFrac = rng.R32() & (PSP_SAS_PITCH_BASE * 2 - 1);
+		}
+		auto volume = [&]() {
+			return (int)(rng.R32() % (PSP_SAS_VOL_MAX * 2 + 1)) - PSP_SAS_VOL_MAX;
+		};
+		int volumeLeft = volume(), volumeRight = volume(), effectLeft = volume(), effectRight = volume();
+
+		u32 refFrac = ReferenceResampleAndMix(refMix, refSend, input, envelope, sampleFrac, pitch, count, volumeLeft, volumeRight, effectLeft, effectRight);
+		u32 frac = SasResampleLinear(resampled, input, sampleFrac, pitch, count);
+		SasMixVoiceSamples(mix, send, resampled, envelope, count, volumeLeft, volumeRight, effectLeft, effectRight);
+
+		EXPECT_EQ_INT(frac, refFrac);
+		for (int i = 0; i < PSP_SAS_MAX_GRAIN * 2; i++) {
+			if (mix[i] != refMix[i] || send[i] != refSend[i]) {
+				printf("Mix mismatch at %d (pitch %04x, frac %04x, count %d): %d, %d != expected %d, %d\n", i, pitch, sampleFrac, count, mix[i], send[i], refMix[i], refSend[i]);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void SetupSpeculationInstance(SasInstance &sas, u32 vagAddr, u32 vagSize) {
+	sas.SetGrainSize(256);
+	sas.waveformEffect.isWetOn = 1;
+	sas.waveformEffect.leftVol = PSP_SAS_VOL_MAX;
+	sas.waveformEffect.rightVol = PSP_SAS_VOL_MAX;
+	sas.SetWaveformEffectType(PSP_SAS_EFFECT_TYPE_HALL);
+	for (int v = 0; v < 8; v++) {
+		SasVoice &voice = sas.voices[v];
+		voice.type = VOICETYPE_VAG;
+		voice.vagAddr = vagAddr + v * 64;
+		voice.vagSize = vagSize - v * 64;
+		voice.pitch = 0x0800 + v * 0x0300;
+		voice.effectLeft = v * 0x100;
+		voice.envelope.SetRate(0xF, 0x01000000, 0x00100000, 0x00010000, 0x00100000);
+		voice.envelope.SetSustainLevel(0x20000000);
+		voice.KeyOn();
+	}
+}
+
+static void WriteRandomVag(GMRng &rng, u32 addr, int numBlocks) {
+	std::vector<u8> data(numBlocks * 16);
+	for (int b = 0; b < numBlocks; b++) {
+		data[b * 16] = (u8)(rng.R32() % 5) << 4 | (u8)(rng.R32() % 13);
+		data[b * 16 + 1] = 0;
+		for (int i = 2; i < 16; i++)
+			data[b * 16 + i] = (u8)rng.R32();
+	}
+	Memory::Memcpy(addr, data.data(), (u32)data.size(), "TestSasAudio");
+}
+
+static bool TestSpeculativeMix(GMRng &rng) {
+	const u32 vagAddr = PSP_GetUserMemoryBase() + 0x10000;
+	const int numBlocks = 256;
+	const u32 outAddr = PSP_GetUserMemoryBase() + 0x20000;
+	const u32 specOutAddr = PSP_GetUserMemoryBase() + 0x21000;
+	WriteRandomVag(rng, vagAddr, numBlocks);
+
+	// One instance mixes normally, the other through SasSpeculativeMix. They must agree on every grain.
+	std::unique_ptr<SasInstance> sas(new SasInstance());
+	std::unique_ptr<SasInstance> specSas(new SasInstance());
+	std::unique_ptr<SasSpeculativeMix> spec(new SasSpeculativeMix());
+	SetupSpeculationInstance(*sas, vagAddr, numBlocks * 16);
+	SetupSpeculationInstance(*specSas, vagAddr, numBlocks * 16);
+
+	int committed = 0;
+	for (int grain = 0; grain < 40; grain++) {
+		bool expectCommit = grain != 0;
+		if (grain == 10) {
+			// A parameter change must throw the speculative mix away.
+			sas->voices[2].pitch = specSas->voices[2].pitch = 0x1234;
+			expectCommit = false;
+		} else if (grain == 20) {
+			// And so must a change to the sample data.
+			WriteRandomVag(rng, vagAddr, numBlocks);
+			expectCommit = false;
+		} else if (grain == 30) {
+			sas->voices[5].KeyOff();
+			specSas->voices[5].KeyOff();
+			expectCommit = false;
+		}
+
+		sas->Mix(outAddr);
+		bool didCommit = spec->Commit(*specSas);
+		if (!didCommit)
+			specSas->MixVoices();
+		specSas->WriteOutput(specOutAddr, 0, 0, 0);
+		EXPECT_EQ_INT(didCommit, expectCommit);
+		committed += didCommit ? 1 : 0;
+
+		if (memcmp(Memory::GetPointer(outAddr), Memory::GetPointer(specOutAddr), 256 * 2 * sizeof(s16)) != 0) {
+			printf("Speculative SAS mix differs at grain %d (committed: %d)\n", grain, (int)didCommit);
+			return false;
+		}
+
+		if (spec->Prepare(*specSas))
+			spec->Run();
+	}
+	EXPECT_EQ_INT(committed, 36);
+	return true;
+}
+
+static void BenchmarkMix(GMRng &rng) {
+	const int voices = 32;
+	const int grain = 256;
+	const int pitches[2] = { PSP_SAS_PITCH_BASE, 0x0C35 };
+
+	std::vector<s16> input(grain * 4 + 2);
+	for (s16 &s : input)
+		s = RandomSample(rng);
+	std::vector<s32> envelope(grain, 0x6000);
+	std::vector<s16> resampled(grain);
+	std::vector<s32> mix(grain * 2), send(grain * 2);
+
+	for (int pitch : pitches) {
+		auto run = [&](bool reference) {
+			int grains = 0;
+			double st = time_now_d();
+			do {
+				// Start each grain from silence, like the real mixer.
+				std::fill(mix.begin(), mix.end(), 0);
+				std::fill(send.begin(), send.end(), 0);
+				for (int v = 0; v < voices; v++) {
+					if (reference) {
+						ReferenceResampleAndMix(mix.data(), send.data(), input.data(), envelope.data(), 0, pitch, grain, 0x1000, 0x0800, 0x0400, 0x0200);
+					} else {
+						SasResampleLinear(resampled.data(), input.data(), 0, pitch, grain);
+						SasMixVoiceSamples(mix.data(), send.data(), resampled.data(), envelope.data(), grain, 0x1000, 0x0800, 0x0400, 0x0200);
+					}
+				}
+				grains++;
+			} while (time_now_d() - st < 0.25);
+			return (double)grains * voices * grain / (time_now_d() - st) / 1000000.0;
+		};
+		double ref = run(true);
+		double opt = run(false);
+		printf("SAS mix, %d voices, pitch %04x: %0.1f Msamples/s (reference %0.1f)\n", voices, pitch, opt, ref);
+	}
+}
+
+bool TestSasAudio() {
+	Memory::g_MemorySize = Memory::RAM_NORMAL_SIZE;
+	Memory::Init();
+
+	GMRng rng;
+	rng.Init(0x5A5);
+	bool success = TestVagDecode(rng);
+	success = success && TestResampleAndMix(rng);
+	success = success && TestSpeculativeMix(rng);
+	if (success)
+		BenchmarkMix(rng);
+
+	Memory::Shutdown();
+	return success;
+}
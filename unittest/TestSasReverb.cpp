@@ -0,0 +1,159 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Common/Data/Random/Rng.h"
+#include "Core/Config.h"
+#include "Core/HW/SasReverb.h"
+#include "unittest/UnitTest.h"
+
+// The block path of the reverb must match the sample by sample loop exactly, for every preset.
+// Runs long enough to wrap around even the largest buffers a few times, with odd call sizes to
+// hit the SIMD tails and block splits.
+
+static const size_t callSizes[] = { 256, 1, 37, 512, 1024, 7, 200, 128, 1023 };
+
+static void FillSignal(GMRng &rng, int kind, int16_t *data, size_t samples, double *phase) {
+	for (size_t i = 0; i < samples; i++) {
+		int16_t l, r;
+		switch (kind) {
+		case 0:
+			l = (int16_t)(sin(*phase) * 30000.0);
+			r = (int16_t)(sin(*phase * 1.5) * 20000.0);
+			*phase += 0.05;
+			break;
+		case 1:
+			l = (int16_t)rng.R32();
+			r = (int16_t)rng.R32();
+			break;
+		case 2:
+			// Full scale square, to drive the clamps.
+			l = (i & 64) ? 32767 : -32768;
+			r = (i & 32) ? -32768 : 32767;
+			break;
+		case 3:
+			l = (rng.R32() & 255) == 0 ? 32767 : 0;
+			r = (rng.R32() & 255) == 0 ? -32768 : 0;
+			break;
+		default:
+			l = 0;
+			r = 0;
+			break;
+		}
+		data[i * 2] = l;
+		data[i * 2 + 1] = r;
+	}
+}
+
+static bool TestPreset(int preset, int reverbVolume, uint16_t volLeft, uint16_t volRight, size_t totalSamples) {
+	g_Config.iReverbVolume = reverbVolume;
+
+	SasReverb fast;
+	SasReverb reference;
+	reference.SetForceReference(true);
+	fast.SetPreset(preset);
+	reference.SetPreset(preset);
+
+	GMRng rng;
+	rng.Init(preset * 100 + reverbVolume);
+	double phase = 0.0;
+	std::vector<int16_t> input;
+	std::vector<int16_t> outFast;
+	std::vector<int16_t> outReference;
+
+	size_t done = 0;
+	for (int call = 0; done < totalSamples; call++) {
+		size_t samples = callSizes[call % ARRAY_SIZE(callSizes)];
+		input.resize(samples * 2);
+		// Guard past the end, to catch overruns.
+		outFast.assign(samples * 4 + 8, 0x5555);
+		outReference.assign(samples * 4 + 8, 0x5555);
+		FillSignal(rng, (call / 7) % 5, input.data(), samples, &phase);
+
+		fast.ProcessReverb(outFast.data(), input.data(), samples, volLeft, volRight);
+		reference.ProcessReverb(outReference.data(), input.data(), samples, volLeft, volRight);
+		for (size_t i = 0; i < outFast.size(); i++) {
+			if (outFast[i] != outReference[i]) {
+				printf("Reverb %s (volume %d, %04x/%04x): mismatch at sample %d of call %d (%d samples): %d != expected %d\n",
+					SasReverb::GetPresetName(preset), reverbVolume, volLeft, volRight, (int)(done + i / 4), call, (int)samples, outFast[i], outReference[i]);
+				return false;
+			}
+		}
+		done += samples;
+	}
+	return true;
+}
+
+static double Benchmark(bool forceReference) {
+	SasReverb reverb;
+	reverb.SetForceReference(forceReference);
+	reverb.SetPreset(4);
+
+	GMRng rng;
+	rng.Init(1);
+	double phase = 0.0;
+	std::vector<int16_t> input(1024 * 2);
+	std::vector<int16_t> output(1024 * 4);
+	FillSignal(rng, 0, input.data(), 1024, &phase);
+
+	int64_t samples = 0;
+	double st = time_now_d();
+	do {
+		for (int i = 0; i < 16; i++)
+			reverb.ProcessReverb(output.data(), input.data(), 1024, 0x1000, 0x1000);
+		samples += 16 * 1024;
+	} while (time_now_d() - st < 0.1);
+	return samples / (time_now_d() - st);
+}
+
+bool TestSasReverb() {
+	int savedVolume = g_Config.iReverbVolume;
+
+	struct Volumes {
+		int reverb;
+		uint16_t left;
+		uint16_t right;
+	};
+	static const Volumes volumes[] = {
+		{ 10, 0x1000, 0x1000 },
+		{ 25, 0xFFFF, 0x8000 },
+		{ 1, 0x7FFF, 0 },
+		{ 0, 0x1000, 0x1000 },
+	};
+
+	bool success = true;
+	for (int preset = -1; preset < 9 && success; preset++) {
+		for (size_t v = 0; v < ARRAY_SIZE(volumes) && success; v++) {
+			// The first run is long enough to wrap the echo buffers (0x18040 samples) twice.
+			success = TestPreset(preset, volumes[v].reverb, volumes[v].left, volumes[v].right, v == 0 ? 220000 : 60000);
+		}
+	}
+
+	g_Config.iReverbVolume = 10;
+	if (success) {
+		double fast = Benchmark(false);
+		double plain = Benchmark(true);
+		printf("Reverb (Hall): %0.1f M samples/s (sample by sample %0.1f)\n", fast / 1000000.0, plain / 1000000.0);
+	}
+
+	g_Config.iReverbVolume = savedVolume;
+	return success;
+}
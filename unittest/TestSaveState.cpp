@@ -0,0 +1,115 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zstd.h>
+
+#include "Common/Common.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "unittest/UnitTest.h"
+
+struct ChunkTestState {
+	std::vector<u8> ram;
+	std::vector<u32> objects;
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("ChunkTest", 1);
+		if (!s)
+			return;
+		{
+			auto s2 = p.Section("Memory", 1);
+			if (s2)
+				Do(p, ram);
+		}
+		{
+			auto s2 = p.Section("Kernel", 1);
+			if (s2) {
+				// Too deep to get its own chunk.
+				auto s3 = p.Section("KernelObject", 1);
+				if (s3)
+					Do(p, objects);
+			}
+		}
+	}
+};
+
+// Removes the file however the test ends.
+struct TempFile {
+	explicit TempFile(const Path &p) : path(p) {}
+	~TempFile() {
+		File::Delete(path);
+	}
+	Path path;
+};
+
+bool TestSaveStateChunks() {
+	ChunkTestState state;
+	state.ram.resize(9 * 1024 * 1024);
+	for (size_t i = 0; i < state.ram.size(); i++)
+		state.ram[i] = (u8)((i >> 12) ^ (i * 7 % 13));
+	for (u32 i = 0; i < 1000; i++)
+		state.objects.push_back(i * 3);
+
+	const TempFile file(Path("unittest_chunks.ppst"));
+	const Path &filename = file.path;
+	EXPECT_EQ_INT(CChunkFileReader::Save(filename, "Chunks", "v1.0", state), CChunkFileReader::ERROR_NONE);
+
+	// The outer section, then RAM in three pieces, then the rest of the kernel.
+	std::vector<CChunkFileReader::ChunkInfo> chunks;
+	EXPECT_EQ_INT(CChunkFileReader::GetChunkIndex(filename, &chunks), CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_INT((int)chunks.size(), 5);
+	const char *titles[] = { "ChunkTest", "Memory", "Memory", "Memory", "Kernel" };
+	for (size_t i = 0; i < chunks.size() && i < ARRAY_SIZE(titles); i++) {
+		EXPECT_EQ_STR(std::string(chunks[i].title, strnlen(chunks[i].title, sizeof(chunks[i].title))), std::string(titles[i]));
+	}
+
+	// A single chunk starts with the marker of its section.
+	std::vector<u8> kernel;
+	EXPECT_EQ_INT(CChunkFileReader::ReadChunk(filename, chunks.back(), &kernel), CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_INT((int)kernel.size(), (int)chunks.back().size);
+	EXPECT_TRUE(memcmp(kernel.data(), "Kernel", 6) == 0);
+
+	ChunkTestState loaded;
+	std::string gitVersion;
+	std::string failureReason;
+	EXPECT_EQ_INT(CChunkFileReader::Load(filename, &gitVersion, loaded, &failureReason), CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_STR(gitVersion, std::string("v1.0"));
+	EXPECT_TRUE(loaded.ram == state.ram);
+	EXPECT_TRUE(loaded.objects == state.objects);
+
+	// Older versions decompress everything after the header and title in one go, skipping the index.
+	std::vector<u8> expected;
+	EXPECT_EQ_INT(CChunkFileReader::MeasureAndSavePtr(state, &expected), CChunkFileReader::ERROR_NONE);
+	std::string contents;
+	EXPECT_TRUE(File::ReadBinaryFileToString(filename, &contents));
+	const size_t headerSize = 4 * sizeof(u32) + 32 + 128;
+	EXPECT_TRUE(contents.size() > headerSize);
+	std::vector<u8> whole(expected.size());
+	size_t result = ZSTD_decompress(whole.data(), whole.size(), contents.data() + headerSize, contents.size() - headerSize);
+	EXPECT_FALSE(ZSTD_isError(result));
+	EXPECT_EQ_INT((int)result, (int)expected.size());
+	EXPECT_TRUE(whole == expected);
+
+	return true;
+}
@@ -1,5 +1,6 @@
 #include "ppsspp_config.h"
 #include <algorithm>
+#include <memory>
 
 #include "Common/StringUtils.h"
 
@@ -16,6 +17,10 @@
 #include "GPU/Common/ReinterpretFramebuffer.h"
 #include "GPU/Common/StencilCommon.h"
 #include "GPU/Common/DepalettizeShaderCommon.h"
+#include "GPU/Common/ShaderPrecompile.h"
+#include "GPU/Common/ShaderGenCache.h"
+#include "Common/File/DirListing.h"
+#include "Common/File/FileUtil.h"
 
 #if PPSSPP_PLATFORM(WINDOWS)
 #include <wrl/client.h>
@@ -615,6 +620,138 @@ bool TestGeometryShaders() {
 }
 
 
+// Runs the generators through g_shaderGenCache, cold and then warm, and checks that what comes
+// out of the cache is identical to what the generators produce directly.
+static bool CheckShaderGenCacheEquivalence() {
+	std::unique_ptr<char[]> buffer(new char[PRECOMPILE_CODE_BUFFER_SIZE]);
+	GMRng rng;
+	Draw::Bugs bugs;
+	int compared = 0;
+	int spirvCompared = 0;
+
+	for (int j = 0; j < numLanguages; j++) {
+		ShaderLanguageDesc compat(languages[j]);
+		for (int i = 0; i < 40; i++) {
+			VShaderID vsid;
+			vsid.d[0] = rng.R32();
+			vsid.d[1] = rng.R32();
+			vsid.SetBits(VS_BIT_WEIGHT_FMTSCALE, 2, 0);
+			if (vsid.Bit(VS_BIT_IS_THROUGH)) {
+				vsid.SetBit(VS_BIT_USE_HW_TRANSFORM, 0);
+			}
+			if (!vsid.Bit(VS_BIT_USE_HW_TRANSFORM)) {
+				vsid.SetBit(VS_BIT_ENABLE_BONES, 0);
+			}
+			vsid.SetBit(VS_BIT_VERTEX_RANGE_CULLING, 0);
+
+			FShaderID fsid;
+			fsid.d[0] = rng.R32();
+			fsid.d[1] = rng.R32();
+			fsid.SetBit(FS_BIT_NO_DEPTH_CANNOT_DISCARD_STENCIL, false);
+			if (static_cast<ReplaceAlphaType>(fsid.Bits(FS_BIT_STENCIL_TO_ALPHA, 2)) == ReplaceAlphaType::REPLACE_ALPHA_DUALSOURCE)
+				continue;
+
+			// Reference, with the cache out of the picture.
+			PrecompiledVertexShader vsRef;
+			vsRef.id = vsid;
+			std::string errorString;
+			buffer[0] = '\0';
+			vsRef.success = GenerateVertexShader(vsid, buffer.get(), compat, bugs, &vsRef.attrMask, &vsRef.uniformMask, &vsRef.flags, &errorString);
+			vsRef.code = buffer.get();
+			PrecompiledFragmentShader fsRef;
+			fsRef.id = fsid;
+			buffer[0] = '\0';
+			fsRef.success = GenerateFragmentShader(fsid, buffer.get(), compat, bugs, &fsRef.uniformMask, &fsRef.flags, &errorString);
+			fsRef.code = buffer.get();
+
+			// First pass fills the cache, the second one must be served from it.
+			for (int pass = 0; pass < 2; pass++) {
+				int hitsBefore = g_shaderGenCache.Hits();
+				PrecompiledVertexShader vs;
+				vs.id = vsid;
+				GenerateVertexShaderCached(compat, bugs, buffer.get(), &vs);
+				PrecompiledFragmentShader fs;
+				fs.id = fsid;
+				GenerateFragmentShaderCached(compat, bugs, buffer.get(), &fs);
+
+				int expectedHits = pass == 0 ? 0 : (int)vsRef.success + (int)fsRef.success;
+				if (g_shaderGenCache.Hits() - hitsBefore != expectedHits) {
+					printf("Shader generation cache: expected %d hits on pass %d, got %d\n", expectedHits, pass, g_shaderGenCache.Hits() - hitsBefore);
+					return false;
+				}
+				if (vs.success != vsRef.success || (vs.success && (vs.code != vsRef.code || vs.attrMask != vsRef.attrMask || vs.uniformMask != vsRef.uniformMask || vs.flags != vsRef.flags))) {
+					printf("Shader generation cache mismatch for vertex shader %s (%s, pass %d)\n", VertexShaderDesc(vsid).c_str(), ShaderLanguageToString(languages[j]), pass);
+					PrintDiff(vsRef.code.c_str(), vs.code.c_str());
+					return false;
+				}
+				if (fs.success != fsRef.success || (fs.success && (fs.code != fsRef.code || fs.uniformMask != fsRef.uniformMask || fs.flags != fsRef.flags))) {
+					printf("Shader generation cache mismatch for fragment shader %s (%s, pass %d)\n", FragmentShaderDesc(fsid).c_str(), ShaderLanguageToString(languages[j]), pass);
+					PrintDiff(fsRef.code.c_str(), fs.code.c_str());
+					return false;
+				}
+				compared++;
+			}
+
+			// And the SPIR-V round trip.
+			if (languages[j] == ShaderLanguage::GLSL_VULKAN && fsRef.success) {
+				std::vector<uint32_t> spirv;
+				std::vector<uint32_t> cached;
+				if (!GLSLtoSPV(StageToVulkan(ShaderStage::Fragment), fsRef.code.c_str(), GLSLVariant::VULKAN, spirv, &errorString)) {
+					printf("Error compiling fragment shader:\n\n%s\n\n%s\n", LineNumberString(fsRef.code).c_str(), errorString.c_str());
+					return false;
+				}
+				g_shaderGenCache.StoreSPIRV(ShaderStage::Fragment, fsRef.code.c_str(), spirv);
+				if (!g_shaderGenCache.LoadSPIRV(ShaderStage::Fragment, fsRef.code.c_str(), &cached) || cached != spirv) {
+					printf("Shader generation cache: SPIR-V mismatch for fragment shader %s\n", FragmentShaderDesc(fsid).c_str());
+					return false;
+				}
+				// The stage is part of the key.
+				if (g_shaderGenCache.LoadSPIRV(ShaderStage::Vertex, fsRef.code.c_str(), &cached)) {
+					printf("Shader generation cache: SPIR-V stage not part of the key\n");
+					return false;
+				}
+				spirvCompared++;
+			}
+		}
+	}
+
+	printf("%d cached shader pairs and %d SPIR-V modules matched the generators\n", compared, spirvCompared);
+	return true;
+}
+
+bool TestShaderGenCache() {
+	const Path dir("shadergen_test_cache");
+	File::DeleteDirRecursively(dir);
+	g_shaderGenCache.SetDirectory(dir);
+	if (!g_shaderGenCache.Enabled()) {
+		printf("Failed to create %s\n", dir.c_str());
+		return false;
+	}
+	g_shaderGenCache.ResetStats();
+
+	bool success = CheckShaderGenCacheEquivalence();
+
+	if (success) {
+		// Trimming has to get it under the limit, but not empty it.
+		const uint64_t maxSize = 256 * 1024;
+		g_shaderGenCache.Trim(maxSize);
+		std::vector<File::FileInfo> files;
+		File::GetFilesInDir(dir, &files);
+		uint64_t totalSize = 0;
+		for (const File::FileInfo &file : files) {
+			totalSize += file.size;
+		}
+		if (files.empty() || totalSize > maxSize) {
+			printf("Shader generation cache: trimmed to %d files, %d bytes\n", (int)files.size(), (int)totalSize);
+			success = false;
+		}
+	}
+
+	g_shaderGenCache.SetDirectory(Path());
+	File::DeleteDirRecursively(dir);
+	return success;
+}
+
 bool TestShaderGenerators() {
 #if PPSSPP_PLATFORM(WINDOWS)
 	LoadD3D11();
@@ -648,5 +785,9 @@ bool TestShaderGenerators() {
 		return false;
 	}
 
+	if (!TestShaderGenCache()) {
+		return false;
+	}
+
 	return true;
 } 
@@ -1,7 +1,9 @@
+#include <cstring>
 #include <thread>
 #include <vector>
 
 #include "Common/Log.h"
+#include "Common/File/VFS/MappedZipFileReader.h"
 #include "Common/File/VFS/ZipFileReader.h"
 
 #include "UnitTest.h"
@@ -87,8 +89,95 @@ bool TestZipFile() {
 	return true;
 }
 
+static bool CompareZipFile(VFSBackend *mapped, VFSBackend *zip, const char *path) {
+	size_t zipSize = 0;
+	uint8_t *zipData = zip->ReadFile(path, &zipSize);
+	EXPECT_TRUE(zipData != nullptr);
+	size_t mappedSize = 0;
+	uint8_t *mappedData = mapped->ReadFile(path, &mappedSize);
+	EXPECT_TRUE(mappedData != nullptr);
+	EXPECT_EQ_INT(mappedSize, zipSize);
+	EXPECT_TRUE(memcmp(mappedData, zipData, zipSize + 1) == 0);
+
+	// Reading in small pieces has to give the same, also after a rewind.
+	VFSFileReference *ref = mapped->GetFile(path);
+	EXPECT_TRUE(ref != nullptr);
+	size_t openSize = 0;
+	VFSOpenFile *openFile = mapped->OpenFileForRead(ref, &openSize);
+	EXPECT_TRUE(openFile != nullptr);
+	EXPECT_EQ_INT(openSize, zipSize);
+	for (int pass = 0; pass < 2; pass++) {
+		std::vector<uint8_t> pieces;
+		uint8_t buf[3];
+		size_t count;
+		while ((count = mapped->Read(openFile, buf, sizeof(buf))) != 0) {
+			pieces.insert(pieces.end(), buf, buf + count);
+		}
+		EXPECT_EQ_INT(pieces.size(), zipSize);
+		EXPECT_TRUE(zipSize == 0 || memcmp(pieces.data(), zipData, zipSize) == 0);
+		mapped->Rewind(openFile);
+	}
+	const uint8_t *pointer = mapped->DataPointer(openFile);
+	EXPECT_TRUE(pointer == nullptr || zipSize == 0 || memcmp(pointer, zipData, zipSize) == 0);
+	mapped->CloseFile(openFile);
+	mapped->ReleaseFile(ref);
+
+	delete[] zipData;
+	delete[] mappedData;
+	return true;
+}
+
+bool TestMappedZipFile() {
+	Path zipPath = Path("../source_assets/ziptest.zip");
+	if (!File::Exists(zipPath)) {
+		zipPath = Path("source_assets/ziptest.zip");
+	}
+
+	MappedZipFileReader *mapped = MappedZipFileReader::Create(zipPath, "", true);
+	if (!mapped) {
+		// Not supported on this platform, ZipFileReader is used instead.
+		return true;
+	}
+	ZipFileReader *zip = ZipFileReader::Create(zipPath, "", true);
+	EXPECT_TRUE(zip != nullptr);
+
+	std::vector<File::FileInfo> listing;
+	EXPECT_TRUE(mapped->GetFileListing("ziptest", &listing, nullptr));
+	EXPECT_EQ_INT(listing.size(), 3);
+	EXPECT_TRUE(CheckContainsDir(listing, "data"));
+	EXPECT_TRUE(CheckContainsFile(listing, "langregion.txt"));
+	EXPECT_FALSE(mapped->GetFileListing("ziptestwrong", &listing, nullptr));
+
+	// Stored and deflated files.
+	EXPECT_TRUE(CompareZipFile(mapped, zip, "in_root.txt"));
+	EXPECT_TRUE(CompareZipFile(mapped, zip, "ziptest/data/big.txt"));
+	EXPECT_TRUE(CompareZipFile(mapped, zip, "ziptest/lang/en_us.txt"));
+
+	// Lookups are case insensitive, like in ZipFileReader.
+	File::FileInfo info;
+	EXPECT_TRUE(mapped->GetFileInfo("ZIPTEST/data/BIG.txt", &info));
+	EXPECT_TRUE(info.exists);
+	EXPECT_FALSE(mapped->GetFileInfo("ziptest/data/missing.txt", &info));
+	delete zip;
+	delete mapped;
+
+	mapped = MappedZipFileReader::Create(zipPath, "ziptest/data", true);
+	EXPECT_TRUE(mapped != nullptr);
+	EXPECT_TRUE(mapped->GetFileListing("", &listing, nullptr));
+	EXPECT_EQ_INT(listing.size(), 4);
+	EXPECT_TRUE(CheckContainsFile(listing, "big.txt"));
+	size_t size = 0;
+	uint8_t *data = mapped->ReadFile("big.txt", &size);
+	EXPECT_TRUE(data != nullptr);
+	delete[] data;
+	delete mapped;
+	return true;
+}
+
 bool TestVFS() {
 	if (!TestZipFile())
 		return false;
+	if (!TestMappedZipFile())
+		return false;
 	return true;
 }
@@ -15,7 +15,11 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <cstring>
 #include <math.h>
+#include <vector>
+
 
 #include "Common/CommonTypes.h"
 #include "Common/TimeUtil.h"
@@ -81,7 +85,7 @@ class VertexDecoderTestHarness {
 		dec_->DecodeVerts(dst_, src_, &gstate_c.uv, indexLowerBound_, indexUpperBound);
 	}
 
-	double ExecuteTimed(int vtype, int indexUpperBound, bool useJit) {
+	double ExecuteTimed(int vtype, int indexUpperBound, bool useJit, double seconds = 0.5) {
 		SetupExecute(vtype, useJit);
 
 		int total = 0;
@@ -91,7 +95,7 @@ class VertexDecoderTestHarness {
 				dec_->DecodeVerts(dst_, src_, &gstate_c.uv, indexLowerBound_, indexUpperBound);
 				++total;
 			}
-		} while (time_now_d() - st < 0.5);
+		} while (time_now_d() - st < seconds);
 		double elapsed = time_now_d() - st;
 
 		return total / elapsed;
@@ -266,6 +270,25 @@ class VertexDecoderTestHarness {
 		return assertFailed_;
 	}
 
+	void SetAllowFMA(bool allow) {
+		cache_->SetAllowFMA(allow);
+	}
+
+	// The most common formats skip the jit in favor of VertexDecoderHandwritten.
+	bool IsHandwritten() const {
+		return dec_ && dec_->jitted_ && !cache_->IsInSpace((const u8 *)dec_->jitted_);
+	}
+
+	void AddRandomBytes(int count) {
+		if (needsReset_) {
+			Reset();
+		}
+		for (int i = 0; i < count; ++i) {
+			// Keep it deterministic, and avoid huge or NAN floats by never setting the top bits.
+			src_[srcPos_++] = (u8)((i * 37 + 11) & 0x3F);
+		}
+	}
+
 private:
 	void SetupExecute(int vtype, bool useJit) {
 		if (dec_ != nullptr) {
@@ -563,8 +586,10 @@ static bool TestVertex8Skin() {
 	dec.Add8(127, 0, 128);
 	dec.Add8(127, 0, 128);
 
-	for (int jit = 0; jit <= 1; ++jit) {
-		dec.Execute(vtype, 0, jit == 1);
+	// Steps, jit without and with FMA.
+	for (int jit = 0; jit <= 2; ++jit) {
+		dec.SetAllowFMA(jit == 2);
+		dec.Execute(vtype, 0, jit != 0);
 		dec.AssertFloat("TestVertex8Skin-Nrm", (2.0f * 1.5f + 1.0f * 0.5f) * 127.0f / 128.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 		dec.AssertFloat("TestVertex8Skin-Pos", (2.0f * 1.5f + 1.0f * 0.5f) * 127.0f / 128.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 	}
@@ -595,8 +620,10 @@ static bool TestVertex16Skin() {
 	dec.Add16(32767, 0, 32768);
 	dec.Add16(32767, 0, 32768);
 
-	for (int jit = 0; jit <= 1; ++jit) {
-		dec.Execute(vtype, 0, jit == 1);
+	// Steps, jit without and with FMA.
+	for (int jit = 0; jit <= 2; ++jit) {
+		dec.SetAllowFMA(jit == 2);
+		dec.Execute(vtype, 0, jit != 0);
 		dec.AssertFloat("TestVertex16Skin-Nrm", (2.0f * 1.5f + 1.0f * 0.5f) * 32767.0f / 32768.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 		dec.AssertFloat("TestVertex16Skin-Pos", (2.0f * 1.5f + 1.0f * 0.5f) * 32767.0f / 32768.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 	}
@@ -627,8 +654,10 @@ static bool TestVertexFloatSkin() {
 	dec.AddFloat(1.0f, 0, -1.0f);
 	dec.AddFloat(1.0f, 0, -1.0f);
 
-	for (int jit = 0; jit <= 1; ++jit) {
-		dec.Execute(vtype, 0, jit == 1);
+	// Steps, jit without and with FMA.
+	for (int jit = 0; jit <= 2; ++jit) {
+		dec.SetAllowFMA(jit == 2);
+		dec.Execute(vtype, 0, jit != 0);
 		dec.AssertFloat("TestVertexFloatSkin-Nrm", (2.0f * 1.5f + 1.0f * 0.5f) * 1.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 		dec.AssertFloat("TestVertexFloatSkin-Pos", (2.0f * 1.5f + 1.0f * 0.5f) * 1.0f, 0.0f, 2.0f * 5.0f * -1.0f);
 	}
@@ -636,8 +665,106 @@ static bool TestVertexFloatSkin() {
 	return !dec.HasFailed();
 }
 
+// FMA rounds once per multiply-add, so skinned output isn't bit exact with the steps or the SSE jit.
+// Check that it stays close on less tidy data than the tests above.
+static bool TestVertexSkinPrecision() {
+	static const int formats[] = {
+		GE_VTYPE_WEIGHT_8BIT | (3 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_8BIT | GE_VTYPE_POS_16BIT,
+		GE_VTYPE_WEIGHT_16BIT | (7 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_16BIT | GE_VTYPE_POS_16BIT,
+		GE_VTYPE_WEIGHT_FLOAT | (3 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_FLOAT | GE_VTYPE_POS_FLOAT,
+	};
+	const int count = 256;
+
+	float savedBones[ARRAY_SIZE(gstate.boneMatrix)];
+	memcpy(savedBones, gstate.boneMatrix, sizeof(savedBones));
+	for (int i = 0; i < 8 * 12; ++i) {
+		gstate.boneMatrix[i] = (float)((i * 7) % 13) * 0.37f - 2.0f;
+	}
+
+	bool pass = true;
+	for (int vtype : formats) {
+		VertexDecoderTestHarness dec;
+		VertexDecoderOptions opts{};
+		opts.applySkinInDecode = true;
+		dec.SetOptions(opts);
+		dec.AddRandomBytes(count * 128);
+
+		// Steps, jit without and with FMA. Skinned output is all floats.
+		std::vector<float> results[3];
+		for (int jit = 0; jit <= 2; ++jit) {
+			dec.SetAllowFMA(jit == 2);
+			dec.Execute(vtype, count - 1, jit != 0);
+			const float *data = (const float *)dec.GetData();
+			results[jit].assign(data, data + count * dec.GetDstStride() / sizeof(float));
+		}
+
+		for (int jit = 1; jit <= 2; ++jit) {
+			for (size_t i = 0; i < results[0].size(); ++i) {
+				float expected = results[0][i];
+				float actual = results[jit][i];
+				if (fabsf(actual - expected) > 0.00001f * std::max(1.0f, fabsf(expected))) {
+					printf("TestVertexSkinPrecision: %08x %s float %d: %f != expected %f\n", vtype, jit == 2 ? "fma" : "jit", (int)i, actual, expected);
+					pass = false;
+					break;
+				}
+			}
+		}
+	}
+
+	memcpy(gstate.boneMatrix, savedBones, sizeof(savedBones));
+	return pass;
+}
+
 // TODO: Morph (col, pos, nrm), weights (no skin), morph + weights?
 
+bool TestVertexJitBenchmark() {
+	static const struct {
+		const char *name;
+		int vtype;
+		bool skin;
+	} formats[] = {
+		{ "Ps8", GE_VTYPE_POS_8BIT, false },
+		{ "Tu8 C5551 Ps16", GE_VTYPE_TC_8BIT | GE_VTYPE_COL_5551 | GE_VTYPE_POS_16BIT, false },
+		{ "Tu16 Ns8 C8888 Pfloat", GE_VTYPE_TC_16BIT | GE_VTYPE_NRM_8BIT | GE_VTYPE_COL_8888 | GE_VTYPE_POS_FLOAT, false },
+		{ "Tfloat Nfloat Pfloat", GE_VTYPE_TC_FLOAT | GE_VTYPE_NRM_FLOAT | GE_VTYPE_POS_FLOAT, false },
+		{ "Ts16 Ns16 Ps16", GE_VTYPE_TC_16BIT | GE_VTYPE_NRM_16BIT | GE_VTYPE_POS_16BIT, false },
+		{ "W4u8 Ns8 Ps16 skin", GE_VTYPE_WEIGHT_8BIT | (3 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_8BIT | GE_VTYPE_POS_16BIT, true },
+		{ "W8u16 Ns16 Ps16 skin", GE_VTYPE_WEIGHT_16BIT | (7 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_16BIT | GE_VTYPE_POS_16BIT, true },
+		{ "W4float Nfloat Pfloat skin", GE_VTYPE_WEIGHT_FLOAT | (3 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_NRM_FLOAT | GE_VTYPE_POS_FLOAT, true },
+	};
+	const int count = 1024;
+
+	float savedBones[ARRAY_SIZE(gstate.boneMatrix)];
+	memcpy(savedBones, gstate.boneMatrix, sizeof(savedBones));
+	for (int i = 0; i < 8 * 12; ++i) {
+		gstate.boneMatrix[i] = (i % 4) == 0 ? 1.0f : 0.0f;
+	}
+
+	printf("Vertex decoder throughput (Mverts/s): steps, jit, jit fma\n");
+	for (const auto &format : formats) {
+		VertexDecoderTestHarness dec;
+		VertexDecoderOptions opts{};
+		opts.applySkinInDecode = format.skin;
+		dec.SetOptions(opts);
+		// Way more than the largest vertex size.
+		dec.AddRandomBytes(count * 128);
+
+		double steps = dec.ExecuteTimed(format.vtype, count - 1, false, 0.1);
+		dec.SetAllowFMA(false);
+		double jit = dec.ExecuteTimed(format.vtype, count - 1, true, 0.1);
+		bool handwritten = dec.IsHandwritten();
+		dec.SetAllowFMA(true);
+		double fma = dec.ExecuteTimed(format.vtype, count - 1, true, 0.1);
+
+		const double scale = count / 1000000.0;
+		printf("  %-28s %8.1f %8.1f %8.1f%s\n", format.name, steps * scale, jit * scale, fma * scale, handwritten ? " (handwritten)" : "");
+	}
+	printf("\n");
+
+	memcpy(gstate.boneMatrix, savedBones, sizeof(savedBones));
+	return true;
+}
+
 typedef bool (*VertexTestFunc)();
 
 static VertexTestFunc vertdecTestFuncs[] = {
@@ -657,6 +784,7 @@ static VertexTestFunc vertdecTestFuncs[] = {
 	&TestVertex8Skin,
 	&TestVertex16Skin,
 	&TestVertexFloatSkin,
+	&TestVertexSkinPrecision,
 };
 
 bool TestVertexJit() {
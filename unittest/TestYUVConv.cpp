@@ -0,0 +1,207 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+#include "Common/Data/Convert/YUVConv.h"
+#include "Common/Data/Random/Rng.h"
+#include "unittest/UnitTest.h"
+
+// The row converters must match the per-pixel functions exactly, for every width (to cover the SIMD
+// loop and the scalar tail) and every output format.
+
+static const YUVOutputFormat allFormats[] = {
+	YUVOutputFormat::RGBA8888, YUVOutputFormat::RGB565, YUVOutputFormat::RGBA5551, YUVOutputFormat::RGBA4444,
+};
+
+static const char *FormatName(YUVOutputFormat format) {
+	switch (format) {
+	case YUVOutputFormat::RGBA8888: return "8888";
+	case YUVOutputFormat::RGB565: return "565";
+	case YUVOutputFormat::RGBA5551: return "5551";
+	case YUVOutputFormat::RGBA4444: return "4444";
+	}
+	return "?";
+}
+
+static u32 ReferencePixel(YUVOutputFormat format, int y, int u, int v) {
+	int r, g, b;
+	YUVToRGB_BT601(y, u, v, &r, &g, &b);
+	switch (format) {
+	case YUVOutputFormat::RGBA8888: return (b << 16) | (g << 8) | r;
+	case YUVOutputFormat::RGB565: return (r >> 3) | ((g >> 2) << 5) | ((b >> 3) << 11);
+	case YUVOutputFormat::RGBA5551: return (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+	case YUVOutputFormat::RGBA4444: return (r >> 4) | ((g >> 4) << 4) | ((b >> 4) << 8);
+	}
+	return 0;
+}
+
+static void RandomBytes(GMRng &rng, std::vector<u8> &data) {
+	for (u8 &b : data)
+		b = (u8)rng.R32();
+}
+
+static bool TestBT601Rows(GMRng &rng) {
+	std::vector<u8> y(512), u(256), v(256);
+	std::vector<u32> out(512);
+	for (YUVOutputFormat format : allFormats) {
+		const int bpp = format == YUVOutputFormat::RGBA8888 ? 4 : 2;
+		for (int width = 1; width <= 512; width = width < 70 ? width + 1 : width * 2) {
+			RandomBytes(rng, y);
+			RandomBytes(rng, u);
+			RandomBytes(rng, v);
+			// Make sure the extremes show up, to exercise clamping and saturation.
+			y[0] = 255; u[0] = 255; v[0] = 255;
+			if (width > 2) {
+				y[2] = 0; u[1] = 0; v[1] = 0;
+			}
+			memset(out.data(), 0xCC, out.size() * sizeof(u32));
+
+			ConvertYUV420RowBT601(format, out.data(), y.data(), u.data(), v.data(), width);
+			for (int x = 0; x < width; x++) {
+				u32 expected = ReferencePixel(format, y[x], u[x >> 1], v[x >> 1]);
+				u32 actual = bpp == 4 ? out[x] : ((const u16 *)out.data())[x];
+				if (actual != expected) {
+					printf("YUV420 %s: mismatch at %d/%d: %08x != expected %08x\n", FormatName(format), x, width, actual, expected);
+					return false;
+				}
+			}
+			// And nothing written past the end.
+			const u8 *tail = (const u8 *)out.data() + width * bpp;
+			for (size_t i = width * bpp; i < out.size() * sizeof(u32); i++) {
+				if (*tail++ != 0xCC) {
+					printf("YUV420 %s: wrote past the end of a %d pixel row\n", FormatName(format), width);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool TestBT601Frame(GMRng &rng) {
+	// Odd size and padded strides, like FFmpeg gives us.
+	const int width = 37, height = 11;
+	const int yStride = 64, uvStride = 32, dstStride = 40 * 4;
+	std::vector<u8> y(yStride * height), u(uvStride * (height + 1) / 2), v(uvStride * (height + 1) / 2);
+	std::vector<u8> out(dstStride * height);
+	RandomBytes(rng, y);
+	RandomBytes(rng, u);
+	RandomBytes(rng, v);
+
+	ConvertYUV420ToRGB_BT601(YUVOutputFormat::RGBA8888, out.data(), dstStride, y.data(), yStride, u.data(), uvStride, v.data(), uvStride, width, height);
+	for (int row = 0; row < height; row++) {
+		const u32 *line = (const u32 *)(out.data() + row * dstStride);
+		for (int x = 0; x < width; x++) {
+			u32 expected = ReferencePixel(YUVOutputFormat::RGBA8888, y[row * yStride + x], u[(row >> 1) * uvStride + (x >> 1)], v[(row >> 1) * uvStride + (x >> 1)]);
+			if (line[x] != expected) {
+				printf("YUV420 frame: mismatch at %d,%d: %08x != expected %08x\n", x, row, line[x], expected);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool TestPSPJpegRows(GMRng &rng) {
+	std::vector<u8> y(512), cb(512), cr(512);
+	std::vector<u32> out(512);
+	for (int shift = 0; shift <= 1; shift++) {
+		for (int width = 1; width <= 512; width = width < 70 ? width + 1 : width * 2) {
+			RandomBytes(rng, y);
+			RandomBytes(rng, cb);
+			RandomBytes(rng, cr);
+			y[0] = 255; cb[0] = 255; cr[0] = 0;
+
+			ConvertYCbCrRowPSPJpeg(out.data(), y.data(), cb.data(), cr.data(), width, shift);
+			for (int x = 0; x < width; x++) {
+				u32 expected = YCbCrToABGR_PSPJpeg(y[x], cb[x >> shift], cr[x >> shift]);
+				if (out[x] != expected) {
+					printf("PSP jpeg (shift %d): mismatch at %d/%d: %08x != expected %08x\n", shift, x, width, out[x], expected);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static void BenchmarkYUV(GMRng &rng) {
+	// PSMF video size.
+	const int width = 480, height = 272;
+	std::vector<u8> y(width * height), u(width * height / 4), v(width * height / 4);
+	std::vector<u32> out(width * height);
+	RandomBytes(rng, y);
+	RandomBytes(rng, u);
+	RandomBytes(rng, v);
+
+	auto measure = [&](auto frame) {
+		int frames = 0;
+		double st = time_now_d();
+		do {
+			for (int i = 0; i < 16; i++)
+				frame();
+			frames += 16;
+		} while (time_now_d() - st < 0.1);
+		return frames / (time_now_d() - st);
+	};
+
+	for (YUVOutputFormat format : allFormats) {
+		const int bpp = format == YUVOutputFormat::RGBA8888 ? 4 : 2;
+		double fast = measure([&] {
+			ConvertYUV420ToRGB_BT601(format, (u8 *)out.data(), width * bpp, y.data(), width, u.data(), width / 2, v.data(), width / 2, width, height);
+		});
+		double plain = measure([&] {
+			for (int row = 0; row < height; row++) {
+				for (int x = 0; x < width; x++) {
+					u32 c = ReferencePixel(format, y[row * width + x], u[(row >> 1) * (width / 2) + (x >> 1)], v[(row >> 1) * (width / 2) + (x >> 1)]);
+					if (bpp == 4)
+						out[row * width + x] = c;
+					else
+						((u16 *)out.data())[row * width + x] = (u16)c;
+				}
+			}
+		});
+		printf("YUV420 -> %s: %0.0f frames/s (per pixel %0.0f)\n", FormatName(format), fast, plain);
+	}
+
+	double fast = measure([&] {
+		for (int row = 0; row < height; row++)
+			ConvertYCbCrRowPSPJpeg(&out[row * width], &y[row * width], &u[(row >> 1) * (width / 2)], &v[(row >> 1) * (width / 2)], width, 1);
+	});
+	double plain = measure([&] {
+		for (int row = 0; row < height; row++) {
+			for (int x = 0; x < width; x++)
+				out[row * width + x] = YCbCrToABGR_PSPJpeg(y[row * width + x], u[(row >> 1) * (width / 2) + (x >> 1)], v[(row >> 1) * (width / 2) + (x >> 1)]);
+		}
+	});
+	printf("sceJpeg YCbCr -> 8888: %0.0f frames/s (per pixel %0.0f)\n", fast, plain);
+}
+
+bool TestYUVConv() {
+	GMRng rng;
+	rng.Init(0x5678);
+
+	RET(TestBT601Rows(rng));
+	RET(TestBT601Frame(rng));
+	RET(TestPSPJpegRows(rng));
+	BenchmarkYUV(rng);
+	return true;
+}
@@ -35,12 +35,14 @@
 #include "ppsspp_config.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
 #include <vector>
 #include <string>
 #include <sstream>
+#include <thread>
 
 #if PPSSPP_PLATFORM(ANDROID)
 #include <jni.h>
@@ -49,11 +51,13 @@
 #include "Common/Data/Collections/TinySet.h"
 #include "Common/Data/Collections/FastVec.h"
 #include "Common/Data/Collections/CharQueue.h"
+#include "Common/Data/Collections/SPSCRing.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/Data/Text/WrapText.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Buffer.h"
+#include "Common/File/IOUring.h"
 #include "Common/File/Path.h"
 #include "Common/Input/InputState.h"
 #include "Common/Math/math_util.h"
@@ -1092,6 +1096,164 @@ bool TestBuffer() {
 	return true;
 }
 
+bool TestSPSCRing() {
+	SPSCRing<int> ring(8);
+	EXPECT_EQ_INT((int)ring.WriteAvailable(), 8);
+	const int data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	EXPECT_TRUE(ring.Push(data, 6));
+	EXPECT_FALSE(ring.Push(data, 3));
+	EXPECT_EQ_INT((int)ring.ReadAvailable(), 6);
+	EXPECT_EQ_INT(ring.Peek(5), 6);
+	int out[8];
+	EXPECT_EQ_INT((int)ring.Pop(out, 4), 4);
+	EXPECT_EQ_MEM(out, data, 4 * sizeof(int));
+
+	// This one wraps around the end.
+	EXPECT_TRUE(ring.Push(data, 6));
+	EXPECT_EQ_INT((int)ring.WriteAvailable(), 0);
+	EXPECT_EQ_INT(ring.Peek(2), 1);
+	EXPECT_EQ_INT((int)ring.Pop(out, 8), 8);
+	EXPECT_EQ_INT(out[0], 5);
+	EXPECT_EQ_INT(out[1], 6);
+	EXPECT_EQ_MEM(out + 2, data, 6 * sizeof(int));
+	EXPECT_EQ_INT((int)ring.Pop(out, 8), 0);
+
+	// Now hammer it from two threads, with odd sized chunks so the wrap point moves around.
+	// The consumer mixes Pop with Peek/Consume, like the audio resampler does.
+	const uint32_t total = 4000000;
+	SPSCRing<uint32_t> stress(1024);
+	// Set by the consumer on a mismatch, so the producer doesn't wait forever on a full ring.
+	std::atomic<bool> abort{};
+	std::thread producer([&] {
+		uint32_t next = 0;
+		uint32_t chunk[97];
+		int size = 1;
+		while (next < total && !abort.load(std::memory_order_relaxed)) {
+			size = size % 97 + 1;
+			int n = (int)std::min((uint32_t)size, total - next);
+			for (int i = 0; i < n; i++)
+				chunk[i] = next + i;
+			uint32_t *dest1, *dest2;
+			size_t sz1, sz2;
+			if ((size & 1) && stress.BeginWrite(n, &dest1, &sz1, &dest2, &sz2)) {
+				memcpy(dest1, chunk, sz1 * sizeof(uint32_t));
+				if (dest2)
+					memcpy(dest2, chunk + sz1, sz2 * sizeof(uint32_t));
+				stress.EndWrite(n);
+				next += n;
+			} else if (!(size & 1) && stress.Push(chunk, n)) {
+				next += n;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	bool success = true;
+	uint32_t chunk[61];
+	int size = 1;
+	while (expected < total && success) {
+		size = size % 61 + 1;
+		size_t n;
+		if (size & 1) {
+			n = stress.Pop(chunk, size);
+		} else {
+			n = std::min(stress.ReadAvailable(), (size_t)size);
+			for (size_t i = 0; i < n; i++)
+				chunk[i] = stress.Peek(i);
+			stress.Consume(n);
+		}
+		if (n == 0)
+			std::this_thread::yield();
+		for (size_t i = 0; i < n; i++) {
+			if (chunk[i] != expected + i) {
+				printf("SPSCRing: got %u, expected %u\n", chunk[i], (uint32_t)(expected + i));
+				success = false;
+				abort = true;
+				break;
+			}
+		}
+		expected += (uint32_t)n;
+	}
+	producer.join();
+	EXPECT_TRUE(success);
+	EXPECT_EQ_INT((int)stress.SizeApprox(), 0);
+	return true;
+}
+
+bool TestIOUring() {
+	IOUring ring;
+	if (!ring.Init(16)) {
+		// Fine, everything falls back to plain reads then.
+		printf("io_uring not available, skipping\n");
+		return true;
+	}
+
+	FILE *f = tmpfile();
+	EXPECT_TRUE(f != nullptr);
+	std::vector<uint32_t> data(64 * 1024);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (uint32_t)i * 2654435761U;
+	EXPECT_EQ_INT((int)fwrite(data.data(), sizeof(uint32_t), data.size(), f), (int)data.size());
+	fflush(f);
+	const int fd = fileno(f);
+
+	// Several reads in flight at once, completing in whatever order. The last one is cut short by the end of the file.
+	const int count = 12;
+	const uint32_t readSize = 32 * 1024;
+	std::vector<uint8_t> buffers[count];
+	for (int i = 0; i < count; i++) {
+		buffers[i].resize(readSize);
+		EXPECT_TRUE(ring.SubmitRead(fd, buffers[i].data(), readSize, (uint64_t)i * 23 * 1000, i));
+	}
+	bool seen[count]{};
+	for (int i = 0; i < count; i++) {
+		uint64_t userData;
+		int32_t result;
+		EXPECT_TRUE(ring.WaitCompletion(&userData, &result));
+		EXPECT_TRUE(userData < count && !seen[userData]);
+		seen[userData] = true;
+
+		const size_t offset = (size_t)userData * 23 * 1000;
+		const size_t expected = std::min((size_t)readSize, data.size() * sizeof(uint32_t) - offset);
+		EXPECT_EQ_INT(result, (int)expected);
+		EXPECT_TRUE(memcmp(buffers[userData].data(), (const uint8_t *)data.data() + offset, expected) == 0);
+	}
+
+	// A read of a bad file reports the error, and a nop can wake up a waiting thread.
+	uint8_t byte;
+	EXPECT_TRUE(ring.SubmitRead(-1, &byte, 1, 0, 100));
+	uint64_t userData = 0;
+	int32_t result = 0;
+	EXPECT_TRUE(ring.WaitCompletion(&userData, &result));
+	EXPECT_EQ_INT((int)userData, 100);
+	EXPECT_TRUE(result < 0);
+
+	std::thread waiter([&] {
+		ring.WaitCompletion(&userData, &result);
+	});
+	EXPECT_TRUE(ring.SubmitNop(200));
+	waiter.join();
+	EXPECT_EQ_INT((int)userData, 200);
+
+	// Without a nop, interrupting makes a blocked wait fail so the thread can still be joined.
+	bool waited = true;
+	std::thread stuck([&] {
+		waited = ring.WaitCompletion(&userData, &result);
+	});
+	sleep_ms(50, "io-uring-test");
+	ring.Interrupt();
+	stuck.join();
+	EXPECT_FALSE(waited);
+	EXPECT_FALSE(ring.SubmitNop(300));
+
+	fclose(f);
+	ring.Shutdown();
+	EXPECT_FALSE(ring.IsOpen());
+	return true;
+}
+
 typedef bool (*TestFunc)();
 struct TestItem {
 	const char *name;
@@ -1109,6 +1271,15 @@ bool TestSoftwareGPUJit();
 bool TestIRPassSimplify();
 bool TestThreadManager();
 bool TestVFS();
+bool TestSasAudio();
+bool TestAt3Dsp();
+bool TestAudioResampler();
+bool TestYUVConv();
+bool TestFLACEncoder();
+bool TestSasReverb();
+bool TestBlockDevices();
+bool TestSaveStateChunks();
+bool TestVertexJitBenchmark();
 
 TestItem availableTests[] = {
 #if PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
@@ -1154,6 +1325,21 @@ TestItem availableTests[] = {
 	TEST_ITEM(ColorConv),
 	TEST_ITEM(CharQueue),
 	TEST_ITEM(Buffer),
+	TEST_ITEM(SasAudio),
+	TEST_ITEM(At3Dsp),
+	TEST_ITEM(AudioResampler),
+	TEST_ITEM(YUVConv),
+	TEST_ITEM(FLACEncoder),
+	TEST_ITEM(SasReverb),
+	TEST_ITEM(BlockDevices),
+	TEST_ITEM(SPSCRing),
+	TEST_ITEM(IOUring),
+	TEST_ITEM(SaveStateChunks),
+};
+
+// Only timings, so these are left out of "all". Run them by name.
+TestItem benchmarkTests[] = {
+	TEST_ITEM(VertexJitBenchmark),
 };
 
 int main(int argc, const char *argv[]) {
@@ -1182,6 +1368,12 @@ int main(int argc, const char *argv[]) {
 				break;
 			}
 		}
+		for (auto f : benchmarkTests) {
+			if (!strcasecmp(argv[1], f.name)) {
+				testFunc = f.func;
+				break;
+			}
+		}
 	}
 
 	if (allTests) {
@@ -1209,6 +1401,11 @@ int main(int argc, const char *argv[]) {
 		for (auto f : availableTests) {
 			fprintf(stderr, "  * %s\n", f.name);
 		}
+		fprintf(stderr, "\n");
+		fprintf(stderr, "Benchmarks (not part of \"all\"):\n");
+		for (auto f : benchmarkTests) {
+			fprintf(stderr, "  * %s\n", f.name);
+		}
 		return 1;
 	} else {
 		if (!testFunc()) {